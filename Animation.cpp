@@ -0,0 +1,157 @@
+#include "Animation.h"
+
+#include <algorithm>
+#include <cassert>
+#include "JobSystem.h"
+#include "MathKernel.h"
+#include "SimdDispatch.h"
+
+namespace {
+
+// 1回に補間するチャンネル数(作業領域がL1に収まる量)
+const size_t kChunkSize = 256;
+// JobSystemで分けるときの1区間の最小のチャンネル数
+const size_t kParallelMinGrain = 1024;
+// カーソルから先へ順に調べるキーの数(これで見つからなければ二分探索する)
+const uint32_t kLinearSearchKeys = 4;
+
+} // namespace
+
+uint32_t AnimationTrack::AddKeyTimes(const float* times, size_t keyCount) {
+	assert(keyCount >= 1);
+	assert(std::is_sorted(times, times + keyCount));
+	const uint32_t channel = static_cast<uint32_t>(GetChannelCount());
+	times_.insert(times_.end(), times, times + keyCount);
+	if (keyCount == 1) {
+		times_.push_back(times[0]);
+	}
+	keyBegins_.push_back(static_cast<uint32_t>(times_.size()));
+	return channel;
+}
+
+void AnimationTrack::Locate(
+    float time, uint32_t* cursors, size_t begin, size_t end, uint32_t* keys, float* weights) const {
+	const float* allTimes = times_.data();
+	const uint32_t* keyBegins = keyBegins_.data();
+	for (size_t channel = begin; channel < end; channel++) {
+		const uint32_t keyBegin = keyBegins[channel];
+		const float* times = allTimes + keyBegin;
+		const uint32_t last = keyBegins[channel + 1] - keyBegin - 1;
+		uint32_t key = std::min(cursors[channel], last - 1);
+		float weight = 0.0f;
+		if (time >= times[last]) {
+			key = last - 1;
+			weight = 1.0f;
+		}
+		else if (time <= times[0]) {
+			key = 0;
+		}
+		else {
+			// times[key] <= time < times[key + 1]となるkeyを探す
+			// 少し先なら順に進め、戻ったときや遠いときは二分探索する
+			uint32_t steps = 0;
+			while (times[key] > time || times[key + 1] <= time) {
+				if (times[key] > time || ++steps > kLinearSearchKeys) {
+					key = static_cast<uint32_t>(std::upper_bound(times, times + last, time) - times) - 1;
+					break;
+				}
+				key++;
+			}
+			weight = (time - times[key]) / (times[key + 1] - times[key]);
+		}
+		cursors[channel] = key;
+		keys[channel - begin] = keyBegin + key;
+		weights[channel - begin] = weight;
+	}
+}
+
+uint32_t Vector3Track::AddChannel(const float* times, const Vector3* values, size_t keyCount) {
+	const uint32_t channel = AddKeyTimes(times, keyCount);
+	values_.insert(values_.end(), values, values + keyCount);
+	if (keyCount == 1) {
+		values_.push_back(values[0]);
+	}
+	return channel;
+}
+
+// キーの値をkChunkSize個ずつSoAに集めてから一括で補間する
+void Vector3Track::Sample(float time, uint32_t* cursors, const Vector3SoA& result) const {
+	static const auto lerp = MT4_SELECT_SIMD_KERNEL(LerpVectors);
+	static const auto lerpShortAngle = MT4_SELECT_SIMD_KERNEL(LerpShortAngles);
+	JobSystem::GetInstance().ParallelFor(GetChannelCount(), kParallelMinGrain, [&](size_t rangeBegin, size_t rangeEnd) {
+		uint32_t keys[kChunkSize];
+		float weights[kChunkSize];
+		float x0[kChunkSize], y0[kChunkSize], z0[kChunkSize];
+		float x1[kChunkSize], y1[kChunkSize], z1[kChunkSize];
+		const Vector3* values = values_.data();
+		for (size_t begin = rangeBegin; begin < rangeEnd; begin += kChunkSize) {
+			const size_t count = std::min(rangeEnd - begin, kChunkSize);
+			Locate(time, cursors, begin, begin + count, keys, weights);
+			for (size_t i = 0; i < count; i++) {
+				const Vector3& from = values[keys[i]];
+				const Vector3& to = values[keys[i] + 1];
+				x0[i] = from.x;
+				y0[i] = from.y;
+				z0[i] = from.z;
+				x1[i] = to.x;
+				y1[i] = to.y;
+				z1[i] = to.z;
+			}
+			const Vector3SoA output{ result.x + begin, result.y + begin, result.z + begin };
+			if (interpolation_ == Vector3Interpolation::kLinear) {
+				lerp(ConstVector3SoA(x0, y0, z0), ConstVector3SoA(x1, y1, z1), weights, output, count);
+			}
+			else {
+				lerpShortAngle(x0, x1, weights, output.x, count);
+				lerpShortAngle(y0, y1, weights, output.y, count);
+				lerpShortAngle(z0, z1, weights, output.z, count);
+			}
+		}
+	});
+}
+
+uint32_t QuaternionTrack::AddChannel(const float* times, const Quaternion* values, size_t keyCount) {
+	const uint32_t channel = AddKeyTimes(times, keyCount);
+	values_.insert(values_.end(), values, values + keyCount);
+	if (keyCount == 1) {
+		values_.push_back(values[0]);
+	}
+	return channel;
+}
+
+void QuaternionTrack::Sample(float time, uint32_t* cursors, const QuaternionSoA& result) const {
+	static const auto slerp = MT4_SELECT_SIMD_KERNEL(SlerpQuaternions);
+	static const auto nlerp = MT4_SELECT_SIMD_KERNEL(NlerpQuaternions);
+	JobSystem::GetInstance().ParallelFor(GetChannelCount(), kParallelMinGrain, [&](size_t rangeBegin, size_t rangeEnd) {
+		uint32_t keys[kChunkSize];
+		float weights[kChunkSize];
+		float x0[kChunkSize], y0[kChunkSize], z0[kChunkSize], w0[kChunkSize];
+		float x1[kChunkSize], y1[kChunkSize], z1[kChunkSize], w1[kChunkSize];
+		const Quaternion* values = values_.data();
+		for (size_t begin = rangeBegin; begin < rangeEnd; begin += kChunkSize) {
+			const size_t count = std::min(rangeEnd - begin, kChunkSize);
+			Locate(time, cursors, begin, begin + count, keys, weights);
+			for (size_t i = 0; i < count; i++) {
+				const Quaternion& from = values[keys[i]];
+				const Quaternion& to = values[keys[i] + 1];
+				x0[i] = from.x;
+				y0[i] = from.y;
+				z0[i] = from.z;
+				w0[i] = from.w;
+				x1[i] = to.x;
+				y1[i] = to.y;
+				z1[i] = to.z;
+				w1[i] = to.w;
+			}
+			const ConstQuaternionSoA from(x0, y0, z0, w0);
+			const ConstQuaternionSoA to(x1, y1, z1, w1);
+			const QuaternionSoA output{ result.x + begin, result.y + begin, result.z + begin, result.w + begin };
+			if (interpolation_ == QuaternionInterpolation::kSlerp) {
+				slerp(from, to, weights, output, count);
+			}
+			else {
+				nlerp(from, to, weights, output, count);
+			}
+		}
+	});
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+// キーフレームアニメーション
+// 同じ種類のチャンネル(全ボーンの平行移動など)を1つのトラックにまとめ、全チャンネルを同じ時刻で一括評価する
+// キーの時刻と値はチャンネルの順に1本の配列に詰めて持つ
+// 前回のキーの位置(カーソル)はチャンネルごとに呼び出し側が持ち、再生位置が少しずつ進むときは探し直さない
+// 評価結果のSoAはそのままMakeAffineMatrix(一括)に渡せる
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Quaternion.h"
+#include "QuaternionSoA.h"
+#include "Vector3.h"
+#include "Vector3SoA.h"
+
+// Vector3のチャンネルの補間方法
+enum class Vector3Interpolation {
+	kLinear,     // Lerp(平行移動・スケール)
+	kShortAngle, // 成分ごとにLerpShortAngle(オイラー角)
+};
+
+// クォータニオンのチャンネルの補間方法
+enum class QuaternionInterpolation {
+	kSlerp,
+	kNlerp,
+};
+
+// キーの時刻を持つトラックの共通部分
+class AnimationTrack {
+public:
+	size_t GetChannelCount() const { return keyBegins_.size() - 1; }
+	// チャンネルの最初と最後のキーの時刻
+	float GetStartTime(uint32_t channel) const { return times_[keyBegins_[channel]]; }
+	float GetEndTime(uint32_t channel) const { return times_[keyBegins_[channel + 1] - 1]; }
+
+protected:
+	AnimationTrack() : keyBegins_{ 0 } {}
+
+	// キーの時刻を追加してチャンネル番号を返す(timesは昇順、keyCount >= 1)
+	// キーが1つのときは同じキーを2つ持ち、どのチャンネルにも補間する2つのキーがあるようにする
+	uint32_t AddKeyTimes(const float* times, size_t keyCount);
+	// チャンネル[begin, end)について、時刻timeを挟むキー(keys[i], keys[i] + 1)と補間係数を求める
+	// 範囲外の時刻は最初か最後のキーの値になる
+	void Locate(float time, uint32_t* cursors, size_t begin, size_t end, uint32_t* keys, float* weights) const;
+
+	std::vector<float> times_;
+	std::vector<uint32_t> keyBegins_; // チャンネルcのキーは[keyBegins_[c], keyBegins_[c + 1])
+};
+
+// Vector3のトラック
+class Vector3Track : public AnimationTrack {
+public:
+	explicit Vector3Track(Vector3Interpolation interpolation = Vector3Interpolation::kLinear)
+	    : interpolation_(interpolation) {}
+
+	// チャンネルを追加して番号を返す(timesは昇順、keyCount >= 1)
+	uint32_t AddChannel(const float* times, const Vector3* values, size_t keyCount);
+	// 時刻timeでの全チャンネルの値をresultに書き込む
+	// cursorsはチャンネル数分の配列で、最初は0にしておく(評価するたびに更新される)
+	void Sample(float time, uint32_t* cursors, const Vector3SoA& result) const;
+
+private:
+	Vector3Interpolation interpolation_;
+	std::vector<Vector3> values_;
+};
+
+// クォータニオンのトラック
+class QuaternionTrack : public AnimationTrack {
+public:
+	explicit QuaternionTrack(QuaternionInterpolation interpolation = QuaternionInterpolation::kSlerp)
+	    : interpolation_(interpolation) {}
+
+	// チャンネルを追加して番号を返す(timesは昇順、keyCount >= 1、valuesは単位クォータニオン)
+	uint32_t AddChannel(const float* times, const Quaternion* values, size_t keyCount);
+	// 時刻timeでの全チャンネルの値をresultに書き込む(cursorsはVector3Track::Sampleと同じ)
+	void Sample(float time, uint32_t* cursors, const QuaternionSoA& result) const;
+
+private:
+	QuaternionInterpolation interpolation_;
+	std::vector<Quaternion> values_;
+};
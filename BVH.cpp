@@ -0,0 +1,369 @@
+#include "BVH.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include "JobSystem.h"
+#include "MathFunction.h"
+#include "MathKernel.h"
+#include "SimdDispatch.h"
+
+namespace {
+
+// これ以下なら分けずに葉にする
+const uint32_t kMinSplitSize = 2;
+// SAHで分け方を調べるときのビンの数(軸ごと)
+const size_t kBinCount = 16;
+// SAHのコスト ノード1つをたどるコスト(図形1つとの判定を1とする)
+const float kTraversalCost = 2.0f;
+// JobSystemで分けるときの1区間の最小の数
+const size_t kRayParallelMinGrain = 64;
+const size_t kPointParallelMinGrain = 64;
+const size_t kRefitParallelMinGrain = 4096;
+
+// 構築中の図形
+struct BuildItem {
+	AABB bounds;
+	Vector3 center;
+	uint32_t id;
+};
+
+AABB MakeEmptyAABB() {
+	const float infinity = std::numeric_limits<float>::infinity();
+	return { { infinity, infinity, infinity }, { -infinity, -infinity, -infinity } };
+}
+
+// 構築で何度も呼ぶので、NaNを考えなくてよいstd::min/maxを使う
+void Grow(AABB& aabb, const Vector3& point) {
+	aabb.min = { std::min(aabb.min.x, point.x), std::min(aabb.min.y, point.y), std::min(aabb.min.z, point.z) };
+	aabb.max = { std::max(aabb.max.x, point.x), std::max(aabb.max.y, point.y), std::max(aabb.max.z, point.z) };
+}
+
+void Grow(AABB& aabb, const AABB& other) {
+	aabb.min = { std::min(aabb.min.x, other.min.x), std::min(aabb.min.y, other.min.y), std::min(aabb.min.z, other.min.z) };
+	aabb.max = { std::max(aabb.max.x, other.max.x), std::max(aabb.max.y, other.max.y), std::max(aabb.max.z, other.max.z) };
+}
+
+// 表面積の半分(比べるだけなので2倍しない)
+float GetHalfArea(const AABB& aabb) {
+	const Vector3 size = Subtract(aabb.max, aabb.min);
+	return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+float GetAxis(const Vector3& v, uint32_t axis) { return axis == 0 ? v.x : (axis == 1 ? v.y : v.z); }
+
+uint32_t MakeId(BVHPrimitiveType type, size_t index) {
+	return (static_cast<uint32_t>(type) << kBVHTypeShift) | static_cast<uint32_t>(index);
+}
+
+// 元の図形から葉の図形を作る
+BVHPrimitive MakePrimitive(const BVHGeometry& geometry, uint32_t id) {
+	const uint32_t index = id & ((1u << kBVHTypeShift) - 1);
+	switch (static_cast<BVHPrimitiveType>(id >> kBVHTypeShift)) {
+	case BVHPrimitiveType::kTriangle: {
+		const Triangle& triangle = geometry.triangles[index];
+		return { triangle.vertices[0], Subtract(triangle.vertices[1], triangle.vertices[0]),
+			Subtract(triangle.vertices[2], triangle.vertices[0]), id };
+	}
+	case BVHPrimitiveType::kSphere: {
+		const Sphere& sphere = geometry.spheres[index];
+		return { sphere.center, { sphere.radius, 0.0f, 0.0f }, {}, id };
+	}
+	default: {
+		const Segment& segment = geometry.segments[index];
+		return { segment.origin, segment.diff, { geometry.segmentRadius, 0.0f, 0.0f }, id };
+	}
+	}
+}
+
+AABB GetBounds(const BVHPrimitive& primitive) {
+	AABB bounds = MakeEmptyAABB();
+	switch (static_cast<BVHPrimitiveType>(primitive.id >> kBVHTypeShift)) {
+	case BVHPrimitiveType::kTriangle:
+		Grow(bounds, primitive.a);
+		Grow(bounds, Add(primitive.a, primitive.b));
+		Grow(bounds, Add(primitive.a, primitive.c));
+		return bounds;
+	case BVHPrimitiveType::kSphere: {
+		const Vector3 radius{ primitive.b.x, primitive.b.x, primitive.b.x };
+		return { Subtract(primitive.a, radius), Add(primitive.a, radius) };
+	}
+	default: {
+		const Vector3 radius{ primitive.c.x, primitive.c.x, primitive.c.x };
+		Grow(bounds, primitive.a);
+		Grow(bounds, Add(primitive.a, primitive.b));
+		return { Subtract(bounds.min, radius), Add(bounds.max, radius) };
+	}
+	}
+}
+
+// 図形上で点に最も近い点
+Vector3 GetClosestPoint(const BVHPrimitive& primitive, const Vector3& point) {
+	switch (static_cast<BVHPrimitiveType>(primitive.id >> kBVHTypeShift)) {
+	case BVHPrimitiveType::kTriangle:
+		return ClosestPoint(point, Triangle{ { primitive.a, Add(primitive.a, primitive.b), Add(primitive.a, primitive.c) } });
+	case BVHPrimitiveType::kSphere:
+		return ClosestPoint(point, Sphere{ primitive.a, primitive.b.x });
+	default:
+		return ClosestPoint(point, Segment{ primitive.a, primitive.b });
+	}
+}
+
+// AABBと点の距離の2乗(内側なら0)
+float GetDistanceSquared(const AABB& aabb, const Vector3& point) {
+	const float dx = std::fmax(std::fmax(aabb.min.x - point.x, point.x - aabb.max.x), 0.0f);
+	const float dy = std::fmax(std::fmax(aabb.min.y - point.y, point.y - aabb.max.y), 0.0f);
+	const float dz = std::fmax(std::fmax(aabb.min.z - point.z, point.z - aabb.max.z), 0.0f);
+	return dx * dx + dy * dy + dz * dz;
+}
+
+// [begin, end)の図形でノードを作り、子を深さ優先で続けて作る
+void BuildNode(std::vector<BVHNode>& nodes, std::vector<BuildItem>& items, uint32_t begin, uint32_t end, size_t depth) {
+	const uint32_t nodeIndex = static_cast<uint32_t>(nodes.size());
+	nodes.push_back({});
+	AABB bounds = MakeEmptyAABB();
+	AABB centers = MakeEmptyAABB();
+	for (uint32_t i = begin; i < end; i++) {
+		Grow(bounds, items[i].bounds);
+		Grow(centers, items[i].center);
+	}
+	nodes[nodeIndex].bounds = bounds;
+	const uint32_t count = end - begin;
+	// 深さの上限に達したら分けない(下の中央値で分けるので、ここでの数もkBVHMaxLeafSize以下になる)
+	if (count <= kMinSplitSize || depth + 2 >= kBVHStackSize) {
+		assert(count <= kBVHMaxLeafSize);
+		nodes[nodeIndex].index = begin;
+		nodes[nodeIndex].count = static_cast<uint16_t>(count);
+		return;
+	}
+	// SAHで偏った分け方(端の数個だけを切り離す)が続くと、深さの上限で大きな葉ができてしまう
+	// 残りの深さで半分ずつ分けても葉がkBVHMaxLeafSizeを超える数なら、中心の最も広がった軸の中央値で分ける
+	const size_t remainingDepth = kBVHStackSize - 2 - depth;
+	if (remainingDepth <= 32 && count > (uint64_t(kBVHMaxLeafSize) << (remainingDepth - 1))) {
+		const Vector3 extent = Subtract(centers.max, centers.min);
+		const uint32_t axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+		const uint32_t middle = begin + count / 2;
+		std::nth_element(items.begin() + begin, items.begin() + middle, items.begin() + end,
+		    [&](const BuildItem& a, const BuildItem& b) { return GetAxis(a.center, axis) < GetAxis(b.center, axis); });
+		nodes[nodeIndex].axis = static_cast<uint16_t>(axis);
+		nodes[nodeIndex].count = 0;
+		BuildNode(nodes, items, begin, middle, depth + 1);
+		nodes[nodeIndex].index = static_cast<uint32_t>(nodes.size());
+		BuildNode(nodes, items, middle, end, depth + 1);
+		return;
+	}
+
+	// 中心をビンに分け、ビンの境目で分けたときのSAHのコストが最小になる軸と位置を探す
+	float bestCost = std::numeric_limits<float>::infinity();
+	uint32_t bestAxis = 0;
+	size_t bestSplit = 0;
+	for (uint32_t axis = 0; axis < 3; axis++) {
+		const float minCenter = GetAxis(centers.min, axis);
+		const float extent = GetAxis(centers.max, axis) - minCenter;
+		if (!(extent > 0.0f)) {
+			continue;
+		}
+		const float scale = float(kBinCount) / extent;
+		AABB binBounds[kBinCount];
+		uint32_t binCounts[kBinCount] = {};
+		for (AABB& binBound : binBounds) {
+			binBound = MakeEmptyAABB();
+		}
+		for (uint32_t i = begin; i < end; i++) {
+			const size_t bin = std::min(size_t((GetAxis(items[i].center, axis) - minCenter) * scale), kBinCount - 1);
+			Grow(binBounds[bin], items[i].bounds);
+			binCounts[bin]++;
+		}
+		// 右側の累積を先に求め、左から順に足しながらコストを比べる
+		float rightCosts[kBinCount];
+		AABB right = MakeEmptyAABB();
+		uint32_t rightCount = 0;
+		for (size_t bin = kBinCount - 1; bin > 0; bin--) {
+			Grow(right, binBounds[bin]);
+			rightCount += binCounts[bin];
+			rightCosts[bin] = rightCount > 0 ? GetHalfArea(right) * float(rightCount) : 0.0f;
+		}
+		AABB left = MakeEmptyAABB();
+		uint32_t leftCount = 0;
+		for (size_t split = 1; split < kBinCount; split++) {
+			Grow(left, binBounds[split - 1]);
+			leftCount += binCounts[split - 1];
+			if (leftCount == 0 || leftCount == count) {
+				continue;
+			}
+			const float cost = GetHalfArea(left) * float(leftCount) + rightCosts[split];
+			if (cost < bestCost) {
+				bestCost = cost;
+				bestAxis = axis;
+				bestSplit = split;
+			}
+		}
+	}
+
+	uint32_t middle = begin;
+	if (bestSplit > 0) {
+		// 分けたときのコスト(親の表面積に対する割合) + たどるコストが葉のままのコストより大きければ葉にする
+		const float parentArea = GetHalfArea(bounds);
+		if (count <= kBVHMaxLeafSize && kTraversalCost + bestCost / parentArea >= float(count)) {
+			nodes[nodeIndex].index = begin;
+			nodes[nodeIndex].count = static_cast<uint16_t>(count);
+			return;
+		}
+		const float minCenter = GetAxis(centers.min, bestAxis);
+		const float scale = float(kBinCount) / (GetAxis(centers.max, bestAxis) - minCenter);
+		middle = static_cast<uint32_t>(std::partition(items.begin() + begin, items.begin() + end, [&](const BuildItem& item) {
+			return std::min(size_t((GetAxis(item.center, bestAxis) - minCenter) * scale), kBinCount - 1) < bestSplit;
+		}) - items.begin());
+	}
+	if (middle == begin || middle == end) {
+		// 中心がすべて同じ位置にあるときは数で半分に分ける
+		if (count <= kBVHMaxLeafSize) {
+			nodes[nodeIndex].index = begin;
+			nodes[nodeIndex].count = static_cast<uint16_t>(count);
+			return;
+		}
+		middle = begin + count / 2;
+	}
+
+	nodes[nodeIndex].axis = static_cast<uint16_t>(bestAxis);
+	nodes[nodeIndex].count = 0;
+	BuildNode(nodes, items, begin, middle, depth + 1);
+	nodes[nodeIndex].index = static_cast<uint32_t>(nodes.size());
+	BuildNode(nodes, items, middle, end, depth + 1);
+}
+
+} // namespace
+
+void BVH::Build(const BVHGeometry& geometry) {
+	assert(geometry.triangleCount < (1u << kBVHTypeShift));
+	assert(geometry.sphereCount < (1u << kBVHTypeShift));
+	assert(geometry.segmentCount < (1u << kBVHTypeShift));
+	nodes_.clear();
+	primitives_.clear();
+	const size_t count = geometry.triangleCount + geometry.sphereCount + geometry.segmentCount;
+	if (count == 0) {
+		return;
+	}
+
+	std::vector<BuildItem> items;
+	items.reserve(count);
+	const auto add = [&](BVHPrimitiveType type, size_t typeCount) {
+		for (size_t i = 0; i < typeCount; i++) {
+			const AABB bounds = GetBounds(MakePrimitive(geometry, MakeId(type, i)));
+			const Vector3 center = Multiply(0.5f, Add(bounds.min, bounds.max));
+			items.push_back({ bounds, center, MakeId(type, i) });
+		}
+	};
+	add(BVHPrimitiveType::kTriangle, geometry.triangleCount);
+	add(BVHPrimitiveType::kSphere, geometry.sphereCount);
+	add(BVHPrimitiveType::kSegment, geometry.segmentCount);
+
+	nodes_.reserve(count * 2);
+	BuildNode(nodes_, items, 0, static_cast<uint32_t>(count), 0);
+	nodes_.shrink_to_fit();
+	primitives_.reserve(count);
+	for (const BuildItem& item : items) {
+		primitives_.push_back(MakePrimitive(geometry, item.id));
+	}
+}
+
+// 子は親より後ろにあるので、後ろから順に境界を求め直せば子が先に終わっている
+void BVH::Refit(const BVHGeometry& geometry) {
+	assert(primitives_.size() == geometry.triangleCount + geometry.sphereCount + geometry.segmentCount);
+	JobSystem::GetInstance().ParallelFor(primitives_.size(), kRefitParallelMinGrain, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			primitives_[i] = MakePrimitive(geometry, primitives_[i].id);
+		}
+	});
+	for (size_t i = nodes_.size(); i-- > 0;) {
+		BVHNode& node = nodes_[i];
+		AABB bounds = MakeEmptyAABB();
+		if (node.count > 0) {
+			for (uint32_t p = node.index; p < node.index + node.count; p++) {
+				Grow(bounds, GetBounds(primitives_[p]));
+			}
+		}
+		else {
+			bounds = nodes_[i + 1].bounds;
+			Grow(bounds, nodes_[node.index].bounds);
+		}
+		node.bounds = bounds;
+	}
+}
+
+bool BVH::Raycast(const Ray& ray, RayHit& hit, float maxT) const {
+	const ConstRaySoA rays(&ray.origin.x, &ray.origin.y, &ray.origin.z, &ray.diff.x, &ray.diff.y, &ray.diff.z);
+	Raycast(rays, &maxT, &hit, 1);
+	return hit.index != kBVHNoHit;
+}
+
+void BVH::Raycast(const ConstRaySoA& rays, const float* maxT, RayHit* hits, size_t count) const {
+	if (nodes_.empty()) {
+		for (size_t i = 0; i < count; i++) {
+			hits[i] = { maxT ? maxT[i] : std::numeric_limits<float>::infinity(), kBVHNoHit, BVHPrimitiveType::kTriangle };
+		}
+		return;
+	}
+	static const auto kernel = MT4_SELECT_SIMD_KERNEL(RaycastBVH);
+	JobSystem::GetInstance().ParallelFor(count, kRayParallelMinGrain, [&](size_t begin, size_t end) {
+		const ConstRaySoA range(rays.originX + begin, rays.originY + begin, rays.originZ + begin,
+		    rays.diffX + begin, rays.diffY + begin, rays.diffZ + begin);
+		kernel(nodes_.data(), primitives_.data(), range, maxT ? maxT + begin : nullptr, hits + begin, end - begin);
+	});
+}
+
+// 近い方の子から調べ、見つかった点より遠いノードは省く
+bool BVH::FindClosestPoint(const Vector3& point, BVHClosestPoint& result, float maxDistance) const {
+	result = { point, maxDistance, kBVHNoHit, BVHPrimitiveType::kTriangle };
+	if (nodes_.empty()) {
+		return false;
+	}
+	float bestSquared = maxDistance * maxDistance;
+	struct Entry {
+		uint32_t node;
+		float distanceSquared;
+	};
+	Entry stack[kBVHStackSize];
+	size_t stackSize = 0;
+	stack[stackSize++] = { 0, GetDistanceSquared(nodes_[0].bounds, point) };
+	while (stackSize > 0) {
+		const Entry entry = stack[--stackSize];
+		if (entry.distanceSquared > bestSquared) {
+			continue;
+		}
+		const BVHNode& node = nodes_[entry.node];
+		if (node.count == 0) {
+			Entry near{ entry.node + 1, GetDistanceSquared(nodes_[entry.node + 1].bounds, point) };
+			Entry far{ node.index, GetDistanceSquared(nodes_[node.index].bounds, point) };
+			if (far.distanceSquared < near.distanceSquared) {
+				std::swap(near, far);
+			}
+			stack[stackSize++] = far;
+			stack[stackSize++] = near;
+			continue;
+		}
+		for (uint32_t p = node.index; p < node.index + node.count; p++) {
+			const Vector3 closest = GetClosestPoint(primitives_[p], point);
+			const Vector3 offset = Subtract(closest, point);
+			const float distanceSquared = Dot(offset, offset);
+			if (distanceSquared < bestSquared) {
+				bestSquared = distanceSquared;
+				const uint32_t id = primitives_[p].id;
+				result = { closest, 0.0f, id & ((1u << kBVHTypeShift) - 1), static_cast<BVHPrimitiveType>(id >> kBVHTypeShift) };
+			}
+		}
+	}
+	if (result.index == kBVHNoHit) {
+		return false;
+	}
+	result.distance = std::sqrt(bestSquared);
+	return true;
+}
+
+void BVH::FindClosestPoints(const ConstVector3SoA& points, BVHClosestPoint* results, size_t count, float maxDistance) const {
+	JobSystem::GetInstance().ParallelFor(count, kPointParallelMinGrain, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			FindClosestPoint(Vector3{ points.x[i], points.y[i], points.z[i] }, results[i], maxDistance);
+		}
+	});
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+// 境界ボリューム階層(BVH)
+// 三角形・球・線分をまとめて入れ、レイが最初に当たる図形と、点から最も近い図形上の点を木をたどって求める
+// 構築はビンに分けたSAH(表面積ヒューリスティック)で行う
+// ノードは深さ優先の順に1本の配列に並べ(左の子は親のすぐ後ろ)、図形も葉の順に詰め直して持つ
+// 図形が動いたときは木の形を変えずに境界だけ直すRefitを使う(動きが大きいとたどる量が増えるのでBuildし直す)
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "Primitive.h"
+#include "PrimitiveSoA.h"
+#include "Vector3.h"
+#include "Vector3SoA.h"
+
+// 図形の種類
+enum class BVHPrimitiveType : uint32_t {
+	kTriangle,
+	kSphere,
+	kSegment,
+};
+
+// 当たらなかった(見つからなかった)ときの図形の番号
+constexpr uint32_t kBVHNoHit = 0xFFFFFFFF;
+
+// BVHに入れる図形 配列は呼び出し側が持ち、Build/Refitの間だけ参照する
+struct BVHGeometry final {
+	const Triangle* triangles = nullptr;
+	size_t triangleCount = 0;
+	const Sphere* spheres = nullptr;
+	size_t sphereCount = 0;
+	const Segment* segments = nullptr;
+	size_t segmentCount = 0;
+	float segmentRadius = 0.0f; // レイが線分に当たったとみなす距離
+};
+
+// ノード
+struct BVHNode final {
+	AABB bounds;
+	uint32_t index; // 葉なら最初の図形、内部ノードなら右の子(左の子はこのノードのすぐ後ろ)
+	uint16_t count; // 葉の図形の数(0なら内部ノード)
+	uint16_t axis;  // 内部ノードを分けた軸 レイの向きで近い側の子から調べる
+};
+static_assert(sizeof(BVHNode) == 32);
+
+// 葉の図形 種類によってa, b, cの意味が異なる
+// 三角形 a = 頂点0, b = 頂点1 - 頂点0, c = 頂点2 - 頂点0
+// 球     a = 中心, b.x = 半径
+// 線分   a = 始点, b = 始点から終点, c.x = segmentRadius
+struct BVHPrimitive final {
+	Vector3 a, b, c;
+	uint32_t id; // 上位2ビットが種類、残りが種類ごとの番号
+};
+
+// BVHPrimitive::idの種類の位置
+constexpr uint32_t kBVHTypeShift = 30;
+// たどるときのスタックの大きさ(木の深さはこれより小さくする)
+constexpr size_t kBVHStackSize = 64;
+// 葉の図形の数の上限 SAHで分けない方が安くても、この数を超えたら分ける
+constexpr uint32_t kBVHMaxLeafSize = 8;
+
+// レイの交点
+struct RayHit final {
+	float t;        // 交点はorigin + t * diff(当たらなければmaxT)
+	uint32_t index; // 種類ごとの図形の番号(当たらなければkBVHNoHit)
+	BVHPrimitiveType type;
+};
+
+// 最近接点
+struct BVHClosestPoint final {
+	Vector3 point;
+	float distance;
+	uint32_t index; // 種類ごとの図形の番号(見つからなければkBVHNoHit)
+	BVHPrimitiveType type;
+};
+
+class BVH {
+public:
+	// 図形の数は種類ごとに2^30未満
+	void Build(const BVHGeometry& geometry);
+	// Buildと同じ数の図形で境界を直す
+	void Refit(const BVHGeometry& geometry);
+
+	// レイorigin + t * diff (0 <= t <= maxT)が最初に当たる図形 当たればtrue
+	// 三角形は両面、球は中身の詰まったもの(始点が内側ならt = 0)として扱う
+	// 線分はレイとの距離がsegmentRadius以下なら、最も近づく位置で当たりとする
+	bool Raycast(const Ray& ray, RayHit& hit, float maxT = std::numeric_limits<float>::infinity()) const;
+	// 一括・SoA レイをSIMDのレーン幅(4/8本)ずつ束にして一緒にたどる
+	// 束の中のレイは最初のレイの向きで子をたどる順を決めるので、向きの近いレイを並べておくと速い
+	// maxTがnullptrなら上限なし
+	void Raycast(const ConstRaySoA& rays, const float* maxT, RayHit* hits, size_t count) const;
+
+	// 点から距離maxDistance以内で最も近い図形上の点 見つかればtrue
+	// 球は中身の詰まったもの、線分は太さのないものとして扱う
+	bool FindClosestPoint(const Vector3& point, BVHClosestPoint& result,
+	    float maxDistance = std::numeric_limits<float>::infinity()) const;
+	// 一括・SoA
+	void FindClosestPoints(const ConstVector3SoA& points, BVHClosestPoint* results, size_t count,
+	    float maxDistance = std::numeric_limits<float>::infinity()) const;
+
+	const std::vector<BVHNode>& GetNodes() const { return nodes_; }
+	const std::vector<BVHPrimitive>& GetPrimitives() const { return primitives_; }
+
+private:
+	std::vector<BVHNode> nodes_; // nodes_[0]が根
+	std::vector<BVHPrimitive> primitives_;
+};
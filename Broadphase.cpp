@@ -0,0 +1,452 @@
+#include "Broadphase.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include "JobSystem.h"
+#include "MathKernel.h"
+#include "SimdDispatch.h"
+
+namespace {
+
+// JobSystemで分けるときの1区間の最小の数
+const size_t kObjectParallelMinGrain = 4096;
+// 掃引を分けるときの1区間の物体の数(区間ごとに組の配列を持つ)
+const size_t kSweepChunkSize = 1024;
+// 掃引のカーネルが一度に書き込む組の数(スタックに置き、区間の配列に足していく)
+const size_t kSweepBufferSize = 256;
+// 格子の組を調べるときの1区間の表の大きさ
+const size_t kBucketChunkSize = 4096;
+// 1つの物体を入れるセルの最大数 超える物体は格子に入れず、すべての物体と調べる
+const uint64_t kMaxCellsPerObject = 64;
+// 大きい物体と調べるときの1区間の物体の数
+const size_t kLargeObjectChunkSize = 4096;
+// 掃引する軸を選ぶときに調べる物体の数(これより多ければ間引く)
+const size_t kAxisSampleCount = 1024;
+// 今の軸より分散がこの倍率を超えて大きい軸があれば切り替える(切り替えると並べ直しになるので少し粘る)
+const double kAxisSwitchRatio = 1.2;
+// 挿入ソートで許す移動の回数(物体1つあたり) 超えたら並べ直す
+const size_t kInsertionSortBudget = 16;
+// セルの座標の範囲(int32_tに収める)
+const float kMaxCell = 1073741824.0f;
+
+// 球
+struct SphereShape {
+	using SortedSoA = ConstSphereSoA;
+	static constexpr size_t kComponentCount = 4;
+
+	ConstSphereSoA spheres;
+
+	const float* GetCenters(uint32_t axis) const {
+		return axis == 0 ? spheres.x : (axis == 1 ? spheres.y : spheres.z);
+	}
+	float GetCenter(uint32_t axis, size_t i) const { return GetCenters(axis)[i]; }
+	float GetMin(uint32_t axis, size_t i) const { return GetCenters(axis)[i] - spheres.radius[i]; }
+	float GetMax(uint32_t axis, size_t i) const { return GetCenters(axis)[i] + spheres.radius[i]; }
+
+	// SweepSpheresと同じ式で調べる
+	bool Overlaps(size_t a, size_t b) const {
+		const float dx = spheres.x[b] - spheres.x[a];
+		const float dy = spheres.y[b] - spheres.y[a];
+		const float dz = spheres.z[b] - spheres.z[a];
+		const float radius = spheres.radius[a] + spheres.radius[b];
+		return dx * dx + dy * dy + dz * dz <= radius * radius;
+	}
+
+	// [begin, end)をorderの順にsortedへ並べる
+	void Gather(std::vector<float>* sorted, const uint32_t* order, size_t begin, size_t end) const {
+		for (size_t k = begin; k < end; k++) {
+			const uint32_t i = order[k];
+			sorted[0][k] = spheres.x[i];
+			sorted[1][k] = spheres.y[i];
+			sorted[2][k] = spheres.z[i];
+			sorted[3][k] = spheres.radius[i];
+		}
+	}
+	static SortedSoA MakeSorted(const std::vector<float>* sorted) {
+		return { sorted[0].data(), sorted[1].data(), sorted[2].data(), sorted[3].data() };
+	}
+
+	static size_t Sweep(const SortedSoA& sorted, const float* minKeys, const float* maxKeys, const uint32_t* ids,
+	    size_t count, size_t end, SweepCursor& cursor, CollisionPair* pairs, size_t capacity) {
+		static const auto kernel = MT4_SELECT_SIMD_KERNEL(SweepSpheres);
+		return kernel(sorted, minKeys, maxKeys, ids, count, end, cursor, pairs, capacity);
+	}
+};
+
+// AABB
+struct AABBShape {
+	using SortedSoA = ConstAABBSoA;
+	static constexpr size_t kComponentCount = 6;
+
+	ConstAABBSoA aabbs;
+
+	const float* GetMins(uint32_t axis) const {
+		return axis == 0 ? aabbs.minX : (axis == 1 ? aabbs.minY : aabbs.minZ);
+	}
+	const float* GetMaxs(uint32_t axis) const {
+		return axis == 0 ? aabbs.maxX : (axis == 1 ? aabbs.maxY : aabbs.maxZ);
+	}
+	float GetCenter(uint32_t axis, size_t i) const { return (GetMins(axis)[i] + GetMaxs(axis)[i]) * 0.5f; }
+	float GetMin(uint32_t axis, size_t i) const { return GetMins(axis)[i]; }
+	float GetMax(uint32_t axis, size_t i) const { return GetMaxs(axis)[i]; }
+
+	bool Overlaps(size_t a, size_t b) const {
+		return aabbs.minX[a] <= aabbs.maxX[b] && aabbs.minX[b] <= aabbs.maxX[a] &&
+		    aabbs.minY[a] <= aabbs.maxY[b] && aabbs.minY[b] <= aabbs.maxY[a] &&
+		    aabbs.minZ[a] <= aabbs.maxZ[b] && aabbs.minZ[b] <= aabbs.maxZ[a];
+	}
+
+	void Gather(std::vector<float>* sorted, const uint32_t* order, size_t begin, size_t end) const {
+		for (size_t k = begin; k < end; k++) {
+			const uint32_t i = order[k];
+			sorted[0][k] = aabbs.minX[i];
+			sorted[1][k] = aabbs.minY[i];
+			sorted[2][k] = aabbs.minZ[i];
+			sorted[3][k] = aabbs.maxX[i];
+			sorted[4][k] = aabbs.maxY[i];
+			sorted[5][k] = aabbs.maxZ[i];
+		}
+	}
+	static SortedSoA MakeSorted(const std::vector<float>* sorted) {
+		return { sorted[0].data(), sorted[1].data(), sorted[2].data(),
+			sorted[3].data(), sorted[4].data(), sorted[5].data() };
+	}
+
+	static size_t Sweep(const SortedSoA& sorted, const float* minKeys, const float* maxKeys, const uint32_t* ids,
+	    size_t count, size_t end, SweepCursor& cursor, CollisionPair* pairs, size_t capacity) {
+		static const auto kernel = MT4_SELECT_SIMD_KERNEL(SweepAABBs);
+		return kernel(sorted, minKeys, maxKeys, ids, count, end, cursor, pairs, capacity);
+	}
+};
+
+// 掃引 [begin, end)の組をpairsに追加する
+// カーネルは命令セット別の翻訳単位にあるので、std::vectorには触れさせず固定長の配列に書き込ませる
+template<class Shape>
+void SweepChunk(const typename Shape::SortedSoA& sorted, const float* minKeys, const float* maxKeys,
+    const uint32_t* ids, size_t count, size_t begin, size_t end, std::vector<CollisionPair>& pairs) {
+	static_assert(kSweepBufferSize >= kSweepMinCapacity);
+	CollisionPair buffer[kSweepBufferSize];
+	SweepCursor cursor{ begin, begin + 1 };
+	while (cursor.i < end) {
+		const size_t written = Shape::Sweep(sorted, minKeys, maxKeys, ids, count, end, cursor, buffer, kSweepBufferSize);
+		pairs.insert(pairs.end(), buffer, buffer + written);
+	}
+}
+
+// 大小の順が浮動小数点数と同じになる整数
+uint32_t ToSortableBits(float value) {
+	const uint32_t bits = std::bit_cast<uint32_t>(value);
+	return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+// 区間ごとの組をつなげる
+void Concatenate(const std::vector<std::vector<CollisionPair>>& chunkPairs, std::vector<CollisionPair>& pairs) {
+	size_t total = 0;
+	for (const std::vector<CollisionPair>& chunk : chunkPairs) {
+		total += chunk.size();
+	}
+	pairs.resize(total);
+	size_t offset = 0;
+	for (const std::vector<CollisionPair>& chunk : chunkPairs) {
+		if (!chunk.empty()) {
+			std::memcpy(pairs.data() + offset, chunk.data(), chunk.size() * sizeof(CollisionPair));
+		}
+		offset += chunk.size();
+	}
+}
+
+// 座標の入るセル
+int32_t ToCell(float value, float inverseCellSize) {
+	return static_cast<int32_t>(std::floor(std::clamp(value * inverseCellSize, -kMaxCell, kMaxCell)));
+}
+
+// 物体が入るセルの範囲(両端を含む)
+struct CellRange {
+	int32_t min[3];
+	int32_t max[3];
+};
+
+template<class Shape>
+CellRange GetCellRange(const Shape& shape, size_t i, float inverseCellSize) {
+	CellRange range;
+	for (uint32_t axis = 0; axis < 3; axis++) {
+		range.min[axis] = ToCell(shape.GetMin(axis, i), inverseCellSize);
+		range.max[axis] = ToCell(shape.GetMax(axis, i), inverseCellSize);
+	}
+	return range;
+}
+
+// 物体が入るセルの数 kMaxCellsPerObjectを超えたら0
+// 軸ごとに掛けながら確かめるので、途中でもuint64_tを超えない
+uint32_t CountCells(const CellRange& range) {
+	uint64_t cells = 1;
+	for (uint32_t axis = 0; axis < 3; axis++) {
+		cells *= static_cast<uint64_t>(static_cast<int64_t>(range.max[axis]) - range.min[axis] + 1);
+		if (cells > kMaxCellsPerObject) {
+			return 0;
+		}
+	}
+	return static_cast<uint32_t>(cells);
+}
+
+// セルの座標から表の位置を求める(tableBitsは表の大きさの2の指数)
+uint32_t HashCell(int32_t x, int32_t y, int32_t z, uint32_t tableBits) {
+	const uint32_t hash = (static_cast<uint32_t>(x) * 73856093u) ^ (static_cast<uint32_t>(y) * 19349663u) ^
+	    (static_cast<uint32_t>(z) * 83492791u);
+	// 上位ビットに混ぜてから取り出す
+	return tableBits == 0 ? 0 : (hash * 0x9E3779B1u) >> (32 - tableBits);
+}
+
+} // namespace
+
+void SweepAndPrune::FindPairs(const ConstSphereSoA& spheres, size_t count, std::vector<CollisionPair>& pairs) {
+	FindShapePairs(SphereShape{ spheres }, count, pairs);
+}
+
+void SweepAndPrune::FindPairs(const ConstAABBSoA& aabbs, size_t count, std::vector<CollisionPair>& pairs) {
+	FindShapePairs(AABBShape{ aabbs }, count, pairs);
+}
+
+template<class Shape>
+void SweepAndPrune::FindShapePairs(const Shape& shape, size_t count, std::vector<CollisionPair>& pairs) {
+	pairs.clear();
+	if (count < 2) {
+		order_.clear();
+		return;
+	}
+	const bool axisChanged = SelectAxis(shape, count);
+	Sort(shape, count, axisChanged || order_.size() != count);
+
+	// 掃引の順に並べる
+	maxKeys_.resize(count);
+	for (size_t component = 0; component < Shape::kComponentCount; component++) {
+		sorted_[component].resize(count);
+	}
+	JobSystem::GetInstance().ParallelFor(count, kObjectParallelMinGrain, [&](size_t begin, size_t end) {
+		shape.Gather(sorted_, order_.data(), begin, end);
+		for (size_t k = begin; k < end; k++) {
+			maxKeys_[k] = shape.GetMax(axis_, order_[k]);
+		}
+	});
+
+	// 区間ごとに掃引する
+	const typename Shape::SortedSoA sorted = Shape::MakeSorted(sorted_);
+	const size_t chunkCount = (count + kSweepChunkSize - 1) / kSweepChunkSize;
+	chunkPairs_.resize(chunkCount);
+	JobSystem::GetInstance().ParallelFor(chunkCount, 1, [&](size_t begin, size_t end) {
+		for (size_t chunk = begin; chunk < end; chunk++) {
+			chunkPairs_[chunk].clear();
+			SweepChunk<Shape>(sorted, minKeys_.data(), maxKeys_.data(), order_.data(), count, chunk * kSweepChunkSize,
+			    std::min(count, (chunk + 1) * kSweepChunkSize), chunkPairs_[chunk]);
+		}
+	});
+	Concatenate(chunkPairs_, pairs);
+}
+
+template<class Shape>
+bool SweepAndPrune::SelectAxis(const Shape& shape, size_t count) {
+	// 中心の分散が最も大きい軸(重なる範囲が少ない)
+	double sums[3] = {}, squareSums[3] = {};
+	const size_t stride = std::max<size_t>(1, count / kAxisSampleCount);
+	size_t sampleCount = 0;
+	for (size_t i = 0; i < count; i += stride) {
+		for (uint32_t axis = 0; axis < 3; axis++) {
+			const double center = shape.GetCenter(axis, i);
+			sums[axis] += center;
+			squareSums[axis] += center * center;
+		}
+		sampleCount++;
+	}
+	double variances[3];
+	for (uint32_t axis = 0; axis < 3; axis++) {
+		const double mean = sums[axis] / sampleCount;
+		variances[axis] = squareSums[axis] / sampleCount - mean * mean;
+	}
+	const uint32_t best = static_cast<uint32_t>(std::max_element(variances, variances + 3) - variances);
+	if (best == axis_) {
+		return false;
+	}
+	if (order_.size() != count || variances[best] > variances[axis_] * kAxisSwitchRatio) {
+		axis_ = best;
+		return true;
+	}
+	return false;
+}
+
+template<class Shape>
+void SweepAndPrune::Sort(const Shape& shape, size_t count, bool rebuild) {
+	minKeys_.resize(count);
+	if (!rebuild) {
+		// 前回の並びのまま最小値を取り直し、挿入ソートで直す
+		JobSystem::GetInstance().ParallelFor(count, kObjectParallelMinGrain, [&](size_t begin, size_t end) {
+			for (size_t k = begin; k < end; k++) {
+				minKeys_[k] = shape.GetMin(axis_, order_[k]);
+			}
+		});
+		size_t budget = count * kInsertionSortBudget;
+		for (size_t k = 1; k < count && !rebuild; k++) {
+			const float key = minKeys_[k];
+			const uint32_t object = order_[k];
+			size_t j = k;
+			for (; j > 0 && minKeys_[j - 1] > key; j--) {
+				minKeys_[j] = minKeys_[j - 1];
+				order_[j] = order_[j - 1];
+			}
+			minKeys_[j] = key;
+			order_[j] = object;
+			// 大きく動いたときは作り直した方が速い
+			const size_t moved = k - j;
+			if (moved > budget) {
+				rebuild = true;
+			}
+			budget -= std::min(moved, budget);
+		}
+	}
+	if (rebuild) {
+		// (最小値, 番号)を1つの整数にして並べる 同じ値なら番号の順
+		order_.resize(count);
+		sortItems_.resize(count);
+		JobSystem::GetInstance().ParallelFor(count, kObjectParallelMinGrain, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				sortItems_[i] = (static_cast<uint64_t>(ToSortableBits(shape.GetMin(axis_, i))) << 32) | i;
+			}
+		});
+		std::sort(sortItems_.begin(), sortItems_.end());
+		JobSystem::GetInstance().ParallelFor(count, kObjectParallelMinGrain, [&](size_t begin, size_t end) {
+			for (size_t k = begin; k < end; k++) {
+				order_[k] = static_cast<uint32_t>(sortItems_[k]);
+				minKeys_[k] = shape.GetMin(axis_, order_[k]);
+			}
+		});
+	}
+}
+
+void SpatialHashGrid::FindPairs(const ConstSphereSoA& spheres, size_t count, std::vector<CollisionPair>& pairs) {
+	FindShapePairs(SphereShape{ spheres }, count, pairs);
+}
+
+void SpatialHashGrid::FindPairs(const ConstAABBSoA& aabbs, size_t count, std::vector<CollisionPair>& pairs) {
+	FindShapePairs(AABBShape{ aabbs }, count, pairs);
+}
+
+template<class Shape>
+void SpatialHashGrid::FindShapePairs(const Shape& shape, size_t count, std::vector<CollisionPair>& pairs) {
+	pairs.clear();
+	if (count < 2) {
+		return;
+	}
+	const float inverseCellSize = 1.0f / cellSize_;
+
+	// 物体ごとのセルの数を数え、エントリの位置を決める
+	// セルが多すぎる物体はエントリを作らず(数0)、大きい物体の一覧に入れる
+	entryBegins_.resize(count + 1);
+	entryBegins_[0] = 0;
+	JobSystem::GetInstance().ParallelFor(count, kObjectParallelMinGrain, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			entryBegins_[i + 1] = CountCells(GetCellRange(shape, i, inverseCellSize));
+		}
+	});
+	largeObjects_.clear();
+	for (size_t i = 0; i < count; i++) {
+		if (entryBegins_[i + 1] == 0) {
+			largeObjects_.push_back(static_cast<uint32_t>(i));
+		}
+		entryBegins_[i + 1] += entryBegins_[i];
+	}
+	const size_t entryCount = entryBegins_[count];
+	entries_.resize(entryCount);
+	JobSystem::GetInstance().ParallelFor(count, kObjectParallelMinGrain, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			if (entryBegins_[i] == entryBegins_[i + 1]) {
+				continue;
+			}
+			const CellRange range = GetCellRange(shape, i, inverseCellSize);
+			Entry* entry = entries_.data() + entryBegins_[i];
+			for (int32_t z = range.min[2]; z <= range.max[2]; z++) {
+				for (int32_t y = range.min[1]; y <= range.max[1]; y++) {
+					for (int32_t x = range.min[0]; x <= range.max[0]; x++) {
+						*entry++ = { x, y, z, static_cast<uint32_t>(i) };
+					}
+				}
+			}
+		}
+	});
+
+	// 表の位置の順に並べる(数え上げソート)
+	// 表はエントリの数の2倍以上にして、違うセルが同じ位置に入ることを減らす
+	const size_t tableSize = std::bit_ceil(entryCount * 2);
+	const uint32_t tableBits = static_cast<uint32_t>(std::countr_zero(tableSize));
+	bucketBegins_.assign(tableSize + 1, 0);
+	for (const Entry& entry : entries_) {
+		bucketBegins_[HashCell(entry.x, entry.y, entry.z, tableBits)]++;
+	}
+	uint32_t sum = 0;
+	for (size_t bucket = 0; bucket <= tableSize; bucket++) {
+		sum += bucketBegins_[bucket];
+		bucketBegins_[bucket] = sum; // この時点ではバケツの終わり
+	}
+	sortedEntries_.resize(entryCount);
+	for (size_t k = entryCount; k-- > 0;) {
+		const Entry& entry = entries_[k];
+		sortedEntries_[--bucketBegins_[HashCell(entry.x, entry.y, entry.z, tableBits)]] = entry;
+	}
+
+	// 同じバケツの中で同じセルに入る組を調べる
+	// 2つの物体が重なるセルのうち、両方の最小の角のセル(各軸で大きい方)だけで組にして重複を防ぐ
+	const size_t chunkCount = (tableSize + kBucketChunkSize - 1) / kBucketChunkSize;
+	const size_t largeChunkCount = largeObjects_.empty() ? 0 : (count + kLargeObjectChunkSize - 1) / kLargeObjectChunkSize;
+	chunkPairs_.resize(chunkCount + largeChunkCount);
+	JobSystem::GetInstance().ParallelFor(chunkCount, 1, [&](size_t begin, size_t end) {
+		for (size_t chunk = begin; chunk < end; chunk++) {
+			std::vector<CollisionPair>& chunkPairs = chunkPairs_[chunk];
+			chunkPairs.clear();
+			const size_t bucketEnd = std::min(tableSize, (chunk + 1) * kBucketChunkSize);
+			for (size_t bucket = chunk * kBucketChunkSize; bucket < bucketEnd; bucket++) {
+				for (uint32_t a = bucketBegins_[bucket]; a < bucketBegins_[bucket + 1]; a++) {
+					const Entry& entryA = sortedEntries_[a];
+					for (uint32_t b = a + 1; b < bucketBegins_[bucket + 1]; b++) {
+						const Entry& entryB = sortedEntries_[b];
+						if (entryA.x != entryB.x || entryA.y != entryB.y || entryA.z != entryB.z ||
+						    !shape.Overlaps(entryA.object, entryB.object)) {
+							continue;
+						}
+						const CellRange rangeA = GetCellRange(shape, entryA.object, inverseCellSize);
+						const CellRange rangeB = GetCellRange(shape, entryB.object, inverseCellSize);
+						if (std::max(rangeA.min[0], rangeB.min[0]) != entryA.x ||
+						    std::max(rangeA.min[1], rangeB.min[1]) != entryA.y ||
+						    std::max(rangeA.min[2], rangeB.min[2]) != entryA.z) {
+							continue;
+						}
+						chunkPairs.push_back(entryA.object < entryB.object ?
+						    CollisionPair{ entryA.object, entryB.object } : CollisionPair{ entryB.object, entryA.object });
+					}
+				}
+			}
+		}
+	});
+
+	// 大きい物体はすべての物体と調べる(大きい物体同士は番号の大きい方から1回だけ)
+	JobSystem::GetInstance().ParallelFor(largeChunkCount, 1, [&](size_t begin, size_t end) {
+		for (size_t chunk = begin; chunk < end; chunk++) {
+			std::vector<CollisionPair>& chunkPairs = chunkPairs_[chunkCount + chunk];
+			chunkPairs.clear();
+			const size_t objectEnd = std::min(count, (chunk + 1) * kLargeObjectChunkSize);
+			for (size_t i = chunk * kLargeObjectChunkSize; i < objectEnd; i++) {
+				const uint32_t object = static_cast<uint32_t>(i);
+				const bool large = entryBegins_[i] == entryBegins_[i + 1];
+				for (const uint32_t largeObject : largeObjects_) {
+					if (large && largeObject >= object) {
+						continue;
+					}
+					if (shape.Overlaps(object, largeObject)) {
+						chunkPairs.push_back(object < largeObject ?
+						    CollisionPair{ object, largeObject } : CollisionPair{ largeObject, object });
+					}
+				}
+			}
+		}
+	});
+	Concatenate(chunkPairs_, pairs);
+}
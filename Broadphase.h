@@ -0,0 +1,80 @@
+#pragma once
+
+// 衝突判定の前段(ブロードフェーズ)
+// 球(中心と半径)かAABBの列から、重なっている組をすべて求める
+// SweepAndPruneは1つの軸の最小値で並べて範囲の重なる相手だけを調べる。前回の並びから並べ直すので、少しずつ動く場面に向く
+// (軸の上で重なる相手はすべて調べるので、一様に広がった数十万個以上の場面ではSpatialHashGridの方が速い)
+// SpatialHashGridは一様な格子のセルに分けて同じセルの相手だけを調べる。密度がほぼ一様な場面に向く
+// どちらも結果は全組を調べた場合と同じで、要素数が多いとJobSystem::GetInstance()のスレッドで分けて処理する
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "PrimitiveSoA.h"
+
+// 重なっている組(first < second)
+struct CollisionPair final {
+	uint32_t first;
+	uint32_t second;
+};
+
+// 掃引(sweep and prune)
+class SweepAndPrune {
+public:
+	// 重なっている組をpairsに書き込む(前の内容は消す。組の順番は決まっていない)
+	// 球は中心間の距離が半径の和以下、AABBは全軸で範囲が重なる(接していてもよい)ときに重なるとする
+	// 要素数が前回と同じなら前回の並びを挿入ソートで並べ直す(番号が同じ物体を指していること)
+	void FindPairs(const ConstSphereSoA& spheres, size_t count, std::vector<CollisionPair>& pairs);
+	void FindPairs(const ConstAABBSoA& aabbs, size_t count, std::vector<CollisionPair>& pairs);
+
+private:
+	template<class Shape>
+	void FindShapePairs(const Shape& shape, size_t count, std::vector<CollisionPair>& pairs);
+	// 掃引する軸を選ぶ 軸を変えたらtrue
+	template<class Shape>
+	bool SelectAxis(const Shape& shape, size_t count);
+	// 掃引する軸の最小値で並べ直す
+	template<class Shape>
+	void Sort(const Shape& shape, size_t count, bool rebuild);
+
+	uint32_t axis_ = 0;
+	std::vector<uint32_t> order_;      // 最小値の順に並べた物体の番号
+	std::vector<float> minKeys_;       // order_の順
+	std::vector<float> maxKeys_;       // order_の順
+	std::vector<float> sorted_[6];     // order_の順に並べた図形のSoA
+	std::vector<uint64_t> sortItems_;  // 並べ直すときの(最小値, 番号)
+	std::vector<std::vector<CollisionPair>> chunkPairs_;
+};
+
+// 一様格子(セルの座標のハッシュで表を引く)
+class SpatialHashGrid {
+public:
+	// cellSizeは物体の大きさ(直径)程度にする 小さすぎると1つの物体が多くのセルに入る
+	// 64個より多くのセルにまたがる物体は格子に入れず、ほかのすべての物体と調べる
+	explicit SpatialHashGrid(float cellSize) : cellSize_(cellSize) {}
+
+	float GetCellSize() const { return cellSize_; }
+	void SetCellSize(float cellSize) { cellSize_ = cellSize; }
+
+	// 重なっている組をpairsに書き込む(SweepAndPrune::FindPairsと同じ)
+	void FindPairs(const ConstSphereSoA& spheres, size_t count, std::vector<CollisionPair>& pairs);
+	void FindPairs(const ConstAABBSoA& aabbs, size_t count, std::vector<CollisionPair>& pairs);
+
+private:
+	// 物体が入るセル1つ分
+	struct Entry {
+		int32_t x, y, z;
+		uint32_t object;
+	};
+
+	template<class Shape>
+	void FindShapePairs(const Shape& shape, size_t count, std::vector<CollisionPair>& pairs);
+
+	float cellSize_;
+	std::vector<uint32_t> entryBegins_; // 物体ごとのエントリの位置
+	std::vector<Entry> entries_;
+	std::vector<Entry> sortedEntries_; // 表の位置の順
+	std::vector<uint32_t> bucketBegins_;
+	std::vector<uint32_t> largeObjects_; // セルが多すぎて格子に入れない物体
+	std::vector<std::vector<CollisionPair>> chunkPairs_;
+};
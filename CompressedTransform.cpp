@@ -0,0 +1,188 @@
+#include "CompressedTransform.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include "JobSystem.h"
+#include "MathFunction.h"
+#include "MathKernel.h"
+#include "SimdDispatch.h"
+
+namespace {
+
+// JobSystemで分けるときの1区間の最小のブロック数
+const size_t kParallelMinBlocks = 256;
+
+// ブロック1つ分の姿勢(SoA) 余りは単位行列で埋める
+struct BlockInput {
+	float scale[3][kCompressedTransformBlockSize];
+	float rotate[4][kCompressedTransformBlockSize];
+	float translate[3][kCompressedTransformBlockSize];
+
+	explicit BlockInput(const TransformQuantization& quantization) {
+		const float origin[3] = { quantization.origin.x, quantization.origin.y, quantization.origin.z };
+		for (size_t j = 0; j < kCompressedTransformBlockSize; j++) {
+			for (int axis = 0; axis < 3; axis++) {
+				scale[axis][j] = 1.0f;
+				rotate[axis][j] = 0.0f;
+				translate[axis][j] = origin[axis];
+			}
+			rotate[3][j] = 1.0f;
+		}
+	}
+	void Set(size_t j, const Vector3& s, const Quaternion& q, const Vector3& t) {
+		scale[0][j] = s.x;
+		scale[1][j] = s.y;
+		scale[2][j] = s.z;
+		rotate[0][j] = q.x;
+		rotate[1][j] = q.y;
+		rotate[2][j] = q.z;
+		rotate[3][j] = q.w;
+		translate[0][j] = t.x;
+		translate[1][j] = t.y;
+		translate[2][j] = t.z;
+	}
+	// アフィン行列を分解して先頭からcount個に入れる
+	void Decompose(const Matrix4x4* matrices, size_t count) {
+		static const auto kernel = MT4_SELECT_SIMD_KERNEL(DecomposeMatrices);
+		kernel(matrices, Vector3SoA{ scale[0], scale[1], scale[2] },
+		    QuaternionSoA{ rotate[0], rotate[1], rotate[2], rotate[3] },
+		    Vector3SoA{ translate[0], translate[1], translate[2] }, count, kDecomposeShearTolerance, nullptr);
+	}
+	void Encode(const TransformQuantization& quantization, CompressedTransformBlock& block) const {
+		static const auto kernel = MT4_SELECT_SIMD_KERNEL(EncodeTransforms);
+		kernel(ConstVector3SoA(scale[0], scale[1], scale[2]),
+		    ConstQuaternionSoA(rotate[0], rotate[1], rotate[2], rotate[3]),
+		    ConstVector3SoA(translate[0], translate[1], translate[2]), quantization, &block, 1);
+	}
+};
+
+size_t GetBlockCount(size_t count) {
+	return (count + kCompressedTransformBlockSize - 1) / kCompressedTransformBlockSize;
+}
+
+// ヘッダーを書き込み、ブロックの先頭を返す
+CompressedTransformBlock* WriteHeader(size_t count, const TransformQuantization& quantization, void* data) {
+	assert(reinterpret_cast<uintptr_t>(data) % alignof(CompressedTransformHeader) == 0);
+	assert(quantization.step > 0.0f);
+	CompressedTransformHeader header{};
+	header.magic = kCompressedTransformMagic;
+	header.version = kCompressedTransformVersion;
+	header.count = static_cast<uint32_t>(count);
+	header.blockCount = static_cast<uint32_t>(GetBlockCount(count));
+	header.origin[0] = quantization.origin.x;
+	header.origin[1] = quantization.origin.y;
+	header.origin[2] = quantization.origin.z;
+	header.step = quantization.step;
+	std::memcpy(data, &header, sizeof(header));
+	return reinterpret_cast<CompressedTransformBlock*>(static_cast<uint8_t*>(data) + sizeof(header));
+}
+
+ConstVector3SoA Offset(const ConstVector3SoA& soa, size_t i) { return { soa.x + i, soa.y + i, soa.z + i }; }
+ConstQuaternionSoA Offset(const ConstQuaternionSoA& soa, size_t i) {
+	return { soa.x + i, soa.y + i, soa.z + i, soa.w + i };
+}
+
+} // namespace
+
+size_t GetCompressedTransformSize(size_t count) {
+	return sizeof(CompressedTransformHeader) + GetBlockCount(count) * sizeof(CompressedTransformBlock);
+}
+
+void EncodeTransforms(const ConstVector3SoA& scale, const ConstQuaternionSoA& rotate, const ConstVector3SoA& translate,
+    size_t count, const TransformQuantization& quantization, void* data) {
+	CompressedTransformBlock* blocks = WriteHeader(count, quantization, data);
+	static const auto kernel = MT4_SELECT_SIMD_KERNEL(EncodeTransforms);
+	const size_t fullBlockCount = count / kCompressedTransformBlockSize;
+	JobSystem::GetInstance().ParallelFor(fullBlockCount, kParallelMinBlocks, [&](size_t begin, size_t end) {
+		const size_t i = begin * kCompressedTransformBlockSize;
+		kernel(Offset(scale, i), Offset(rotate, i), Offset(translate, i), quantization, blocks + begin, end - begin);
+	});
+	// 余りは単位行列で埋めたブロックにする
+	if (fullBlockCount * kCompressedTransformBlockSize < count) {
+		BlockInput input(quantization);
+		for (size_t i = fullBlockCount * kCompressedTransformBlockSize, j = 0; i < count; i++, j++) {
+			input.Set(j, Vector3{ scale.x[i], scale.y[i], scale.z[i] },
+			    Quaternion{ rotate.x[i], rotate.y[i], rotate.z[i], rotate.w[i] },
+			    Vector3{ translate.x[i], translate.y[i], translate.z[i] });
+		}
+		input.Encode(quantization, blocks[fullBlockCount]);
+	}
+}
+
+void EncodeTransforms(const Matrix4x4* matrices, size_t count, const TransformQuantization& quantization, void* data) {
+	CompressedTransformBlock* blocks = WriteHeader(count, quantization, data);
+	JobSystem::GetInstance().ParallelFor(GetBlockCount(count), kParallelMinBlocks, [&](size_t begin, size_t end) {
+		for (size_t block = begin; block < end; block++) {
+			BlockInput input(quantization);
+			const size_t first = block * kCompressedTransformBlockSize;
+			const size_t last = std::min(count, first + kCompressedTransformBlockSize);
+			input.Decompose(matrices + first, last - first);
+			input.Encode(quantization, blocks[block]);
+		}
+	});
+}
+
+bool CompressedTransformView::Open(const void* data, size_t size) {
+	header_ = nullptr;
+	blocks_ = nullptr;
+	if (data == nullptr || size < sizeof(CompressedTransformHeader) ||
+	    reinterpret_cast<uintptr_t>(data) % alignof(CompressedTransformHeader) != 0) {
+		return false;
+	}
+	const CompressedTransformHeader* header = static_cast<const CompressedTransformHeader*>(data);
+	if (header->magic != kCompressedTransformMagic || header->version != kCompressedTransformVersion ||
+	    header->blockCount != GetBlockCount(header->count) || !(header->step > 0.0f) ||
+	    size < GetCompressedTransformSize(header->count)) {
+		return false;
+	}
+	header_ = header;
+	blocks_ = reinterpret_cast<const CompressedTransformBlock*>(static_cast<const uint8_t*>(data) + sizeof(*header));
+	return true;
+}
+
+TransformQuantization CompressedTransformView::GetQuantization() const {
+	assert(header_);
+	return { { header_->origin[0], header_->origin[1], header_->origin[2] }, header_->step };
+}
+
+void CompressedTransformView::Decode(Matrix4x4* result, size_t begin, size_t count) const {
+	assert(begin + count <= GetCount());
+	if (count == 0) {
+		return;
+	}
+	static const auto kernel = MT4_SELECT_SIMD_KERNEL(DecodeTransforms);
+	const TransformQuantization quantization = GetQuantization();
+	// 端のブロックは一時領域に展開してから必要な分だけ写す
+	const size_t end = begin + count;
+	const size_t firstBlock = begin / kCompressedTransformBlockSize;
+	const size_t lastBlock = (end - 1) / kCompressedTransformBlockSize;
+	JobSystem::GetInstance().ParallelFor(lastBlock - firstBlock + 1, kParallelMinBlocks, [&](size_t first, size_t last) {
+		for (size_t block = firstBlock + first; block < firstBlock + last;) {
+			const size_t blockBegin = block * kCompressedTransformBlockSize;
+			if (blockBegin >= begin && blockBegin + kCompressedTransformBlockSize <= end) {
+				// 丸ごと出力に入るブロックはまとめて直接展開する
+				size_t blockEnd = block + 1;
+				while (blockEnd < firstBlock + last && (blockEnd + 1) * kCompressedTransformBlockSize <= end) {
+					blockEnd++;
+				}
+				kernel(blocks_ + block, blockEnd - block, quantization, result + (blockBegin - begin));
+				block = blockEnd;
+				continue;
+			}
+			Matrix4x4 matrices[kCompressedTransformBlockSize];
+			kernel(blocks_ + block, 1, quantization, matrices);
+			const size_t copyBegin = std::max(begin, blockBegin);
+			const size_t copyEnd = std::min(end, blockBegin + kCompressedTransformBlockSize);
+			std::copy(matrices + (copyBegin - blockBegin), matrices + (copyEnd - blockBegin), result + (copyBegin - begin));
+			block++;
+		}
+	});
+}
+
+Matrix4x4 CompressedTransformView::Decode(size_t index) const {
+	Matrix4x4 result;
+	Decode(&result, index, 1);
+	return result;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+// 姿勢(拡大縮小・回転・平行移動)の圧縮形式
+// 1つあたり約24.5バイト(Matrix4x4の64バイトの約38%)で、インスタンス描画やネットワークでの同期に使う
+//
+// 回転   最大成分を除いた3成分(smallest three)を16ビットずつ + 除いた成分の番号2ビット
+//        除いた成分は正になるように符号をそろえ、単位長さから求め直す
+// 拡大   半精度浮動小数点数(binary16)3つ
+// 平行移動 原点originから間隔stepの格子に量子化した32ビット整数3つ
+//
+// 誤差(量子化による最大値 復元の計算で加わるfloatの丸めを除く)
+// 回転   残す3成分は[-1/√2, 1/√2]を65535等分するので各成分の誤差 ≤ √2 / 131070 ≒ 1.1e-5
+//        回転角の誤差 ≤ 約1e-4 rad(0.006度)、回転行列の成分の誤差 ≤ 約1e-4
+// 拡大   相対誤差 ≤ 2^-11 ≒ 4.9e-4(|s|が6.1e-5 ~ 65504のとき) それより大きい値は65504に切り詰める
+// 平行移動 各軸の誤差 ≤ step / 2 表せる範囲は origin ± 約2^31 * step(それを超えると端に切り詰める)
+//
+// バイナリ形式(リトルエンディアン・4バイト境界)
+//   CompressedTransformHeader(32バイト)
+//   CompressedTransformBlock × blockCount(196バイト × ceil(count / 8))
+// ブロックは8個分の各成分を並べたもの(SIMDでそのまま読める) 最後のブロックの余りは単位行列で埋める
+// メモリマップしたファイルや受信バッファをCompressedTransformView::Openに渡すと、コピーせずにその場で展開できる
+
+#include <cstddef>
+#include <cstdint>
+#include "Matrix4x4.h"
+#include "QuaternionSoA.h"
+#include "Vector3.h"
+#include "Vector3SoA.h"
+
+// 1ブロックの姿勢の数
+constexpr size_t kCompressedTransformBlockSize = 8;
+// 先頭の識別子("MT4T")と版
+constexpr uint32_t kCompressedTransformMagic = 0x5434544D;
+constexpr uint32_t kCompressedTransformVersion = 1;
+
+// 平行移動を量子化する格子(position = origin + step * 整数)
+struct TransformQuantization final {
+	Vector3 origin;
+	float step;
+};
+
+struct CompressedTransformHeader final {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t count;      // 姿勢の数
+	uint32_t blockCount; // ceil(count / 8)
+	float origin[3];
+	float step;
+};
+static_assert(sizeof(CompressedTransformHeader) == 32);
+
+struct CompressedTransformBlock final {
+	int32_t position[3][kCompressedTransformBlockSize]; // [軸][要素]
+	uint16_t rotation[3][kCompressedTransformBlockSize]; // 最大成分を除いた3成分(x, y, z, wの順)
+	uint16_t scale[3][kCompressedTransformBlockSize];    // 半精度浮動小数点数
+	uint16_t rotationIndex;                              // 除いた成分の番号(要素iはビット2i, 2i + 1)
+	uint16_t reserved;
+};
+static_assert(sizeof(CompressedTransformBlock) == 196);
+
+// count個を圧縮したときのバイト数
+size_t GetCompressedTransformSize(size_t count);
+
+// 圧縮してdataに書き込む(GetCompressedTransformSize(count)バイト、4バイト境界)
+// 回転は正規化してから使う
+void EncodeTransforms(const ConstVector3SoA& scale, const ConstQuaternionSoA& rotate, const ConstVector3SoA& translate,
+    size_t count, const TransformQuantization& quantization, void* data);
+// アフィン行列から圧縮する(Decompose(MathFunction.h)で拡大・回転・平行移動に分ける 剪断は捨てる)
+void EncodeTransforms(const Matrix4x4* matrices, size_t count, const TransformQuantization& quantization, void* data);
+
+// 圧縮したデータを参照して展開する(データはコピーしない)
+class CompressedTransformView {
+public:
+	// 識別子・版・サイズを確かめる 正しくなければfalse
+	bool Open(const void* data, size_t size);
+
+	size_t GetCount() const { return header_ ? header_->count : 0; }
+	TransformQuantization GetQuantization() const;
+	const CompressedTransformBlock* GetBlocks() const { return blocks_; }
+
+	// [begin, begin + count)をアフィン行列に展開する
+	void Decode(Matrix4x4* result, size_t begin, size_t count) const;
+	Matrix4x4 Decode(size_t index) const;
+
+private:
+	const CompressedTransformHeader* header_ = nullptr;
+	const CompressedTransformBlock* blocks_ = nullptr;
+};
@@ -0,0 +1,74 @@
+#include "Frustum.h"
+
+#include <cmath>
+#include "MathKernel.h"
+#include "SimdDispatch.h"
+
+namespace {
+
+// 行ベクトル * 行列なので、クリップ座標の各成分は行列の列と(x, y, z, 1)の内積になる
+// (a, b, c, d) = w * 4列目 + sign * column列目 として a x + b y + c z + d >= 0 が内側となる平面を作る
+Plane MakePlane(const Matrix4x4& m, float w, int column, float sign) {
+	const float a = w * m.m[0][3] + sign * m.m[0][column];
+	const float b = w * m.m[1][3] + sign * m.m[1][column];
+	const float c = w * m.m[2][3] + sign * m.m[2][column];
+	const float d = w * m.m[3][3] + sign * m.m[3][column];
+	const float inverseLength = 1.0f / std::sqrt(a * a + b * b + c * c);
+	return Plane{ Vector3{ a * inverseLength, b * inverseLength, c * inverseLength }, -d * inverseLength };
+}
+
+// 平面の内側にある点の、平面からの距離の最大値(負なら図形全体が外側)
+float GetMaxDistance(const Plane& plane, const Vector3& center, const Vector3& extent) {
+	return plane.normal.x * center.x + plane.normal.y * center.y + plane.normal.z * center.z - plane.distance +
+	       std::fabs(plane.normal.x) * extent.x + std::fabs(plane.normal.y) * extent.y +
+	       std::fabs(plane.normal.z) * extent.z;
+}
+
+} // namespace
+
+// 左右は -w <= x <= w、上下は -w <= y <= w、近遠は 0 <= z <= w
+Frustum MakeFrustum(const Matrix4x4& viewProjection) {
+	Frustum frustum;
+	frustum.planes[0] = MakePlane(viewProjection, 1.0f, 0, 1.0f);
+	frustum.planes[1] = MakePlane(viewProjection, 1.0f, 0, -1.0f);
+	frustum.planes[2] = MakePlane(viewProjection, 1.0f, 1, 1.0f);
+	frustum.planes[3] = MakePlane(viewProjection, 1.0f, 1, -1.0f);
+	frustum.planes[4] = MakePlane(viewProjection, 0.0f, 2, 1.0f);
+	frustum.planes[5] = MakePlane(viewProjection, 1.0f, 2, -1.0f);
+	return frustum;
+}
+
+bool IsVisible(const Frustum& frustum, const Sphere& sphere) {
+	for (const Plane& plane : frustum.planes) {
+		if (GetMaxDistance(plane, sphere.center, Vector3{ 0.0f, 0.0f, 0.0f }) + sphere.radius < 0.0f) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// 中心と半分の大きさで判定する
+bool IsVisible(const Frustum& frustum, const AABB& aabb) {
+	const Vector3 center{
+	    (aabb.min.x + aabb.max.x) * 0.5f, (aabb.min.y + aabb.max.y) * 0.5f, (aabb.min.z + aabb.max.z) * 0.5f };
+	const Vector3 extent{
+	    (aabb.max.x - aabb.min.x) * 0.5f, (aabb.max.y - aabb.min.y) * 0.5f, (aabb.max.z - aabb.min.z) * 0.5f };
+	for (const Plane& plane : frustum.planes) {
+		if (GetMaxDistance(plane, center, extent) < 0.0f) {
+			return false;
+		}
+	}
+	return true;
+}
+
+size_t CullSpheres(const Frustum& frustum, const ConstSphereSoA& spheres, size_t count,
+    uint32_t* visibleIndices, uint8_t* lastPlanes) {
+	static const auto kernel = MT4_SELECT_SIMD_KERNEL(CullSpheres);
+	return kernel(frustum, spheres, count, visibleIndices, lastPlanes);
+}
+
+size_t CullAABBs(const Frustum& frustum, const ConstAABBSoA& aabbs, size_t count,
+    uint32_t* visibleIndices, uint8_t* lastPlanes) {
+	static const auto kernel = MT4_SELECT_SIMD_KERNEL(CullAABBs);
+	return kernel(frustum, aabbs, count, visibleIndices, lastPlanes);
+}
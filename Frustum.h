@@ -0,0 +1,39 @@
+#pragma once
+
+// 視錐台カリング
+// ビュー射影行列(MakeViewMatrix等 * MakePerspectiveFovMatrix / MakeOrthographicMatrix 深度は0～1)から
+// 6平面を取り出し、球やAABBが視錐台と重なるかを調べる
+// 判定は保守的で、視錐台の角の外側にある物体は見えるものとして残ることがある
+
+#include <cstddef>
+#include <cstdint>
+#include "Matrix4x4.h"
+#include "Primitive.h"
+#include "PrimitiveSoA.h"
+
+// 平面の数 順番は左, 右, 下, 上, 近, 遠
+constexpr size_t kFrustumPlaneCount = 6;
+// lastPlanesで「直前の判定で見えていた」を表す値
+constexpr uint8_t kFrustumVisible = 6;
+
+// 視錐台 各平面の法線は内側を向く
+struct Frustum final {
+	Plane planes[kFrustumPlaneCount];
+};
+
+// ビュー射影行列から視錐台を作る
+Frustum MakeFrustum(const Matrix4x4& viewProjection);
+
+// 視錐台と重なるか
+bool IsVisible(const Frustum& frustum, const Sphere& sphere);
+bool IsVisible(const Frustum& frustum, const AABB& aabb);
+
+// 視錐台カリング(一括・SoA)
+// 見える物体の番号を小さい順にvisibleIndicesへ詰めて書き込み、その数を返す(visibleIndicesはcount個分必要)
+// lastPlanesを渡すと、物体ごとに外側と判定した平面の番号(見えたらkFrustumVisible)を記録し、
+// 次の呼び出しではその平面を先に調べる(並びの近い物体がまとめて同じ平面の外にあれば残りの平面を省く)
+// lastPlanesはcount個分で、初回は任意の値でよい
+size_t CullSpheres(const Frustum& frustum, const ConstSphereSoA& spheres, size_t count,
+    uint32_t* visibleIndices, uint8_t* lastPlanes = nullptr);
+size_t CullAABBs(const Frustum& frustum, const ConstAABBSoA& aabbs, size_t count,
+    uint32_t* visibleIndices, uint8_t* lastPlanes = nullptr);
@@ -0,0 +1,194 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+// ParallelForの処理中か(入れ子の呼び出しはその場で処理する)
+thread_local bool insideParallelFor = false;
+
+uint64_t PackRange(uint32_t begin, uint32_t end) { return uint64_t(begin) | (uint64_t(end) << 32); }
+uint32_t RangeBegin(uint64_t range) { return static_cast<uint32_t>(range); }
+uint32_t RangeEnd(uint64_t range) { return static_cast<uint32_t>(range >> 32); }
+
+// 環境変数MT4_THREADSの指定(なければ論理コア数)
+size_t SelectThreadCount() {
+	char value[32] = {};
+#if defined(_MSC_VER)
+	size_t length = 0;
+	if (getenv_s(&length, value, sizeof(value), "MT4_THREADS") != 0) {
+		length = 0;
+	}
+#else
+	const char* env = std::getenv("MT4_THREADS");
+	const size_t length = env != nullptr ? 1 : 0;
+	if (env != nullptr) {
+		std::strncpy(value, env, sizeof(value) - 1);
+	}
+#endif
+	if (length != 0) {
+		const long threadCount = std::strtol(value, nullptr, 10);
+		if (threadCount > 0) {
+			return static_cast<size_t>(threadCount);
+		}
+	}
+	return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+} // namespace
+
+JobSystem::JobSystem(size_t workerCount) { StartWorkers(workerCount); }
+
+JobSystem::~JobSystem() { StopWorkers(); }
+
+JobSystem& JobSystem::GetInstance() {
+	static JobSystem instance(SelectThreadCount() - 1);
+	return instance;
+}
+
+void JobSystem::SetThreadCount(size_t threadCount) {
+	std::lock_guard<std::mutex> runLock(runMutex_);
+	StopWorkers();
+	StartWorkers(std::max<size_t>(threadCount, 1) - 1);
+}
+
+void JobSystem::StartWorkers(size_t workerCount) {
+	exit_ = false;
+	queues_ = std::make_unique<WorkQueue[]>(workerCount + 1);
+	for (size_t i = 0; i <= workerCount; i++) {
+		queues_[i].range.store(0);
+	}
+	workers_.reserve(workerCount);
+	for (size_t i = 0; i < workerCount; i++) {
+		workers_.emplace_back([this, i] { WorkerMain(i + 1); });
+	}
+}
+
+void JobSystem::StopWorkers() {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		exit_ = true;
+	}
+	wakeCondition_.notify_all();
+	for (std::thread& worker : workers_) {
+		worker.join();
+	}
+	workers_.clear();
+}
+
+void JobSystem::Run(size_t count, size_t minGrain, RangeFunction function, void* context) {
+	if (count == 0) {
+		return;
+	}
+	minGrain = std::max<size_t>(minGrain, 1);
+	if (workers_.empty() || count <= minGrain || insideParallelFor) {
+		function(context, 0, count);
+		return;
+	}
+	// 他のスレッドのParallelForが実行中なら待たずに自分で処理する
+	std::unique_lock<std::mutex> runLock(runMutex_, std::try_to_lock);
+	if (!runLock.owns_lock()) {
+		function(context, 0, count);
+		return;
+	}
+
+	// スレッドあたりkChunksPerThread個程度に分け、各キューに連続した区間を割り当てる
+	const size_t threadCount = workers_.size() + 1;
+	const size_t targetChunkCount = threadCount * kChunksPerThread;
+	const size_t grain = std::max(minGrain, (count + targetChunkCount - 1) / targetChunkCount);
+	const size_t chunkCount = (count + grain - 1) / grain;
+	for (size_t i = 0; i < threadCount; i++) {
+		const uint32_t begin = static_cast<uint32_t>(chunkCount * i / threadCount);
+		const uint32_t end = static_cast<uint32_t>(chunkCount * (i + 1) / threadCount);
+		queues_[i].range.store(PackRange(begin, end), std::memory_order_relaxed);
+	}
+
+	Job job{ function, context, count, grain, {} };
+	job.remaining.store(chunkCount);
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		job_ = &job;
+		generation_++;
+	}
+	wakeCondition_.notify_all();
+
+	insideParallelFor = true;
+	Execute(job, 0);
+	insideParallelFor = false;
+
+	// 全区間が終わり、jobを参照しているワーカーがいなくなるまで待つ
+	std::unique_lock<std::mutex> lock(mutex_);
+	doneCondition_.wait(lock, [&] { return job.remaining.load() == 0 && activeWorkers_ == 0; });
+	job_ = nullptr;
+}
+
+void JobSystem::WorkerMain(size_t queueIndex) {
+	insideParallelFor = true;
+	size_t seenGeneration = 0;
+	for (;;) {
+		Job* job = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			wakeCondition_.wait(lock, [&] { return exit_ || (job_ != nullptr && generation_ != seenGeneration); });
+			if (exit_) {
+				return;
+			}
+			seenGeneration = generation_;
+			job = job_;
+			activeWorkers_++;
+		}
+		Execute(*job, queueIndex);
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			activeWorkers_--;
+		}
+		doneCondition_.notify_all();
+	}
+}
+
+void JobSystem::Execute(Job& job, size_t queueIndex) {
+	std::atomic<uint64_t>& own = queues_[queueIndex].range;
+	for (;;) {
+		uint32_t chunk = 0;
+		uint64_t range = own.load(std::memory_order_acquire);
+		bool popped = false;
+		while (RangeBegin(range) < RangeEnd(range)) {
+			if (own.compare_exchange_weak(range, PackRange(RangeBegin(range) + 1, RangeEnd(range)))) {
+				chunk = RangeBegin(range);
+				popped = true;
+				break;
+			}
+		}
+		if (!popped && !Steal(queueIndex, chunk)) {
+			return;
+		}
+		const size_t begin = chunk * job.grain;
+		const size_t end = std::min(begin + job.grain, job.count);
+		job.function(job.context, begin, end);
+		job.remaining.fetch_sub(1);
+	}
+}
+
+// 他のキューの残りの後ろ半分を取り、1つ目をchunkに返して残りを自分のキューに移す
+// 自分のキューは空なので、移すまでの間に他のスレッドが書き換えることはない
+bool JobSystem::Steal(size_t queueIndex, uint32_t& chunk) {
+	const size_t queueCount = workers_.size() + 1;
+	for (size_t offset = 1; offset < queueCount; offset++) {
+		std::atomic<uint64_t>& victim = queues_[(queueIndex + offset) % queueCount].range;
+		uint64_t range = victim.load(std::memory_order_acquire);
+		while (RangeBegin(range) < RangeEnd(range)) {
+			const uint32_t begin = RangeBegin(range), end = RangeEnd(range);
+			const uint32_t middle = end - (end - begin + 1) / 2;
+			if (victim.compare_exchange_weak(range, PackRange(begin, middle))) {
+				chunk = middle;
+				if (middle + 1 < end) {
+					queues_[queueIndex].range.store(PackRange(middle + 1, end), std::memory_order_release);
+				}
+				return true;
+			}
+		}
+	}
+	return false;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+// 並列処理
+// 起動時にワーカースレッドを作っておき、ParallelForで範囲を分けて呼び出し元と一緒に処理する
+// 分けた区間はスレッドごとのキューに連続して割り当て、自分のキューが空になったら他のキューの後ろ半分を盗む
+// ParallelForの中からParallelForを呼ぶと、内側は呼び出したスレッドでそのまま処理する
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+class JobSystem {
+public:
+	// 区間の大きさを決めるときの最小の要素数の既定値
+	static constexpr size_t kDefaultMinGrain = 1024;
+	// 1スレッドあたりの区間数の目安(盗めるだけの区間を残す)
+	static constexpr size_t kChunksPerThread = 8;
+
+	// workerCountは呼び出し元以外のスレッド数
+	explicit JobSystem(size_t workerCount);
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	// 共有のインスタンス
+	// スレッド数は環境変数MT4_THREADS(呼び出し元を含む)、指定がなければ論理コア数
+	static JobSystem& GetInstance();
+
+	// 処理に参加するスレッド数(呼び出し元を含む)
+	size_t GetThreadCount() const { return workers_.size() + 1; }
+	// スレッド数を変える(1ならすべて呼び出し元で処理する)
+	// 実行中のParallelForが終わるのを待ってからワーカーを作り直す
+	void SetThreadCount(size_t threadCount);
+
+	// [0, count)を区間に分けてfunc(begin, end)を呼ぶ。すべて終わってから戻る
+	// 区間の大きさはスレッド数から決め、minGrain個より小さくはしない
+	// count <= minGrainのとき、ワーカーがいないとき、入れ子や他のスレッドのParallelFor実行中は呼び出し元で処理する
+	template<class Func>
+	void ParallelFor(size_t count, size_t minGrain, Func&& func) {
+		using Function = std::remove_reference_t<Func>;
+		Run(count, minGrain,
+		    [](void* context, size_t begin, size_t end) { (*static_cast<Function*>(context))(begin, end); },
+		    const_cast<void*>(static_cast<const void*>(&func)));
+	}
+	template<class Func>
+	void ParallelFor(size_t count, Func&& func) {
+		ParallelFor(count, kDefaultMinGrain, func);
+	}
+
+private:
+	using RangeFunction = void (*)(void* context, size_t begin, size_t end);
+
+	// 実行中のParallelFor
+	struct Job {
+		RangeFunction function;
+		void* context;
+		size_t count;
+		size_t grain;
+		std::atomic<size_t> remaining;
+	};
+
+	// スレッドごとのキュー
+	// 区間番号の範囲[begin, end)を下位/上位32ビットに詰め、持ち主は先頭から、他のスレッドは後ろから取る
+	struct alignas(64) WorkQueue {
+		std::atomic<uint64_t> range;
+	};
+
+	void Run(size_t count, size_t minGrain, RangeFunction function, void* context);
+	void StartWorkers(size_t workerCount);
+	void StopWorkers();
+	void WorkerMain(size_t queueIndex);
+	// 自分のキューが空になるまで処理し、空になったら他のキューから盗む
+	void Execute(Job& job, size_t queueIndex);
+	bool Steal(size_t queueIndex, uint32_t& chunk);
+
+	std::vector<std::thread> workers_;
+	std::unique_ptr<WorkQueue[]> queues_; // 0番は呼び出し元
+	std::mutex mutex_;
+	std::condition_variable wakeCondition_;
+	std::condition_variable doneCondition_;
+	std::mutex runMutex_; // ParallelForは同時に1つだけ
+	Job* job_ = nullptr;
+	size_t generation_ = 0;
+	size_t activeWorkers_ = 0;
+	bool exit_ = false;
+};
@@ -1,445 +1,407 @@
 ﻿#include "MathFunction.h"
 
-#include <assert.h>
+#include <atomic>
+#include <cmath>
+#include <numbers>
+#include "JobSystem.h"
+#include "MathKernel.h"
+#include "SimdDispatch.h"
 
-#define _USE_MATH_DEFINES
-#include <math.h>
+namespace {
 
-// ベクトルの加法
-Vector3 Add(const Vector3& v1, const Vector3& v2) {
-	Vector3 result;
-	result.x = v1.x + v2.x;
-	result.y = v1.y + v2.y;
-	result.z = v1.z + v2.z;
-	return result;
-}
+// 一括演算をJobSystemで分けるときの1区間の最小の要素数
+// これ以下の個数なら呼び出したスレッドでそのまま処理する
+const size_t kParallelMinGrain = 2048;
 
-// ベクトルの減法
-Vector3 Subtract(const Vector3& v1, const Vector3 v2) {
-	Vector3 result;
-	result.x = v1.x - v2.x;
-	result.y = v1.y - v2.y;
-	result.z = v1.z - v2.z;
-	return result;
+// offset番目からの列
+ConstVector3SoA Offset(const ConstVector3SoA& soa, size_t offset) {
+	return ConstVector3SoA(soa.x + offset, soa.y + offset, soa.z + offset);
 }
-
-// スカラー倍
-Vector3 Multiply(const float& k, Vector3 v1) {
-	Vector3 result;
-	result.x = k * v1.x;
-	result.y = k * v1.y;
-	result.z = k * v1.z;
-	return result;
+Vector3SoA Offset(const Vector3SoA& soa, size_t offset) {
+	return Vector3SoA{ soa.x + offset, soa.y + offset, soa.z + offset };
 }
-
-// 内積
-float Dot(const Vector3& v1, const Vector3& v2) {
-	float result;
-	result = v1.x * v2.x + v1.y * v2.y + v1.z * v2.z;
-	return result;
+ConstQuaternionSoA Offset(const ConstQuaternionSoA& soa, size_t offset) {
+	return ConstQuaternionSoA(soa.x + offset, soa.y + offset, soa.z + offset, soa.w + offset);
 }
-
-// 長さ(ノルム)
-float Length(const Vector3& v1) {
-	float result;
-	result = sqrtf(Dot(v1, v1));
-	return result;
+QuaternionSoA Offset(const QuaternionSoA& soa, size_t offset) {
+	return QuaternionSoA{ soa.x + offset, soa.y + offset, soa.z + offset, soa.w + offset };
 }
 
-// 正規化
-Vector3 Normalize(const Vector3& v1) {
-	Vector3 result = { 0, 0, 0 };
-	float length = Length(v1);
-	if (length != 0.0f) {
-		result.x = v1.x / length;
-		result.y = v1.y / length;
-		result.z = v1.z / length;
-	}
+} // namespace
 
+// 行列の積
+// 実行環境に合わせて選んだカーネルで計算する(基準実装はMultiplyMatrixScalar)
+Matrix4x4 Multiply(const Matrix4x4& m1, const Matrix4x4& m2) {
+	MT4_PROFILE_SCOPE(kMultiply, 1);
+	static const auto kernel = MT4_SELECT_SIMD_KERNEL_AVX512(MultiplyMatrix);
+	Matrix4x4 result;
+	kernel(m1, m2, result);
 	return result;
 }
 
-// ベクトル変換
-Vector3 TransformNormal(const Vector3& v, const Matrix4x4& m) {
-	Vector3 result{
-		v.x * m.m[0][0] + v.y * m.m[1][0] + v.z * m.m[2][0],
-		v.x * m.m[0][1] + v.y * m.m[1][1] + v.z * m.m[2][1],
-		v.x * m.m[0][2] + v.y * m.m[1][2] + v.z * m.m[2][2] };
-
-	return result;
+// 行列の積(一括)
+void Multiply(const Matrix4x4* m1, const Matrix4x4* m2, Matrix4x4* result, size_t count) {
+	MT4_PROFILE_SCOPE(kMultiplyBatch, count);
+	static const auto kernel = MT4_SELECT_SIMD_KERNEL_AVX512(MultiplyMatrices);
+	JobSystem::GetInstance().ParallelFor(count, kParallelMinGrain, [&](size_t begin, size_t end) {
+		kernel(m1 + begin, m2 + begin, result + begin, end - begin);
+	});
 }
 
-// クロス積
-Vector3 Cross(const Vector3& v1, const Vector3& v2) {
-	Vector3 result;
-	result.x = (v1.y * v2.z) - (v1.z * v2.y);
-	result.y = (v1.z * v2.x) - (v1.x * v2.z);
-	result.z = (v1.x * v2.y) - (v1.y * v2.x);
-
+// 逆行列
+Matrix4x4 Inverse(const Matrix4x4& m) {
+	MT4_PROFILE_SCOPE(kInverse, 1);
+	static const auto kernel = MT4_SELECT_SIMD_KERNEL(InverseMatrix);
+	Matrix4x4 result;
+	kernel(m, result);
 	return result;
 }
 
-Vector3 GetXAxis(const Matrix4x4& m)
-{
-	return Vector3(m.m[0][0], m.m[0][1], m.m[0][2]);
-}
-
-Vector3 GetYAxis(const Matrix4x4& m)
-{
-	return Vector3(m.m[1][0], m.m[1][1], m.m[1][2]);
+bool TryInverse(const Matrix4x4& m, Matrix4x4& result) {
+	MT4_PROFILE_SCOPE(kInverse, 1);
+	static const auto kernel = MT4_SELECT_SIMD_KERNEL(InverseMatrix);
+	Matrix4x4 inverse;
+	if (!kernel(m, inverse)) {
+		return false;
+	}
+	result = inverse;
+	return true;
+}
+
+// 逆行列(一括)
+bool Inverse(const Matrix4x4* m, Matrix4x4* result, size_t count, bool* succeeded) {
+	MT4_PROFILE_SCOPE(kInverseBatch, count);
+	static const auto kernel = MT4_SELECT_SIMD_KERNEL(InverseMatrices);
+	std::atomic<bool> failed = false;
+	JobSystem::GetInstance().ParallelFor(count, kParallelMinGrain, [&](size_t begin, size_t end) {
+		if (!kernel(m + begin, result + begin, end - begin, succeeded ? succeeded + begin : nullptr)) {
+			failed.store(true, std::memory_order_relaxed);
+		}
+	});
+	return !failed.load(std::memory_order_relaxed);
 }
 
-Vector3 GetZAxis(const Matrix4x4& m)
-{
-	return Vector3(m.m[2][0], m.m[2][1], m.m[2][2]);
-}
+// アフィン行列の逆行列
+// 左上3x3の逆行列Aと -t * A で求める
+Matrix4x4 InverseAffine(const Matrix4x4& m) {
+	MT4_PROFILE_SCOPE(kInverseAffine, 1);
+	const float c00 = m.m[1][1] * m.m[2][2] - m.m[1][2] * m.m[2][1];
+	const float c01 = m.m[1][2] * m.m[2][0] - m.m[1][0] * m.m[2][2];
+	const float c02 = m.m[1][0] * m.m[2][1] - m.m[1][1] * m.m[2][0];
+	const float invDet = 1.0f / (m.m[0][0] * c00 + m.m[0][1] * c01 + m.m[0][2] * c02);
 
-Matrix4x4 Add(const Matrix4x4& m1, const Matrix4x4& m2) {
 	Matrix4x4 result;
-
-	for (int i = 0; i < 4; i++) {
-		for (int j = 0; j < 4; j++) {
-			result.m[i][j] = m1.m[i][j] + m2.m[i][j];
-		}
+	result.m[0][0] = c00 * invDet;
+	result.m[0][1] = (m.m[0][2] * m.m[2][1] - m.m[0][1] * m.m[2][2]) * invDet;
+	result.m[0][2] = (m.m[0][1] * m.m[1][2] - m.m[0][2] * m.m[1][1]) * invDet;
+	result.m[0][3] = 0.0f;
+	result.m[1][0] = c01 * invDet;
+	result.m[1][1] = (m.m[0][0] * m.m[2][2] - m.m[0][2] * m.m[2][0]) * invDet;
+	result.m[1][2] = (m.m[0][2] * m.m[1][0] - m.m[0][0] * m.m[1][2]) * invDet;
+	result.m[1][3] = 0.0f;
+	result.m[2][0] = c02 * invDet;
+	result.m[2][1] = (m.m[0][1] * m.m[2][0] - m.m[0][0] * m.m[2][1]) * invDet;
+	result.m[2][2] = (m.m[0][0] * m.m[1][1] - m.m[0][1] * m.m[1][0]) * invDet;
+	result.m[2][3] = 0.0f;
+	for (int column = 0; column < 3; column++) {
+		result.m[3][column] = -(m.m[3][0] * result.m[0][column] + m.m[3][1] * result.m[1][column] +
+		                        m.m[3][2] * result.m[2][column]);
 	}
-
+	result.m[3][3] = 1.0f;
 	return result;
 }
 
-Matrix4x4 Subtract(const Matrix4x4& m1, const Matrix4x4& m2) {
+// 剛体変換の逆行列
+Matrix4x4 InverseRigid(const Matrix4x4& m) {
+	MT4_PROFILE_SCOPE(kInverseRigid, 1);
 	Matrix4x4 result;
-
-	for (int i = 0; i < 4; i++) {
-		for (int j = 0; j < 4; j++) {
-			result.m[i][j] = m1.m[i][j] - m2.m[i][j];
+	for (int line = 0; line < 3; line++) {
+		for (int column = 0; column < 3; column++) {
+			result.m[line][column] = m.m[column][line];
 		}
+		result.m[line][3] = 0.0f;
 	}
-
-	return result;
-}
-
-// 行列の積
-Matrix4x4 Multiply(const Matrix4x4& m1, const Matrix4x4& m2) {
-	Matrix4x4 result;
-	for (int line = 0; line < 4; line++) {
-		for (int j = 0; j < 4; j++) {
-			result.m[line][j] = 0;
-		}
+	for (int column = 0; column < 3; column++) {
+		result.m[3][column] = -(m.m[3][0] * m.m[column][0] + m.m[3][1] * m.m[column][1] + m.m[3][2] * m.m[column][2]);
 	}
-	for (int line = 0; line < 4; line++) {
-		for (int column = 0; column < 4; column++) {
-			result.m[line][column] =
-				m1.m[line][0] * m2.m[0][column] + m1.m[line][1] * m2.m[1][column] +
-				m1.m[line][2] * m2.m[2][column] + m1.m[line][3] * m2.m[3][column];
-		}
+	result.m[3][3] = 1.0f;
+	return result;
+}
+
+// 座標変換(一括・SoA)
+void Transform(const ConstVector3SoA& input, const Vector3SoA& output, size_t count, const Matrix4x4& matrix) {
+	MT4_PROFILE_SCOPE(kTransformBatch, count);
+	static const auto kernel = MT4_SELECT_SIMD_KERNEL(TransformPoints);
+	const bool affine = IsAffineMatrix(matrix);
+	JobSystem::GetInstance().ParallelFor(count, kParallelMinGrain, [&](size_t begin, size_t end) {
+		kernel(Offset(input, begin), Offset(output, begin), end - begin, matrix, affine);
+	});
+}
+
+// 座標変換(一括・AoS)
+// カーネルの中でレーン幅ずつSoAに並べ替える(メモリ上の詰め替えはしない)
+void Transform(const Vector3* input, Vector3* output, size_t count, const Matrix4x4& matrix) {
+	MT4_PROFILE_SCOPE(kTransformBatch, count);
+	static const auto kernel = MT4_SELECT_SIMD_KERNEL(TransformPointsAoS);
+	const bool affine = IsAffineMatrix(matrix);
+	JobSystem::GetInstance().ParallelFor(count, kParallelMinGrain, [&](size_t begin, size_t end) {
+		kernel(input + begin, output + begin, end - begin, matrix, affine);
+	});
+}
+
+// 法線行列
+// 行a, b, cの3x3行列の逆行列の転置は (b x c, c x a, a x b) / (a . (b x c))
+Matrix3x3 MakeNormalMatrix(const Matrix4x4& m) {
+	Matrix3x3 result;
+	for (int line = 0; line < 3; line++) {
+		const float* b = m.m[(line + 1) % 3];
+		const float* c = m.m[(line + 2) % 3];
+		result.m[line][0] = b[1] * c[2] - b[2] * c[1];
+		result.m[line][1] = b[2] * c[0] - b[0] * c[2];
+		result.m[line][2] = b[0] * c[1] - b[1] * c[0];
 	}
-	return result;
-}
-
-// 逆行列
-Matrix4x4 Inverse(const Matrix4x4& m) {
-	Matrix4x4 result;
-	float A = m.m[0][0] * m.m[1][1] * m.m[2][2] * m.m[3][3] +
-		m.m[0][0] * m.m[1][2] * m.m[2][3] * m.m[3][1] +
-		m.m[0][0] * m.m[1][3] * m.m[2][1] * m.m[3][2] -
-
-		m.m[0][0] * m.m[1][3] * m.m[2][2] * m.m[3][1] -
-		m.m[0][0] * m.m[1][2] * m.m[2][1] * m.m[3][3] -
-		m.m[0][0] * m.m[1][1] * m.m[2][3] * m.m[3][2] -
-
-		m.m[0][1] * m.m[1][0] * m.m[2][2] * m.m[3][3] -
-		m.m[0][2] * m.m[1][0] * m.m[2][3] * m.m[3][1] -
-		m.m[0][3] * m.m[1][0] * m.m[2][1] * m.m[3][2] +
-
-		m.m[0][3] * m.m[1][0] * m.m[2][2] * m.m[3][1] +
-		m.m[0][2] * m.m[1][0] * m.m[2][1] * m.m[3][3] +
-		m.m[0][1] * m.m[1][0] * m.m[2][3] * m.m[3][2] +
-
-		m.m[0][1] * m.m[1][2] * m.m[2][0] * m.m[3][3] +
-		m.m[0][2] * m.m[1][3] * m.m[2][0] * m.m[3][1] +
-		m.m[0][3] * m.m[1][1] * m.m[2][0] * m.m[3][2] -
-
-		m.m[0][3] * m.m[1][2] * m.m[2][0] * m.m[3][1] -
-		m.m[0][2] * m.m[1][1] * m.m[2][0] * m.m[3][3] -
-		m.m[0][1] * m.m[1][3] * m.m[2][0] * m.m[3][2] -
-
-		m.m[0][1] * m.m[1][2] * m.m[2][3] * m.m[3][0] -
-		m.m[0][2] * m.m[1][3] * m.m[2][1] * m.m[3][0] -
-		m.m[0][3] * m.m[1][1] * m.m[2][2] * m.m[3][0] +
-
-		m.m[0][3] * m.m[1][2] * m.m[2][1] * m.m[3][0] +
-		m.m[0][2] * m.m[1][1] * m.m[2][3] * m.m[3][0] +
-		m.m[0][1] * m.m[1][3] * m.m[2][2] * m.m[3][0];
-
-	result.m[0][0] =
-		(1 / A) * (m.m[1][1] * m.m[2][2] * m.m[3][3] + m.m[1][2] * m.m[2][3] * m.m[3][1] +
-			m.m[1][3] * m.m[2][1] * m.m[3][2] - m.m[1][3] * m.m[2][2] * m.m[3][1] -
-			m.m[1][2] * m.m[2][1] * m.m[3][3] - m.m[1][1] * m.m[2][3] * m.m[3][2]);
-	result.m[0][1] =
-		(1 / A) * (-m.m[0][1] * m.m[2][2] * m.m[3][3] - m.m[0][2] * m.m[2][3] * m.m[3][1] -
-			m.m[0][3] * m.m[2][1] * m.m[3][2] + m.m[0][3] * m.m[2][2] * m.m[3][1] +
-			m.m[0][2] * m.m[2][1] * m.m[3][3] + m.m[0][1] * m.m[2][3] * m.m[3][2]);
-	result.m[0][2] =
-		(1 / A) * (m.m[0][1] * m.m[1][2] * m.m[3][3] + m.m[0][2] * m.m[1][3] * m.m[3][1] +
-			m.m[0][3] * m.m[1][1] * m.m[3][2] - m.m[0][3] * m.m[1][2] * m.m[3][1] -
-			m.m[0][2] * m.m[1][1] * m.m[3][3] - m.m[0][1] * m.m[1][3] * m.m[3][2]);
-	result.m[0][3] =
-		(1 / A) * (-m.m[0][1] * m.m[1][2] * m.m[2][3] - m.m[0][2] * m.m[1][3] * m.m[2][1] -
-			m.m[0][3] * m.m[1][1] * m.m[2][2] + m.m[0][3] * m.m[1][2] * m.m[2][1] +
-			m.m[0][2] * m.m[1][1] * m.m[2][3] + m.m[0][1] * m.m[1][3] * m.m[2][2]);
-	result.m[1][0] =
-		(1 / A) * (-m.m[1][0] * m.m[2][2] * m.m[3][3] - m.m[1][2] * m.m[2][3] * m.m[3][0] -
-			m.m[1][3] * m.m[2][0] * m.m[3][2] + m.m[1][3] * m.m[2][2] * m.m[3][0] +
-			m.m[1][2] * m.m[2][0] * m.m[3][3] + m.m[1][0] * m.m[2][3] * m.m[3][2]);
-	result.m[1][1] =
-		(1 / A) * (m.m[0][0] * m.m[2][2] * m.m[3][3] + m.m[0][2] * m.m[2][3] * m.m[3][0] +
-			m.m[0][3] * m.m[2][0] * m.m[3][2] - m.m[0][3] * m.m[2][2] * m.m[3][0] -
-			m.m[0][2] * m.m[2][0] * m.m[3][3] - m.m[0][0] * m.m[2][3] * m.m[3][2]);
-	result.m[1][2] =
-		(1 / A) * (-m.m[0][0] * m.m[1][2] * m.m[3][3] - m.m[0][2] * m.m[1][3] * m.m[3][0] -
-			m.m[0][3] * m.m[1][0] * m.m[3][2] + m.m[0][3] * m.m[1][2] * m.m[3][0] +
-			m.m[0][2] * m.m[1][0] * m.m[3][3] + m.m[0][0] * m.m[1][3] * m.m[3][2]);
-	result.m[1][3] =
-		(1 / A) * (m.m[0][0] * m.m[1][2] * m.m[2][3] + m.m[0][2] * m.m[1][3] * m.m[2][0] +
-			m.m[0][3] * m.m[1][0] * m.m[2][2] - m.m[0][3] * m.m[1][2] * m.m[2][0] -
-			m.m[0][2] * m.m[1][0] * m.m[2][3] - m.m[0][0] * m.m[1][3] * m.m[2][2]);
-	result.m[2][0] =
-		(1 / A) * (m.m[1][0] * m.m[2][1] * m.m[3][3] + m.m[1][1] * m.m[2][3] * m.m[3][0] +
-			m.m[1][3] * m.m[2][0] * m.m[3][1] - m.m[1][3] * m.m[2][1] * m.m[3][0] -
-			m.m[1][1] * m.m[2][0] * m.m[3][3] - m.m[1][0] * m.m[2][3] * m.m[3][1]);
-	result.m[2][1] =
-		(1 / A) * (-m.m[0][0] * m.m[2][1] * m.m[3][3] - m.m[0][1] * m.m[2][3] * m.m[3][0] -
-			m.m[0][3] * m.m[2][0] * m.m[3][1] + m.m[0][3] * m.m[2][1] * m.m[3][0] +
-			m.m[0][1] * m.m[2][0] * m.m[3][3] + m.m[0][0] * m.m[2][3] * m.m[3][1]);
-	result.m[2][2] =
-		(1 / A) * (m.m[0][0] * m.m[1][1] * m.m[3][3] + m.m[0][1] * m.m[1][3] * m.m[3][0] +
-			m.m[0][3] * m.m[1][0] * m.m[3][1] - m.m[0][3] * m.m[1][1] * m.m[3][0] -
-			m.m[0][1] * m.m[1][0] * m.m[3][3] - m.m[0][0] * m.m[1][3] * m.m[3][1]);
-	result.m[2][3] =
-		(1 / A) * (-m.m[0][0] * m.m[1][1] * m.m[2][3] - m.m[0][1] * m.m[1][3] * m.m[2][0] -
-			m.m[0][3] * m.m[1][0] * m.m[2][1] + m.m[0][3] * m.m[1][1] * m.m[2][0] +
-			m.m[0][1] * m.m[1][0] * m.m[2][3] + m.m[0][0] * m.m[1][3] * m.m[2][1]);
-	result.m[3][0] =
-		(1 / A) * (-m.m[1][0] * m.m[2][1] * m.m[3][2] - m.m[1][1] * m.m[2][2] * m.m[3][0] -
-			m.m[1][2] * m.m[2][0] * m.m[3][1] + m.m[1][2] * m.m[2][1] * m.m[3][0] +
-			m.m[1][1] * m.m[2][0] * m.m[3][2] + m.m[1][0] * m.m[2][2] * m.m[3][1]);
-	result.m[3][1] =
-		(1 / A) * (m.m[0][0] * m.m[2][1] * m.m[3][2] + m.m[0][1] * m.m[2][2] * m.m[3][0] +
-			m.m[0][2] * m.m[2][0] * m.m[3][1] - m.m[0][2] * m.m[2][1] * m.m[3][0] -
-			m.m[0][1] * m.m[2][0] * m.m[3][2] - m.m[0][0] * m.m[2][2] * m.m[3][1]);
-	result.m[3][2] =
-		(1 / A) * (-m.m[0][0] * m.m[1][1] * m.m[3][2] - m.m[0][1] * m.m[1][2] * m.m[3][0] -
-			m.m[0][2] * m.m[1][0] * m.m[3][1] + m.m[0][2] * m.m[1][1] * m.m[3][0] +
-			m.m[0][1] * m.m[1][0] * m.m[3][2] + m.m[0][0] * m.m[1][2] * m.m[3][1]);
-	result.m[3][3] =
-		(1 / A) * (m.m[0][0] * m.m[1][1] * m.m[2][2] + m.m[0][1] * m.m[1][2] * m.m[2][0] +
-			m.m[0][2] * m.m[1][0] * m.m[2][1] - m.m[0][2] * m.m[1][1] * m.m[2][0] -
-			m.m[0][1] * m.m[1][0] * m.m[2][2] - m.m[0][0] * m.m[1][2] * m.m[2][1]);
-
-	return result;
-}
-
-Matrix4x4 Transpose(const Matrix4x4& m) {
-	Matrix4x4 result;
-	for (int i = 0; i < 4; i++) {
-		for (int j = 0; j < 4; j++) {
-			result.m[i][j] = m.m[j][i];
-		}
-	}
-	return result;
-}
-
-// 平行移動行列
-Matrix4x4 MakeTranslateMatrix(const Vector3& translate) {
-	Matrix4x4 result;
-	for (int line = 0; line < 4; line++) {
-		for (int column = 0; column < 4; column++) {
-			if (line == column) {
-				result.m[line][column] = 1;
-			}
-			else {
-				result.m[line][column] = 0;
+	const float determinant =
+	    m.m[0][0] * result.m[0][0] + m.m[0][1] * result.m[0][1] + m.m[0][2] * result.m[0][2];
+	if (determinant != 0.0f) {
+		const float inverseDeterminant = 1.0f / determinant;
+		for (int line = 0; line < 3; line++) {
+			for (int column = 0; column < 3; column++) {
+				result.m[line][column] *= inverseDeterminant;
 			}
 		}
 	}
-
-	result.m[3][0] = translate.x;
-	result.m[3][1] = translate.y;
-	result.m[3][2] = translate.z;
-
 	return result;
 }
 
-// 拡大縮小行列
-Matrix4x4 MakeScaleMatrix(const Vector3& scale) {
-	Matrix4x4 result;
-	for (int line = 0; line < 4; line++) {
-		for (int column = 0; column < 4; column++) {
-			if (line == column) {
-				result.m[line][column] = 1;
+// 長さの2乗(一括・SoA)
+void LengthSquared(const ConstVector3SoA& v, float* result, size_t count) {
+	static const auto kernel = MT4_SELECT_SIMD_KERNEL(LengthsSquared);
+	JobSystem::GetInstance().ParallelFor(count, kParallelMinGrain, [&](size_t begin, size_t end) {
+		kernel(Offset(v, begin), result + begin, end - begin);
+	});
+}
+
+// 長さ(一括・SoA)
+template<ReciprocalPrecision kPrecision>
+void Length(const ConstVector3SoA& v, float* result, size_t count) {
+	static const auto kernel = MT4_SELECT_SIMD_KERNEL(Lengths);
+	JobSystem::GetInstance().ParallelFor(count, kParallelMinGrain, [&](size_t begin, size_t end) {
+		kernel(Offset(v, begin), result + begin, end - begin, kPrecision);
+	});
+}
+
+// 正規化(一括・SoA)
+template<ReciprocalPrecision kPrecision>
+void Normalize(const ConstVector3SoA& input, const Vector3SoA& output, size_t count) {
+	static const auto kernel = MT4_SELECT_SIMD_KERNEL(NormalizeVectors);
+	JobSystem::GetInstance().ParallelFor(count, kParallelMinGrain, [&](size_t begin, size_t end) {
+		kernel(Offset(input, begin), Offset(output, begin), end - begin, kPrecision);
+	});
+}
+
+// 正射影ベクトル(一括・SoA)
+template<ReciprocalPrecision kPrecision>
+void Project(const ConstVector3SoA& v1, const ConstVector3SoA& v2, const Vector3SoA& result, size_t count) {
+	static const auto kernel = MT4_SELECT_SIMD_KERNEL(ProjectVectors);
+	JobSystem::GetInstance().ParallelFor(count, kParallelMinGrain, [&](size_t begin, size_t end) {
+		kernel(Offset(v1, begin), Offset(v2, begin), Offset(result, begin), end - begin, kPrecision);
+	});
+}
+
+// 逆数・逆平方根の精度ごとの実体化
+#define MT4_INSTANTIATE_RECIPROCAL_PRECISION(precision) \
+	template void Length<precision>(const ConstVector3SoA& v, float* result, size_t count); \
+	template void Normalize<precision>(const ConstVector3SoA& input, const Vector3SoA& output, size_t count); \
+	template void Project<precision>( \
+		const ConstVector3SoA& v1, const ConstVector3SoA& v2, const Vector3SoA& result, size_t count);
+
+MT4_INSTANTIATE_RECIPROCAL_PRECISION(ReciprocalPrecision::kExact)
+MT4_INSTANTIATE_RECIPROCAL_PRECISION(ReciprocalPrecision::kPrecise)
+MT4_INSTANTIATE_RECIPROCAL_PRECISION(ReciprocalPrecision::kFast)
+
+#undef MT4_INSTANTIATE_RECIPROCAL_PRECISION
+
+// 法線の変換(一括・SoA)
+void TransformNormals(const ConstVector3SoA& input, const Vector3SoA& output, size_t count, const Matrix3x3& normalMatrix) {
+	static const auto kernel = MT4_SELECT_SIMD_KERNEL(TransformNormals);
+	JobSystem::GetInstance().ParallelFor(count, kParallelMinGrain, [&](size_t begin, size_t end) {
+		kernel(Offset(input, begin), Offset(output, begin), end - begin, normalMatrix);
+	});
+}
+
+// 法線の変換(一括・AoS)
+// 一定数ずつSoAに詰め替えてSoA版のカーネルで処理する
+void TransformNormals(const Vector3* input, Vector3* output, size_t count, const Matrix3x3& normalMatrix) {
+	static const auto kernel = MT4_SELECT_SIMD_KERNEL(TransformNormals);
+	JobSystem::GetInstance().ParallelFor(count, kParallelMinGrain, [&](size_t rangeBegin, size_t rangeEnd) {
+		const size_t kChunkSize = 256;
+		float x[kChunkSize];
+		float y[kChunkSize];
+		float z[kChunkSize];
+		const Vector3SoA chunk{ x, y, z };
+
+		for (size_t begin = rangeBegin; begin < rangeEnd; begin += kChunkSize) {
+			const size_t n = (rangeEnd - begin < kChunkSize) ? rangeEnd - begin : kChunkSize;
+			for (size_t i = 0; i < n; i++) {
+				x[i] = input[begin + i].x;
+				y[i] = input[begin + i].y;
+				z[i] = input[begin + i].z;
 			}
-			else {
-				result.m[line][column] = 0;
+			kernel(ConstVector3SoA(x, y, z), chunk, n, normalMatrix);
+			for (size_t i = 0; i < n; i++) {
+				output[begin + i].x = x[i];
+				output[begin + i].y = y[i];
+				output[begin + i].z = z[i];
 			}
 		}
-	}
-
-	result.m[0][0] = scale.x;
-	result.m[1][1] = scale.y;
-	result.m[2][2] = scale.z;
-
-	return result;
-}
-
-// 座標変換
-Vector3 Transform(const Vector3& vector, const Matrix4x4& matrix) {
-	Vector3 result;
-	result.x = vector.x * matrix.m[0][0] + vector.y * matrix.m[1][0] + vector.z * matrix.m[2][0] +
-		1.0f * matrix.m[3][0];
-	result.y = vector.x * matrix.m[0][1] + vector.y * matrix.m[1][1] + vector.z * matrix.m[2][1] +
-		1.0f * matrix.m[3][1];
-	result.z = vector.x * matrix.m[0][2] + vector.y * matrix.m[1][2] + vector.z * matrix.m[2][2] +
-		1.0f * matrix.m[3][2];
-	float w = vector.x * matrix.m[0][3] + vector.y * matrix.m[1][3] + vector.z * matrix.m[2][3] +
-		1.0f * matrix.m[3][3];
-	assert(w != 0.0f);
-	result.x /= w;
-	result.y /= w;
-	result.z /= w;
-	return result;
+	});
 }
 
 // X軸回転行列
+template<SinCosPrecision kPrecision>
 Matrix4x4 MakeRotateXMatrix(float radian) {
-	Matrix4x4 result;
-	for (int line = 0; line < 4; line++) {
-		for (int column = 0; column < 4; column++) {
-			if (line == column) {
-				result.m[line][column] = 1;
-			}
-			else {
-				result.m[line][column] = 0;
-			}
-		}
-	}
-	result.m[1][1] = std::cos(radian);
-	result.m[1][2] = std::sin(radian);
-	result.m[2][1] = -std::sin(radian);
-	result.m[2][2] = std::cos(radian);
-	return result;
+	float s, c;
+	SinCos<kPrecision>(radian, s, c);
+	return Matrix4x4{
+		1.0f, 0.0f, 0.0f, 0.0f,
+		0.0f, c, s, 0.0f,
+		0.0f, -s, c, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f };
 }
 
 // Y軸回転行列
+template<SinCosPrecision kPrecision>
 Matrix4x4 MakeRotateYMatrix(float radian) {
-	Matrix4x4 result;
-	for (int line = 0; line < 4; line++) {
-		for (int column = 0; column < 4; column++) {
-			if (line == column) {
-				result.m[line][column] = 1;
-			}
-			else {
-				result.m[line][column] = 0;
-			}
-		}
-	}
-	result.m[0][0] = std::cos(radian);
-	result.m[0][2] = -std::sin(radian);
-	result.m[2][0] = std::sin(radian);
-	result.m[2][2] = std::cos(radian);
-	return result;
+	float s, c;
+	SinCos<kPrecision>(radian, s, c);
+	return Matrix4x4{
+		c, 0.0f, -s, 0.0f,
+		0.0f, 1.0f, 0.0f, 0.0f,
+		s, 0.0f, c, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f };
 }
 
 // Z軸回転行列
+template<SinCosPrecision kPrecision>
 Matrix4x4 MakeRotateZMatrix(float radian) {
-	Matrix4x4 result;
-	for (int line = 0; line < 4; line++) {
-		for (int column = 0; column < 4; column++) {
-			if (line == column) {
-				result.m[line][column] = 1;
-			}
-			else {
-				result.m[line][column] = 0;
-			}
-		}
-	}
-	result.m[0][0] = std::cos(radian);
-	result.m[0][1] = std::sin(radian);
-	result.m[1][0] = -std::sin(radian);
-	result.m[1][1] = std::cos(radian);
-	return result;
+	float s, c;
+	SinCos<kPrecision>(radian, s, c);
+	return Matrix4x4{
+		c, s, 0.0f, 0.0f,
+		-s, c, 0.0f, 0.0f,
+		0.0f, 0.0f, 1.0f, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f };
 }
 
+// XYZ回転行列(X回転 * Y回転 * Z回転を展開したもの)
+template<SinCosPrecision kPrecision>
 Matrix4x4 MakeRotateXYZMatrix(const Vector3& rotation)
 {
-	Matrix4x4 result = MakeIdentity4x4();
-	result = Multiply(result, MakeRotateXMatrix(rotation.x));
-	result = Multiply(result, MakeRotateYMatrix(rotation.y));
-	result = Multiply(result, MakeRotateZMatrix(rotation.z));
-	return result;
-}
+	float sx, cx, sy, cy, sz, cz;
+	SinCos<kPrecision>(rotation.x, sx, cx);
+	SinCos<kPrecision>(rotation.y, sy, cy);
+	SinCos<kPrecision>(rotation.z, sz, cz);
+	return Matrix4x4{
+		cy * cz, cy * sz, -sy, 0.0f,
+		sx * sy * cz - cx * sz, sx * sy * sz + cx * cz, sx * cy, 0.0f,
+		cx * sy * cz + sx * sz, cx * sy * sz - sx * cz, cx * cy, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f };
+}
+
+namespace {
+
+// アフィン変換行列(スケーリング * (Z回転 * X回転 * Y回転) * 平行移動を展開したもの)
+// 各軸のsin/cosを受け取って直接書き込む
+inline void StoreAffineMatrix(
+	float scaleX, float scaleY, float scaleZ,
+	float sx, float cx, float sy, float cy, float sz, float cz,
+	float translateX, float translateY, float translateZ, Matrix4x4& result) {
+	result.m[0][0] = scaleX * (cz * cy + sz * sx * sy);
+	result.m[0][1] = scaleX * (sz * cx);
+	result.m[0][2] = scaleX * (sz * sx * cy - cz * sy);
+	result.m[0][3] = 0.0f;
+	result.m[1][0] = scaleY * (cz * sx * sy - sz * cy);
+	result.m[1][1] = scaleY * (cz * cx);
+	result.m[1][2] = scaleY * (sz * sy + cz * sx * cy);
+	result.m[1][3] = 0.0f;
+	result.m[2][0] = scaleZ * (cx * sy);
+	result.m[2][1] = scaleZ * (-sx);
+	result.m[2][2] = scaleZ * (cx * cy);
+	result.m[2][3] = 0.0f;
+	result.m[3][0] = translateX;
+	result.m[3][1] = translateY;
+	result.m[3][2] = translateZ;
+	result.m[3][3] = 1.0f;
+}
+
+} // namespace
 
 // アフィン変換行列
+template<SinCosPrecision kPrecision>
 Matrix4x4 MakeAffineMatrix(const Vector3& scale, const Vector3& rot, const Vector3& translate) {
+	MT4_PROFILE_SCOPE(kMakeAffineMatrix, 1);
+	float sx, cx, sy, cy, sz, cz;
+	SinCos<kPrecision>(rot.x, sx, cx);
+	SinCos<kPrecision>(rot.y, sy, cy);
+	SinCos<kPrecision>(rot.z, sz, cz);
 	Matrix4x4 result;
-	for (int line = 0; line < 4; line++) {
-		for (int column = 0; column < 4; column++) {
-			result.m[line][column] = 0;
-		}
-	}
-	// スケーリング行列の作成
-	Matrix4x4 scaleMatrix = MakeScaleMatrix(scale);
-
-	// X軸周り回転行列の作成
-	Matrix4x4 rotateX = MakeRotateXMatrix(rot.x);
-	// Y軸周り回転行列の作成
-	Matrix4x4 rotateY = MakeRotateYMatrix(rot.y);
-	// Z軸周り回転行列の作成
-	Matrix4x4 rotateZ = MakeRotateZMatrix(rot.z);
-	// 回転行列の合成(Z回転 * X回転 * Y回転)
-	Matrix4x4 rotateMatrix = Multiply(Multiply(rotateZ, rotateX), rotateY);
-
-	// 平行移動行列の作成
-	Matrix4x4 translateMatrix = MakeTranslateMatrix(translate);
-
-	result = Multiply(Multiply(scaleMatrix, rotateMatrix), translateMatrix);
+	StoreAffineMatrix(
+		scale.x, scale.y, scale.z, sx, cx, sy, cy, sz, cz,
+		translate.x, translate.y, translate.z, result);
 	return result;
 }
 
+// スケーリング * 回転行列 * 平行移動を展開したもの
 Matrix4x4 MakeAffineMatrix(const Vector3& scale, const Matrix4x4& rotateMatrix, const Vector3& translate)
 {
+	MT4_PROFILE_SCOPE(kMakeAffineMatrix, 1);
+	const float scales[4] = { scale.x, scale.y, scale.z, 1.0f };
+	const float translates[3] = { translate.x, translate.y, translate.z };
 	Matrix4x4 result;
 	for (int line = 0; line < 4; line++) {
-		for (int column = 0; column < 4; column++) {
-			result.m[line][column] = 0;
+		const float w = scales[line] * rotateMatrix.m[line][3];
+		for (int column = 0; column < 3; column++) {
+			result.m[line][column] = scales[line] * rotateMatrix.m[line][column] + w * translates[column];
 		}
+		result.m[line][3] = w;
 	}
-	// スケーリング行列の作成
-	Matrix4x4 scaleMatrix = MakeScaleMatrix(scale);
-
-	// 平行移動行列の作成
-	Matrix4x4 translateMatrix = MakeTranslateMatrix(translate);
-
-	result = Multiply(Multiply(scaleMatrix, rotateMatrix), translateMatrix);
 	return result;
 }
 
-// 単位行列の作成
-Matrix4x4 MakeIdentity4x4() {
-	Matrix4x4 result;
-	for (int i = 0; i < 4; i++) {
-		for (int j = 0; j < 4; j++) {
-			if (i == j) {
-				result.m[i][j] = 1;
-			}
-			else {
-				result.m[i][j] = 0;
+// アフィン変換行列(一括)
+// 一定数ずつsin/cosをまとめて求めてから行列を組み立てる
+template<SinCosPrecision kPrecision>
+void MakeAffineMatrix(
+	const ConstVector3SoA& scale, const ConstVector3SoA& rotate, const ConstVector3SoA& translate,
+	Matrix4x4* result, size_t count) {
+	MT4_PROFILE_SCOPE(kMakeAffineMatrixBatch, count);
+	JobSystem::GetInstance().ParallelFor(count, kParallelMinGrain, [&](size_t rangeBegin, size_t rangeEnd) {
+		const size_t kChunkSize = 64;
+		float sinX[kChunkSize], cosX[kChunkSize];
+		float sinY[kChunkSize], cosY[kChunkSize];
+		float sinZ[kChunkSize], cosZ[kChunkSize];
+
+		for (size_t begin = rangeBegin; begin < rangeEnd; begin += kChunkSize) {
+			const size_t n = (rangeEnd - begin < kChunkSize) ? rangeEnd - begin : kChunkSize;
+			SinCos<kPrecision>(rotate.x + begin, sinX, cosX, n);
+			SinCos<kPrecision>(rotate.y + begin, sinY, cosY, n);
+			SinCos<kPrecision>(rotate.z + begin, sinZ, cosZ, n);
+			for (size_t i = 0; i < n; i++) {
+				const size_t index = begin + i;
+				StoreAffineMatrix(
+					scale.x[index], scale.y[index], scale.z[index],
+					sinX[i], cosX[i], sinY[i], cosY[i], sinZ[i], cosZ[i],
+					translate.x[index], translate.y[index], translate.z[index], result[index]);
 			}
 		}
-	}
-	return result;
+	});
 }
 
+template<SinCosPrecision kPrecision>
 Matrix4x4 MakePerspectiveFovMatrix(float fovY, float aspectRatio, float nearClip, float farClip) {
+	float s, c;
+	SinCos<kPrecision>(fovY / 2.0f, s, c);
+	const float cot = c / s;
 	Matrix4x4 result;
 	for (int line = 0; line < 4; line++) {
 		for (int column = 0; column < 4; column++) {
@@ -447,8 +409,8 @@ Matrix4x4 MakePerspectiveFovMatrix(float fovY, float aspectRatio, float nearClip
 		}
 	}
 
-	result.m[0][0] = (1 / aspectRatio) * (1 / std::tan(fovY / 2.0f));
-	result.m[1][1] = (1 / std::tan(fovY / 2.0f));
+	result.m[0][0] = (1 / aspectRatio) * cot;
+	result.m[1][1] = cot;
 	result.m[2][2] = farClip / (farClip - nearClip);
 	result.m[2][3] = 1;
 	result.m[3][2] = (-nearClip * farClip) / (farClip - nearClip);
@@ -499,7 +461,8 @@ Matrix4x4 MakeViewMatrix(const Vector3& rotate, const Vector3& translate)
 {
 	Matrix4x4 result;
 	result = MakeAffineMatrix({ 1.0f, 1.0f, 1.0f }, rotate, translate);
-	result = Inverse(result);
+	// 拡大縮小を含まないので回転の転置で逆行列になる
+	result = InverseRigid(result);
 	return result;
 }
 
@@ -521,74 +484,381 @@ Matrix4x4 DirectionToDirection(const Vector3& from, const Vector3& to)
 	return result;
 }
 
+// sin/cosは1回だけ求める
+template<SinCosPrecision kPrecision>
 Matrix4x4 MakeRotateAxisAngle(const Vector3& axis, float angle)
 {
+	float sin, cos;
+	SinCos<kPrecision>(angle, sin, cos);
+	const float oneMinusCos = 1.0f - cos;
 	Matrix4x4 result = MakeIdentity4x4();
-	result.m[0][0] = (axis.x * axis.x) * (1 - std::cosf(angle)) + std::cosf(angle);
-	result.m[0][1] = (axis.x * axis.y) * (1.0f - std::cosf(angle)) + axis.z * std::sinf(angle);
-	result.m[0][2] = (axis.x * axis.z) * (1.0f - std::cosf(angle)) - axis.y * std::sinf(angle);
-	result.m[1][0] = (axis.x * axis.y) * (1.0f - std::cosf(angle)) - axis.z * std::sinf(angle);
-	result.m[1][1] = (axis.y * axis.y) * (1.0f - std::cosf(angle)) + std::cosf(angle);
-	result.m[1][2] = (axis.y * axis.z) * (1.0f - std::cosf(angle)) + axis.x * std::sinf(angle);
-	result.m[2][0] = (axis.x * axis.z) * (1.0f - std::cosf(angle)) + axis.y * std::sinf(angle);
-	result.m[2][1] = (axis.y * axis.z) * (1.0f - std::cosf(angle)) - axis.x * std::sinf(angle);
-	result.m[2][2] = (axis.z * axis.z) * (1.0f - std::cosf(angle)) + std::cosf(angle);
-	return result;
-}
-
-// 正射影ベクトル
-Vector3 Project(const Vector3& v1, const Vector3& v2) {
-	Vector3 result;
-	float t = Dot(v1, v2) / (Length(v2) * Length(v2));
-	result = Multiply(t, v2);
-	return result;
-}
-
-float ConvertToRadians(float degree)
-{
-	float result = degree * float(M_PI) / 180.0f;
+	result.m[0][0] = (axis.x * axis.x) * oneMinusCos + cos;
+	result.m[0][1] = (axis.x * axis.y) * oneMinusCos + axis.z * sin;
+	result.m[0][2] = (axis.x * axis.z) * oneMinusCos - axis.y * sin;
+	result.m[1][0] = (axis.x * axis.y) * oneMinusCos - axis.z * sin;
+	result.m[1][1] = (axis.y * axis.y) * oneMinusCos + cos;
+	result.m[1][2] = (axis.y * axis.z) * oneMinusCos + axis.x * sin;
+	result.m[2][0] = (axis.x * axis.z) * oneMinusCos + axis.y * sin;
+	result.m[2][1] = (axis.y * axis.z) * oneMinusCos - axis.x * sin;
+	result.m[2][2] = (axis.z * axis.z) * oneMinusCos + cos;
 	return result;
 }
 
 float LerpShortAngle(float a, float b, float t) {
+	const float twoPi = 2.0f * std::numbers::pi_v<float>;
 	// 角度差分を求める
 	float diff = b - a;
 
-	diff = std::fmodf(diff, float(M_PI));
+	// 2πの剰余を[-π, π]に収める
+	diff = std::fmod(diff, twoPi);
 
-	if (diff > M_PI) {
-		diff = diff - float(M_PI);
+	if (diff > std::numbers::pi_v<float>) {
+		diff = diff - twoPi;
 	}
-	else if (diff < -M_PI) {
-		diff = diff + float(M_PI);
-
+	else if (diff < -std::numbers::pi_v<float>) {
+		diff = diff + twoPi;
 	}
 
 	return a + diff * t;
 }
 
-Vector3 Lerp(const Vector3& v1, const Vector3& v2, float t) {
-	Vector3 result = Add(v1, Multiply(t, Subtract(v2, v1)));
-	return result;
+// 最短角度補間(一括)
+void LerpShortAngle(const float* a, const float* b, const float* t, float* result, size_t count) {
+	static const auto kernel = MT4_SELECT_SIMD_KERNEL(LerpShortAngles);
+	JobSystem::GetInstance().ParallelFor(count, kParallelMinGrain, [&](size_t begin, size_t end) {
+		kernel(a + begin, b + begin, t + begin, result + begin, end - begin);
+	});
+}
+
+// 線形補間(一括)
+void Lerp(const ConstVector3SoA& v1, const ConstVector3SoA& v2, const float* t, const Vector3SoA& result, size_t count) {
+	static const auto kernel = MT4_SELECT_SIMD_KERNEL(LerpVectors);
+	JobSystem::GetInstance().ParallelFor(count, kParallelMinGrain, [&](size_t begin, size_t end) {
+		kernel(Offset(v1, begin), Offset(v2, begin), t + begin, Offset(result, begin), end - begin);
+	});
 }
 
+// ベクトルの球面線形補間(向きを球面線形補間し、長さを線形補間する)
+// 向きはe1と、e2のe1に垂直な成分の方向を基底にしてt * angleだけ回す(逆向きに近くてもsinで割らない)
+// ほぼ同じ向きのときは正規化線形補間にし、
+// e2のe1に垂直な成分が残らず回転する平面が決まらないときだけ、v1に垂直な軸(DirectionToDirectionQuaternionと同じ選び方)の周りに回す
+template<SinCosPrecision kPrecision>
 Vector3 Slerp(const Vector3& v1, const Vector3& v2, float t) {
-	float s = ((1 - t) * Length(v1)) + (t * Length(v2));
-	Vector3 e1 = Normalize(v1);
-	Vector3 e2 = Normalize(v2);
-	float an = std::acosf(Dot(v1, v2) * (1.0f / (Length(v1) * Length(v2))));
-	if (an > 0.0f || an < 180.0f) {
-		Vector3 v1e = Multiply(std::sinf((1 - t) * an) / std::sinf(an), e1);
-		Vector3 v2e = Multiply(std::sinf(t * an) / std::sinf(an), e2);
-		Vector3 result = Multiply(s, Add(v1e, v2e));
-		return result;
-	}
-	return v1;
-}
-
-// 最近接点
-// Vector3 ClosestPoint(const Vector3& point, const Segment& segment)
-//{
-//	Vector3 result;
-//	result = Add(segment.origin, Project(Subtract(point, segment.origin), segment.diff));
-//	ret
\ No newline at end of file
+	const float kLinearThreshold = 0.9995f;
+	const float kDegenerateTangent = 1e-12f;
+	const float length1 = Length(v1);
+	const float length2 = Length(v2);
+	if (length1 == 0.0f || length2 == 0.0f) {
+		// 向きが決まらない
+		return Lerp(v1, v2, t);
+	}
+	const Vector3 e1 = Multiply(1.0f / length1, v1);
+	const Vector3 e2 = Multiply(1.0f / length2, v2);
+	const float dot = std::fmin(std::fmax(Dot(e1, e2), -1.0f), 1.0f);
+	const float length = (1.0f - t) * length1 + t * length2;
+
+	Vector3 direction;
+	if (dot > kLinearThreshold) {
+		direction = Normalize(Lerp(e1, e2, t));
+	}
+	else {
+		// |dot| > 0.7ではacos(dot)の誤差が大きくなるので、垂直な成分の長さ(sin)からasinで求める
+		Vector3 tangent = Subtract(e2, Multiply(dot, e1));
+		float angle = std::acos(dot);
+		if (std::fabs(dot) > 0.7f) {
+			const float acute = std::asin(std::fmin(Length(tangent), 1.0f));
+			angle = dot > 0.0f ? acute : std::numbers::pi_v<float> - acute;
+		}
+		if (Dot(tangent, tangent) < kDegenerateTangent) {
+			angle = std::numbers::pi_v<float>;
+			tangent = Cross(Vector3{ 1.0f, 0.0f, 0.0f }, e1);
+			if (Dot(tangent, tangent) < 1e-6f) {
+				tangent = Cross(Vector3{ 0.0f, 1.0f, 0.0f }, e1);
+			}
+		}
+		float sin, cos;
+		SinCos<kPrecision>(t * angle, sin, cos);
+		direction = Add(Multiply(cos, e1), Multiply(sin, Normalize(tangent)));
+	}
+	return Multiply(length, direction);
+}
+
+// ベクトルの球面線形補間(一括)
+void Slerp(const ConstVector3SoA& v1, const ConstVector3SoA& v2, const float* t, const Vector3SoA& result, size_t count) {
+	static const auto kernel = MT4_SELECT_SIMD_KERNEL(SlerpVectors);
+	JobSystem::GetInstance().ParallelFor(count, kParallelMinGrain, [&](size_t begin, size_t end) {
+		kernel(Offset(v1, begin), Offset(v2, begin), t + begin, Offset(result, begin), end - begin);
+	});
+}
+
+namespace {
+
+// アフィン変換行列(回転をクォータニオンで指定)
+// 各行をスケーリングした回転行列に平行移動を加える
+Matrix4x4 ComposeAffineMatrix(const Vector3& scale, const Quaternion& rotate, const Vector3& translate) {
+	Matrix4x4 result = MakeRotateMatrix(rotate);
+	const float scales[3] = { scale.x, scale.y, scale.z };
+	for (int line = 0; line < 3; line++) {
+		for (int column = 0; column < 3; column++) {
+			result.m[line][column] *= scales[line];
+		}
+	}
+	result.m[3][0] = translate.x;
+	result.m[3][1] = translate.y;
+	result.m[3][2] = translate.z;
+	return result;
+}
+
+} // namespace
+
+Matrix4x4 MakeAffineMatrix(const Vector3& scale, const Quaternion& rotate, const Vector3& translate) {
+	MT4_PROFILE_SCOPE(kMakeAffineMatrix, 1);
+	return ComposeAffineMatrix(scale, rotate, translate);
+}
+
+void MakeAffineMatrix(
+	const ConstVector3SoA& scale, const ConstQuaternionSoA& rotate, const ConstVector3SoA& translate,
+	Matrix4x4* result, size_t count) {
+	MT4_PROFILE_SCOPE(kMakeAffineMatrixBatch, count);
+	JobSystem::GetInstance().ParallelFor(count, kParallelMinGrain, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			result[i] = ComposeAffineMatrix(
+				Vector3{ scale.x[i], scale.y[i], scale.z[i] },
+				Quaternion{ rotate.x[i], rotate.y[i], rotate.z[i], rotate.w[i] },
+				Vector3{ translate.x[i], translate.y[i], translate.z[i] });
+		}
+	});
+}
+
+// 任意軸回転を表すクォータニオン
+template<SinCosPrecision kPrecision>
+Quaternion MakeRotateAxisAngleQuaternion(const Vector3& axis, float angle) {
+	float sin, cos;
+	SinCos<kPrecision>(angle * 0.5f, sin, cos);
+	return Quaternion{ axis.x * sin, axis.y * sin, axis.z * sin, cos };
+}
+
+// fromの向きをtoの向きに回転するクォータニオン
+// (from × to, 1 + from・to)を正規化すると半分の角度のsin/cosになる
+// 逆向きに近いときは1 + from・toが桁落ちするので|from × to|^2 / (1 - from・to)で求め、
+// from × toも打ち消し合わないようにfrom × (from + to)で求める(from × from = 0)
+Quaternion DirectionToDirectionQuaternion(const Vector3& from, const Vector3& to) {
+	// |from × to|がこれ(正規化したベクトルの丸めの大きさ)より小さいと回転軸が決まらない
+	const float kDegenerateAxis = 1e-14f;
+	const float dot = Dot(from, to);
+	if (dot >= 0.0f) {
+		const Vector3 axis = Cross(from, to);
+		return Normalize(Quaternion{ axis.x, axis.y, axis.z, 1.0f + dot });
+	}
+	Vector3 axis = Cross(from, Add(from, to));
+	const float axisSquared = Dot(axis, axis);
+	if (axisSquared < kDegenerateAxis) {
+		// 逆向きのときはfromに垂直な軸で180度回転する
+		axis = Cross(Vector3{ 1.0f, 0.0f, 0.0f }, from);
+		if (Dot(axis, axis) < 1e-6f) {
+			axis = Cross(Vector3{ 0.0f, 1.0f, 0.0f }, from);
+		}
+		axis = Normalize(axis);
+		return Quaternion{ axis.x, axis.y, axis.z, 0.0f };
+	}
+	return Normalize(Quaternion{ axis.x, axis.y, axis.z, axisSquared / (1.0f - dot) });
+}
+
+// 回転行列からクォータニオンを作る
+// 桁落ちを避けるため、対角成分のうち最も大きいものから求める
+Quaternion MakeRotateQuaternion(const Matrix4x4& rotateMatrix) {
+	const float (&m)[4][4] = rotateMatrix.m;
+	const float trace = m[0][0] + m[1][1] + m[2][2];
+	if (trace > 0.0f) {
+		const float s = std::sqrt(trace + 1.0f) * 2.0f;
+		return Quaternion{ (m[1][2] - m[2][1]) / s, (m[2][0] - m[0][2]) / s, (m[0][1] - m[1][0]) / s, 0.25f * s };
+	}
+	if (m[0][0] > m[1][1] && m[0][0] > m[2][2]) {
+		const float s = std::sqrt(1.0f + m[0][0] - m[1][1] - m[2][2]) * 2.0f;
+		return Quaternion{ 0.25f * s, (m[0][1] + m[1][0]) / s, (m[0][2] + m[2][0]) / s, (m[1][2] - m[2][1]) / s };
+	}
+	if (m[1][1] > m[2][2]) {
+		const float s = std::sqrt(1.0f + m[1][1] - m[0][0] - m[2][2]) * 2.0f;
+		return Quaternion{ (m[0][1] + m[1][0]) / s, 0.25f * s, (m[1][2] + m[2][1]) / s, (m[2][0] - m[0][2]) / s };
+	}
+	const float s = std::sqrt(1.0f + m[2][2] - m[0][0] - m[1][1]) * 2.0f;
+	return Quaternion{ (m[0][2] + m[2][0]) / s, (m[1][2] + m[2][1]) / s, 0.25f * s, (m[0][1] - m[1][0]) / s };
+}
+
+// アフィン行列の分解
+// 各軸から前の軸の成分を除いて正規化し、除いた量(なす角の余弦)で剪断を調べる
+bool Decompose(const Matrix4x4& m, Vector3& scale, Matrix3x3& rotate, Vector3& translate, float shearTolerance) {
+	const Vector3 rows[3] = { GetXAxis(m), GetYAxis(m), GetZAxis(m) };
+	Vector3 axes[3];
+	float scales[3];
+	bool nonZero = true, orthogonal = true;
+	for (int i = 0; i < 3; i++) {
+		Vector3 r = rows[i];
+		const float lengthSquared = Dot(r, r);
+		for (int k = 0; k < i; k++) {
+			const float dot = Dot(axes[k], r);
+			orthogonal = orthogonal && dot * dot <= shearTolerance * shearTolerance * lengthSquared;
+			r = Subtract(r, Multiply(dot, axes[k]));
+		}
+		scales[i] = Length(r);
+		nonZero = nonZero && scales[i] > 0.0f;
+		axes[i] = scales[i] > 0.0f ? Multiply(1.0f / scales[i], r) : Vector3{ 0.0f, 0.0f, 0.0f };
+	}
+	// 鏡映を含むならx軸を反転して回転にする
+	if (Dot(Cross(axes[0], axes[1]), axes[2]) < 0.0f) {
+		scales[0] = -scales[0];
+		axes[0] = Multiply(-1.0f, axes[0]);
+	}
+	rotate = MakeIdentity3x3();
+	if (nonZero) {
+		for (int i = 0; i < 3; i++) {
+			rotate.m[i][0] = axes[i].x;
+			rotate.m[i][1] = axes[i].y;
+			rotate.m[i][2] = axes[i].z;
+		}
+	}
+	scale = Vector3{ scales[0], scales[1], scales[2] };
+	translate = Vector3{ m.m[3][0], m.m[3][1], m.m[3][2] };
+	return nonZero && orthogonal;
+}
+
+bool Decompose(const Matrix4x4& m, Vector3& scale, Quaternion& rotate, Vector3& translate, float shearTolerance) {
+	Matrix3x3 rotateMatrix;
+	const bool succeeded = Decompose(m, scale, rotateMatrix, translate, shearTolerance);
+	rotate = MakeRotateQuaternion(MakeMatrix4x4(rotateMatrix));
+	return succeeded;
+}
+
+// アフィン行列の分解(一括)
+bool Decompose(const Matrix4x4* m, const Vector3SoA& scale, const QuaternionSoA& rotate, const Vector3SoA& translate,
+    size_t count, bool* succeeded, float shearTolerance) {
+	static const auto kernel = MT4_SELECT_SIMD_KERNEL(DecomposeMatrices);
+	std::atomic<bool> failed = false;
+	JobSystem::GetInstance().ParallelFor(count, kParallelMinGrain, [&](size_t begin, size_t end) {
+		if (!kernel(m + begin, Offset(scale, begin), Offset(rotate, begin), Offset(translate, begin), end - begin,
+		        shearTolerance, succeeded ? succeeded + begin : nullptr)) {
+			failed.store(true, std::memory_order_relaxed);
+		}
+	});
+	return !failed.load(std::memory_order_relaxed);
+}
+
+// 分解して補間し、組み立て直す(一括)
+void BlendAffineMatrices(const Matrix4x4* m0, const Matrix4x4* m1, const float* t, Matrix4x4* result, size_t count,
+    float shearTolerance) {
+	static const auto kernel = MT4_SELECT_SIMD_KERNEL(BlendAffineMatrices);
+	JobSystem::GetInstance().ParallelFor(count, kParallelMinGrain, [&](size_t begin, size_t end) {
+		kernel(m0 + begin, m1 + begin, t + begin, result + begin, end - begin, shearTolerance);
+	});
+}
+
+// 球面線形補間
+// ほぼ同じ向きのときはsinで割れないので正規化線形補間にする
+template<SinCosPrecision kPrecision>
+Quaternion Slerp(const Quaternion& q0, const Quaternion& q1, float t) {
+	const float kLinearThreshold = 0.9995f;
+	float dot = Dot(q0, q1);
+	float sign = 1.0f;
+	if (dot < 0.0f) {
+		dot = -dot;
+		sign = -1.0f;
+	}
+	if (dot > kLinearThreshold) {
+		return Nlerp(q0, q1, t);
+	}
+	const float angle = std::acos(dot);
+	float sinAngle, sin0, sin1, cos;
+	SinCos<kPrecision>(angle, sinAngle, cos);
+	SinCos<kPrecision>((1.0f - t) * angle, sin0, cos);
+	SinCos<kPrecision>(t * angle, sin1, cos);
+	const float weight0 = sin0 / sinAngle;
+	const float weight1 = sign * sin1 / sinAngle;
+	return Quaternion{
+		weight0 * q0.x + weight1 * q1.x, weight0 * q0.y + weight1 * q1.y,
+		weight0 * q0.z + weight1 * q1.z, weight0 * q0.w + weight1 * q1.w };
+}
+
+// 補間(一括)
+void Nlerp(const ConstQuaternionSoA& q0, const ConstQuaternionSoA& q1, const float* t,
+	const QuaternionSoA& result, size_t count) {
+	static const auto kernel = MT4_SELECT_SIMD_KERNEL(NlerpQuaternions);
+	JobSystem::GetInstance().ParallelFor(count, kParallelMinGrain, [&](size_t begin, size_t end) {
+		kernel(Offset(q0, begin), Offset(q1, begin), t + begin, Offset(result, begin), end - begin);
+	});
+}
+
+void Slerp(const ConstQuaternionSoA& q0, const ConstQuaternionSoA& q1, const float* t,
+	const QuaternionSoA& result, size_t count) {
+	static const auto kernel = MT4_SELECT_SIMD_KERNEL(SlerpQuaternions);
+	JobSystem::GetInstance().ParallelFor(count, kParallelMinGrain, [&](size_t begin, size_t end) {
+		kernel(Offset(q0, begin), Offset(q1, begin), t + begin, Offset(result, begin), end - begin);
+	});
+}
+
+// sin/cosの精度ごとの実体化
+#define MT4_INSTANTIATE_SIN_COS_PRECISION(precision) \
+	template Matrix4x4 MakeRotateXMatrix<precision>(float radian); \
+	template Matrix4x4 MakeRotateYMatrix<precision>(float radian); \
+	template Matrix4x4 MakeRotateZMatrix<precision>(float radian); \
+	template Matrix4x4 MakeRotateXYZMatrix<precision>(const Vector3& rotation); \
+	template Matrix4x4 MakeAffineMatrix<precision>(const Vector3& scale, const Vector3& rot, const Vector3& translate); \
+	template void MakeAffineMatrix<precision>( \
+		const ConstVector3SoA& scale, const ConstVector3SoA& rotate, const ConstVector3SoA& translate, \
+		Matrix4x4* result, size_t count); \
+	template Matrix4x4 MakePerspectiveFovMatrix<precision>(float fovY, float aspectRatio, float nearClip, float farClip); \
+	template Matrix4x4 MakeRotateAxisAngle<precision>(const Vector3& axis, float angle); \
+	template Vector3 Slerp<precision>(const Vector3& v1, const Vector3& v2, float t); \
+	template Quaternion MakeRotateAxisAngleQuaternion<precision>(const Vector3& axis, float angle); \
+	template Quaternion Slerp<precision>(const Quaternion& q0, const Quaternion& q1, float t);
+
+MT4_INSTANTIATE_SIN_COS_PRECISION(SinCosPrecision::kExact)
+MT4_INSTANTIATE_SIN_COS_PRECISION(SinCosPrecision::kPrecise)
+MT4_INSTANTIATE_SIN_COS_PRECISION(SinCosPrecision::kFast)
+
+#undef MT4_INSTANTIATE_SIN_COS_PRECISION
+
+// 三角形の最近接点
+// 点が頂点・辺・面のどの領域に射影されるかを重心座標の符号で調べる
+Vector3 ClosestPoint(const Vector3& point, const Triangle& triangle) {
+	const Vector3& a = triangle.vertices[0];
+	const Vector3& b = triangle.vertices[1];
+	const Vector3& c = triangle.vertices[2];
+	const Vector3 ab = Subtract(b, a);
+	const Vector3 ac = Subtract(c, a);
+	const Vector3 ap = Subtract(point, a);
+	const float d1 = Dot(ab, ap);
+	const float d2 = Dot(ac, ap);
+	if (d1 <= 0.0f && d2 <= 0.0f) {
+		return a;
+	}
+	const Vector3 bp = Subtract(point, b);
+	const float d3 = Dot(ab, bp);
+	const float d4 = Dot(ac, bp);
+	if (d3 >= 0.0f && d4 <= d3) {
+		return b;
+	}
+	const float vc = d1 * d4 - d3 * d2;
+	if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+		// 辺ab
+		return Add(a, Multiply(d1 / (d1 - d3), ab));
+	}
+	const Vector3 cp = Subtract(point, c);
+	const float d5 = Dot(ab, cp);
+	const float d6 = Dot(ac, cp);
+	if (d6 >= 0.0f && d5 <= d6) {
+		return c;
+	}
+	const float vb = d5 * d2 - d1 * d6;
+	if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+		// 辺ac
+		return Add(a, Multiply(d2 / (d2 - d6), ac));
+	}
+	const float va = d3 * d6 - d5 * d4;
+	if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+		// 辺bc
+		return Add(b, Multiply((d4 - d3) / ((d4 - d3) + (d5 - d6)), Subtract(c, b)));
+	}
+	// 面の内側
+	const float denominator = 1.0f / (va + vb + vc);
+	return Add(a, Add(Multiply(vb * denominator, ab), Multiply(vc * denominator, ac)));
+}
@@ -1,69 +1,263 @@
 ﻿#pragma once
 
+#include <cassert>
 #include <cmath>
+#include <cstddef>
+#include <numbers>
 #include "Vector2.h"
 #include "Vector3.h"
 #include "Vector4.h"
 #include "Matrix4x4.h"
+#include "Primitive.h"
+#include "Profiler.h"
+#include "Quaternion.h"
+#include "QuaternionSoA.h"
+#include "Reciprocal.h"
+#include "SinCos.h"
+#include "Vector3SoA.h"
+#include "VectorMatrix.h"
+
+// 小さな関数はここでinline(constexpr)定義し、呼び出し側で展開できるようにする
+// 一括演算や命令セット別のカーネルを使うものはMathFunction.cppに置く
+// 一括演算は要素数が多いとJobSystem::GetInstance()のスレッドで分けて処理する
 
 // ベクトルの加法
-Vector3 Add(const Vector3& v1, const Vector3& v2);
+constexpr Vector3 Add(const Vector3& v1, const Vector3& v2) {
+	return Vector3{ v1.x + v2.x, v1.y + v2.y, v1.z + v2.z };
+}
 // ベクトルの減法
-Vector3 Subtract(const Vector3& v1, const Vector3 v2);
+constexpr Vector3 Subtract(const Vector3& v1, const Vector3& v2) {
+	return Vector3{ v1.x - v2.x, v1.y - v2.y, v1.z - v2.z };
+}
 // スカラー倍
-Vector3 Multiply(const float& k, Vector3 v1);
+constexpr Vector3 Multiply(float k, const Vector3& v1) {
+	return Vector3{ k * v1.x, k * v1.y, k * v1.z };
+}
 // 内積
-float Dot(const Vector3& v1, const Vector3& v2);
+constexpr float Dot(const Vector3& v1, const Vector3& v2) {
+	return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z;
+}
 // 長さ(ノルム)
-float Length(const Vector3& v1);
+inline float Length(const Vector3& v1) {
+	return std::sqrt(Dot(v1, v1));
+}
 // 正規化
-Vector3 Normalize(const Vector3& v1);
+inline Vector3 Normalize(const Vector3& v1) {
+	const float length = Length(v1);
+	if (length == 0.0f) {
+		return Vector3{ 0.0f, 0.0f, 0.0f };
+	}
+	return Vector3{ v1.x / length, v1.y / length, v1.z / length };
+}
+// 長さの2乗
+constexpr float LengthSquared(const Vector3& v1) {
+	return Dot(v1, v1);
+}
+// 長さの2乗・長さ・正規化(一括・SoA)
+// kPrecisionで逆平方根の精度を選べる(Reciprocal.h) 長さ0のベクトルはNormalizeと同じく0ベクトルにする
+// 出力は入力と同じ配列でもよい
+void LengthSquared(const ConstVector3SoA& v, float* result, size_t count);
+template<ReciprocalPrecision kPrecision = ReciprocalPrecision::kExact>
+void Length(const ConstVector3SoA& v, float* result, size_t count);
+template<ReciprocalPrecision kPrecision = ReciprocalPrecision::kExact>
+void Normalize(const ConstVector3SoA& input, const Vector3SoA& output, size_t count);
+
+// Vector2/Vector4はVec<float, 2/4>(VectorMatrix.h)の演算をそのまま使う
+constexpr Vector2 Add(const Vector2& v1, const Vector2& v2) { return ToVector2(Add(ToVec(v1), ToVec(v2))); }
+constexpr Vector2 Subtract(const Vector2& v1, const Vector2& v2) { return ToVector2(Subtract(ToVec(v1), ToVec(v2))); }
+constexpr Vector2 Multiply(float k, const Vector2& v1) { return ToVector2(Multiply(k, ToVec(v1))); }
+constexpr float Dot(const Vector2& v1, const Vector2& v2) { return Dot(ToVec(v1), ToVec(v2)); }
+inline float Length(const Vector2& v1) { return Length(ToVec(v1)); }
+inline Vector2 Normalize(const Vector2& v1) { return ToVector2(Normalize(ToVec(v1))); }
+constexpr Vector2 Lerp(const Vector2& v1, const Vector2& v2, float t) { return ToVector2(Lerp(ToVec(v1), ToVec(v2), t)); }
+constexpr Vector4 Add(const Vector4& v1, const Vector4& v2) { return ToVector4(Add(ToVec(v1), ToVec(v2))); }
+constexpr Vector4 Subtract(const Vector4& v1, const Vector4& v2) { return ToVector4(Subtract(ToVec(v1), ToVec(v2))); }
+constexpr Vector4 Multiply(float k, const Vector4& v1) { return ToVector4(Multiply(k, ToVec(v1))); }
+constexpr float Dot(const Vector4& v1, const Vector4& v2) { return Dot(ToVec(v1), ToVec(v2)); }
+inline float Length(const Vector4& v1) { return Length(ToVec(v1)); }
+inline Vector4 Normalize(const Vector4& v1) { return ToVector4(Normalize(ToVec(v1))); }
+constexpr Vector4 Lerp(const Vector4& v1, const Vector4& v2, float t) { return ToVector4(Lerp(ToVec(v1), ToVec(v2), t)); }
+// 行ベクトルと行列の積(wも含めてそのまま掛ける)
+constexpr Vector4 Transform(const Vector4& v, const Matrix4x4& m) { return ToVector4(Multiply(ToVec(v), ToMat(m))); }
 
-// ベクトル変換
-Vector3 TransformNormal(const Vector3& v, const Matrix4x4& m);
+// ベクトル変換(左上3x3をそのまま掛ける)
+// 拡大が一様でない行列で法線を変換するときはMakeNormalMatrixで作った行列を使う
+constexpr Vector3 TransformNormal(const Vector3& v, const Matrix4x4& m) {
+	return Vector3{
+	    v.x * m.m[0][0] + v.y * m.m[1][0] + v.z * m.m[2][0],
+	    v.x * m.m[0][1] + v.y * m.m[1][1] + v.z * m.m[2][1],
+	    v.x * m.m[0][2] + v.y * m.m[1][2] + v.z * m.m[2][2] };
+}
 
 // クロス積
-Vector3 Cross(const Vector3& v1, const Vector3& v2);
+constexpr Vector3 Cross(const Vector3& v1, const Vector3& v2) {
+	return Vector3{
+	    v1.y * v2.z - v1.z * v2.y,
+	    v1.z * v2.x - v1.x * v2.z,
+	    v1.x * v2.y - v1.y * v2.x };
+}
 
-Vector3 GetXAxis(const Matrix4x4& m);
-Vector3 GetYAxis(const Matrix4x4& m);
-Vector3 GetZAxis(const Matrix4x4& m);
+constexpr Vector3 GetXAxis(const Matrix4x4& m) { return Vector3{ m.m[0][0], m.m[0][1], m.m[0][2] }; }
+constexpr Vector3 GetYAxis(const Matrix4x4& m) { return Vector3{ m.m[1][0], m.m[1][1], m.m[1][2] }; }
+constexpr Vector3 GetZAxis(const Matrix4x4& m) { return Vector3{ m.m[2][0], m.m[2][1], m.m[2][2] }; }
 
 // 行列の加法
-Matrix4x4 Add(const Matrix4x4& m1, const Matrix4x4& m2);
+constexpr Matrix4x4 Add(const Matrix4x4& m1, const Matrix4x4& m2) {
+	Matrix4x4 result{};
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			result.m[i][j] = m1.m[i][j] + m2.m[i][j];
+		}
+	}
+	return result;
+}
 // 行列の減法
-Matrix4x4 Subtract(const Matrix4x4& m1, const Matrix4x4& m2);
+constexpr Matrix4x4 Subtract(const Matrix4x4& m1, const Matrix4x4& m2) {
+	Matrix4x4 result{};
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			result.m[i][j] = m1.m[i][j] - m2.m[i][j];
+		}
+	}
+	return result;
+}
 // 行列の積
 Matrix4x4 Multiply(const Matrix4x4& m1, const Matrix4x4& m2);
+// 行列の積(一括) result[i] = m1[i] * m2[i]
+// resultはm1, m2と同じ配列でもよい
+void Multiply(const Matrix4x4* m1, const Matrix4x4* m2, Matrix4x4* result, size_t count);
 // 逆行列
 Matrix4x4 Inverse(const Matrix4x4& m);
+// 逆行列(正則でなければfalseを返し、resultは変更しない)
+bool TryInverse(const Matrix4x4& m, Matrix4x4& result);
+// 逆行列(一括)
+// すべて正則ならtrueを返す。succeededを渡すと行列ごとの成否を書き込む(失敗した結果は不定)
+bool Inverse(const Matrix4x4* m, Matrix4x4* result, size_t count, bool* succeeded = nullptr);
+// アフィン行列の逆行列(4列目が(0,0,0,1)であること)
+Matrix4x4 InverseAffine(const Matrix4x4& m);
+// 剛体変換(回転+平行移動)の逆行列 回転部分を転置して平行移動を打ち消す
+Matrix4x4 InverseRigid(const Matrix4x4& m);
 // 転置行列
-Matrix4x4 Transpose(const Matrix4x4& m);
+constexpr Matrix4x4 Transpose(const Matrix4x4& m) {
+	Matrix4x4 result{};
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			result.m[i][j] = m.m[j][i];
+		}
+	}
+	return result;
+}
 // 単位行列の作成
-Matrix4x4 MakeIdentity4x4();
+constexpr Matrix4x4 MakeIdentity4x4() {
+	return Matrix4x4{
+		1.0f, 0.0f, 0.0f, 0.0f,
+		0.0f, 1.0f, 0.0f, 0.0f,
+		0.0f, 0.0f, 1.0f, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f,
+	};
+}
 
 // 平行移動行列
-Matrix4x4 MakeTranslateMatrix(const Vector3& translate);
+constexpr Matrix4x4 MakeTranslateMatrix(const Vector3& translate) {
+	return Matrix4x4{
+		1.0f, 0.0f, 0.0f, 0.0f,
+		0.0f, 1.0f, 0.0f, 0.0f,
+		0.0f, 0.0f, 1.0f, 0.0f,
+		translate.x, translate.y, translate.z, 1.0f,
+	};
+}
 // 拡大縮小行列
-Matrix4x4 MakeScaleMatrix(const Vector3& scale);
+constexpr Matrix4x4 MakeScaleMatrix(const Vector3& scale) {
+	return Matrix4x4{
+		scale.x, 0.0f, 0.0f, 0.0f,
+		0.0f, scale.y, 0.0f, 0.0f,
+		0.0f, 0.0f, scale.z, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f,
+	};
+}
 // 座標変換
-Vector3 Transform(const Vector3& vector, const Matrix4x4& matrix);
+constexpr Vector3 Transform(const Vector3& vector, const Matrix4x4& matrix) {
+	if (!std::is_constant_evaluated()) {
+		MT4_PROFILE_COUNT(kTransform, 1);
+	}
+	const float w = vector.x * matrix.m[0][3] + vector.y * matrix.m[1][3] + vector.z * matrix.m[2][3] + matrix.m[3][3];
+	assert(w != 0.0f);
+	return Vector3{
+	    (vector.x * matrix.m[0][0] + vector.y * matrix.m[1][0] + vector.z * matrix.m[2][0] + matrix.m[3][0]) / w,
+	    (vector.x * matrix.m[0][1] + vector.y * matrix.m[1][1] + vector.z * matrix.m[2][1] + matrix.m[3][1]) / w,
+	    (vector.x * matrix.m[0][2] + vector.y * matrix.m[1][2] + vector.z * matrix.m[2][2] + matrix.m[3][2]) / w };
+}
+// 座標変換(一括・SoA)
+// 入力と出力は同じ配列でもよい。アフィン行列ならw除算を省略する
+void Transform(const ConstVector3SoA& input, const Vector3SoA& output, size_t count, const Matrix4x4& matrix);
+// 座標変換(一括・AoS)
+void Transform(const Vector3* input, Vector3* output, size_t count, const Matrix4x4& matrix);
+// アフィン行列か(4列目が(0,0,0,1))
+constexpr bool IsAffineMatrix(const Matrix4x4& m) {
+	return m.m[0][3] == 0.0f && m.m[1][3] == 0.0f && m.m[2][3] == 0.0f && m.m[3][3] == 1.0f;
+}
+
+// 3x3行列(Matrix3x3 = Mat<float, 3, 3>) 加減算・積・転置・行列式・逆行列はVectorMatrix.hの演算を使う
+constexpr Matrix3x3 MakeIdentity3x3() { return MakeIdentity<float, 3>(); }
+// 4x4行列の左上3x3
+constexpr Matrix3x3 MakeMatrix3x3(const Matrix4x4& m) {
+	return MakeMat<float, 3, 3>([&](auto i, auto j) { return m.m[i][j]; });
+}
+// 左上を3x3行列、残りを単位行列と同じにした4x4行列
+constexpr Matrix4x4 MakeMatrix4x4(const Matrix3x3& m) {
+	return ToMatrix4x4(MakeMat<float, 4, 4>([&](auto i, auto j) {
+		return (i < 3 && j < 3) ? m.m[i][j] : (i == j ? 1.0f : 0.0f);
+	}));
+}
+// ベクトル変換(3x3)
+constexpr Vector3 Transform(const Vector3& v, const Matrix3x3& m) { return ToVector3(Multiply(ToVec(v), m)); }
+// 法線行列(左上3x3の逆行列の転置) 余因子から求め、4x4の逆行列は使わない
+// 特異なら余因子行列をそのまま返す(正規化して使うなら向きは正しい)
+Matrix3x3 MakeNormalMatrix(const Matrix4x4& m);
+// 法線行列(拡大が一様な行列用) 左上3x3 / (1行目の長さ)^2
+inline Matrix3x3 MakeNormalMatrixUniformScale(const Matrix4x4& m) {
+	const float inverseScaleSquared =
+	    1.0f / (m.m[0][0] * m.m[0][0] + m.m[0][1] * m.m[0][1] + m.m[0][2] * m.m[0][2]);
+	return MakeMat<float, 3, 3>([&](auto i, auto j) { return m.m[i][j] * inverseScaleSquared; });
+}
+// 法線の変換(一括・SoA/AoS) normalMatrixはMakeNormalMatrixで作ったもの
+// 結果は逆平方根の近似(ニュートン法で1回補正)で正規化する 長さ0の法線は0のまま 入力と出力は同じ配列でもよい
+void TransformNormals(const ConstVector3SoA& input, const Vector3SoA& output, size_t count, const Matrix3x3& normalMatrix);
+void TransformNormals(const Vector3* input, Vector3* output, size_t count, const Matrix3x3& normalMatrix);
+
+// 三角関数を使う関数はkPrecisionでsin/cosの精度を選べる(SinCos.h)
 
 // X軸回転行列
+template<SinCosPrecision kPrecision = SinCosPrecision::kExact>
 Matrix4x4 MakeRotateXMatrix(float radian);
 // Y軸回転行列
+template<SinCosPrecision kPrecision = SinCosPrecision::kExact>
 Matrix4x4 MakeRotateYMatrix(float radian);
 // Z軸回転行列
+template<SinCosPrecision kPrecision = SinCosPrecision::kExact>
 Matrix4x4 MakeRotateZMatrix(float radian);
 
 // XYZ回転行列
+template<SinCosPrecision kPrecision = SinCosPrecision::kExact>
 Matrix4x4 MakeRotateXYZMatrix(const Vector3& rotation);
 
 // アフィン変換行列
+template<SinCosPrecision kPrecision = SinCosPrecision::kExact>
 Matrix4x4 MakeAffineMatrix(const Vector3& scale, const Vector3& rot, const Vector3& translate);
 Matrix4x4 MakeAffineMatrix(const Vector3& scale, const Matrix4x4& rotateMatrix, const Vector3& translate);
+// アフィン変換行列(一括・SoA)
+template<SinCosPrecision kPrecision = SinCosPrecision::kExact>
+void MakeAffineMatrix(
+    const ConstVector3SoA& scale, const ConstVector3SoA& rotate, const ConstVector3SoA& translate,
+    Matrix4x4* result, size_t count);
+// アフィン変換行列(回転をクォータニオンで指定 単位クォータニオンであること)
+Matrix4x4 MakeAffineMatrix(const Vector3& scale, const Quaternion& rotate, const Vector3& translate);
+void MakeAffineMatrix(
+    const ConstVector3SoA& scale, const ConstQuaternionSoA& rotate, const ConstVector3SoA& translate,
+    Matrix4x4* result, size_t count);
 
 // 透視投射行列
+template<SinCosPrecision kPrecision = SinCosPrecision::kExact>
 Matrix4x4 MakePerspectiveFovMatrix(float fovY, float aspectRatio, float nearClip, float farClip);
 // 正射影行列
 Matrix4x4 MakeOrthographicMatrix(
@@ -77,21 +271,161 @@ Matrix4x4 MakeViewMatrix(const Vector3& rotate, const Vector3& translate);
 
 // 任意軸回転行列
 Matrix4x4 DirectionToDirection(const Vector3& from, const Vector3& to);
+template<SinCosPrecision kPrecision = SinCosPrecision::kExact>
 Matrix4x4 MakeRotateAxisAngle(const Vector3& axis, float angle);
 
 
 // 正射影ベクトル
-Vector3 Project(const Vector3& v1, const Vector3& v2);
+inline Vector3 Project(const Vector3& v1, const Vector3& v2) {
+	return Multiply(Dot(v1, v2) / Dot(v2, v2), v2);
+}
+// 正射影ベクトル(一括・SoA) kPrecisionで逆数の精度を選べる(Reciprocal.h)
+// v2が長さ0なら0ベクトルにする(1つずつのProjectはNaNになる) resultはv1, v2と同じ配列でもよい
+template<ReciprocalPrecision kPrecision = ReciprocalPrecision::kExact>
+void Project(const ConstVector3SoA& v1, const ConstVector3SoA& v2, const Vector3SoA& result, size_t count);
 // 最近接点
-// Vector3 ClosestPoint(const Vector3& point, const Segment& segment);
+inline Vector3 ClosestPoint(const Vector3& point, const Segment& segment) {
+	const float lengthSquared = Dot(segment.diff, segment.diff);
+	if (lengthSquared == 0.0f) {
+		return segment.origin;
+	}
+	const float t = Dot(Subtract(point, segment.origin), segment.diff) / lengthSquared;
+	return Add(segment.origin, Multiply(std::fmin(std::fmax(t, 0.0f), 1.0f), segment.diff));
+}
+// 球は中身の詰まったものとして扱う(内側の点はそのまま返す)
+inline Vector3 ClosestPoint(const Vector3& point, const Sphere& sphere) {
+	const Vector3 offset = Subtract(point, sphere.center);
+	const float distance = Length(offset);
+	if (distance <= sphere.radius) {
+		return point;
+	}
+	return Add(sphere.center, Multiply(sphere.radius / distance, offset));
+}
+Vector3 ClosestPoint(const Vector3& point, const Triangle& triangle);
 
-float ConvertToRadians(float degree);
+constexpr float ConvertToRadians(float degree) {
+	return degree * (std::numbers::pi_v<float> / 180.0f);
+}
 
 // 最短角度補間
 float LerpShortAngle(float a, float b, float t);
+// 最短角度補間(一括) result[i] = LerpShortAngle(a[i], b[i], t[i])
+// 差がちょうど±πのときは回る向きがLerpShortAngleと異なることがある
+void LerpShortAngle(const float* a, const float* b, const float* t, float* result, size_t count);
 
-Vector3 Lerp(const Vector3& v1, const Vector3& v2, float t);
+constexpr Vector3 Lerp(const Vector3& v1, const Vector3& v2, float t) {
+	return Add(v1, Multiply(t, Subtract(v2, v1)));
+}
+// 線形補間(一括・SoA) result[i] = Lerp(v1[i], v2[i], t[i])
+// resultはv1, v2と同じ配列でもよい
+void Lerp(const ConstVector3SoA& v1, const ConstVector3SoA& v2, const float* t, const Vector3SoA& result, size_t count);
+// 球面線形補間(向きを球面線形補間し、長さを線形補間する)
+// 長さ0のベクトルはLerp、ほぼ逆向きのときはv1に垂直な軸の周りに回す
+template<SinCosPrecision kPrecision = SinCosPrecision::kExact>
 Vector3 Slerp(const Vector3& v1, const Vector3& v2, float t);
+// 球面線形補間(一括・SoA) result[i] = Slerp<kPrecise>(v1[i], v2[i], t[i])とほぼ同じ
+// resultはv1, v2と同じ配列でもよい
+void Slerp(const ConstVector3SoA& v1, const ConstVector3SoA& v2, const float* t, const Vector3SoA& result, size_t count);
+
+// クォータニオン
+// 積q1 * q2はq2の回転のあとにq1の回転をする(MakeRotateMatrix(q1 * q2) = MakeRotateMatrix(q2) * MakeRotateMatrix(q1))
+
+// 積
+constexpr Quaternion Multiply(const Quaternion& lhs, const Quaternion& rhs) {
+	return Quaternion{
+	    lhs.w * rhs.x + lhs.x * rhs.w + lhs.y * rhs.z - lhs.z * rhs.y,
+	    lhs.w * rhs.y - lhs.x * rhs.z + lhs.y * rhs.w + lhs.z * rhs.x,
+	    lhs.w * rhs.z + lhs.x * rhs.y - lhs.y * rhs.x + lhs.z * rhs.w,
+	    lhs.w * rhs.w - lhs.x * rhs.x - lhs.y * rhs.y - lhs.z * rhs.z };
+}
+// 単位クォータニオン
+constexpr Quaternion IdentityQuaternion() { return Quaternion{ 0.0f, 0.0f, 0.0f, 1.0f }; }
+// 共役
+constexpr Quaternion Conjugate(const Quaternion& q) { return Quaternion{ -q.x, -q.y, -q.z, q.w }; }
+// 内積
+constexpr float Dot(const Quaternion& q1, const Quaternion& q2) {
+	return q1.x * q2.x + q1.y * q2.y + q1.z * q2.z + q1.w * q2.w;
+}
+// ノルム
+inline float Norm(const Quaternion& q) { return std::sqrt(Dot(q, q)); }
+// 正規化
+inline Quaternion Normalize(const Quaternion& q) {
+	const float norm = Norm(q);
+	if (norm == 0.0f) {
+		return IdentityQuaternion();
+	}
+	return Quaternion{ q.x / norm, q.y / norm, q.z / norm, q.w / norm };
+}
+// 逆クォータニオン
+constexpr Quaternion Inverse(const Quaternion& q) {
+	const float normSquared = Dot(q, q);
+	return Quaternion{ -q.x / normSquared, -q.y / normSquared, -q.z / normSquared, q.w / normSquared };
+}
+
+// 任意軸回転を表すクォータニオン(axisは正規化済みであること)
+template<SinCosPrecision kPrecision = SinCosPrecision::kExact>
+Quaternion MakeRotateAxisAngleQuaternion(const Vector3& axis, float angle);
+// fromの向きをtoの向きに回転するクォータニオン(from, toは正規化済みであること)
+Quaternion DirectionToDirectionQuaternion(const Vector3& from, const Vector3& to);
+
+// ベクトルを回転する(単位クォータニオンであること)
+// v + 2w(u × v) + 2u × (u × v)  (u = (x, y, z))
+constexpr Vector3 RotateVector(const Vector3& vector, const Quaternion& q) {
+	const Vector3 u{ q.x, q.y, q.z };
+	const Vector3 t = Multiply(2.0f, Cross(u, vector));
+	return Add(Add(vector, Multiply(q.w, t)), Cross(u, t));
+}
+// 回転行列(単位クォータニオンであること)
+constexpr Matrix4x4 MakeRotateMatrix(const Quaternion& q) {
+	const float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z, ww = q.w * q.w;
+	const float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+	const float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+	return Matrix4x4{
+		ww + xx - yy - zz, 2.0f * (xy + wz), 2.0f * (xz - wy), 0.0f,
+		2.0f * (xy - wz), ww - xx + yy - zz, 2.0f * (yz + wx), 0.0f,
+		2.0f * (xz + wy), 2.0f * (yz - wx), ww - xx - yy + zz, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f,
+	};
+}
+// 回転行列(3x3)
+constexpr Matrix3x3 MakeRotateMatrix3x3(const Quaternion& q) { return MakeMatrix3x3(MakeRotateMatrix(q)); }
+// 回転行列からクォータニオンを作る(左上3x3が回転行列であること)
+Quaternion MakeRotateQuaternion(const Matrix4x4& rotateMatrix);
 
+// アフィン行列の分解 m = MakeAffineMatrix(scale, rotate, translate)となる値を求める
+// 行(各軸)をGram-Schmidt法で直交化して回転にし、行列式が負ならxの拡大を負にする
+// 剪断を含む(行どうしのなす角の余弦がshearToleranceを超える)か拡大が0ならfalseを返す
+// falseでも結果は書き込む(剪断は捨てた近似になり、拡大が0なら回転は単位行列)
+constexpr float kDecomposeShearTolerance = 1e-4f;
+bool Decompose(const Matrix4x4& m, Vector3& scale, Matrix3x3& rotate, Vector3& translate,
+    float shearTolerance = kDecomposeShearTolerance);
+bool Decompose(const Matrix4x4& m, Vector3& scale, Quaternion& rotate, Vector3& translate,
+    float shearTolerance = kDecomposeShearTolerance);
+// アフィン行列の分解(一括・SoA)
+// すべてtrueならtrueを返す succeededを渡すと行列ごとの結果を書き込む
+bool Decompose(const Matrix4x4* m, const Vector3SoA& scale, const QuaternionSoA& rotate, const Vector3SoA& translate,
+    size_t count, bool* succeeded = nullptr, float shearTolerance = kDecomposeShearTolerance);
+// 分解して補間し、組み立て直す(一括)
+// m0[i], m1[i]を分解し、拡大と平行移動はLerp、回転はNlerpでt[i]だけ補間して組み立てる 中間の配列は作らない
+// どちらかのDecomposeがfalseになる(剪断を含むか拡大が0の)ときは行列を要素ごとに線形補間する
+// resultはm0, m1と同じ配列でもよい 鏡映を含むものと含まないものの補間は途中で拡大が0を通る
+void BlendAffineMatrices(const Matrix4x4* m0, const Matrix4x4* m1, const float* t, Matrix4x4* result, size_t count,
+    float shearTolerance = kDecomposeShearTolerance);
 
+// 正規化線形補間(最短経路)
+inline Quaternion Nlerp(const Quaternion& q0, const Quaternion& q1, float t) {
+	const float t1 = Dot(q0, q1) < 0.0f ? -t : t;
+	return Normalize(Quaternion{
+	    (1.0f - t) * q0.x + t1 * q1.x, (1.0f - t) * q0.y + t1 * q1.y,
+	    (1.0f - t) * q0.z + t1 * q1.z, (1.0f - t) * q0.w + t1 * q1.w });
+}
+// 球面線形補間(最短経路)
+template<SinCosPrecision kPrecision = SinCosPrecision::kExact>
+Quaternion Slerp(const Quaternion& q0, const Quaternion& q1, float t);
 
+// 補間(一括・SoA) result[i] = Nlerp/Slerp(q0[i], q1[i], t[i])
+// resultはq0, q1と同じ配列でもよい
+void Nlerp(const ConstQuaternionSoA& q0, const ConstQuaternionSoA& q1, const float* t,
+    const QuaternionSoA& result, size_t count);
+void Slerp(const ConstQuaternionSoA& q0, const ConstQuaternionSoA& q1, const float* t,
+    const QuaternionSoA& result, size_t count);
@@ -0,0 +1,228 @@
+#pragma once
+
+// 一括演算カーネルの命令セット別エントリポイント
+// 公開APIはMathFunction.cpp側で実行環境に合わせて選択する
+
+#include <cstddef>
+#include <cstdint>
+#include "BVH.h"
+#include "Broadphase.h"
+#include "CompressedTransform.h"
+#include "Frustum.h"
+#include "Matrix4x4.h"
+#include "PrimitiveSoA.h"
+#include "QuaternionSoA.h"
+#include "Reciprocal.h"
+#include "SinCos.h"
+#include "Skinning.h"
+#include "Vector3SoA.h"
+#include "VectorMatrix.h"
+#include "VertexPipeline.h"
+
+// 行列の積
+void MultiplyMatrixScalar(const Matrix4x4& m1, const Matrix4x4& m2, Matrix4x4& result);
+void MultiplyMatrixSSE2(const Matrix4x4& m1, const Matrix4x4& m2, Matrix4x4& result);
+void MultiplyMatrixAVX2(const Matrix4x4& m1, const Matrix4x4& m2, Matrix4x4& result);
+void MultiplyMatrixAVX512(const Matrix4x4& m1, const Matrix4x4& m2, Matrix4x4& result);
+
+// 行列の積(一括) result[i] = m1[i] * m2[i]
+void MultiplyMatricesScalar(const Matrix4x4* m1, const Matrix4x4* m2, Matrix4x4* result, size_t count);
+void MultiplyMatricesSSE2(const Matrix4x4* m1, const Matrix4x4* m2, Matrix4x4* result, size_t count);
+void MultiplyMatricesAVX2(const Matrix4x4* m1, const Matrix4x4* m2, Matrix4x4* result, size_t count);
+void MultiplyMatricesAVX512(const Matrix4x4* m1, const Matrix4x4* m2, Matrix4x4* result, size_t count);
+
+// 逆行列 正則ならtrueを返す(resultは正則でなくても書き込む)
+bool InverseMatrixScalar(const Matrix4x4& m, Matrix4x4& result);
+bool InverseMatrixSSE2(const Matrix4x4& m, Matrix4x4& result);
+bool InverseMatrixAVX2(const Matrix4x4& m, Matrix4x4& result);
+
+// 逆行列(一括) すべて正則ならtrueを返す
+bool InverseMatricesScalar(const Matrix4x4* m, Matrix4x4* result, size_t count, bool* succeeded);
+bool InverseMatricesSSE2(const Matrix4x4* m, Matrix4x4* result, size_t count, bool* succeeded);
+bool InverseMatricesAVX2(const Matrix4x4* m, Matrix4x4* result, size_t count, bool* succeeded);
+
+// アフィン行列の分解(一括) すべて剪断を含まず拡大が0でなければtrueを返す
+bool DecomposeMatricesScalar(const Matrix4x4* m, const Vector3SoA& scale, const QuaternionSoA& rotate,
+    const Vector3SoA& translate, size_t count, float shearTolerance, bool* succeeded);
+bool DecomposeMatricesSSE2(const Matrix4x4* m, const Vector3SoA& scale, const QuaternionSoA& rotate,
+    const Vector3SoA& translate, size_t count, float shearTolerance, bool* succeeded);
+bool DecomposeMatricesAVX2(const Matrix4x4* m, const Vector3SoA& scale, const QuaternionSoA& rotate,
+    const Vector3SoA& translate, size_t count, float shearTolerance, bool* succeeded);
+
+// アフィン行列を分解して補間し、組み立て直す(一括)
+void BlendAffineMatricesScalar(
+    const Matrix4x4* m0, const Matrix4x4* m1, const float* t, Matrix4x4* result, size_t count, float shearTolerance);
+void BlendAffineMatricesSSE2(
+    const Matrix4x4* m0, const Matrix4x4* m1, const float* t, Matrix4x4* result, size_t count, float shearTolerance);
+void BlendAffineMatricesAVX2(
+    const Matrix4x4* m0, const Matrix4x4* m1, const float* t, Matrix4x4* result, size_t count, float shearTolerance);
+
+// 座標変換(SoA)
+// affineがtrueのときはw除算を省略する
+void TransformPointsScalar(
+    const ConstVector3SoA& input, const Vector3SoA& output, size_t count, const Matrix4x4& matrix, bool affine);
+void TransformPointsSSE2(
+    const ConstVector3SoA& input, const Vector3SoA& output, size_t count, const Matrix4x4& matrix, bool affine);
+void TransformPointsAVX2(
+    const ConstVector3SoA& input, const Vector3SoA& output, size_t count, const Matrix4x4& matrix, bool affine);
+// 座標変換(AoS) レーン幅ずつレジスタ内でSoAに並べ替えて計算する
+void TransformPointsAoSScalar(const Vector3* input, Vector3* output, size_t count, const Matrix4x4& matrix, bool affine);
+void TransformPointsAoSSSE2(const Vector3* input, Vector3* output, size_t count, const Matrix4x4& matrix, bool affine);
+void TransformPointsAoSAVX2(const Vector3* input, Vector3* output, size_t count, const Matrix4x4& matrix, bool affine);
+
+// 法線の変換(SoA) 結果は正規化する
+void TransformNormalsScalar(const ConstVector3SoA& input, const Vector3SoA& output, size_t count, const Matrix3x3& matrix);
+void TransformNormalsSSE2(const ConstVector3SoA& input, const Vector3SoA& output, size_t count, const Matrix3x3& matrix);
+void TransformNormalsAVX2(const ConstVector3SoA& input, const Vector3SoA& output, size_t count, const Matrix3x3& matrix);
+
+// sinとcos(一括) precisionはkPreciseかkFast
+void SinCosScalar(const float* radians, float* sin, float* cos, size_t count, SinCosPrecision precision);
+void SinCosSSE2(const float* radians, float* sin, float* cos, size_t count, SinCosPrecision precision);
+void SinCosAVX2(const float* radians, float* sin, float* cos, size_t count, SinCosPrecision precision);
+
+// クォータニオンの補間(一括) 結果は正規化する
+void NlerpQuaternionsScalar(const ConstQuaternionSoA& q0, const ConstQuaternionSoA& q1, const float* t,
+    const QuaternionSoA& result, size_t count);
+void NlerpQuaternionsSSE2(const ConstQuaternionSoA& q0, const ConstQuaternionSoA& q1, const float* t,
+    const QuaternionSoA& result, size_t count);
+void NlerpQuaternionsAVX2(const ConstQuaternionSoA& q0, const ConstQuaternionSoA& q1, const float* t,
+    const QuaternionSoA& result, size_t count);
+void SlerpQuaternionsScalar(const ConstQuaternionSoA& q0, const ConstQuaternionSoA& q1, const float* t,
+    const QuaternionSoA& result, size_t count);
+void SlerpQuaternionsSSE2(const ConstQuaternionSoA& q0, const ConstQuaternionSoA& q1, const float* t,
+    const QuaternionSoA& result, size_t count);
+void SlerpQuaternionsAVX2(const ConstQuaternionSoA& q0, const ConstQuaternionSoA& q1, const float* t,
+    const QuaternionSoA& result, size_t count);
+
+// 線形補間(一括)
+void LerpVectorsScalar(const ConstVector3SoA& v1, const ConstVector3SoA& v2, const float* t,
+    const Vector3SoA& result, size_t count);
+void LerpVectorsSSE2(const ConstVector3SoA& v1, const ConstVector3SoA& v2, const float* t,
+    const Vector3SoA& result, size_t count);
+void LerpVectorsAVX2(const ConstVector3SoA& v1, const ConstVector3SoA& v2, const float* t,
+    const Vector3SoA& result, size_t count);
+
+// ベクトルの球面線形補間(一括)
+void SlerpVectorsScalar(const ConstVector3SoA& v1, const ConstVector3SoA& v2, const float* t,
+    const Vector3SoA& result, size_t count);
+void SlerpVectorsSSE2(const ConstVector3SoA& v1, const ConstVector3SoA& v2, const float* t,
+    const Vector3SoA& result, size_t count);
+void SlerpVectorsAVX2(const ConstVector3SoA& v1, const ConstVector3SoA& v2, const float* t,
+    const Vector3SoA& result, size_t count);
+
+// 長さの2乗・長さ・正規化・正射影(一括) 長さ0のベクトルの正規化と長さ0のベクトルへの正射影は0ベクトル
+void LengthsSquaredScalar(const ConstVector3SoA& v, float* result, size_t count);
+void LengthsSquaredSSE2(const ConstVector3SoA& v, float* result, size_t count);
+void LengthsSquaredAVX2(const ConstVector3SoA& v, float* result, size_t count);
+void LengthsScalar(const ConstVector3SoA& v, float* result, size_t count, ReciprocalPrecision precision);
+void LengthsSSE2(const ConstVector3SoA& v, float* result, size_t count, ReciprocalPrecision precision);
+void LengthsAVX2(const ConstVector3SoA& v, float* result, size_t count, ReciprocalPrecision precision);
+void NormalizeVectorsScalar(
+    const ConstVector3SoA& input, const Vector3SoA& output, size_t count, ReciprocalPrecision precision);
+void NormalizeVectorsSSE2(
+    const ConstVector3SoA& input, const Vector3SoA& output, size_t count, ReciprocalPrecision precision);
+void NormalizeVectorsAVX2(
+    const ConstVector3SoA& input, const Vector3SoA& output, size_t count, ReciprocalPrecision precision);
+void ProjectVectorsScalar(const ConstVector3SoA& v1, const ConstVector3SoA& v2, const Vector3SoA& result,
+    size_t count, ReciprocalPrecision precision);
+void ProjectVectorsSSE2(const ConstVector3SoA& v1, const ConstVector3SoA& v2, const Vector3SoA& result,
+    size_t count, ReciprocalPrecision precision);
+void ProjectVectorsAVX2(const ConstVector3SoA& v1, const ConstVector3SoA& v2, const Vector3SoA& result,
+    size_t count, ReciprocalPrecision precision);
+
+// 最短角度補間(一括)
+void LerpShortAnglesScalar(const float* a, const float* b, const float* t, float* result, size_t count);
+void LerpShortAnglesSSE2(const float* a, const float* b, const float* t, float* result, size_t count);
+void LerpShortAnglesAVX2(const float* a, const float* b, const float* t, float* result, size_t count);
+
+// パーティクルの積分(一括) 寿命が尽きた数を返す
+size_t IntegrateParticlesScalar(const Vector3SoA& positions, const Vector3SoA& velocities, float* lifetimes,
+    size_t count, const Vector3& gravity, float damping, float deltaTime);
+size_t IntegrateParticlesSSE2(const Vector3SoA& positions, const Vector3SoA& velocities, float* lifetimes,
+    size_t count, const Vector3& gravity, float damping, float deltaTime);
+size_t IntegrateParticlesAVX2(const Vector3SoA& positions, const Vector3SoA& velocities, float* lifetimes,
+    size_t count, const Vector3& gravity, float damping, float deltaTime);
+// lifetimes[begin, end)で最初に寿命が尽きた番号 なければend
+size_t FindExpiredParticleScalar(const float* lifetimes, size_t begin, size_t end);
+size_t FindExpiredParticleSSE2(const float* lifetimes, size_t begin, size_t end);
+size_t FindExpiredParticleAVX2(const float* lifetimes, size_t begin, size_t end);
+
+// 視錐台カリング(一括) 見えるものの番号を詰めて書き込み、その数を返す
+size_t CullSpheresScalar(const Frustum& frustum, const ConstSphereSoA& spheres, size_t count,
+    uint32_t* visibleIndices, uint8_t* lastPlanes);
+size_t CullSpheresSSE2(const Frustum& frustum, const ConstSphereSoA& spheres, size_t count,
+    uint32_t* visibleIndices, uint8_t* lastPlanes);
+size_t CullSpheresAVX2(const Frustum& frustum, const ConstSphereSoA& spheres, size_t count,
+    uint32_t* visibleIndices, uint8_t* lastPlanes);
+size_t CullAABBsScalar(const Frustum& frustum, const ConstAABBSoA& aabbs, size_t count,
+    uint32_t* visibleIndices, uint8_t* lastPlanes);
+size_t CullAABBsSSE2(const Frustum& frustum, const ConstAABBSoA& aabbs, size_t count,
+    uint32_t* visibleIndices, uint8_t* lastPlanes);
+size_t CullAABBsAVX2(const Frustum& frustum, const ConstAABBSoA& aabbs, size_t count,
+    uint32_t* visibleIndices, uint8_t* lastPlanes);
+
+// 頂点変換(一括・SoA) clipMatrixでクリップ座標にして外側のクリップ面をclipFlagsに記録し、
+// screenMatrix(clipMatrix * ビューポート行列)の結果をw除算してpositionに書き込む
+void ProjectPointsScalar(const ConstVector3SoA& input, ScreenVertex* output, size_t count,
+    const Matrix4x4& clipMatrix, const Matrix4x4& screenMatrix);
+void ProjectPointsSSE2(const ConstVector3SoA& input, ScreenVertex* output, size_t count,
+    const Matrix4x4& clipMatrix, const Matrix4x4& screenMatrix);
+void ProjectPointsAVX2(const ConstVector3SoA& input, ScreenVertex* output, size_t count,
+    const Matrix4x4& clipMatrix, const Matrix4x4& screenMatrix);
+
+// BVHのレイ判定(一括)
+void RaycastBVHScalar(const BVHNode* nodes, const BVHPrimitive* primitives, const ConstRaySoA& rays,
+    const float* maxT, RayHit* hits, size_t count);
+void RaycastBVHSSE2(const BVHNode* nodes, const BVHPrimitive* primitives, const ConstRaySoA& rays,
+    const float* maxT, RayHit* hits, size_t count);
+void RaycastBVHAVX2(const BVHNode* nodes, const BVHPrimitive* primitives, const ConstRaySoA& rays,
+    const float* maxT, RayHit* hits, size_t count);
+
+// 掃引を再開する位置(図形iの相手jから)
+struct SweepCursor {
+	size_t i;
+	size_t j;
+};
+
+// 掃引で重なる組を探す [cursor.i, end) はじめはcursor = { begin, begin + 1 }
+// 図形・minKeys・maxKeys・idsは掃引する軸の最小値(minKeys)の昇順に並べておく
+// 重なる組をpairsに書き込んで数を返す 途中でpairsが足りなくなったらcursorを続きの位置にして返る(cursor.i == endで終わり)
+// capacityはkSweepMinCapacity以上にすること
+constexpr size_t kSweepMinCapacity = 16;
+size_t SweepSpheresScalar(const ConstSphereSoA& spheres, const float* minKeys, const float* maxKeys,
+    const uint32_t* ids, size_t count, size_t end, SweepCursor& cursor, CollisionPair* pairs, size_t capacity);
+size_t SweepSpheresSSE2(const ConstSphereSoA& spheres, const float* minKeys, const float* maxKeys,
+    const uint32_t* ids, size_t count, size_t end, SweepCursor& cursor, CollisionPair* pairs, size_t capacity);
+size_t SweepSpheresAVX2(const ConstSphereSoA& spheres, const float* minKeys, const float* maxKeys,
+    const uint32_t* ids, size_t count, size_t end, SweepCursor& cursor, CollisionPair* pairs, size_t capacity);
+size_t SweepAABBsScalar(const ConstAABBSoA& aabbs, const float* minKeys, const float* maxKeys,
+    const uint32_t* ids, size_t count, size_t end, SweepCursor& cursor, CollisionPair* pairs, size_t capacity);
+size_t SweepAABBsSSE2(const ConstAABBSoA& aabbs, const float* minKeys, const float* maxKeys,
+    const uint32_t* ids, size_t count, size_t end, SweepCursor& cursor, CollisionPair* pairs, size_t capacity);
+size_t SweepAABBsAVX2(const ConstAABBSoA& aabbs, const float* minKeys, const float* maxKeys,
+    const uint32_t* ids, size_t count, size_t end, SweepCursor& cursor, CollisionPair* pairs, size_t capacity);
+
+// 姿勢の圧縮・展開(blockCount * kCompressedTransformBlockSize個)
+void EncodeTransformsScalar(const ConstVector3SoA& scale, const ConstQuaternionSoA& rotate,
+    const ConstVector3SoA& translate, const TransformQuantization& quantization, CompressedTransformBlock* blocks,
+    size_t blockCount);
+void EncodeTransformsSSE2(const ConstVector3SoA& scale, const ConstQuaternionSoA& rotate,
+    const ConstVector3SoA& translate, const TransformQuantization& quantization, CompressedTransformBlock* blocks,
+    size_t blockCount);
+void EncodeTransformsAVX2(const ConstVector3SoA& scale, const ConstQuaternionSoA& rotate,
+    const ConstVector3SoA& translate, const TransformQuantization& quantization, CompressedTransformBlock* blocks,
+    size_t blockCount);
+void DecodeTransformsScalar(const CompressedTransformBlock* blocks, size_t blockCount,
+    const TransformQuantization& quantization, Matrix4x4* result);
+void DecodeTransformsSSE2(const CompressedTransformBlock* blocks, size_t blockCount,
+    const TransformQuantization& quantization, Matrix4x4* result);
+void DecodeTransformsAVX2(const CompressedTransformBlock* blocks, size_t blockCount,
+    const TransformQuantization& quantization, Matrix4x4* result);
+
+// スキニング(normals.xがnullptrなら法線は変換しない)
+void SkinVerticesScalar(const Matrix4x4* palette, const SkinInfluence* influences, const ConstVector3SoA& positions,
+    const ConstVector3SoA& normals, const Vector3SoA& skinnedPositions, const Vector3SoA& skinnedNormals, size_t count);
+void SkinVerticesSSE2(const Matrix4x4* palette, const SkinInfluence* influences, const ConstVector3SoA& positions,
+    const ConstVector3SoA& normals, const Vector3SoA& skinnedPositions, const Vector3SoA& skinnedNormals, size_t count);
+void SkinVerticesAVX2(const Matrix4x4* palette, const SkinInfluence* influences, const ConstVector3SoA& positions,
+    const ConstVector3SoA& normals, const Vector3SoA& skinnedPositions, const Vector3SoA& skinnedNormals, size_t count);
@@ -0,0 +1,1815 @@
+#pragma once
+
+// レーン型でパラメータ化した一括演算カーネル本体
+// MathKernel*.cppから各命令セットのレーン型で実体化する
+
+#include <cfloat>
+#include <iterator>
+#include <limits>
+#include <numbers>
+#include <type_traits>
+#include "MathKernel.h"
+#include "MathSimd.h"
+
+namespace {
+
+// 行列Lane::kWidth個をSoAに並べ替える a[line * 4 + column]のレーンjがm[j].m[line][column]
+template<class Lane>
+void LoadMatrices(const Matrix4x4* m, Lane a[16]) {
+	alignas(64) float buffer[16][Lane::kWidth];
+	for (size_t j = 0; j < Lane::kWidth; j++) {
+		for (int k = 0; k < 16; k++) {
+			buffer[k][j] = m[j].m[k / 4][k % 4];
+		}
+	}
+	for (int k = 0; k < 16; k++) {
+		a[k] = Lane::Load(buffer[k]);
+	}
+}
+
+template<class Lane>
+void StoreMatrices(const Lane a[16], Matrix4x4* m) {
+	alignas(64) float buffer[16][Lane::kWidth];
+	for (int k = 0; k < 16; k++) {
+		a[k].Store(buffer[k]);
+	}
+	for (size_t j = 0; j < Lane::kWidth; j++) {
+		for (int k = 0; k < 16; k++) {
+			m[j].m[k / 4][k % 4] = buffer[k][j];
+		}
+	}
+}
+
+#if MT4_SIMD_SSE2
+// 4行列なら行ごとの4x4転置で済む
+template<>
+inline void LoadMatrices<SimdFloat4>(const Matrix4x4* m, SimdFloat4 a[16]) {
+	for (int line = 0; line < 4; line++) {
+		__m128 r0 = _mm_loadu_ps(m[0].m[line]);
+		__m128 r1 = _mm_loadu_ps(m[1].m[line]);
+		__m128 r2 = _mm_loadu_ps(m[2].m[line]);
+		__m128 r3 = _mm_loadu_ps(m[3].m[line]);
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		a[line * 4 + 0].v = r0;
+		a[line * 4 + 1].v = r1;
+		a[line * 4 + 2].v = r2;
+		a[line * 4 + 3].v = r3;
+	}
+}
+
+template<>
+inline void StoreMatrices<SimdFloat4>(const SimdFloat4 a[16], Matrix4x4* m) {
+	for (int line = 0; line < 4; line++) {
+		__m128 r0 = a[line * 4 + 0].v;
+		__m128 r1 = a[line * 4 + 1].v;
+		__m128 r2 = a[line * 4 + 2].v;
+		__m128 r3 = a[line * 4 + 3].v;
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		_mm_storeu_ps(m[0].m[line], r0);
+		_mm_storeu_ps(m[1].m[line], r1);
+		_mm_storeu_ps(m[2].m[line], r2);
+		_mm_storeu_ps(m[3].m[line], r3);
+	}
+}
+#endif
+
+#if MT4_SIMD_AVX2
+// 8行列は前半4つと後半4つに分けて転置する
+template<>
+inline void StoreMatrices<SimdFloat8>(const SimdFloat8 a[16], Matrix4x4* m) {
+	for (int line = 0; line < 4; line++) {
+		const SimdFloat8* row = a + line * 4;
+		__m128 r0 = _mm256_castps256_ps128(row[0].v), r1 = _mm256_castps256_ps128(row[1].v);
+		__m128 r2 = _mm256_castps256_ps128(row[2].v), r3 = _mm256_castps256_ps128(row[3].v);
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		_mm_storeu_ps(m[0].m[line], r0);
+		_mm_storeu_ps(m[1].m[line], r1);
+		_mm_storeu_ps(m[2].m[line], r2);
+		_mm_storeu_ps(m[3].m[line], r3);
+		r0 = _mm256_extractf128_ps(row[0].v, 1);
+		r1 = _mm256_extractf128_ps(row[1].v, 1);
+		r2 = _mm256_extractf128_ps(row[2].v, 1);
+		r3 = _mm256_extractf128_ps(row[3].v, 1);
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		_mm_storeu_ps(m[4].m[line], r0);
+		_mm_storeu_ps(m[5].m[line], r1);
+		_mm_storeu_ps(m[6].m[line], r2);
+		_mm_storeu_ps(m[7].m[line], r3);
+	}
+}
+#endif
+
+// 逆行列(SoA)
+// 2x2小行列式12個から余因子を求める。正則なレーンは全ビットが立ったマスクを返す
+template<class Lane>
+Lane InverseLanes(const Lane a[16], Lane b[16]) {
+	const Lane s0 = a[0] * a[5] - a[1] * a[4];
+	const Lane s1 = a[0] * a[6] - a[2] * a[4];
+	const Lane s2 = a[0] * a[7] - a[3] * a[4];
+	const Lane s3 = a[1] * a[6] - a[2] * a[5];
+	const Lane s4 = a[1] * a[7] - a[3] * a[5];
+	const Lane s5 = a[2] * a[7] - a[3] * a[6];
+	const Lane c5 = a[10] * a[15] - a[11] * a[14];
+	const Lane c4 = a[9] * a[15] - a[11] * a[13];
+	const Lane c3 = a[9] * a[14] - a[10] * a[13];
+	const Lane c2 = a[8] * a[15] - a[11] * a[12];
+	const Lane c1 = a[8] * a[14] - a[10] * a[12];
+	const Lane c0 = a[8] * a[13] - a[9] * a[12];
+
+	const Lane det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+	const Lane invDet = Lane::Broadcast(1.0f) / det;
+
+	b[0] = (a[5] * c5 - a[6] * c4 + a[7] * c3) * invDet;
+	b[1] = (a[2] * c4 - a[1] * c5 - a[3] * c3) * invDet;
+	b[2] = (a[13] * s5 - a[14] * s4 + a[15] * s3) * invDet;
+	b[3] = (a[10] * s4 - a[9] * s5 - a[11] * s3) * invDet;
+	b[4] = (a[6] * c2 - a[4] * c5 - a[7] * c1) * invDet;
+	b[5] = (a[0] * c5 - a[2] * c2 + a[3] * c1) * invDet;
+	b[6] = (a[14] * s2 - a[12] * s5 - a[15] * s1) * invDet;
+	b[7] = (a[8] * s5 - a[10] * s2 + a[11] * s1) * invDet;
+	b[8] = (a[4] * c4 - a[5] * c2 + a[7] * c0) * invDet;
+	b[9] = (a[1] * c2 - a[0] * c4 - a[3] * c0) * invDet;
+	b[10] = (a[12] * s4 - a[13] * s2 + a[15] * s0) * invDet;
+	b[11] = (a[9] * s2 - a[8] * s4 - a[11] * s0) * invDet;
+	b[12] = (a[5] * c1 - a[4] * c3 - a[6] * c0) * invDet;
+	b[13] = (a[0] * c3 - a[1] * c1 + a[2] * c0) * invDet;
+	b[14] = (a[13] * s1 - a[12] * s3 - a[14] * s0) * invDet;
+	b[15] = (a[8] * s3 - a[9] * s1 + a[10] * s0) * invDet;
+
+	// 1/detが有限(NaNでもない)なら正則とみなす
+	return CompareLessEqual(Abs(invDet), Lane::Broadcast(FLT_MAX));
+}
+
+// 逆行列(一括) 本体をLaneで、端数をスカラーで処理する
+template<class Lane>
+bool InverseMatrices(const Matrix4x4* m, Matrix4x4* result, size_t count, bool* succeeded) {
+	bool all = true;
+	size_t i = 0;
+	for (; i + Lane::kWidth <= count; i += Lane::kWidth) {
+		Lane a[16];
+		Lane b[16];
+		LoadMatrices(m + i, a);
+		const int mask = MoveMask(InverseLanes(a, b));
+		StoreMatrices(b, result + i);
+		all = all && mask == (1 << Lane::kWidth) - 1;
+		if (succeeded) {
+			for (size_t j = 0; j < Lane::kWidth; j++) {
+				succeeded[i + j] = ((mask >> j) & 1) != 0;
+			}
+		}
+	}
+	for (; i < count; i++) {
+		SimdFloat1 a[16];
+		SimdFloat1 b[16];
+		LoadMatrices(m + i, a);
+		const bool ok = MoveMask(InverseLanes(a, b)) != 0;
+		StoreMatrices(b, result + i);
+		all = all && ok;
+		if (succeeded) {
+			succeeded[i] = ok;
+		}
+	}
+	return all;
+}
+
+#if MT4_SIMD_SSE2
+// 逆行列(1行列をSSEで計算)
+// 2x2ブロックに分けて M^-1 = 1/|M| * [X# Y#; Z# W#] の随伴行列を求める
+inline __m128 Matrix2Multiply(__m128 a, __m128 b) {
+	return _mm_add_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 3, 0))),
+	    _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+}
+// a# * b
+inline __m128 Matrix2AdjointMultiply(__m128 a, __m128 b) {
+	return _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 3, 3)), b),
+	    _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 1, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2))));
+}
+// a * b#
+inline __m128 Matrix2MultiplyAdjoint(__m128 a, __m128 b) {
+	return _mm_sub_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 3, 0, 3))),
+	    _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+}
+
+inline bool InverseMatrix4(const Matrix4x4& m, Matrix4x4& result) {
+	const __m128 row0 = _mm_loadu_ps(m.m[0]);
+	const __m128 row1 = _mm_loadu_ps(m.m[1]);
+	const __m128 row2 = _mm_loadu_ps(m.m[2]);
+	const __m128 row3 = _mm_loadu_ps(m.m[3]);
+
+	// 2x2小行列
+	const __m128 a = _mm_movelh_ps(row0, row1);
+	const __m128 b = _mm_movehl_ps(row1, row0);
+	const __m128 c = _mm_movelh_ps(row2, row3);
+	const __m128 d = _mm_movehl_ps(row3, row2);
+
+	// (|A|, |B|, |C|, |D|)
+	const __m128 detSub = _mm_sub_ps(
+	    _mm_mul_ps(_mm_shuffle_ps(row0, row2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(row1, row3, _MM_SHUFFLE(3, 1, 3, 1))),
+	    _mm_mul_ps(_mm_shuffle_ps(row0, row2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(row1, row3, _MM_SHUFFLE(2, 0, 2, 0))));
+	const __m128 detA = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(0, 0, 0, 0));
+	const __m128 detB = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(1, 1, 1, 1));
+	const __m128 detC = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(2, 2, 2, 2));
+	const __m128 detD = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(3, 3, 3, 3));
+
+	const __m128 dc = Matrix2AdjointMultiply(d, c);
+	const __m128 ab = Matrix2AdjointMultiply(a, b);
+	__m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), Matrix2Multiply(b, dc));
+	__m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), Matrix2Multiply(c, ab));
+	__m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), Matrix2MultiplyAdjoint(d, ab));
+	__m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), Matrix2MultiplyAdjoint(a, dc));
+
+	// |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+	__m128 trace = _mm_mul_ps(ab, _mm_shuffle_ps(dc, dc, _MM_SHUFFLE(3, 1, 2, 0)));
+	trace = _mm_add_ps(trace, _mm_shuffle_ps(trace, trace, _MM_SHUFFLE(2, 3, 0, 1)));
+	trace = _mm_add_ps(trace, _mm_shuffle_ps(trace, trace, _MM_SHUFFLE(1, 0, 3, 2)));
+	const __m128 det = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), trace);
+
+	const __m128 invDet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det);
+	x = _mm_mul_ps(x, invDet);
+	y = _mm_mul_ps(y, invDet);
+	z = _mm_mul_ps(z, invDet);
+	w = _mm_mul_ps(w, invDet);
+
+	// 随伴の並べ替えと格納をまとめて行う
+	_mm_storeu_ps(result.m[0], _mm_shuffle_ps(x, y, _MM_SHUFFLE(1, 3, 1, 3)));
+	_mm_storeu_ps(result.m[1], _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 2, 0, 2)));
+	_mm_storeu_ps(result.m[2], _mm_shuffle_ps(z, w, _MM_SHUFFLE(1, 3, 1, 3)));
+	_mm_storeu_ps(result.m[3], _mm_shuffle_ps(z, w, _MM_SHUFFLE(0, 2, 0, 2)));
+
+	const float inverse = _mm_cvtss_f32(invDet);
+	return fabsf(inverse) <= FLT_MAX;
+}
+#endif
+
+// 点(x, y, z, 1)と行列のcolumn列目の内積
+template<class Lane>
+struct MatrixColumnLanes {
+	Lane m0, m1, m2, m3;
+
+	MatrixColumnLanes(const Matrix4x4& matrix, int column)
+	    : m0(Lane::Broadcast(matrix.m[0][column])), m1(Lane::Broadcast(matrix.m[1][column])),
+	      m2(Lane::Broadcast(matrix.m[2][column])), m3(Lane::Broadcast(matrix.m[3][column])) {}
+	Lane Dot(Lane x, Lane y, Lane z) const { return MulAdd(x, m0, MulAdd(y, m1, MulAdd(z, m2, m3))); }
+};
+
+// 座標変換(SoA) [begin, end)
+template<class Lane, bool kAffine>
+void TransformPointsRange(
+    const ConstVector3SoA& input, const Vector3SoA& output, size_t begin, size_t end, const Matrix4x4& matrix) {
+	const Lane m00 = Lane::Broadcast(matrix.m[0][0]), m01 = Lane::Broadcast(matrix.m[0][1]), m02 = Lane::Broadcast(matrix.m[0][2]);
+	const Lane m10 = Lane::Broadcast(matrix.m[1][0]), m11 = Lane::Broadcast(matrix.m[1][1]), m12 = Lane::Broadcast(matrix.m[1][2]);
+	const Lane m20 = Lane::Broadcast(matrix.m[2][0]), m21 = Lane::Broadcast(matrix.m[2][1]), m22 = Lane::Broadcast(matrix.m[2][2]);
+	const Lane m30 = Lane::Broadcast(matrix.m[3][0]), m31 = Lane::Broadcast(matrix.m[3][1]), m32 = Lane::Broadcast(matrix.m[3][2]);
+
+	for (size_t i = begin; i < end; i += Lane::kWidth) {
+		const Lane x = Lane::Load(input.x + i);
+		const Lane y = Lane::Load(input.y + i);
+		const Lane z = Lane::Load(input.z + i);
+		Lane rx = MulAdd(x, m00, MulAdd(y, m10, MulAdd(z, m20, m30)));
+		Lane ry = MulAdd(x, m01, MulAdd(y, m11, MulAdd(z, m21, m31)));
+		Lane rz = MulAdd(x, m02, MulAdd(y, m12, MulAdd(z, m22, m32)));
+		if constexpr (!kAffine) {
+			const Lane w = MulAdd(x, Lane::Broadcast(matrix.m[0][3]),
+			    MulAdd(y, Lane::Broadcast(matrix.m[1][3]),
+			        MulAdd(z, Lane::Broadcast(matrix.m[2][3]), Lane::Broadcast(matrix.m[3][3]))));
+			const Lane invW = Lane::Broadcast(1.0f) / w;
+			rx = rx * invW;
+			ry = ry * invW;
+			rz = rz * invW;
+		}
+		rx.Store(output.x + i);
+		ry.Store(output.y + i);
+		rz.Store(output.z + i);
+	}
+}
+
+// 本体をLaneで処理し、端数をスカラーで処理する
+template<class Lane>
+void TransformPoints(
+    const ConstVector3SoA& input, const Vector3SoA& output, size_t count, const Matrix4x4& matrix, bool affine) {
+	const size_t body = count - count % Lane::kWidth;
+	if (affine) {
+		TransformPointsRange<Lane, true>(input, output, 0, body, matrix);
+		TransformPointsRange<SimdFloat1, true>(input, output, body, count, matrix);
+	} else {
+		TransformPointsRange<Lane, false>(input, output, 0, body, matrix);
+		TransformPointsRange<SimdFloat1, false>(input, output, body, count, matrix);
+	}
+}
+
+// 座標変換(AoS) [begin, end)
+// Lane::kWidth個ずつレジスタ内でSoAに並べ替えて計算し、AoSに戻して書き込む(inputとoutputは同じでもよい)
+template<class Lane, bool kAffine>
+void TransformPointsAoSRange(const Vector3* input, Vector3* output, size_t begin, size_t end, const Matrix4x4& matrix) {
+	const MatrixColumnLanes<Lane> columnX(matrix, 0), columnY(matrix, 1), columnZ(matrix, 2), columnW(matrix, 3);
+	for (size_t i = begin; i < end; i += Lane::kWidth) {
+		Lane x, y, z;
+		LoadInterleaved(input + i, x, y, z);
+		Lane rx = columnX.Dot(x, y, z);
+		Lane ry = columnY.Dot(x, y, z);
+		Lane rz = columnZ.Dot(x, y, z);
+		if constexpr (!kAffine) {
+			const Lane invW = Lane::Broadcast(1.0f) / columnW.Dot(x, y, z);
+			rx = rx * invW;
+			ry = ry * invW;
+			rz = rz * invW;
+		}
+		StoreInterleaved(rx, ry, rz, output + i);
+	}
+}
+
+// 本体をLaneで処理し、端数をスカラーで処理する
+template<class Lane>
+void TransformPointsAoS(const Vector3* input, Vector3* output, size_t count, const Matrix4x4& matrix, bool affine) {
+	const size_t body = count - count % Lane::kWidth;
+	if (affine) {
+		TransformPointsAoSRange<Lane, true>(input, output, 0, body, matrix);
+		TransformPointsAoSRange<SimdFloat1, true>(input, output, body, count, matrix);
+	} else {
+		TransformPointsAoSRange<Lane, false>(input, output, 0, body, matrix);
+		TransformPointsAoSRange<SimdFloat1, false>(input, output, body, count, matrix);
+	}
+}
+
+// 法線の変換(SoA) [begin, end) 結果は正規化する(長さ0なら0のまま)
+template<class Lane>
+void TransformNormalsRange(
+    const ConstVector3SoA& input, const Vector3SoA& output, size_t begin, size_t end, const Matrix3x3& matrix) {
+	const Lane m00 = Lane::Broadcast(matrix.m[0][0]), m01 = Lane::Broadcast(matrix.m[0][1]), m02 = Lane::Broadcast(matrix.m[0][2]);
+	const Lane m10 = Lane::Broadcast(matrix.m[1][0]), m11 = Lane::Broadcast(matrix.m[1][1]), m12 = Lane::Broadcast(matrix.m[1][2]);
+	const Lane m20 = Lane::Broadcast(matrix.m[2][0]), m21 = Lane::Broadcast(matrix.m[2][1]), m22 = Lane::Broadcast(matrix.m[2][2]);
+	const Lane minLengthSquared = Lane::Broadcast(FLT_MIN);
+
+	for (size_t i = begin; i < end; i += Lane::kWidth) {
+		const Lane x = Lane::Load(input.x + i);
+		const Lane y = Lane::Load(input.y + i);
+		const Lane z = Lane::Load(input.z + i);
+		const Lane rx = MulAdd(x, m00, MulAdd(y, m10, z * m20));
+		const Lane ry = MulAdd(x, m01, MulAdd(y, m11, z * m21));
+		const Lane rz = MulAdd(x, m02, MulAdd(y, m12, z * m22));
+		const Lane inverseLength = ReciprocalSqrt(Max(MulAdd(rx, rx, MulAdd(ry, ry, rz * rz)), minLengthSquared));
+		(rx * inverseLength).Store(output.x + i);
+		(ry * inverseLength).Store(output.y + i);
+		(rz * inverseLength).Store(output.z + i);
+	}
+}
+
+// 本体をLaneで処理し、端数をスカラーで処理する
+template<class Lane>
+void TransformNormals(const ConstVector3SoA& input, const Vector3SoA& output, size_t count, const Matrix3x3& matrix) {
+	const size_t body = count - count % Lane::kWidth;
+	TransformNormalsRange<Lane>(input, output, 0, body, matrix);
+	TransformNormalsRange<SimdFloat1>(input, output, body, count, matrix);
+}
+
+// sinとcos(レーンごと)
+// 象限の判定も浮動小数点演算だけで行う
+template<class Lane, SinCosPrecision kPrecision>
+void SinCosLanes(Lane x, Lane& sin, Lane& cos) {
+	using Polynomial = SinCosPolynomial<kPrecision>;
+	const Lane bias = Lane::Broadcast(kSinCosRoundingBias);
+	const Lane one = Lane::Broadcast(1.0f);
+	const Lane oneAndHalf = Lane::Broadcast(1.5f);
+
+	// x = n * π/2 + r
+	const Lane n = MulAdd(x, Lane::Broadcast(kSinCosTwoOverPi), bias) - bias;
+	Lane r = x;
+	for (float halfPi : Polynomial::kHalfPi) {
+		r = MulAdd(n, Lane::Broadcast(-halfPi), r);
+	}
+	const Lane r2 = r * r;
+
+	const size_t sinCount = std::size(Polynomial::kSin);
+	Lane s = Lane::Broadcast(Polynomial::kSin[sinCount - 1]);
+	for (size_t k = sinCount - 1; k-- > 0;) {
+		s = MulAdd(s, r2, Lane::Broadcast(Polynomial::kSin[k]));
+	}
+	s = MulAdd(r * r2, s, r);
+	const size_t cosCount = std::size(Polynomial::kCos);
+	Lane c = Lane::Broadcast(Polynomial::kCos[cosCount - 1]);
+	for (size_t k = cosCount - 1; k-- > 0;) {
+		c = MulAdd(c, r2, Lane::Broadcast(Polynomial::kCos[k]));
+	}
+	c = MulAdd(r2, c, one);
+
+	// q = n mod 4 (floor(n / 4) = round(n / 4 - 0.375))
+	const Lane quotient = (MulAdd(n, Lane::Broadcast(0.25f), Lane::Broadcast(-0.375f)) + bias) - bias;
+	const Lane q = MulAdd(quotient, Lane::Broadcast(-4.0f), n);
+	// qが奇数ならsinとcosを入れ替え、sinはq >= 2、cosはq == 1, 2で符号を反転する
+	const Lane distance = Abs(q - Lane::Broadcast(2.0f));
+	const Lane swap = And(CompareLess(Lane::Broadcast(0.5f), distance), CompareLess(distance, oneAndHalf));
+	const Lane sinNegative = CompareLess(oneAndHalf, q);
+	const Lane cosNegative = CompareLess(Abs(q - oneAndHalf), one);
+	const Lane sinValue = Select(swap, c, s);
+	const Lane cosValue = Select(swap, s, c);
+	const Lane zero = Lane::Broadcast(0.0f);
+	sin = Select(sinNegative, zero - sinValue, sinValue);
+	cos = Select(cosNegative, zero - cosValue, cosValue);
+}
+
+// sinとcos(一括) [begin, end)
+template<class Lane, SinCosPrecision kPrecision>
+void SinCosRange(const float* radians, float* sin, float* cos, size_t begin, size_t end) {
+	for (size_t i = begin; i < end; i += Lane::kWidth) {
+		Lane s, c;
+		SinCosLanes<Lane, kPrecision>(Lane::Load(radians + i), s, c);
+		s.Store(sin + i);
+		c.Store(cos + i);
+	}
+}
+
+// 本体をLaneで処理し、端数をスカラーで処理する
+template<class Lane>
+void SinCosBatch(const float* radians, float* sin, float* cos, size_t count, SinCosPrecision precision) {
+	const size_t body = count - count % Lane::kWidth;
+	if (precision == SinCosPrecision::kFast) {
+		SinCosRange<Lane, SinCosPrecision::kFast>(radians, sin, cos, 0, body);
+		SinCosRange<SimdFloat1, SinCosPrecision::kFast>(radians, sin, cos, body, count);
+	}
+	else {
+		SinCosRange<Lane, SinCosPrecision::kPrecise>(radians, sin, cos, 0, body);
+		SinCosRange<SimdFloat1, SinCosPrecision::kPrecise>(radians, sin, cos, body, count);
+	}
+}
+
+// 4成分をまとめたレーン
+template<class Lane>
+struct QuaternionLanes {
+	Lane x, y, z, w;
+
+	static QuaternionLanes Load(const ConstQuaternionSoA& q, size_t i) {
+		return { Lane::Load(q.x + i), Lane::Load(q.y + i), Lane::Load(q.z + i), Lane::Load(q.w + i) };
+	}
+	void Store(const QuaternionSoA& q, size_t i) const {
+		x.Store(q.x + i);
+		y.Store(q.y + i);
+		z.Store(q.z + i);
+		w.Store(q.w + i);
+	}
+};
+
+template<class Lane>
+Lane Dot(const QuaternionLanes<Lane>& a, const QuaternionLanes<Lane>& b) {
+	return MulAdd(a.x, b.x, MulAdd(a.y, b.y, MulAdd(a.z, b.z, a.w * b.w)));
+}
+
+// weight0 * q0 + weight1 * q1 を正規化する
+template<class Lane>
+QuaternionLanes<Lane> BlendQuaternions(
+    const QuaternionLanes<Lane>& q0, const QuaternionLanes<Lane>& q1, Lane weight0, Lane weight1) {
+	QuaternionLanes<Lane> blended{
+		MulAdd(q0.x, weight0, q1.x * weight1),
+		MulAdd(q0.y, weight0, q1.y * weight1),
+		MulAdd(q0.z, weight0, q1.z * weight1),
+		MulAdd(q0.w, weight0, q1.w * weight1),
+	};
+	const Lane inverseLength = Lane::Broadcast(1.0f) / Sqrt(Dot(blended, blended));
+	blended.x = blended.x * inverseLength;
+	blended.y = blended.y * inverseLength;
+	blended.z = blended.z * inverseLength;
+	blended.w = blended.w * inverseLength;
+	return blended;
+}
+
+// weight0 * q0 + weight1 * q1 を正規化して書き込む
+template<class Lane>
+void StoreBlendedQuaternions(const QuaternionLanes<Lane>& q0, const QuaternionLanes<Lane>& q1,
+    Lane weight0, Lane weight1, const QuaternionSoA& result, size_t i) {
+	BlendQuaternions(q0, q1, weight0, weight1).Store(result, i);
+}
+
+// 正規化線形補間 [begin, end)
+// 内積が負なら最短経路になるようq1の符号を反転する
+template<class Lane>
+void NlerpQuaternionsRange(const ConstQuaternionSoA& q0, const ConstQuaternionSoA& q1, const float* t,
+    const QuaternionSoA& result, size_t begin, size_t end) {
+	const Lane zero = Lane::Broadcast(0.0f);
+	const Lane one = Lane::Broadcast(1.0f);
+	for (size_t i = begin; i < end; i += Lane::kWidth) {
+		const QuaternionLanes<Lane> a = QuaternionLanes<Lane>::Load(q0, i);
+		const QuaternionLanes<Lane> b = QuaternionLanes<Lane>::Load(q1, i);
+		const Lane weight = Lane::Load(t + i);
+		const Lane negative = CompareLess(Dot(a, b), zero);
+		StoreBlendedQuaternions(a, b, one - weight, Select(negative, zero - weight, weight), result, i);
+	}
+}
+
+// acos(x) (0 <= x <= 1) 多項式近似(最大誤差2e-8)
+// acos(x) = sqrt(1 - x) * (a0 + a1 x + ... + a7 x^7)
+template<class Lane>
+Lane AcosLanes(Lane x) {
+	const float kAcos[] = { 1.5707963050f, -0.2145988016f, 0.0889789874f, -0.0501743046f,
+		0.0308918810f, -0.0170881256f, 0.0066700901f, -0.0012624911f };
+	Lane polynomial = Lane::Broadcast(kAcos[7]);
+	for (int k = 6; k >= 0; k--) {
+		polynomial = MulAdd(polynomial, x, Lane::Broadcast(kAcos[k]));
+	}
+	return Sqrt(Lane::Broadcast(1.0f) - x) * polynomial;
+}
+
+// 球面線形補間 [begin, end)
+// acosはAcosLanes、sinはSinCosLanes(kPrecise)で求める
+// ほぼ同じ向き(内積 > kSlerpLinearThreshold)は正規化線形補間にする
+template<class Lane>
+void SlerpQuaternionsRange(const ConstQuaternionSoA& q0, const ConstQuaternionSoA& q1, const float* t,
+    const QuaternionSoA& result, size_t begin, size_t end) {
+	const float kSlerpLinearThreshold = 0.9995f;
+	const Lane zero = Lane::Broadcast(0.0f);
+	const Lane one = Lane::Broadcast(1.0f);
+	for (size_t i = begin; i < end; i += Lane::kWidth) {
+		const QuaternionLanes<Lane> a = QuaternionLanes<Lane>::Load(q0, i);
+		const QuaternionLanes<Lane> b = QuaternionLanes<Lane>::Load(q1, i);
+		const Lane weight = Lane::Load(t + i);
+		const Lane dot = Dot(a, b);
+		const Lane negative = CompareLess(dot, zero);
+		const Lane cosAngle = Min(Abs(dot), one);
+		const Lane angle = AcosLanes(cosAngle);
+
+		Lane sinAngle, sin0, sin1, cos;
+		SinCosLanes<Lane, SinCosPrecision::kPrecise>(angle, sinAngle, cos);
+		SinCosLanes<Lane, SinCosPrecision::kPrecise>((one - weight) * angle, sin0, cos);
+		SinCosLanes<Lane, SinCosPrecision::kPrecise>(weight * angle, sin1, cos);
+		const Lane inverseSin = one / sinAngle;
+		const Lane linear = CompareLess(Lane::Broadcast(kSlerpLinearThreshold), cosAngle);
+		const Lane weight0 = Select(linear, one - weight, sin0 * inverseSin);
+		const Lane weight1 = Select(linear, weight, sin1 * inverseSin);
+		StoreBlendedQuaternions(a, b, weight0, Select(negative, zero - weight1, weight1), result, i);
+	}
+}
+
+// 本体をLaneで処理し、端数をスカラーで処理する
+template<class Lane>
+void NlerpQuaternions(const ConstQuaternionSoA& q0, const ConstQuaternionSoA& q1, const float* t,
+    const QuaternionSoA& result, size_t count) {
+	const size_t body = count - count % Lane::kWidth;
+	NlerpQuaternionsRange<Lane>(q0, q1, t, result, 0, body);
+	NlerpQuaternionsRange<SimdFloat1>(q0, q1, t, result, body, count);
+}
+
+template<class Lane>
+void SlerpQuaternions(const ConstQuaternionSoA& q0, const ConstQuaternionSoA& q1, const float* t,
+    const QuaternionSoA& result, size_t count) {
+	const size_t body = count - count % Lane::kWidth;
+	SlerpQuaternionsRange<Lane>(q0, q1, t, result, 0, body);
+	SlerpQuaternionsRange<SimdFloat1>(q0, q1, t, result, body, count);
+}
+
+// 線形補間 [begin, end)
+template<class Lane>
+void LerpVectorsRange(const ConstVector3SoA& v1, const ConstVector3SoA& v2, const float* t,
+    const Vector3SoA& result, size_t begin, size_t end) {
+	for (size_t i = begin; i < end; i += Lane::kWidth) {
+		const Lane weight = Lane::Load(t + i);
+		const Lane x = Lane::Load(v1.x + i);
+		const Lane y = Lane::Load(v1.y + i);
+		const Lane z = Lane::Load(v1.z + i);
+		MulAdd(Lane::Load(v2.x + i) - x, weight, x).Store(result.x + i);
+		MulAdd(Lane::Load(v2.y + i) - y, weight, y).Store(result.y + i);
+		MulAdd(Lane::Load(v2.z + i) - z, weight, z).Store(result.z + i);
+	}
+}
+
+// ベクトルの球面線形補間 [begin, end)
+// 向きを球面線形補間し、長さを線形補間する(スカラー版のSlerpと同じ場合分けをレーンごとに選ぶ)
+// 垂直な成分が残らないほど逆向きのときはv1に垂直な軸の周りにt * πだけ回し、長さ0のベクトルは線形補間する
+template<class Lane>
+void SlerpVectorsRange(const ConstVector3SoA& v1, const ConstVector3SoA& v2, const float* t,
+    const Vector3SoA& result, size_t begin, size_t end) {
+	const float kSlerpLinearThreshold = 0.9995f;
+	const float kSlerpDegenerateTangent = 1e-12f;
+	const Lane zero = Lane::Broadcast(0.0f);
+	const Lane one = Lane::Broadcast(1.0f);
+	const Lane pi = Lane::Broadcast(std::numbers::pi_v<float>);
+	const Lane threshold = Lane::Broadcast(kSlerpLinearThreshold);
+	for (size_t i = begin; i < end; i += Lane::kWidth) {
+		const Lane x1 = Lane::Load(v1.x + i), y1 = Lane::Load(v1.y + i), z1 = Lane::Load(v1.z + i);
+		const Lane x2 = Lane::Load(v2.x + i), y2 = Lane::Load(v2.y + i), z2 = Lane::Load(v2.z + i);
+		const Lane weight = Lane::Load(t + i);
+		const Lane length1 = Sqrt(MulAdd(x1, x1, MulAdd(y1, y1, z1 * z1)));
+		const Lane length2 = Sqrt(MulAdd(x2, x2, MulAdd(y2, y2, z2 * z2)));
+		const Lane inverse1 = one / length1;
+		const Lane inverse2 = one / length2;
+		const Lane ex1 = x1 * inverse1, ey1 = y1 * inverse1, ez1 = z1 * inverse1;
+		const Lane ex2 = x2 * inverse2, ey2 = y2 * inverse2, ez2 = z2 * inverse2;
+		const Lane cosAngle = Max(Min(MulAdd(ex1, ex2, MulAdd(ey1, ey2, ez1 * ez2)), one), zero - one);
+
+		// e2のe1に垂直な成分
+		// 垂直な成分がほぼ0で回転する平面が決まらないときは代わりにX軸 × e1(e1がX軸に近ければY軸 × e1)を使い、πだけ回す
+		// (ほぼ同じ向きのときは下で正規化線形補間を選ぶので、ここでは逆向きだけが残る)
+		const Lane rx = ex2 - cosAngle * ex1, ry = ey2 - cosAngle * ey1, rz = ez2 - cosAngle * ez1;
+		const Lane opposite = CompareLess(MulAdd(rx, rx, MulAdd(ry, ry, rz * rz)), Lane::Broadcast(kSlerpDegenerateTangent));
+		const Lane nearX = CompareLess(MulAdd(ey1, ey1, ez1 * ez1), Lane::Broadcast(1e-6f));
+		const Lane tx = Select(opposite, Select(nearX, ez1, zero), rx);
+		const Lane ty = Select(opposite, Select(nearX, zero, zero - ez1), ry);
+		const Lane tz = Select(opposite, Select(nearX, zero - ex1, ey1), rz);
+
+		// 角度 |cos| > 0.7ではacos(|cos|)の誤差が大きくなるので、スカラー版と同じくsinから求める(asin(x) = π/2 - acos(x))
+		// acos(-x) = π - acos(x)
+		const Lane tangentLength = Sqrt(MulAdd(tx, tx, MulAdd(ty, ty, tz * tz)));
+		const Lane absCos = Abs(cosAngle);
+		const Lane useSin = CompareLess(Lane::Broadcast(0.7f), absCos);
+		const Lane acute = AcosLanes(Select(useSin, Min(tangentLength, one), absCos));
+		const Lane absAngle = Select(useSin, Lane::Broadcast(std::numbers::pi_v<float> * 0.5f) - acute, acute);
+		const Lane angle = Select(opposite, pi, Select(CompareLess(cosAngle, zero), pi - absAngle, absAngle));
+		Lane sin, cos;
+		SinCosLanes<Lane, SinCosPrecision::kPrecise>(weight * angle, sin, cos);
+		const Lane tangentWeight = sin / tangentLength;
+		Lane dx = MulAdd(ex1, cos, tx * tangentWeight);
+		Lane dy = MulAdd(ey1, cos, ty * tangentWeight);
+		Lane dz = MulAdd(ez1, cos, tz * tangentWeight);
+
+		// ほぼ同じ向きは正規化線形補間
+		const Lane linear = CompareLess(threshold, cosAngle);
+		dx = Select(linear, MulAdd(ex2 - ex1, weight, ex1), dx);
+		dy = Select(linear, MulAdd(ey2 - ey1, weight, ey1), dy);
+		dz = Select(linear, MulAdd(ez2 - ez1, weight, ez1), dz);
+
+		// 正規化してから長さを掛ける
+		const Lane length = MulAdd(weight, length2 - length1, length1);
+		const Lane scale = length / Sqrt(MulAdd(dx, dx, MulAdd(dy, dy, dz * dz)));
+		const Lane degenerate = Or(CompareLessEqual(length1, zero), CompareLessEqual(length2, zero));
+		Select(degenerate, MulAdd(x2 - x1, weight, x1), dx * scale).Store(result.x + i);
+		Select(degenerate, MulAdd(y2 - y1, weight, y1), dy * scale).Store(result.y + i);
+		Select(degenerate, MulAdd(z2 - z1, weight, z1), dz * scale).Store(result.z + i);
+	}
+}
+
+template<class Lane>
+void SlerpVectors(const ConstVector3SoA& v1, const ConstVector3SoA& v2, const float* t,
+    const Vector3SoA& result, size_t count) {
+	const size_t body = count - count % Lane::kWidth;
+	SlerpVectorsRange<Lane>(v1, v2, t, result, 0, body);
+	SlerpVectorsRange<SimdFloat1>(v1, v2, t, result, body, count);
+}
+
+// 最短角度補間 [begin, end)
+// 差から2πの倍数(丸めはkSinCosRoundingBiasを加えて引く)を引いて[-π, π]に収めてから補間する
+template<class Lane>
+void LerpShortAnglesRange(const float* a, const float* b, const float* t, float* result, size_t begin, size_t end) {
+	const Lane bias = Lane::Broadcast(kSinCosRoundingBias);
+	const Lane inverseTwoPi = Lane::Broadcast(0.5f * std::numbers::inv_pi_v<float>);
+	const Lane minusTwoPi = Lane::Broadcast(-2.0f * std::numbers::pi_v<float>);
+	for (size_t i = begin; i < end; i += Lane::kWidth) {
+		const Lane from = Lane::Load(a + i);
+		const Lane difference = Lane::Load(b + i) - from;
+		const Lane turns = MulAdd(difference, inverseTwoPi, bias) - bias;
+		const Lane shortest = MulAdd(turns, minusTwoPi, difference);
+		MulAdd(shortest, Lane::Load(t + i), from).Store(result + i);
+	}
+}
+
+// 本体をLaneで処理し、端数をスカラーで処理する
+template<class Lane>
+void LerpVectors(const ConstVector3SoA& v1, const ConstVector3SoA& v2, const float* t,
+    const Vector3SoA& result, size_t count) {
+	const size_t body = count - count % Lane::kWidth;
+	LerpVectorsRange<Lane>(v1, v2, t, result, 0, body);
+	LerpVectorsRange<SimdFloat1>(v1, v2, t, result, body, count);
+}
+
+template<class Lane>
+void LerpShortAngles(const float* a, const float* b, const float* t, float* result, size_t count) {
+	const size_t body = count - count % Lane::kWidth;
+	LerpShortAnglesRange<Lane>(a, b, t, result, 0, body);
+	LerpShortAnglesRange<SimdFloat1>(a, b, t, result, body, count);
+}
+
+// precisionに合わせてkPrecisionを定数にした関数を呼ぶ function(std::integral_constant<ReciprocalPrecision, kPrecision>)
+// 近似命令のないSimdFloat1は常にkExactにする
+template<class Lane, class Function>
+void DispatchReciprocalPrecision(ReciprocalPrecision precision, Function function) {
+	if (Lane::kWidth == 1) {
+		function(std::integral_constant<ReciprocalPrecision, ReciprocalPrecision::kExact>{});
+	}
+	else if (precision == ReciprocalPrecision::kFast) {
+		function(std::integral_constant<ReciprocalPrecision, ReciprocalPrecision::kFast>{});
+	}
+	else if (precision == ReciprocalPrecision::kPrecise) {
+		function(std::integral_constant<ReciprocalPrecision, ReciprocalPrecision::kPrecise>{});
+	}
+	else {
+		function(std::integral_constant<ReciprocalPrecision, ReciprocalPrecision::kExact>{});
+	}
+}
+
+// 近似命令で扱えない値を含むか
+// 0(長さ0)は範囲内として扱い、(0, FLT_MIN)の非正規化数とmaxValueより大きい値(無限大を含む)を範囲外とする
+template<class Lane>
+bool HasOutOfRangeReciprocalInput(Lane value, float maxValue) {
+	const Lane subnormal = And(CompareLess(Lane::Broadcast(0.0f), value), CompareLess(value, Lane::Broadcast(FLT_MIN)));
+	return MoveMask(Or(subnormal, CompareLess(Lane::Broadcast(maxValue), value))) != 0;
+}
+
+// 1 / sqrt(a)と1 / a(近似版) aは正規化数 0なら無限大になるので呼び出し側で除く
+template<ReciprocalPrecision kPrecision, class Lane>
+Lane ReciprocalSqrtLanes(Lane a) {
+	if constexpr (kPrecision == ReciprocalPrecision::kFast) {
+		return ReciprocalSqrtEstimate(a);
+	}
+	else {
+		return ReciprocalSqrt(a);
+	}
+}
+
+template<ReciprocalPrecision kPrecision, class Lane>
+Lane ReciprocalLanes(Lane a) {
+	if constexpr (kPrecision == ReciprocalPrecision::kFast) {
+		return ReciprocalEstimate(a);
+	}
+	else {
+		return Reciprocal(a);
+	}
+}
+
+// rcpの結果が非正規化数になって0に丸められない入力の上限(2^126)
+constexpr float kMaxReciprocalInput = 8.50705917e37f;
+
+// 長さの2乗 [begin, end)
+template<class Lane>
+void LengthsSquaredRange(const ConstVector3SoA& v, float* result, size_t begin, size_t end) {
+	for (size_t i = begin; i < end; i += Lane::kWidth) {
+		const Lane x = Lane::Load(v.x + i);
+		const Lane y = Lane::Load(v.y + i);
+		const Lane z = Lane::Load(v.z + i);
+		MulAdd(x, x, MulAdd(y, y, z * z)).Store(result + i);
+	}
+}
+
+// 長さ [begin, end) 近似版はlength = a * (1 / sqrt(a))
+template<class Lane, ReciprocalPrecision kPrecision>
+void LengthsRange(const ConstVector3SoA& v, float* result, size_t begin, size_t end) {
+	const Lane zero = Lane::Broadcast(0.0f);
+	for (size_t i = begin; i < end; i += Lane::kWidth) {
+		const Lane x = Lane::Load(v.x + i);
+		const Lane y = Lane::Load(v.y + i);
+		const Lane z = Lane::Load(v.z + i);
+		const Lane lengthSquared = MulAdd(x, x, MulAdd(y, y, z * z));
+		if constexpr (kPrecision != ReciprocalPrecision::kExact) {
+			if (!HasOutOfRangeReciprocalInput(lengthSquared, FLT_MAX)) {
+				const Lane inverseLength = ReciprocalSqrtLanes<kPrecision>(lengthSquared);
+				Select(CompareLess(zero, lengthSquared), lengthSquared * inverseLength, zero).Store(result + i);
+				continue;
+			}
+		}
+		Sqrt(lengthSquared).Store(result + i);
+	}
+}
+
+// 正規化 [begin, end) 長さ(の2乗)が0のベクトルは0ベクトルにする
+// 近似版は逆平方根を0にして掛ける(成分が0でなくても長さの2乗が0に丸められれば0ベクトルになる)
+template<class Lane, ReciprocalPrecision kPrecision>
+void NormalizeVectorsRange(const ConstVector3SoA& input, const Vector3SoA& output, size_t begin, size_t end) {
+	const Lane zero = Lane::Broadcast(0.0f);
+	for (size_t i = begin; i < end; i += Lane::kWidth) {
+		const Lane x = Lane::Load(input.x + i);
+		const Lane y = Lane::Load(input.y + i);
+		const Lane z = Lane::Load(input.z + i);
+		const Lane lengthSquared = MulAdd(x, x, MulAdd(y, y, z * z));
+		if constexpr (kPrecision != ReciprocalPrecision::kExact) {
+			if (!HasOutOfRangeReciprocalInput(lengthSquared, FLT_MAX)) {
+				const Lane inverseLength =
+				    Select(CompareLess(zero, lengthSquared), ReciprocalSqrtLanes<kPrecision>(lengthSquared), zero);
+				(x * inverseLength).Store(output.x + i);
+				(y * inverseLength).Store(output.y + i);
+				(z * inverseLength).Store(output.z + i);
+				continue;
+			}
+		}
+		const Lane length = Sqrt(lengthSquared);
+		const Lane nonZero = CompareLess(zero, length);
+		Select(nonZero, x / length, zero).Store(output.x + i);
+		Select(nonZero, y / length, zero).Store(output.y + i);
+		Select(nonZero, z / length, zero).Store(output.z + i);
+	}
+}
+
+// 正射影 [begin, end) v2の長さ(の2乗)が0なら0ベクトルにする
+template<class Lane, ReciprocalPrecision kPrecision>
+void ProjectVectorsRange(const ConstVector3SoA& v1, const ConstVector3SoA& v2, const Vector3SoA& result,
+    size_t begin, size_t end) {
+	const Lane zero = Lane::Broadcast(0.0f);
+	for (size_t i = begin; i < end; i += Lane::kWidth) {
+		const Lane x = Lane::Load(v2.x + i);
+		const Lane y = Lane::Load(v2.y + i);
+		const Lane z = Lane::Load(v2.z + i);
+		const Lane dot = MulAdd(Lane::Load(v1.x + i), x, MulAdd(Lane::Load(v1.y + i), y, Lane::Load(v1.z + i) * z));
+		const Lane lengthSquared = MulAdd(x, x, MulAdd(y, y, z * z));
+		Lane scale;
+		if (kPrecision != ReciprocalPrecision::kExact && !HasOutOfRangeReciprocalInput(lengthSquared, kMaxReciprocalInput)) {
+			scale = dot * ReciprocalLanes<kPrecision>(lengthSquared);
+		}
+		else {
+			scale = dot / lengthSquared;
+		}
+		scale = Select(CompareLess(zero, lengthSquared), scale, zero);
+		(x * scale).Store(result.x + i);
+		(y * scale).Store(result.y + i);
+		(z * scale).Store(result.z + i);
+	}
+}
+
+// 本体をLaneで処理し、端数をスカラー(近似命令がないのでkExact)で処理する
+template<class Lane>
+void LengthsSquared(const ConstVector3SoA& v, float* result, size_t count) {
+	const size_t body = count - count % Lane::kWidth;
+	LengthsSquaredRange<Lane>(v, result, 0, body);
+	LengthsSquaredRange<SimdFloat1>(v, result, body, count);
+}
+
+template<class Lane>
+void Lengths(const ConstVector3SoA& v, float* result, size_t count, ReciprocalPrecision precision) {
+	const size_t body = count - count % Lane::kWidth;
+	DispatchReciprocalPrecision<Lane>(precision, [&](auto kPrecision) {
+		LengthsRange<Lane, kPrecision>(v, result, 0, body);
+	});
+	LengthsRange<SimdFloat1, ReciprocalPrecision::kExact>(v, result, body, count);
+}
+
+template<class Lane>
+void NormalizeVectors(const ConstVector3SoA& input, const Vector3SoA& output, size_t count, ReciprocalPrecision precision) {
+	const size_t body = count - count % Lane::kWidth;
+	DispatchReciprocalPrecision<Lane>(precision, [&](auto kPrecision) {
+		NormalizeVectorsRange<Lane, kPrecision>(input, output, 0, body);
+	});
+	NormalizeVectorsRange<SimdFloat1, ReciprocalPrecision::kExact>(input, output, body, count);
+}
+
+template<class Lane>
+void ProjectVectors(const ConstVector3SoA& v1, const ConstVector3SoA& v2, const Vector3SoA& result, size_t count,
+    ReciprocalPrecision precision) {
+	const size_t body = count - count % Lane::kWidth;
+	DispatchReciprocalPrecision<Lane>(precision, [&](auto kPrecision) {
+		ProjectVectorsRange<Lane, kPrecision>(v1, v2, result, 0, body);
+	});
+	ProjectVectorsRange<SimdFloat1, ReciprocalPrecision::kExact>(v1, v2, result, body, count);
+}
+
+// 視錐台の平面をレーンに展開したもの
+template<class Lane>
+struct FrustumLanes {
+	Lane x[kFrustumPlaneCount], y[kFrustumPlaneCount], z[kFrustumPlaneCount], distance[kFrustumPlaneCount];
+
+	explicit FrustumLanes(const Frustum& frustum) {
+		for (size_t p = 0; p < kFrustumPlaneCount; p++) {
+			x[p] = Lane::Broadcast(frustum.planes[p].normal.x);
+			y[p] = Lane::Broadcast(frustum.planes[p].normal.y);
+			z[p] = Lane::Broadcast(frustum.planes[p].normal.z);
+			distance[p] = Lane::Broadcast(frustum.planes[p].distance);
+		}
+	}
+};
+
+// 球 平面pの内側にある点の、平面からの距離の最大値(負なら外側)
+template<class Lane>
+struct SphereLanes {
+	Lane x, y, z, radius;
+
+	static SphereLanes Load(const ConstSphereSoA& spheres, size_t i) {
+		return { Lane::Load(spheres.x + i), Lane::Load(spheres.y + i), Lane::Load(spheres.z + i),
+			Lane::Load(spheres.radius + i) };
+	}
+	static SphereLanes Broadcast(const ConstSphereSoA& spheres, size_t i) {
+		return { Lane::Broadcast(spheres.x[i]), Lane::Broadcast(spheres.y[i]), Lane::Broadcast(spheres.z[i]),
+			Lane::Broadcast(spheres.radius[i]) };
+	}
+	Lane GetMaxDistance(const FrustumLanes<Lane>& frustum, size_t p) const {
+		return MulAdd(frustum.x[p], x, MulAdd(frustum.y[p], y, MulAdd(frustum.z[p], z, radius - frustum.distance[p])));
+	}
+};
+
+// AABB 中心と半分の大きさにして、法線の向きで最も内側の頂点を選ぶ
+template<class Lane>
+struct AABBLanes {
+	Lane centerX, centerY, centerZ, extentX, extentY, extentZ;
+
+	static AABBLanes Load(const ConstAABBSoA& aabbs, size_t i) {
+		const Lane half = Lane::Broadcast(0.5f);
+		const Lane minX = Lane::Load(aabbs.minX + i), maxX = Lane::Load(aabbs.maxX + i);
+		const Lane minY = Lane::Load(aabbs.minY + i), maxY = Lane::Load(aabbs.maxY + i);
+		const Lane minZ = Lane::Load(aabbs.minZ + i), maxZ = Lane::Load(aabbs.maxZ + i);
+		return { (minX + maxX) * half, (minY + maxY) * half, (minZ + maxZ) * half,
+			(maxX - minX) * half, (maxY - minY) * half, (maxZ - minZ) * half };
+	}
+	Lane GetMaxDistance(const FrustumLanes<Lane>& frustum, size_t p) const {
+		const Lane extent = MulAdd(Abs(frustum.x[p]), extentX,
+		    MulAdd(Abs(frustum.y[p]), extentY, Abs(frustum.z[p]) * extentZ));
+		return MulAdd(frustum.x[p], centerX,
+		    MulAdd(frustum.y[p], centerY, MulAdd(frustum.z[p], centerZ, extent - frustum.distance[p])));
+	}
+};
+
+// 視錐台カリング [begin, end) 見えるものの番号をvisibleIndicesに詰め、その数を返す
+// lastPlanesがあるとき、レーンがすべて前回同じ平面pの外側だったなら平面pだけ先に調べ、
+// 全レーンがまだ外側なら残りを省く
+template<template<class> class Bounds, class Lane, class SoA>
+size_t CullRange(const SoA& soa, size_t begin, size_t end, const Frustum& frustum,
+    uint32_t* visibleIndices, uint8_t* lastPlanes) {
+	const FrustumLanes<Lane> planes(frustum);
+	const Lane zero = Lane::Broadcast(0.0f);
+	const int allLanes = (1 << Lane::kWidth) - 1;
+	size_t visibleCount = 0;
+	for (size_t i = begin; i < end; i += Lane::kWidth) {
+		const Bounds<Lane> bounds = Bounds<Lane>::Load(soa, i);
+		if (lastPlanes) {
+			const uint8_t plane = lastPlanes[i];
+			bool samePlane = plane < kFrustumPlaneCount;
+			for (size_t k = 1; k < Lane::kWidth; k++) {
+				samePlane = samePlane && lastPlanes[i + k] == plane;
+			}
+			if (samePlane && MoveMask(CompareLess(bounds.GetMaxDistance(planes, plane), zero)) == allLanes) {
+				continue;
+			}
+		}
+
+		Lane minDistance = bounds.GetMaxDistance(planes, 0);
+		if (lastPlanes) {
+			// 外側と判定した最初の平面を記録する
+			Lane firstPlane = Lane::Broadcast(float(kFrustumVisible));
+			Lane distances[kFrustumPlaneCount];
+			distances[0] = minDistance;
+			for (size_t p = 1; p < kFrustumPlaneCount; p++) {
+				distances[p] = bounds.GetMaxDistance(planes, p);
+				minDistance = Min(minDistance, distances[p]);
+			}
+			for (size_t p = kFrustumPlaneCount; p-- > 0;) {
+				firstPlane = Select(CompareLess(distances[p], zero), Lane::Broadcast(float(p)), firstPlane);
+			}
+			float firstPlanes[Lane::kWidth];
+			firstPlane.Store(firstPlanes);
+			for (size_t k = 0; k < Lane::kWidth; k++) {
+				lastPlanes[i + k] = static_cast<uint8_t>(firstPlanes[k]);
+			}
+		}
+		else {
+			for (size_t p = 1; p < kFrustumPlaneCount; p++) {
+				// 1レーンなら外側と分かった時点で打ち切る
+				if (Lane::kWidth == 1 && MoveMask(CompareLess(minDistance, zero)) != 0) {
+					break;
+				}
+				minDistance = Min(minDistance, bounds.GetMaxDistance(planes, p));
+			}
+		}
+
+		// 分岐せずに詰める
+		const int visible = MoveMask(CompareLessEqual(zero, minDistance));
+		for (size_t k = 0; k < Lane::kWidth; k++) {
+			visibleIndices[visibleCount] = static_cast<uint32_t>(i + k);
+			visibleCount += (visible >> k) & 1;
+		}
+	}
+	return visibleCount;
+}
+
+// 本体をLaneで処理し、端数をスカラーで処理する
+template<template<class> class Bounds, class Lane, class SoA>
+size_t Cull(const Frustum& frustum, const SoA& soa, size_t count, uint32_t* visibleIndices, uint8_t* lastPlanes) {
+	const size_t body = count - count % Lane::kWidth;
+	const size_t visibleCount = CullRange<Bounds, Lane>(soa, 0, body, frustum, visibleIndices, lastPlanes);
+	return visibleCount +
+	       CullRange<Bounds, SimdFloat1>(soa, body, count, frustum, visibleIndices + visibleCount, lastPlanes);
+}
+
+// 頂点変換 [begin, end)
+// クリップ面のビットはfloatのビット列としてレーンに持ち、そのままScreenVertex::clipFlagsに書き込む
+template<class Lane>
+void ProjectPointsRange(const ConstVector3SoA& input, ScreenVertex* output, size_t begin, size_t end,
+    const Matrix4x4& clipMatrix, const Matrix4x4& screenMatrix) {
+	const MatrixColumnLanes<Lane> clipX(clipMatrix, 0), clipY(clipMatrix, 1), clipZ(clipMatrix, 2);
+	const MatrixColumnLanes<Lane> screenX(screenMatrix, 0), screenY(screenMatrix, 1), screenZ(screenMatrix, 2);
+	const MatrixColumnLanes<Lane> clipW(clipMatrix, 3); // ビューポート変換でwは変わらない
+	const Lane zero = Lane::Broadcast(0.0f);
+	const Lane one = Lane::Broadcast(1.0f);
+	const Lane leftBit = Lane::Broadcast(BitCast<float>(kClipLeft));
+	const Lane rightBit = Lane::Broadcast(BitCast<float>(kClipRight));
+	const Lane bottomBit = Lane::Broadcast(BitCast<float>(kClipBottom));
+	const Lane topBit = Lane::Broadcast(BitCast<float>(kClipTop));
+	const Lane nearBit = Lane::Broadcast(BitCast<float>(kClipNear));
+	const Lane farBit = Lane::Broadcast(BitCast<float>(kClipFar));
+
+	for (size_t i = begin; i < end; i += Lane::kWidth) {
+		const Lane x = Lane::Load(input.x + i);
+		const Lane y = Lane::Load(input.y + i);
+		const Lane z = Lane::Load(input.z + i);
+		const Lane cx = clipX.Dot(x, y, z), cy = clipY.Dot(x, y, z), cz = clipZ.Dot(x, y, z);
+		const Lane w = clipW.Dot(x, y, z);
+		const Lane negativeW = zero - w;
+		const Lane behindNear = CompareLess(cz, zero);
+		const Lane flags = Or(Or(Or(And(CompareLess(cx, negativeW), leftBit), And(CompareLess(w, cx), rightBit)),
+		    Or(And(CompareLess(cy, negativeW), bottomBit), And(CompareLess(w, cy), topBit))),
+		    Or(And(behindNear, nearBit), And(CompareLess(w, cz), farBit)));
+
+		// 近クリップ面の手前はwが0以下になりうるので除算の結果を使わない
+		const Lane inverseW = Select(behindNear, zero, one / Select(behindNear, one, w));
+		StoreInterleaved(screenX.Dot(x, y, z) * inverseW, screenY.Dot(x, y, z) * inverseW,
+		    screenZ.Dot(x, y, z) * inverseW, flags, output + i);
+	}
+}
+
+// 本体をLaneで処理し、端数をスカラーで処理する
+template<class Lane>
+void ProjectPoints(const ConstVector3SoA& input, ScreenVertex* output, size_t count,
+    const Matrix4x4& clipMatrix, const Matrix4x4& screenMatrix) {
+	const size_t body = count - count % Lane::kWidth;
+	ProjectPointsRange<Lane>(input, output, 0, body, clipMatrix, screenMatrix);
+	ProjectPointsRange<SimdFloat1>(input, output, body, count, clipMatrix, screenMatrix);
+}
+
+// レイの束(レーンごとに1本) AABBとの判定用に向きの逆数と、始点 * 逆数を持つ
+template<class Lane>
+struct RayLanes {
+	Lane originX, originY, originZ, diffX, diffY, diffZ;
+	Lane inverseX, inverseY, inverseZ, scaledX, scaledY, scaledZ;
+
+	static RayLanes Load(const ConstRaySoA& rays, size_t i) {
+		const Lane one = Lane::Broadcast(1.0f);
+		RayLanes ray;
+		ray.originX = Lane::Load(rays.originX + i);
+		ray.originY = Lane::Load(rays.originY + i);
+		ray.originZ = Lane::Load(rays.originZ + i);
+		ray.diffX = Lane::Load(rays.diffX + i);
+		ray.diffY = Lane::Load(rays.diffY + i);
+		ray.diffZ = Lane::Load(rays.diffZ + i);
+		ray.inverseX = one / ray.diffX;
+		ray.inverseY = one / ray.diffY;
+		ray.inverseZ = one / ray.diffZ;
+		ray.scaledX = ray.originX * ray.inverseX;
+		ray.scaledY = ray.originY * ray.inverseY;
+		ray.scaledZ = ray.originZ * ray.inverseZ;
+		return ray;
+	}
+};
+
+// AABBとの交差(スラブ法) 0 <= t <= tMaxの範囲で重なるレーンのマスク
+template<class Lane>
+Lane IntersectAABBLanes(const RayLanes<Lane>& ray, const AABB& bounds, Lane tMax) {
+	const Lane x0 = MulAdd(Lane::Broadcast(bounds.min.x), ray.inverseX, Lane::Broadcast(0.0f) - ray.scaledX);
+	const Lane x1 = MulAdd(Lane::Broadcast(bounds.max.x), ray.inverseX, Lane::Broadcast(0.0f) - ray.scaledX);
+	const Lane y0 = MulAdd(Lane::Broadcast(bounds.min.y), ray.inverseY, Lane::Broadcast(0.0f) - ray.scaledY);
+	const Lane y1 = MulAdd(Lane::Broadcast(bounds.max.y), ray.inverseY, Lane::Broadcast(0.0f) - ray.scaledY);
+	const Lane z0 = MulAdd(Lane::Broadcast(bounds.min.z), ray.inverseZ, Lane::Broadcast(0.0f) - ray.scaledZ);
+	const Lane z1 = MulAdd(Lane::Broadcast(bounds.max.z), ray.inverseZ, Lane::Broadcast(0.0f) - ray.scaledZ);
+	const Lane tNear = Max(Max(Min(x0, x1), Min(y0, y1)), Max(Min(z0, z1), Lane::Broadcast(0.0f)));
+	const Lane tFar = Min(Min(Max(x0, x1), Max(y0, y1)), Min(Max(z0, z1), tMax));
+	return CompareLessEqual(tNear, tFar);
+}
+
+// 三角形との交差(Moller-Trumbore、両面) 当たるレーンのマスクを返し、tに交点を書き込む
+// 平行なとき(det = 0)は重心座標が無限大かNaNになり、どの比較も通らない
+template<class Lane>
+Lane IntersectTriangleLanes(const RayLanes<Lane>& ray, const BVHPrimitive& triangle, Lane& t) {
+	const Lane zero = Lane::Broadcast(0.0f);
+	const Lane e1x = Lane::Broadcast(triangle.b.x), e1y = Lane::Broadcast(triangle.b.y), e1z = Lane::Broadcast(triangle.b.z);
+	const Lane e2x = Lane::Broadcast(triangle.c.x), e2y = Lane::Broadcast(triangle.c.y), e2z = Lane::Broadcast(triangle.c.z);
+	const Lane px = ray.diffY * e2z - ray.diffZ * e2y;
+	const Lane py = ray.diffZ * e2x - ray.diffX * e2z;
+	const Lane pz = ray.diffX * e2y - ray.diffY * e2x;
+	const Lane inverseDet = Lane::Broadcast(1.0f) / MulAdd(e1x, px, MulAdd(e1y, py, e1z * pz));
+	const Lane sx = ray.originX - Lane::Broadcast(triangle.a.x);
+	const Lane sy = ray.originY - Lane::Broadcast(triangle.a.y);
+	const Lane sz = ray.originZ - Lane::Broadcast(triangle.a.z);
+	const Lane u = MulAdd(sx, px, MulAdd(sy, py, sz * pz)) * inverseDet;
+	const Lane qx = sy * e1z - sz * e1y;
+	const Lane qy = sz * e1x - sx * e1z;
+	const Lane qz = sx * e1y - sy * e1x;
+	const Lane v = MulAdd(ray.diffX, qx, MulAdd(ray.diffY, qy, ray.diffZ * qz)) * inverseDet;
+	t = MulAdd(e2x, qx, MulAdd(e2y, qy, e2z * qz)) * inverseDet;
+	return And(And(CompareLessEqual(zero, u), CompareLessEqual(zero, v)),
+	    And(CompareLessEqual(u + v, Lane::Broadcast(1.0f)), CompareLessEqual(zero, t)));
+}
+
+// 球との交差(中身の詰まった球) 始点が内側ならt = 0
+// 判別式はb^2 - acではなく、中心からレイ(直線)までの距離の2乗lを使ってa(r^2 - l)で求める
+// (中心が遠いとb^2とacがほぼ同じ大きさになり、引き算で桁が落ちるため)
+template<class Lane>
+Lane IntersectSphereLanes(const RayLanes<Lane>& ray, const BVHPrimitive& sphere, Lane& t) {
+	const Lane zero = Lane::Broadcast(0.0f);
+	const Lane ox = ray.originX - Lane::Broadcast(sphere.a.x);
+	const Lane oy = ray.originY - Lane::Broadcast(sphere.a.y);
+	const Lane oz = ray.originZ - Lane::Broadcast(sphere.a.z);
+	const Lane radius = Lane::Broadcast(sphere.b.x);
+	const Lane a = MulAdd(ray.diffX, ray.diffX, MulAdd(ray.diffY, ray.diffY, ray.diffZ * ray.diffZ));
+	const Lane b = MulAdd(ox, ray.diffX, MulAdd(oy, ray.diffY, oz * ray.diffZ));
+	const Lane inverseA = Lane::Broadcast(1.0f) / a;
+	const Lane scale = b * inverseA;
+	const Lane lx = ox - scale * ray.diffX, ly = oy - scale * ray.diffY, lz = oz - scale * ray.diffZ;
+	const Lane discriminant = a * (radius * radius - MulAdd(lx, lx, MulAdd(ly, ly, lz * lz)));
+	const Lane root = Sqrt(Max(discriminant, zero));
+	t = Max((zero - b - root) * inverseA, zero);
+	return And(CompareLessEqual(zero, discriminant), CompareLessEqual(zero, (root - b) * inverseA));
+}
+
+// 線分との交差 レイと線分の最近接点の距離がc.x以下なら、レイ上の最近接点で当たりとする
+// レイのパラメータsを求めてから線分のパラメータuを求め、uを[0, 1]に収めたときはsを求め直す
+template<class Lane>
+Lane IntersectSegmentLanes(const RayLanes<Lane>& ray, const BVHPrimitive& segment, Lane& t) {
+	const Lane zero = Lane::Broadcast(0.0f);
+	const Lane one = Lane::Broadcast(1.0f);
+	const Lane ex = Lane::Broadcast(segment.b.x), ey = Lane::Broadcast(segment.b.y), ez = Lane::Broadcast(segment.b.z);
+	const Lane wx = ray.originX - Lane::Broadcast(segment.a.x);
+	const Lane wy = ray.originY - Lane::Broadcast(segment.a.y);
+	const Lane wz = ray.originZ - Lane::Broadcast(segment.a.z);
+	const Lane a = MulAdd(ray.diffX, ray.diffX, MulAdd(ray.diffY, ray.diffY, ray.diffZ * ray.diffZ));
+	const Lane b = MulAdd(ray.diffX, ex, MulAdd(ray.diffY, ey, ray.diffZ * ez));
+	const Lane c = Lane::Broadcast(segment.b.x * segment.b.x + segment.b.y * segment.b.y + segment.b.z * segment.b.z);
+	const Lane d = MulAdd(ray.diffX, wx, MulAdd(ray.diffY, wy, ray.diffZ * wz));
+	const Lane e = MulAdd(ex, wx, MulAdd(ey, wy, ez * wz));
+	const Lane denominator = a * c - b * b;
+	// 平行(または線分の長さが0)ならs = 0から始める
+	const Lane parallel = CompareLessEqual(denominator, a * c * Lane::Broadcast(1e-6f));
+	Lane s = Select(parallel, zero, Max((b * e - c * d) / denominator, zero));
+	const Lane u = Select(CompareLessEqual(c, zero), zero, MulAdd(b, s, e) / c);
+	const Lane before = CompareLess(u, zero);
+	const Lane after = CompareLess(one, u);
+	const Lane inverseA = one / a;
+	s = Select(before, Max(zero - d * inverseA, zero), Select(after, Max((b - d) * inverseA, zero), s));
+	const Lane clamped = Min(Max(u, zero), one);
+	const Lane dx = MulAdd(ray.diffX, s, wx) - ex * clamped;
+	const Lane dy = MulAdd(ray.diffY, s, wy) - ey * clamped;
+	const Lane dz = MulAdd(ray.diffZ, s, wz) - ez * clamped;
+	const Lane radius = Lane::Broadcast(segment.c.x);
+	t = s;
+	return CompareLessEqual(MulAdd(dx, dx, MulAdd(dy, dy, dz * dz)), radius * radius);
+}
+
+// 交点がないときの距離(定数式にして、numeric_limitsの関数をこの翻訳単位で実体化しない)
+constexpr float kInfinity = std::numeric_limits<float>::infinity();
+
+// BVHのレイ判定 [begin, end)
+// Lane::kWidth本のレイを束にして、どれかのレイが重なるノードをたどる
+// 内部ノードは束の最初のレイの向きで近い側の子から調べ、各レイの最も近い交点で遠いノードを省く
+template<class Lane>
+void RaycastBVHRange(const BVHNode* nodes, const BVHPrimitive* primitives, const ConstRaySoA& rays,
+    const float* maxT, RayHit* hits, size_t begin, size_t end) {
+	const Lane noHit = Lane::Broadcast(BitCast<float>(kBVHNoHit));
+	for (size_t i = begin; i < end; i += Lane::kWidth) {
+		const RayLanes<Lane> ray = RayLanes<Lane>::Load(rays, i);
+		Lane tBest = maxT ? Lane::Load(maxT + i) : Lane::Broadcast(kInfinity);
+		Lane idBest = noHit; // 図形のidをfloatのビット列として持つ
+		const bool negative[3] = { rays.diffX[i] < 0.0f, rays.diffY[i] < 0.0f, rays.diffZ[i] < 0.0f };
+
+		uint32_t stack[kBVHStackSize];
+		size_t stackSize = 0;
+		stack[stackSize++] = 0;
+		while (stackSize > 0) {
+			const uint32_t nodeIndex = stack[--stackSize];
+			const BVHNode& node = nodes[nodeIndex];
+			if (MoveMask(IntersectAABBLanes(ray, node.bounds, tBest)) == 0) {
+				continue;
+			}
+			if (node.count == 0) {
+				// 近い側の子を後に積んで先に取り出す
+				const uint32_t left = nodeIndex + 1;
+				const uint32_t right = node.index;
+				stack[stackSize++] = negative[node.axis] ? left : right;
+				stack[stackSize++] = negative[node.axis] ? right : left;
+				continue;
+			}
+			for (uint32_t p = node.index; p < node.index + node.count; p++) {
+				const BVHPrimitive& primitive = primitives[p];
+				Lane t, hit;
+				switch (static_cast<BVHPrimitiveType>(primitive.id >> kBVHTypeShift)) {
+				case BVHPrimitiveType::kTriangle:
+					hit = IntersectTriangleLanes(ray, primitive, t);
+					break;
+				case BVHPrimitiveType::kSphere:
+					hit = IntersectSphereLanes(ray, primitive, t);
+					break;
+				default:
+					hit = IntersectSegmentLanes(ray, primitive, t);
+					break;
+				}
+				hit = And(hit, CompareLess(t, tBest));
+				tBest = Select(hit, t, tBest);
+				idBest = Select(hit, Lane::Broadcast(BitCast<float>(primitive.id)), idBest);
+			}
+		}
+
+		float ts[Lane::kWidth], ids[Lane::kWidth];
+		tBest.Store(ts);
+		idBest.Store(ids);
+		for (size_t k = 0; k < Lane::kWidth; k++) {
+			const uint32_t id = BitCast<uint32_t>(ids[k]);
+			RayHit& hit = hits[i + k];
+			hit.t = ts[k];
+			hit.index = id == kBVHNoHit ? kBVHNoHit : id & ((1u << kBVHTypeShift) - 1);
+			hit.type = static_cast<BVHPrimitiveType>(id == kBVHNoHit ? 0 : id >> kBVHTypeShift);
+		}
+	}
+}
+
+template<class Lane>
+void RaycastBVH(const BVHNode* nodes, const BVHPrimitive* primitives, const ConstRaySoA& rays,
+    const float* maxT, RayHit* hits, size_t count) {
+	const size_t body = count - count % Lane::kWidth;
+	RaycastBVHRange<Lane>(nodes, primitives, rays, maxT, hits, 0, body);
+	RaycastBVHRange<SimdFloat1>(nodes, primitives, rays, maxT, hits, body, count);
+}
+
+// AABB 最小・最大のまま(重なりの判定用)
+template<class Lane>
+struct AABBRangeLanes {
+	Lane minX, minY, minZ, maxX, maxY, maxZ;
+
+	static AABBRangeLanes Load(const ConstAABBSoA& aabbs, size_t i) {
+		return { Lane::Load(aabbs.minX + i), Lane::Load(aabbs.minY + i), Lane::Load(aabbs.minZ + i),
+			Lane::Load(aabbs.maxX + i), Lane::Load(aabbs.maxY + i), Lane::Load(aabbs.maxZ + i) };
+	}
+	static AABBRangeLanes Broadcast(const ConstAABBSoA& aabbs, size_t i) {
+		return { Lane::Broadcast(aabbs.minX[i]), Lane::Broadcast(aabbs.minY[i]), Lane::Broadcast(aabbs.minZ[i]),
+			Lane::Broadcast(aabbs.maxX[i]), Lane::Broadcast(aabbs.maxY[i]), Lane::Broadcast(aabbs.maxZ[i]) };
+	}
+};
+
+// 重なるレーンのマスク(接していても重なるとする)
+template<class Lane>
+Lane OverlapLanes(const SphereLanes<Lane>& a, const SphereLanes<Lane>& b) {
+	const Lane dx = b.x - a.x, dy = b.y - a.y, dz = b.z - a.z;
+	const Lane radius = a.radius + b.radius;
+	return CompareLessEqual(dx * dx + dy * dy + dz * dz, radius * radius);
+}
+
+template<class Lane>
+Lane OverlapLanes(const AABBRangeLanes<Lane>& a, const AABBRangeLanes<Lane>& b) {
+	return And(And(And(CompareLessEqual(a.minX, b.maxX), CompareLessEqual(b.minX, a.maxX)),
+	               And(CompareLessEqual(a.minY, b.maxY), CompareLessEqual(b.minY, a.maxY))),
+	    And(CompareLessEqual(a.minZ, b.maxZ), CompareLessEqual(b.minZ, a.maxZ)));
+}
+
+// 図形selfと[j, j + Lane::kWidth)の図形を調べ、重なる組をpairs[written]から書き込む(最大Lane::kWidth組)
+// 最後のレーンまで掃引の範囲内(次のブロックも調べる)ならtrueを返す
+template<template<class> class Shape, class Lane, class SoA>
+bool SweepBlock(const SoA& soa, const Shape<Lane>& self, Lane maxKey, const float* minKeys, const uint32_t* ids,
+    size_t i, size_t j, CollisionPair* pairs, size_t& written) {
+	const Lane inRange = CompareLessEqual(Lane::Load(minKeys + j), maxKey);
+	uint32_t overlap = static_cast<uint32_t>(MoveMask(And(inRange, OverlapLanes(self, Shape<Lane>::Load(soa, j)))));
+	while (overlap != 0) {
+		const uint32_t other = ids[j + CountTrailingZeros(overlap)];
+		overlap &= overlap - 1;
+		pairs[written++] = ids[i] < other ? CollisionPair{ ids[i], other } : CollisionPair{ other, ids[i] };
+	}
+	return (MoveMask(inRange) >> (Lane::kWidth - 1)) != 0;
+}
+
+// 掃引 [cursor.i, end)
+// 図形はminKeysの昇順に並んでいるので、図形iの後ろをminKeysがmaxKeys[i]を超えるまでまとめて調べる
+// 次のブロックの組が入りきらなくなったら、cursorにその位置を残して返る
+template<template<class> class Shape, class Lane, class SoA>
+size_t SweepRange(const SoA& soa, const float* minKeys, const float* maxKeys, const uint32_t* ids, size_t count,
+    size_t end, SweepCursor& cursor, CollisionPair* pairs, size_t capacity) {
+	size_t written = 0;
+	size_t j = cursor.j;
+	for (size_t i = cursor.i; i < end; i++, j = i + 1) {
+		const Shape<Lane> self = Shape<Lane>::Broadcast(soa, i);
+		const Lane maxKey = Lane::Broadcast(maxKeys[i]);
+		bool inRange = true;
+		for (; inRange && j + Lane::kWidth <= count; j += Lane::kWidth) {
+			if (capacity - written < Lane::kWidth) {
+				cursor = SweepCursor{ i, j };
+				return written;
+			}
+			inRange = SweepBlock<Shape, Lane>(soa, self, maxKey, minKeys, ids, i, j, pairs, written);
+		}
+		if (inRange && j < count) {
+			// 端数
+			const Shape<SimdFloat1> selfScalar = Shape<SimdFloat1>::Broadcast(soa, i);
+			const SimdFloat1 maxKeyScalar = SimdFloat1::Broadcast(maxKeys[i]);
+			for (; j < count; j++) {
+				if (written == capacity) {
+					cursor = SweepCursor{ i, j };
+					return written;
+				}
+				if (!SweepBlock<Shape, SimdFloat1>(soa, selfScalar, maxKeyScalar, minKeys, ids, i, j, pairs, written)) {
+					break;
+				}
+			}
+		}
+	}
+	cursor = SweepCursor{ end, end };
+	return written;
+}
+
+// 圧縮した姿勢(CompressedTransform.h)
+// 回転の3成分 [-1/√2, 1/√2] ↔ [0, 65535]
+constexpr float kCompressedRotationMax = 0.70710678f;
+constexpr float kCompressedRotationToInteger = 65535.0f / (2.0f * kCompressedRotationMax);
+constexpr float kCompressedRotationFromInteger = (2.0f * kCompressedRotationMax) / 65535.0f;
+// 半精度浮動小数点数の最大値 / floatで表せる2^31未満の最大の整数
+constexpr float kHalfMax = 65504.0f;
+constexpr float kInt32Max = 2147483520.0f;
+
+// ブロックを圧縮する inputのi番目からkCompressedTransformBlockSize個
+template<class Lane>
+void EncodeTransformBlock(const ConstVector3SoA& scale, const ConstQuaternionSoA& rotate,
+    const ConstVector3SoA& translate, size_t i, const TransformQuantization& quantization,
+    CompressedTransformBlock& block) {
+	const Lane zero = Lane::Broadcast(0.0f), one = Lane::Broadcast(1.0f);
+	const Lane inverseStep = Lane::Broadcast(1.0f / quantization.step);
+	const Lane origins[3] = { Lane::Broadcast(quantization.origin.x), Lane::Broadcast(quantization.origin.y),
+		Lane::Broadcast(quantization.origin.z) };
+	const float* scales[3] = { scale.x, scale.y, scale.z };
+	const float* translates[3] = { translate.x, translate.y, translate.z };
+	block.rotationIndex = 0;
+	block.reserved = 0;
+	for (size_t j = 0; j < kCompressedTransformBlockSize; j += Lane::kWidth) {
+		Lane x = Lane::Load(rotate.x + i + j), y = Lane::Load(rotate.y + i + j);
+		Lane z = Lane::Load(rotate.z + i + j), w = Lane::Load(rotate.w + i + j);
+		const Lane inverseNorm = one / Sqrt(x * x + y * y + z * z + w * w);
+		x = x * inverseNorm;
+		y = y * inverseNorm;
+		z = z * inverseNorm;
+		w = w * inverseNorm;
+
+		// 絶対値が最大の成分(同じならx, y, z, wの順で先のもの)を除く
+		const Lane largest = Max(Max(Abs(x), Abs(y)), Max(Abs(z), Abs(w)));
+		const Lane isX = CompareLessEqual(largest, Abs(x));
+		const Lane isY = CompareLessEqual(largest, Abs(y));
+		const Lane isZ = CompareLessEqual(largest, Abs(z));
+		const Lane index = Select(isX, zero, Select(isY, one, Select(isZ, Lane::Broadcast(2.0f), Lane::Broadcast(3.0f))));
+		const Lane dropped = Select(isX, x, Select(isY, y, Select(isZ, z, w)));
+		// 除いた成分が正になるように全体の符号をそろえる(qと-qは同じ回転)
+		const Lane sign = Select(CompareLess(dropped, zero), Lane::Broadcast(-1.0f), one);
+		const Lane kept[3] = {
+			Select(isX, y, x) * sign,
+			Select(Or(isX, isY), z, y) * sign,
+			Select(Or(Or(isX, isY), isZ), w, z) * sign,
+		};
+		const Lane toInteger = Lane::Broadcast(kCompressedRotationToInteger);
+		const Lane integerMax = Lane::Broadcast(65535.0f);
+		for (int k = 0; k < 3; k++) {
+			const Lane quantized = (kept[k] + Lane::Broadcast(kCompressedRotationMax)) * toInteger;
+			Min(Max(quantized, zero), integerMax).StoreUInt16(block.rotation[k] + j);
+		}
+		alignas(32) float indices[Lane::kWidth];
+		index.Store(indices);
+		for (size_t k = 0; k < Lane::kWidth; k++) {
+			block.rotationIndex |= static_cast<uint16_t>(static_cast<uint32_t>(indices[k]) << (2 * (j + k)));
+		}
+
+		const Lane halfMax = Lane::Broadcast(kHalfMax), int32Max = Lane::Broadcast(kInt32Max);
+		for (int axis = 0; axis < 3; axis++) {
+			const Lane s = Lane::Load(scales[axis] + i + j);
+			Min(Max(s, zero - halfMax), halfMax).StoreHalf(block.scale[axis] + j);
+			const Lane cell = (Lane::Load(translates[axis] + i + j) - origins[axis]) * inverseStep;
+			Min(Max(cell, zero - int32Max), int32Max).StoreInt32(block.position[axis] + j);
+		}
+	}
+}
+
+// 拡大・回転・平行移動からアフィン行列を組み立てる(MakeAffineMatrix(scale, rotate, translate)と同じ並び)
+template<class Lane>
+void ComposeAffineLanes(const Lane scale[3], const QuaternionLanes<Lane>& q, const Lane translate[3], Lane m[16]) {
+	const Lane zero = Lane::Broadcast(0.0f), one = Lane::Broadcast(1.0f), two = Lane::Broadcast(2.0f);
+	const Lane xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z, ww = q.w * q.w;
+	const Lane xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+	const Lane wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+	m[0] = (ww + xx - yy - zz) * scale[0];
+	m[1] = two * (xy + wz) * scale[0];
+	m[2] = two * (xz - wy) * scale[0];
+	m[3] = zero;
+	m[4] = two * (xy - wz) * scale[1];
+	m[5] = (ww - xx + yy - zz) * scale[1];
+	m[6] = two * (yz + wx) * scale[1];
+	m[7] = zero;
+	m[8] = two * (xz + wy) * scale[2];
+	m[9] = two * (yz - wx) * scale[2];
+	m[10] = (ww - xx - yy + zz) * scale[2];
+	m[11] = zero;
+	m[12] = translate[0];
+	m[13] = translate[1];
+	m[14] = translate[2];
+	m[15] = one;
+}
+
+// ブロックをアフィン行列kCompressedTransformBlockSize個に展開する
+template<class Lane>
+void DecodeTransformBlock(
+    const CompressedTransformBlock& block, const TransformQuantization& quantization, Matrix4x4* result) {
+	const Lane zero = Lane::Broadcast(0.0f), one = Lane::Broadcast(1.0f);
+	const Lane fromInteger = Lane::Broadcast(kCompressedRotationFromInteger);
+	const Lane rotationMin = Lane::Broadcast(-kCompressedRotationMax);
+	const Lane step = Lane::Broadcast(quantization.step);
+	const Lane origins[3] = { Lane::Broadcast(quantization.origin.x), Lane::Broadcast(quantization.origin.y),
+		Lane::Broadcast(quantization.origin.z) };
+	for (size_t j = 0; j < kCompressedTransformBlockSize; j += Lane::kWidth) {
+		const Lane a = MulAdd(Lane::LoadUInt16(block.rotation[0] + j), fromInteger, rotationMin);
+		const Lane b = MulAdd(Lane::LoadUInt16(block.rotation[1] + j), fromInteger, rotationMin);
+		const Lane c = MulAdd(Lane::LoadUInt16(block.rotation[2] + j), fromInteger, rotationMin);
+		const Lane dropped = Sqrt(Max(one - (a * a + b * b + c * c), zero));
+		alignas(32) float indices[Lane::kWidth];
+		for (size_t k = 0; k < Lane::kWidth; k++) {
+			indices[k] = static_cast<float>((block.rotationIndex >> (2 * (j + k))) & 3);
+		}
+		const Lane index = Lane::Load(indices);
+		const Lane below1 = CompareLess(index, Lane::Broadcast(0.5f));
+		const Lane below2 = CompareLess(index, Lane::Broadcast(1.5f));
+		const Lane below3 = CompareLess(index, Lane::Broadcast(2.5f));
+		const QuaternionLanes<Lane> rotate{
+			Select(below1, dropped, a),
+			Select(below1, a, Select(below2, dropped, b)),
+			Select(below2, b, Select(below3, dropped, c)),
+			Select(below3, c, dropped),
+		};
+		Lane scale[3], translate[3];
+		for (int axis = 0; axis < 3; axis++) {
+			scale[axis] = Lane::LoadHalf(block.scale[axis] + j);
+			translate[axis] = MulAdd(Lane::LoadInt32(block.position[axis] + j), step, origins[axis]);
+		}
+		Lane m[16];
+		ComposeAffineLanes(scale, rotate, translate, m);
+		StoreMatrices(m, result + j);
+	}
+}
+
+// ブロックごとに圧縮・展開する(入力・出力はblockCount * kCompressedTransformBlockSize個)
+template<class Lane>
+void EncodeTransforms(const ConstVector3SoA& scale, const ConstQuaternionSoA& rotate,
+    const ConstVector3SoA& translate, const TransformQuantization& quantization, CompressedTransformBlock* blocks,
+    size_t blockCount) {
+	for (size_t i = 0; i < blockCount; i++) {
+		EncodeTransformBlock<Lane>(scale, rotate, translate, i * kCompressedTransformBlockSize, quantization, blocks[i]);
+	}
+}
+
+template<class Lane>
+void DecodeTransforms(const CompressedTransformBlock* blocks, size_t blockCount,
+    const TransformQuantization& quantization, Matrix4x4* result) {
+	for (size_t i = 0; i < blockCount; i++) {
+		DecodeTransformBlock<Lane>(blocks[i], quantization, result + i * kCompressedTransformBlockSize);
+	}
+}
+
+// 3成分の内積
+template<class Lane>
+Lane Dot3(const Lane a[3], const Lane b[3]) {
+	return MulAdd(a[0], b[0], MulAdd(a[1], b[1], a[2] * b[2]));
+}
+
+// 回転行列(行がu[0], u[1], u[2])からクォータニオンを作る
+// MakeRotateQuaternionと同じく、トレース・対角成分の大きいものから求める成分を選ぶ
+template<class Lane>
+QuaternionLanes<Lane> MakeRotateQuaternionLanes(const Lane u[3][3]) {
+	const Lane zero = Lane::Broadcast(0.0f), one = Lane::Broadcast(1.0f);
+	const Lane m00 = u[0][0], m11 = u[1][1], m22 = u[2][2];
+	const Lane trace = m00 + m11 + m22;
+	const Lane useW = CompareLess(zero, trace);
+	const Lane useX = And(CompareLess(m11, m00), CompareLess(m22, m00));
+	const Lane useY = CompareLess(m22, m11);
+	const Lane diagonal =
+	    Select(useW, trace, Select(useX, m00 - m11 - m22, Select(useY, m11 - m00 - m22, m22 - m00 - m11)));
+	const Lane s = Sqrt(one + diagonal) * Lane::Broadcast(2.0f);
+	const Lane inverse = one / s;
+	const Lane quarter = s * Lane::Broadcast(0.25f);
+	const Lane d12 = (u[1][2] - u[2][1]) * inverse, d20 = (u[2][0] - u[0][2]) * inverse;
+	const Lane d01 = (u[0][1] - u[1][0]) * inverse;
+	const Lane s01 = (u[0][1] + u[1][0]) * inverse, s02 = (u[0][2] + u[2][0]) * inverse;
+	const Lane s12 = (u[1][2] + u[2][1]) * inverse;
+	return {
+		Select(useW, d12, Select(useX, quarter, Select(useY, s01, s02))),
+		Select(useW, d20, Select(useX, s01, Select(useY, quarter, s12))),
+		Select(useW, d01, Select(useX, s02, Select(useY, s12, quarter))),
+		Select(useW, quarter, Select(useX, d12, Select(useY, d20, d01))),
+	};
+}
+
+// アフィン行列の分解(SoA) MakeAffineMatrix(scale, rotate, translate)の逆
+// 行をGram-Schmidt法で直交化し、行列式が負ならxの拡大を負にする 拡大が0のレーンの回転は単位クォータニオン
+// 拡大が0でなく、行どうしのなす角の余弦がshearTolerance以下のレーンは全ビットが立ったマスクを返す
+template<class Lane>
+Lane DecomposeLanes(
+    const Lane a[16], float shearTolerance, Lane scale[3], QuaternionLanes<Lane>& rotate, Lane translate[3]) {
+	const Lane zero = Lane::Broadcast(0.0f), one = Lane::Broadcast(1.0f);
+	const Lane toleranceSquared = Lane::Broadcast(shearTolerance * shearTolerance);
+	const Lane rows[3][3] = { { a[0], a[1], a[2] }, { a[4], a[5], a[6] }, { a[8], a[9], a[10] } };
+	Lane u[3][3];
+	Lane nonZero = CompareLess(zero, one);
+	Lane orthogonal = nonZero;
+	for (int i = 0; i < 3; i++) {
+		// 前の軸の成分を除く(除いた量で剪断を調べる)
+		Lane r[3] = { rows[i][0], rows[i][1], rows[i][2] };
+		const Lane lengthSquared = Dot3(r, r);
+		for (int k = 0; k < i; k++) {
+			const Lane dot = Dot3(u[k], r);
+			orthogonal = And(orthogonal, CompareLessEqual(dot * dot, toleranceSquared * lengthSquared));
+			for (int axis = 0; axis < 3; axis++) {
+				r[axis] = MulAdd(zero - dot, u[k][axis], r[axis]);
+			}
+		}
+		scale[i] = Sqrt(Dot3(r, r));
+		const Lane positive = CompareLess(zero, scale[i]);
+		nonZero = And(nonZero, positive);
+		const Lane inverse = Select(positive, one / scale[i], zero);
+		for (int axis = 0; axis < 3; axis++) {
+			u[i][axis] = r[axis] * inverse;
+		}
+	}
+	// 鏡映を含むならx軸を反転して回転にする
+	const Lane cross[3] = {
+		u[0][1] * u[1][2] - u[0][2] * u[1][1],
+		u[0][2] * u[1][0] - u[0][0] * u[1][2],
+		u[0][0] * u[1][1] - u[0][1] * u[1][0],
+	};
+	const Lane mirrored = CompareLess(Dot3(cross, u[2]), zero);
+	scale[0] = Select(mirrored, zero - scale[0], scale[0]);
+	for (int axis = 0; axis < 3; axis++) {
+		u[0][axis] = Select(mirrored, zero - u[0][axis], u[0][axis]);
+	}
+	const QuaternionLanes<Lane> q = MakeRotateQuaternionLanes(u);
+	rotate = { Select(nonZero, q.x, zero), Select(nonZero, q.y, zero), Select(nonZero, q.z, zero),
+		Select(nonZero, q.w, one) };
+	translate[0] = a[12];
+	translate[1] = a[13];
+	translate[2] = a[14];
+	return And(nonZero, orthogonal);
+}
+
+// アフィン行列の分解(一括) [begin, end) すべて剪断を含まず拡大が0でなければtrue
+template<class Lane>
+bool DecomposeMatricesRange(const Matrix4x4* m, const Vector3SoA& scale, const QuaternionSoA& rotate,
+    const Vector3SoA& translate, float shearTolerance, bool* succeeded, size_t begin, size_t end) {
+	bool all = true;
+	for (size_t i = begin; i < end; i += Lane::kWidth) {
+		Lane a[16], s[3], t[3];
+		QuaternionLanes<Lane> q;
+		LoadMatrices(m + i, a);
+		const int mask = MoveMask(DecomposeLanes(a, shearTolerance, s, q, t));
+		s[0].Store(scale.x + i);
+		s[1].Store(scale.y + i);
+		s[2].Store(scale.z + i);
+		q.Store(rotate, i);
+		t[0].Store(translate.x + i);
+		t[1].Store(translate.y + i);
+		t[2].Store(translate.z + i);
+		all = all && mask == (1 << Lane::kWidth) - 1;
+		if (succeeded) {
+			for (size_t j = 0; j < Lane::kWidth; j++) {
+				succeeded[i + j] = ((mask >> j) & 1) != 0;
+			}
+		}
+	}
+	return all;
+}
+
+// 分解して補間し、組み立て直す [begin, end)
+// 拡大と平行移動は線形補間、回転は正規化線形補間(最短経路)
+// どちらかが分解できない(剪断を含むか拡大が0の)レーンは行列を要素ごとに線形補間する
+template<class Lane>
+void BlendAffineMatricesRange(const Matrix4x4* m0, const Matrix4x4* m1, const float* t, Matrix4x4* result,
+    float shearTolerance, size_t begin, size_t end) {
+	const Lane zero = Lane::Broadcast(0.0f), one = Lane::Broadcast(1.0f);
+	for (size_t i = begin; i < end; i += Lane::kWidth) {
+		Lane a[16], b[16], composed[16], scale0[3], scale1[3], translate0[3], translate1[3];
+		QuaternionLanes<Lane> rotate0, rotate1;
+		LoadMatrices(m0 + i, a);
+		LoadMatrices(m1 + i, b);
+		const Lane decomposed = And(DecomposeLanes(a, shearTolerance, scale0, rotate0, translate0),
+		    DecomposeLanes(b, shearTolerance, scale1, rotate1, translate1));
+		const Lane weight = Lane::Load(t + i);
+		Lane scale[3], translate[3];
+		for (int axis = 0; axis < 3; axis++) {
+			scale[axis] = MulAdd(scale1[axis] - scale0[axis], weight, scale0[axis]);
+			translate[axis] = MulAdd(translate1[axis] - translate0[axis], weight, translate0[axis]);
+		}
+		const Lane negative = CompareLess(Dot(rotate0, rotate1), zero);
+		const QuaternionLanes<Lane> rotate =
+		    BlendQuaternions(rotate0, rotate1, one - weight, Select(negative, zero - weight, weight));
+		ComposeAffineLanes(scale, rotate, translate, composed);
+		for (int k = 0; k < 16; k++) {
+			a[k] = Select(decomposed, composed[k], MulAdd(b[k] - a[k], weight, a[k]));
+		}
+		StoreMatrices(a, result + i);
+	}
+}
+
+// 本体をLaneで処理し、端数をスカラーで処理する
+template<class Lane>
+bool DecomposeMatrices(const Matrix4x4* m, const Vector3SoA& scale, const QuaternionSoA& rotate,
+    const Vector3SoA& translate, size_t count, float shearTolerance, bool* succeeded) {
+	const size_t body = count - count % Lane::kWidth;
+	const bool bodySucceeded =
+	    DecomposeMatricesRange<Lane>(m, scale, rotate, translate, shearTolerance, succeeded, 0, body);
+	const bool tailSucceeded =
+	    DecomposeMatricesRange<SimdFloat1>(m, scale, rotate, translate, shearTolerance, succeeded, body, count);
+	return bodySucceeded && tailSucceeded;
+}
+
+template<class Lane>
+void BlendAffineMatrices(
+    const Matrix4x4* m0, const Matrix4x4* m1, const float* t, Matrix4x4* result, size_t count, float shearTolerance) {
+	const size_t body = count - count % Lane::kWidth;
+	BlendAffineMatricesRange<Lane>(m0, m1, t, result, shearTolerance, 0, body);
+	BlendAffineMatricesRange<SimdFloat1>(m0, m1, t, result, shearTolerance, body, count);
+}
+
+// パーティクルの積分 [begin, end) 寿命が尽きた(0以下になった)数を返す
+// v = (v + dt * gravity) * damping, p = p + dt * v, lifetime = lifetime - dt
+template<class Lane>
+size_t IntegrateParticlesRange(const Vector3SoA& positions, const Vector3SoA& velocities, float* lifetimes,
+    const Vector3& gravity, float damping, float deltaTime, size_t begin, size_t end) {
+	const Lane zero = Lane::Broadcast(0.0f);
+	const Lane dt = Lane::Broadcast(deltaTime);
+	const Lane scale = Lane::Broadcast(damping);
+	const Lane gravityX = Lane::Broadcast(gravity.x * deltaTime);
+	const Lane gravityY = Lane::Broadcast(gravity.y * deltaTime);
+	const Lane gravityZ = Lane::Broadcast(gravity.z * deltaTime);
+	size_t expired = 0;
+	for (size_t i = begin; i < end; i += Lane::kWidth) {
+		const Lane vx = (Lane::Load(velocities.x + i) + gravityX) * scale;
+		const Lane vy = (Lane::Load(velocities.y + i) + gravityY) * scale;
+		const Lane vz = (Lane::Load(velocities.z + i) + gravityZ) * scale;
+		vx.Store(velocities.x + i);
+		vy.Store(velocities.y + i);
+		vz.Store(velocities.z + i);
+		MulAdd(vx, dt, Lane::Load(positions.x + i)).Store(positions.x + i);
+		MulAdd(vy, dt, Lane::Load(positions.y + i)).Store(positions.y + i);
+		MulAdd(vz, dt, Lane::Load(positions.z + i)).Store(positions.z + i);
+		const Lane lifetime = Lane::Load(lifetimes + i) - dt;
+		lifetime.Store(lifetimes + i);
+		expired += PopCount(static_cast<uint32_t>(MoveMask(CompareLessEqual(lifetime, zero))));
+	}
+	return expired;
+}
+
+// 本体をLaneで処理し、端数をスカラーで処理する
+template<class Lane>
+size_t IntegrateParticles(const Vector3SoA& positions, const Vector3SoA& velocities, float* lifetimes, size_t count,
+    const Vector3& gravity, float damping, float deltaTime) {
+	const size_t body = count - count % Lane::kWidth;
+	return IntegrateParticlesRange<Lane>(positions, velocities, lifetimes, gravity, damping, deltaTime, 0, body) +
+	       IntegrateParticlesRange<SimdFloat1>(
+	           positions, velocities, lifetimes, gravity, damping, deltaTime, body, count);
+}
+
+// lifetimes[begin, end)で最初に寿命が尽きた(0以下の)番号 なければend
+// 生きている粒子はLane::kWidth個ずつまとめて読み飛ばす
+template<class Lane>
+size_t FindExpiredParticle(const float* lifetimes, size_t begin, size_t end) {
+	const Lane zero = Lane::Broadcast(0.0f);
+	size_t i = begin;
+	for (; i + Lane::kWidth <= end; i += Lane::kWidth) {
+		const int mask = MoveMask(CompareLessEqual(Lane::Load(lifetimes + i), zero));
+		if (mask != 0) {
+			return i + CountTrailingZeros(static_cast<uint32_t>(mask));
+		}
+	}
+	for (; i < end; i++) {
+		if (lifetimes[i] <= 0.0f) {
+			return i;
+		}
+	}
+	return end;
+}
+
+// スキニングの行列(Lane::kWidth頂点分) a[line * 4 + column]のレーンjが頂点jのΣ weight * palette[bone].m[line][column]
+template<class Lane>
+void BlendSkinMatrices(const Matrix4x4* palette, const SkinInfluence* influences, Lane a[16]) {
+	alignas(64) float buffer[16][Lane::kWidth];
+	for (size_t j = 0; j < Lane::kWidth; j++) {
+		const SkinInfluence& influence = influences[j];
+		for (int k = 0; k < 16; k++) {
+			buffer[k][j] = 0.0f;
+		}
+		for (size_t bone = 0; bone < kSkinInfluenceCount; bone++) {
+			const Matrix4x4& m = palette[influence.bones[bone]];
+			const float weight = influence.weights[bone];
+			for (int k = 0; k < 16; k++) {
+				buffer[k][j] += weight * m.m[k / 4][k % 4];
+			}
+		}
+	}
+	for (int k = 0; k < 16; k++) {
+		a[k] = Lane::Load(buffer[k]);
+	}
+}
+
+#if MT4_SIMD_SSE2
+// 頂点ごとに行単位で足し合わせ、4頂点分を行ごとに転置する
+template<>
+inline void BlendSkinMatrices<SimdFloat4>(const Matrix4x4* palette, const SkinInfluence* influences, SimdFloat4 a[16]) {
+	__m128 rows[4][4]; // [頂点][行]
+	for (size_t j = 0; j < 4; j++) {
+		const SkinInfluence& influence = influences[j];
+		const Matrix4x4& m0 = palette[influence.bones[0]];
+		const __m128 w0 = _mm_set1_ps(influence.weights[0]);
+		for (int line = 0; line < 4; line++) {
+			rows[j][line] = _mm_mul_ps(w0, _mm_loadu_ps(m0.m[line]));
+		}
+		for (size_t bone = 1; bone < kSkinInfluenceCount; bone++) {
+			const Matrix4x4& m = palette[influence.bones[bone]];
+			const __m128 w = _mm_set1_ps(influence.weights[bone]);
+			for (int line = 0; line < 4; line++) {
+				rows[j][line] = _mm_add_ps(rows[j][line], _mm_mul_ps(w, _mm_loadu_ps(m.m[line])));
+			}
+		}
+	}
+	for (int line = 0; line < 4; line++) {
+		__m128 r0 = rows[0][line], r1 = rows[1][line], r2 = rows[2][line], r3 = rows[3][line];
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		a[line * 4 + 0].v = r0;
+		a[line * 4 + 1].v = r1;
+		a[line * 4 + 2].v = r2;
+		a[line * 4 + 3].v = r3;
+	}
+}
+#endif
+
+#if MT4_SIMD_AVX2
+// 8x8の転置 r[j]の要素kがr[k]の要素jになる
+inline void Transpose8x8(__m256 r[8]) {
+	const __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]), t1 = _mm256_unpackhi_ps(r[0], r[1]);
+	const __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]), t3 = _mm256_unpackhi_ps(r[2], r[3]);
+	const __m256 t4 = _mm256_unpacklo_ps(r[4], r[5]), t5 = _mm256_unpackhi_ps(r[4], r[5]);
+	const __m256 t6 = _mm256_unpacklo_ps(r[6], r[7]), t7 = _mm256_unpackhi_ps(r[6], r[7]);
+	const __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+	const __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+	const __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+	const __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+	const __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+	const __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+	const __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+	const __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+	r[0] = _mm256_permute2f128_ps(s0, s4, 0x20);
+	r[1] = _mm256_permute2f128_ps(s1, s5, 0x20);
+	r[2] = _mm256_permute2f128_ps(s2, s6, 0x20);
+	r[3] = _mm256_permute2f128_ps(s3, s7, 0x20);
+	r[4] = _mm256_permute2f128_ps(s0, s4, 0x31);
+	r[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+	r[6] = _mm256_permute2f128_ps(s2, s6, 0x31);
+	r[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+}
+
+// 頂点ごとに2行ずつ足し合わせ、8頂点分を転置する
+template<>
+inline void BlendSkinMatrices<SimdFloat8>(const Matrix4x4* palette, const SkinInfluence* influences, SimdFloat8 a[16]) {
+	__m256 upper[8], lower[8]; // [頂点] 0・1行目と2・3行目
+	for (size_t j = 0; j < 8; j++) {
+		const SkinInfluence& influence = influences[j];
+		const Matrix4x4& m0 = palette[influence.bones[0]];
+		const __m256 w0 = _mm256_set1_ps(influence.weights[0]);
+		upper[j] = _mm256_mul_ps(w0, _mm256_loadu_ps(m0.m[0]));
+		lower[j] = _mm256_mul_ps(w0, _mm256_loadu_ps(m0.m[2]));
+		for (size_t bone = 1; bone < kSkinInfluenceCount; bone++) {
+			const Matrix4x4& m = palette[influence.bones[bone]];
+			const __m256 w = _mm256_set1_ps(influence.weights[bone]);
+			upper[j] = _mm256_fmadd_ps(w, _mm256_loadu_ps(m.m[0]), upper[j]);
+			lower[j] = _mm256_fmadd_ps(w, _mm256_loadu_ps(m.m[2]), lower[j]);
+		}
+	}
+	Transpose8x8(upper);
+	Transpose8x8(lower);
+	for (int k = 0; k < 8; k++) {
+		a[k].v = upper[k];
+		a[8 + k].v = lower[k];
+	}
+}
+#endif
+
+// スキニング [begin, end)
+template<class Lane, bool kNormals>
+void SkinVerticesRange(const Matrix4x4* palette, const SkinInfluence* influences, const ConstVector3SoA& positions,
+    const ConstVector3SoA& normals, const Vector3SoA& skinnedPositions, const Vector3SoA& skinnedNormals, size_t begin,
+    size_t end) {
+	for (size_t i = begin; i < end; i += Lane::kWidth) {
+		Lane m[16];
+		BlendSkinMatrices(palette, influences + i, m);
+		const Lane x = Lane::Load(positions.x + i);
+		const Lane y = Lane::Load(positions.y + i);
+		const Lane z = Lane::Load(positions.z + i);
+		MulAdd(x, m[0], MulAdd(y, m[4], MulAdd(z, m[8], m[12]))).Store(skinnedPositions.x + i);
+		MulAdd(x, m[1], MulAdd(y, m[5], MulAdd(z, m[9], m[13]))).Store(skinnedPositions.y + i);
+		MulAdd(x, m[2], MulAdd(y, m[6], MulAdd(z, m[10], m[14]))).Store(skinnedPositions.z + i);
+		if constexpr (kNormals) {
+			const Lane nx = Lane::Load(normals.x + i);
+			const Lane ny = Lane::Load(normals.y + i);
+			const Lane nz = Lane::Load(normals.z + i);
+			const Lane rx = MulAdd(nx, m[0], MulAdd(ny, m[4], nz * m[8]));
+			const Lane ry = MulAdd(nx, m[1], MulAdd(ny, m[5], nz * m[9]));
+			const Lane rz = MulAdd(nx, m[2], MulAdd(ny, m[6], nz * m[10]));
+			// 長さ0の法線は0のまま
+			const Lane lengthSquared = Max(MulAdd(rx, rx, MulAdd(ry, ry, rz * rz)), Lane::Broadcast(FLT_MIN));
+			const Lane inverseLength = Lane::Broadcast(1.0f) / Sqrt(lengthSquared);
+			(rx * inverseLength).Store(skinnedNormals.x + i);
+			(ry * inverseLength).Store(skinnedNormals.y + i);
+			(rz * inverseLength).Store(skinnedNormals.z + i);
+		}
+	}
+}
+
+// 本体をLaneで処理し、端数をスカラーで処理する(normals.xがnullptrなら法線は変換しない)
+template<class Lane>
+void SkinVertices(const Matrix4x4* palette, const SkinInfluence* influences, const ConstVector3SoA& positions,
+    const ConstVector3SoA& normals, const Vector3SoA& skinnedPositions, const Vector3SoA& skinnedNormals,
+    size_t count) {
+	const size_t body = count - count % Lane::kWidth;
+	if (normals.x) {
+		SkinVerticesRange<Lane, true>(palette, influences, positions, normals, skinnedPositions, skinnedNormals, 0, body);
+		SkinVerticesRange<SimdFloat1, true>(
+		    palette, influences, positions, normals, skinnedPositions, skinnedNormals, body, count);
+	}
+	else {
+		SkinVerticesRange<Lane, false>(palette, influences, positions, normals, skinnedPositions, skinnedNormals, 0, body);
+		SkinVerticesRange<SimdFloat1, false>(
+		    palette, influences, positions, normals, skinnedPositions, skinnedNormals, body, count);
+	}
+}
+
+} // namespace
@@ -0,0 +1,192 @@
+#include "MathKernel.inl"
+
+// AVX2 + FMA実装
+// このファイルだけをAVX2有効(/arch:AVX2, -mavx2 -mfma)でコンパイルする
+
+#if MT4_SIMD_AVX2
+
+namespace {
+
+// 2行分(8要素)をまとめて計算する
+// 上下128bitにm1の2行を置き、各行の要素を128bit内でブロードキャストしてm2の行と積和する
+inline __m256 MultiplyRows(__m256 a, __m256 b0, __m256 b1, __m256 b2, __m256 b3) {
+	__m256 r = _mm256_mul_ps(_mm256_permute_ps(a, _MM_SHUFFLE(0, 0, 0, 0)), b0);
+	r = _mm256_fmadd_ps(_mm256_permute_ps(a, _MM_SHUFFLE(1, 1, 1, 1)), b1, r);
+	r = _mm256_fmadd_ps(_mm256_permute_ps(a, _MM_SHUFFLE(2, 2, 2, 2)), b2, r);
+	r = _mm256_fmadd_ps(_mm256_permute_ps(a, _MM_SHUFFLE(3, 3, 3, 3)), b3, r);
+	return r;
+}
+
+} // namespace
+
+// 行列の積
+void MultiplyMatrixAVX2(const Matrix4x4& m1, const Matrix4x4& m2, Matrix4x4& result) {
+	const __m256 b0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m2.m[0]));
+	const __m256 b1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m2.m[1]));
+	const __m256 b2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m2.m[2]));
+	const __m256 b3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m2.m[3]));
+	const __m256 a01 = _mm256_loadu_ps(m1.m[0]);
+	const __m256 a23 = _mm256_loadu_ps(m1.m[2]);
+	_mm256_storeu_ps(result.m[0], MultiplyRows(a01, b0, b1, b2, b3));
+	_mm256_storeu_ps(result.m[2], MultiplyRows(a23, b0, b1, b2, b3));
+}
+
+void MultiplyMatricesAVX2(const Matrix4x4* m1, const Matrix4x4* m2, Matrix4x4* result, size_t count) {
+	for (size_t i = 0; i < count; i++) {
+		MultiplyMatrixAVX2(m1[i], m2[i], result[i]);
+	}
+}
+
+// 逆行列
+bool InverseMatrixAVX2(const Matrix4x4& m, Matrix4x4& result) {
+	return InverseMatrix4(m, result);
+}
+
+// 8行列ずつSoAにして余因子展開する
+bool InverseMatricesAVX2(const Matrix4x4* m, Matrix4x4* result, size_t count, bool* succeeded) {
+	return InverseMatrices<SimdFloat8>(m, result, count, succeeded);
+}
+
+// アフィン行列の分解(一括)
+bool DecomposeMatricesAVX2(const Matrix4x4* m, const Vector3SoA& scale, const QuaternionSoA& rotate,
+    const Vector3SoA& translate, size_t count, float shearTolerance, bool* succeeded) {
+	return DecomposeMatrices<SimdFloat8>(m, scale, rotate, translate, count, shearTolerance, succeeded);
+}
+
+// アフィン行列を分解して補間し、組み立て直す(一括)
+void BlendAffineMatricesAVX2(
+    const Matrix4x4* m0, const Matrix4x4* m1, const float* t, Matrix4x4* result, size_t count, float shearTolerance) {
+	BlendAffineMatrices<SimdFloat8>(m0, m1, t, result, count, shearTolerance);
+}
+
+// 座標変換(SoA)
+void TransformPointsAVX2(
+    const ConstVector3SoA& input, const Vector3SoA& output, size_t count, const Matrix4x4& matrix, bool affine) {
+	TransformPoints<SimdFloat8>(input, output, count, matrix, affine);
+}
+
+// 座標変換(AoS)
+void TransformPointsAoSAVX2(const Vector3* input, Vector3* output, size_t count, const Matrix4x4& matrix, bool affine) {
+	TransformPointsAoS<SimdFloat8>(input, output, count, matrix, affine);
+}
+
+// 法線の変換(SoA)
+void TransformNormalsAVX2(const ConstVector3SoA& input, const Vector3SoA& output, size_t count, const Matrix3x3& matrix) {
+	TransformNormals<SimdFloat8>(input, output, count, matrix);
+}
+
+// sinとcos(一括)
+void SinCosAVX2(const float* radians, float* sin, float* cos, size_t count, SinCosPrecision precision) {
+	SinCosBatch<SimdFloat8>(radians, sin, cos, count, precision);
+}
+
+// クォータニオンの補間(一括)
+void NlerpQuaternionsAVX2(const ConstQuaternionSoA& q0, const ConstQuaternionSoA& q1, const float* t,
+    const QuaternionSoA& result, size_t count) {
+	NlerpQuaternions<SimdFloat8>(q0, q1, t, result, count);
+}
+
+void SlerpQuaternionsAVX2(const ConstQuaternionSoA& q0, const ConstQuaternionSoA& q1, const float* t,
+    const QuaternionSoA& result, size_t count) {
+	SlerpQuaternions<SimdFloat8>(q0, q1, t, result, count);
+}
+
+// 線形補間(一括)
+void LerpVectorsAVX2(const ConstVector3SoA& v1, const ConstVector3SoA& v2, const float* t,
+    const Vector3SoA& result, size_t count) {
+	LerpVectors<SimdFloat8>(v1, v2, t, result, count);
+}
+
+// ベクトルの球面線形補間(一括)
+void SlerpVectorsAVX2(const ConstVector3SoA& v1, const ConstVector3SoA& v2, const float* t,
+    const Vector3SoA& result, size_t count) {
+	SlerpVectors<SimdFloat8>(v1, v2, t, result, count);
+}
+
+// 長さの2乗・長さ・正規化・正射影(一括)
+void LengthsSquaredAVX2(const ConstVector3SoA& v, float* result, size_t count) {
+	LengthsSquared<SimdFloat8>(v, result, count);
+}
+
+void LengthsAVX2(const ConstVector3SoA& v, float* result, size_t count, ReciprocalPrecision precision) {
+	Lengths<SimdFloat8>(v, result, count, precision);
+}
+
+void NormalizeVectorsAVX2(
+    const ConstVector3SoA& input, const Vector3SoA& output, size_t count, ReciprocalPrecision precision) {
+	NormalizeVectors<SimdFloat8>(input, output, count, precision);
+}
+
+void ProjectVectorsAVX2(const ConstVector3SoA& v1, const ConstVector3SoA& v2, const Vector3SoA& result,
+    size_t count, ReciprocalPrecision precision) {
+	ProjectVectors<SimdFloat8>(v1, v2, result, count, precision);
+}
+
+// 最短角度補間(一括)
+void LerpShortAnglesAVX2(const float* a, const float* b, const float* t, float* result, size_t count) {
+	LerpShortAngles<SimdFloat8>(a, b, t, result, count);
+}
+
+// パーティクルの積分(一括)
+size_t IntegrateParticlesAVX2(const Vector3SoA& positions, const Vector3SoA& velocities, float* lifetimes,
+    size_t count, const Vector3& gravity, float damping, float deltaTime) {
+	return IntegrateParticles<SimdFloat8>(positions, velocities, lifetimes, count, gravity, damping, deltaTime);
+}
+
+size_t FindExpiredParticleAVX2(const float* lifetimes, size_t begin, size_t end) {
+	return FindExpiredParticle<SimdFloat8>(lifetimes, begin, end);
+}
+
+// 視錐台カリング(一括)
+size_t CullSpheresAVX2(const Frustum& frustum, const ConstSphereSoA& spheres, size_t count,
+    uint32_t* visibleIndices, uint8_t* lastPlanes) {
+	return Cull<SphereLanes, SimdFloat8>(frustum, spheres, count, visibleIndices, lastPlanes);
+}
+
+size_t CullAABBsAVX2(const Frustum& frustum, const ConstAABBSoA& aabbs, size_t count,
+    uint32_t* visibleIndices, uint8_t* lastPlanes) {
+	return Cull<AABBLanes, SimdFloat8>(frustum, aabbs, count, visibleIndices, lastPlanes);
+}
+
+// 頂点変換(一括・SoA)
+void ProjectPointsAVX2(const ConstVector3SoA& input, ScreenVertex* output, size_t count,
+    const Matrix4x4& clipMatrix, const Matrix4x4& screenMatrix) {
+	ProjectPoints<SimdFloat8>(input, output, count, clipMatrix, screenMatrix);
+}
+
+// BVHのレイ判定(一括)
+void RaycastBVHAVX2(const BVHNode* nodes, const BVHPrimitive* primitives, const ConstRaySoA& rays,
+    const float* maxT, RayHit* hits, size_t count) {
+	RaycastBVH<SimdFloat8>(nodes, primitives, rays, maxT, hits, count);
+}
+
+// 掃引で重なる組を探す
+size_t SweepSpheresAVX2(const ConstSphereSoA& spheres, const float* minKeys, const float* maxKeys,
+    const uint32_t* ids, size_t count, size_t end, SweepCursor& cursor, CollisionPair* pairs, size_t capacity) {
+	return SweepRange<SphereLanes, SimdFloat8>(spheres, minKeys, maxKeys, ids, count, end, cursor, pairs, capacity);
+}
+
+size_t SweepAABBsAVX2(const ConstAABBSoA& aabbs, const float* minKeys, const float* maxKeys,
+    const uint32_t* ids, size_t count, size_t end, SweepCursor& cursor, CollisionPair* pairs, size_t capacity) {
+	return SweepRange<AABBRangeLanes, SimdFloat8>(aabbs, minKeys, maxKeys, ids, count, end, cursor, pairs, capacity);
+}
+
+// 姿勢の圧縮・展開
+void EncodeTransformsAVX2(const ConstVector3SoA& scale, const ConstQuaternionSoA& rotate,
+    const ConstVector3SoA& translate, const TransformQuantization& quantization, CompressedTransformBlock* blocks,
+    size_t blockCount) {
+	EncodeTransforms<SimdFloat8>(scale, rotate, translate, quantization, blocks, blockCount);
+}
+
+void DecodeTransformsAVX2(const CompressedTransformBlock* blocks, size_t blockCount,
+    const TransformQuantization& quantization, Matrix4x4* result) {
+	DecodeTransforms<SimdFloat8>(blocks, blockCount, quantization, result);
+}
+
+// スキニング
+void SkinVerticesAVX2(const Matrix4x4* palette, const SkinInfluence* influences, const ConstVector3SoA& positions,
+    const ConstVector3SoA& normals, const Vector3SoA& skinnedPositions, const Vector3SoA& skinnedNormals, size_t count) {
+	SkinVertices<SimdFloat8>(palette, influences, positions, normals, skinnedPositions, skinnedNormals, count);
+}
+
+#endif
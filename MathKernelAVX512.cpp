@@ -0,0 +1,46 @@
+#include "MathKernel.inl"
+
+// AVX-512F実装
+// このファイルだけをAVX-512有効(/arch:AVX512, -mavx512f)でコンパイルする
+
+#if MT4_SIMD_AVX512
+
+namespace {
+
+// 4行分(16要素)を1レジスタで計算する
+// 128bitごとにm1の各行を置き、行内の要素をブロードキャストしてm2の行と積和する
+inline __m512 MultiplyRows(const Matrix4x4& m1, const Matrix4x4& m2) {
+	const __m512 a = _mm512_loadu_ps(m1.m[0]);
+	const __m512 b0 = _mm512_broadcast_f32x4(_mm_loadu_ps(m2.m[0]));
+	const __m512 b1 = _mm512_broadcast_f32x4(_mm_loadu_ps(m2.m[1]));
+	const __m512 b2 = _mm512_broadcast_f32x4(_mm_loadu_ps(m2.m[2]));
+	const __m512 b3 = _mm512_broadcast_f32x4(_mm_loadu_ps(m2.m[3]));
+	__m512 r = _mm512_mul_ps(_mm512_permute_ps(a, _MM_SHUFFLE(0, 0, 0, 0)), b0);
+	r = _mm512_fmadd_ps(_mm512_permute_ps(a, _MM_SHUFFLE(1, 1, 1, 1)), b1, r);
+	r = _mm512_fmadd_ps(_mm512_permute_ps(a, _MM_SHUFFLE(2, 2, 2, 2)), b2, r);
+	r = _mm512_fmadd_ps(_mm512_permute_ps(a, _MM_SHUFFLE(3, 3, 3, 3)), b3, r);
+	return r;
+}
+
+} // namespace
+
+// 行列の積
+void MultiplyMatrixAVX512(const Matrix4x4& m1, const Matrix4x4& m2, Matrix4x4& result) {
+	_mm512_storeu_ps(result.m[0], MultiplyRows(m1, m2));
+}
+
+// 2組ずつ交互に計算して積和の依存チェーンを隠す
+void MultiplyMatricesAVX512(const Matrix4x4* m1, const Matrix4x4* m2, Matrix4x4* result, size_t count) {
+	size_t i = 0;
+	for (; i + 2 <= count; i += 2) {
+		const __m512 r0 = MultiplyRows(m1[i], m2[i]);
+		const __m512 r1 = MultiplyRows(m1[i + 1], m2[i + 1]);
+		_mm512_storeu_ps(result[i].m[0], r0);
+		_mm512_storeu_ps(result[i + 1].m[0], r1);
+	}
+	for (; i < count; i++) {
+		_mm512_storeu_ps(result[i].m[0], MultiplyRows(m1[i], m2[i]));
+	}
+}
+
+#endif
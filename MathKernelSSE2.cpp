@@ -0,0 +1,182 @@
+#include "MathKernel.inl"
+
+// SSE2実装
+
+#if MT4_SIMD_SSE2
+
+// 行列の積
+// 結果の各行を m1の行要素のブロードキャスト * m2の各行 の和で求める
+void MultiplyMatrixSSE2(const Matrix4x4& m1, const Matrix4x4& m2, Matrix4x4& result) {
+	const __m128 b0 = _mm_loadu_ps(m2.m[0]);
+	const __m128 b1 = _mm_loadu_ps(m2.m[1]);
+	const __m128 b2 = _mm_loadu_ps(m2.m[2]);
+	const __m128 b3 = _mm_loadu_ps(m2.m[3]);
+	for (int line = 0; line < 4; line++) {
+		const __m128 a = _mm_loadu_ps(m1.m[line]);
+		__m128 r = _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 0, 0)), b0);
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 1, 1)), b1));
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 2, 2)), b2));
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 3, 3)), b3));
+		_mm_storeu_ps(result.m[line], r);
+	}
+}
+
+void MultiplyMatricesSSE2(const Matrix4x4* m1, const Matrix4x4* m2, Matrix4x4* result, size_t count) {
+	for (size_t i = 0; i < count; i++) {
+		MultiplyMatrixSSE2(m1[i], m2[i], result[i]);
+	}
+}
+
+// 逆行列
+bool InverseMatrixSSE2(const Matrix4x4& m, Matrix4x4& result) {
+	return InverseMatrix4(m, result);
+}
+
+// 4行列ずつSoAにして余因子展開する
+bool InverseMatricesSSE2(const Matrix4x4* m, Matrix4x4* result, size_t count, bool* succeeded) {
+	return InverseMatrices<SimdFloat4>(m, result, count, succeeded);
+}
+
+// アフィン行列の分解(一括)
+bool DecomposeMatricesSSE2(const Matrix4x4* m, const Vector3SoA& scale, const QuaternionSoA& rotate,
+    const Vector3SoA& translate, size_t count, float shearTolerance, bool* succeeded) {
+	return DecomposeMatrices<SimdFloat4>(m, scale, rotate, translate, count, shearTolerance, succeeded);
+}
+
+// アフィン行列を分解して補間し、組み立て直す(一括)
+void BlendAffineMatricesSSE2(
+    const Matrix4x4* m0, const Matrix4x4* m1, const float* t, Matrix4x4* result, size_t count, float shearTolerance) {
+	BlendAffineMatrices<SimdFloat4>(m0, m1, t, result, count, shearTolerance);
+}
+
+// 座標変換(SoA)
+void TransformPointsSSE2(
+    const ConstVector3SoA& input, const Vector3SoA& output, size_t count, const Matrix4x4& matrix, bool affine) {
+	TransformPoints<SimdFloat4>(input, output, count, matrix, affine);
+}
+
+// 座標変換(AoS)
+void TransformPointsAoSSSE2(const Vector3* input, Vector3* output, size_t count, const Matrix4x4& matrix, bool affine) {
+	TransformPointsAoS<SimdFloat4>(input, output, count, matrix, affine);
+}
+
+// 法線の変換(SoA)
+void TransformNormalsSSE2(const ConstVector3SoA& input, const Vector3SoA& output, size_t count, const Matrix3x3& matrix) {
+	TransformNormals<SimdFloat4>(input, output, count, matrix);
+}
+
+// sinとcos(一括)
+void SinCosSSE2(const float* radians, float* sin, float* cos, size_t count, SinCosPrecision precision) {
+	SinCosBatch<SimdFloat4>(radians, sin, cos, count, precision);
+}
+
+// クォータニオンの補間(一括)
+void NlerpQuaternionsSSE2(const ConstQuaternionSoA& q0, const ConstQuaternionSoA& q1, const float* t,
+    const QuaternionSoA& result, size_t count) {
+	NlerpQuaternions<SimdFloat4>(q0, q1, t, result, count);
+}
+
+void SlerpQuaternionsSSE2(const ConstQuaternionSoA& q0, const ConstQuaternionSoA& q1, const float* t,
+    const QuaternionSoA& result, size_t count) {
+	SlerpQuaternions<SimdFloat4>(q0, q1, t, result, count);
+}
+
+// 線形補間(一括)
+void LerpVectorsSSE2(const ConstVector3SoA& v1, const ConstVector3SoA& v2, const float* t,
+    const Vector3SoA& result, size_t count) {
+	LerpVectors<SimdFloat4>(v1, v2, t, result, count);
+}
+
+// ベクトルの球面線形補間(一括)
+void SlerpVectorsSSE2(const ConstVector3SoA& v1, const ConstVector3SoA& v2, const float* t,
+    const Vector3SoA& result, size_t count) {
+	SlerpVectors<SimdFloat4>(v1, v2, t, result, count);
+}
+
+// 長さの2乗・長さ・正規化・正射影(一括)
+void LengthsSquaredSSE2(const ConstVector3SoA& v, float* result, size_t count) {
+	LengthsSquared<SimdFloat4>(v, result, count);
+}
+
+void LengthsSSE2(const ConstVector3SoA& v, float* result, size_t count, ReciprocalPrecision precision) {
+	Lengths<SimdFloat4>(v, result, count, precision);
+}
+
+void NormalizeVectorsSSE2(
+    const ConstVector3SoA& input, const Vector3SoA& output, size_t count, ReciprocalPrecision precision) {
+	NormalizeVectors<SimdFloat4>(input, output, count, precision);
+}
+
+void ProjectVectorsSSE2(const ConstVector3SoA& v1, const ConstVector3SoA& v2, const Vector3SoA& result,
+    size_t count, ReciprocalPrecision precision) {
+	ProjectVectors<SimdFloat4>(v1, v2, result, count, precision);
+}
+
+// 最短角度補間(一括)
+void LerpShortAnglesSSE2(const float* a, const float* b, const float* t, float* result, size_t count) {
+	LerpShortAngles<SimdFloat4>(a, b, t, result, count);
+}
+
+// パーティクルの積分(一括)
+size_t IntegrateParticlesSSE2(const Vector3SoA& positions, const Vector3SoA& velocities, float* lifetimes,
+    size_t count, const Vector3& gravity, float damping, float deltaTime) {
+	return IntegrateParticles<SimdFloat4>(positions, velocities, lifetimes, count, gravity, damping, deltaTime);
+}
+
+size_t FindExpiredParticleSSE2(const float* lifetimes, size_t begin, size_t end) {
+	return FindExpiredParticle<SimdFloat4>(lifetimes, begin, end);
+}
+
+// 視錐台カリング(一括)
+size_t CullSpheresSSE2(const Frustum& frustum, const ConstSphereSoA& spheres, size_t count,
+    uint32_t* visibleIndices, uint8_t* lastPlanes) {
+	return Cull<SphereLanes, SimdFloat4>(frustum, spheres, count, visibleIndices, lastPlanes);
+}
+
+size_t CullAABBsSSE2(const Frustum& frustum, const ConstAABBSoA& aabbs, size_t count,
+    uint32_t* visibleIndices, uint8_t* lastPlanes) {
+	return Cull<AABBLanes, SimdFloat4>(frustum, aabbs, count, visibleIndices, lastPlanes);
+}
+
+// 頂点変換(一括・SoA)
+void ProjectPointsSSE2(const ConstVector3SoA& input, ScreenVertex* output, size_t count,
+    const Matrix4x4& clipMatrix, const Matrix4x4& screenMatrix) {
+	ProjectPoints<SimdFloat4>(input, output, count, clipMatrix, screenMatrix);
+}
+
+// BVHのレイ判定(一括)
+void RaycastBVHSSE2(const BVHNode* nodes, const BVHPrimitive* primitives, const ConstRaySoA& rays,
+    const float* maxT, RayHit* hits, size_t count) {
+	RaycastBVH<SimdFloat4>(nodes, primitives, rays, maxT, hits, count);
+}
+
+// 掃引で重なる組を探す
+size_t SweepSpheresSSE2(const ConstSphereSoA& spheres, const float* minKeys, const float* maxKeys,
+    const uint32_t* ids, size_t count, size_t end, SweepCursor& cursor, CollisionPair* pairs, size_t capacity) {
+	return SweepRange<SphereLanes, SimdFloat4>(spheres, minKeys, maxKeys, ids, count, end, cursor, pairs, capacity);
+}
+
+size_t SweepAABBsSSE2(const ConstAABBSoA& aabbs, const float* minKeys, const float* maxKeys,
+    const uint32_t* ids, size_t count, size_t end, SweepCursor& cursor, CollisionPair* pairs, size_t capacity) {
+	return SweepRange<AABBRangeLanes, SimdFloat4>(aabbs, minKeys, maxKeys, ids, count, end, cursor, pairs, capacity);
+}
+
+// 姿勢の圧縮・展開
+void EncodeTransformsSSE2(const ConstVector3SoA& scale, const ConstQuaternionSoA& rotate,
+    const ConstVector3SoA& translate, const TransformQuantization& quantization, CompressedTransformBlock* blocks,
+    size_t blockCount) {
+	EncodeTransforms<SimdFloat4>(scale, rotate, translate, quantization, blocks, blockCount);
+}
+
+void DecodeTransformsSSE2(const CompressedTransformBlock* blocks, size_t blockCount,
+    const TransformQuantization& quantization, Matrix4x4* result) {
+	DecodeTransforms<SimdFloat4>(blocks, blockCount, quantization, result);
+}
+
+// スキニング
+void SkinVerticesSSE2(const Matrix4x4* palette, const SkinInfluence* influences, const ConstVector3SoA& positions,
+    const ConstVector3SoA& normals, const Vector3SoA& skinnedPositions, const Vector3SoA& skinnedNormals, size_t count) {
+	SkinVertices<SimdFloat4>(palette, influences, positions, normals, skinnedPositions, skinnedNormals, count);
+}
+
+#endif
@@ -0,0 +1,173 @@
+#include "MathKernel.inl"
+
+// スカラー実装(全環境共通の基準実装)
+
+// 行列の積
+void MultiplyMatrixScalar(const Matrix4x4& m1, const Matrix4x4& m2, Matrix4x4& result) {
+	Matrix4x4 product;
+	for (int line = 0; line < 4; line++) {
+		for (int column = 0; column < 4; column++) {
+			product.m[line][column] =
+			    m1.m[line][0] * m2.m[0][column] + m1.m[line][1] * m2.m[1][column] +
+			    m1.m[line][2] * m2.m[2][column] + m1.m[line][3] * m2.m[3][column];
+		}
+	}
+	result = product;
+}
+
+void MultiplyMatricesScalar(const Matrix4x4* m1, const Matrix4x4* m2, Matrix4x4* result, size_t count) {
+	for (size_t i = 0; i < count; i++) {
+		MultiplyMatrixScalar(m1[i], m2[i], result[i]);
+	}
+}
+
+// 逆行列
+bool InverseMatrixScalar(const Matrix4x4& m, Matrix4x4& result) {
+	return InverseMatricesScalar(&m, &result, 1, nullptr);
+}
+
+bool InverseMatricesScalar(const Matrix4x4* m, Matrix4x4* result, size_t count, bool* succeeded) {
+	return InverseMatrices<SimdFloat1>(m, result, count, succeeded);
+}
+
+// アフィン行列の分解(一括)
+bool DecomposeMatricesScalar(const Matrix4x4* m, const Vector3SoA& scale, const QuaternionSoA& rotate,
+    const Vector3SoA& translate, size_t count, float shearTolerance, bool* succeeded) {
+	return DecomposeMatrices<SimdFloat1>(m, scale, rotate, translate, count, shearTolerance, succeeded);
+}
+
+// アフィン行列を分解して補間し、組み立て直す(一括)
+void BlendAffineMatricesScalar(
+    const Matrix4x4* m0, const Matrix4x4* m1, const float* t, Matrix4x4* result, size_t count, float shearTolerance) {
+	BlendAffineMatrices<SimdFloat1>(m0, m1, t, result, count, shearTolerance);
+}
+
+// 座標変換(SoA)
+void TransformPointsScalar(
+    const ConstVector3SoA& input, const Vector3SoA& output, size_t count, const Matrix4x4& matrix, bool affine) {
+	TransformPoints<SimdFloat1>(input, output, count, matrix, affine);
+}
+
+// 座標変換(AoS)
+void TransformPointsAoSScalar(const Vector3* input, Vector3* output, size_t count, const Matrix4x4& matrix, bool affine) {
+	TransformPointsAoS<SimdFloat1>(input, output, count, matrix, affine);
+}
+
+// 法線の変換(SoA)
+void TransformNormalsScalar(const ConstVector3SoA& input, const Vector3SoA& output, size_t count, const Matrix3x3& matrix) {
+	TransformNormals<SimdFloat1>(input, output, count, matrix);
+}
+
+// sinとcos(一括)
+void SinCosScalar(const float* radians, float* sin, float* cos, size_t count, SinCosPrecision precision) {
+	SinCosBatch<SimdFloat1>(radians, sin, cos, count, precision);
+}
+
+// クォータニオンの補間(一括)
+void NlerpQuaternionsScalar(const ConstQuaternionSoA& q0, const ConstQuaternionSoA& q1, const float* t,
+    const QuaternionSoA& result, size_t count) {
+	NlerpQuaternions<SimdFloat1>(q0, q1, t, result, count);
+}
+
+void SlerpQuaternionsScalar(const ConstQuaternionSoA& q0, const ConstQuaternionSoA& q1, const float* t,
+    const QuaternionSoA& result, size_t count) {
+	SlerpQuaternions<SimdFloat1>(q0, q1, t, result, count);
+}
+
+// 線形補間(一括)
+void LerpVectorsScalar(const ConstVector3SoA& v1, const ConstVector3SoA& v2, const float* t,
+    const Vector3SoA& result, size_t count) {
+	LerpVectors<SimdFloat1>(v1, v2, t, result, count);
+}
+
+// ベクトルの球面線形補間(一括)
+void SlerpVectorsScalar(const ConstVector3SoA& v1, const ConstVector3SoA& v2, const float* t,
+    const Vector3SoA& result, size_t count) {
+	SlerpVectors<SimdFloat1>(v1, v2, t, result, count);
+}
+
+// 長さの2乗・長さ・正規化・正射影(一括)
+void LengthsSquaredScalar(const ConstVector3SoA& v, float* result, size_t count) {
+	LengthsSquared<SimdFloat1>(v, result, count);
+}
+
+void LengthsScalar(const ConstVector3SoA& v, float* result, size_t count, ReciprocalPrecision precision) {
+	Lengths<SimdFloat1>(v, result, count, precision);
+}
+
+void NormalizeVectorsScalar(
+    const ConstVector3SoA& input, const Vector3SoA& output, size_t count, ReciprocalPrecision precision) {
+	NormalizeVectors<SimdFloat1>(input, output, count, precision);
+}
+
+void ProjectVectorsScalar(const ConstVector3SoA& v1, const ConstVector3SoA& v2, const Vector3SoA& result,
+    size_t count, ReciprocalPrecision precision) {
+	ProjectVectors<SimdFloat1>(v1, v2, result, count, precision);
+}
+
+// 最短角度補間(一括)
+void LerpShortAnglesScalar(const float* a, const float* b, const float* t, float* result, size_t count) {
+	LerpShortAngles<SimdFloat1>(a, b, t, result, count);
+}
+
+// パーティクルの積分(一括)
+size_t IntegrateParticlesScalar(const Vector3SoA& positions, const Vector3SoA& velocities, float* lifetimes,
+    size_t count, const Vector3& gravity, float damping, float deltaTime) {
+	return IntegrateParticles<SimdFloat1>(positions, velocities, lifetimes, count, gravity, damping, deltaTime);
+}
+
+size_t FindExpiredParticleScalar(const float* lifetimes, size_t begin, size_t end) {
+	return FindExpiredParticle<SimdFloat1>(lifetimes, begin, end);
+}
+
+// 視錐台カリング(一括)
+size_t CullSpheresScalar(const Frustum& frustum, const ConstSphereSoA& spheres, size_t count,
+    uint32_t* visibleIndices, uint8_t* lastPlanes) {
+	return Cull<SphereLanes, SimdFloat1>(frustum, spheres, count, visibleIndices, lastPlanes);
+}
+
+size_t CullAABBsScalar(const Frustum& frustum, const ConstAABBSoA& aabbs, size_t count,
+    uint32_t* visibleIndices, uint8_t* lastPlanes) {
+	return Cull<AABBLanes, SimdFloat1>(frustum, aabbs, count, visibleIndices, lastPlanes);
+}
+
+// 頂点変換(一括・SoA)
+void ProjectPointsScalar(const ConstVector3SoA& input, ScreenVertex* output, size_t count,
+    const Matrix4x4& clipMatrix, const Matrix4x4& screenMatrix) {
+	ProjectPoints<SimdFloat1>(input, output, count, clipMatrix, screenMatrix);
+}
+
+// BVHのレイ判定(一括)
+void RaycastBVHScalar(const BVHNode* nodes, const BVHPrimitive* primitives, const ConstRaySoA& rays,
+    const float* maxT, RayHit* hits, size_t count) {
+	RaycastBVH<SimdFloat1>(nodes, primitives, rays, maxT, hits, count);
+}
+
+// 掃引で重なる組を探す
+size_t SweepSpheresScalar(const ConstSphereSoA& spheres, const float* minKeys, const float* maxKeys,
+    const uint32_t* ids, size_t count, size_t end, SweepCursor& cursor, CollisionPair* pairs, size_t capacity) {
+	return SweepRange<SphereLanes, SimdFloat1>(spheres, minKeys, maxKeys, ids, count, end, cursor, pairs, capacity);
+}
+
+size_t SweepAABBsScalar(const ConstAABBSoA& aabbs, const float* minKeys, const float* maxKeys,
+    const uint32_t* ids, size_t count, size_t end, SweepCursor& cursor, CollisionPair* pairs, size_t capacity) {
+	return SweepRange<AABBRangeLanes, SimdFloat1>(aabbs, minKeys, maxKeys, ids, count, end, cursor, pairs, capacity);
+}
+
+// 姿勢の圧縮・展開
+void EncodeTransformsScalar(const ConstVector3SoA& scale, const ConstQuaternionSoA& rotate,
+    const ConstVector3SoA& translate, const TransformQuantization& quantization, CompressedTransformBlock* blocks,
+    size_t blockCount) {
+	EncodeTransforms<SimdFloat1>(scale, rotate, translate, quantization, blocks, blockCount);
+}
+
+void DecodeTransformsScalar(const CompressedTransformBlock* blocks, size_t blockCount,
+    const TransformQuantization& quantization, Matrix4x4* result) {
+	DecodeTransforms<SimdFloat1>(blocks, blockCount, quantization, result);
+}
+
+// スキニング
+void SkinVerticesScalar(const Matrix4x4* palette, const SkinInfluence* influences, const ConstVector3SoA& positions,
+    const ConstVector3SoA& normals, const Vector3SoA& skinnedPositions, const Vector3SoA& skinnedNormals, size_t count) {
+	SkinVertices<SimdFloat1>(palette, influences, positions, normals, skinnedPositions, skinnedNormals, count);
+}
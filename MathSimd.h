@@ -0,0 +1,431 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <math.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+#define MT4_SIMD_SSE2 1
+#include <emmintrin.h>
+#else
+#define MT4_SIMD_SSE2 0
+#endif
+
+// AVX2/AVX-512は対応するカーネルの翻訳単位だけをそのオプションでコンパイルする
+#if defined(__AVX2__)
+#define MT4_SIMD_AVX2 1
+#include <immintrin.h>
+#else
+#define MT4_SIMD_AVX2 0
+#endif
+#if defined(__AVX512F__)
+#define MT4_SIMD_AVX512 1
+#else
+#define MT4_SIMD_AVX512 0
+#endif
+// MSVCは/arch:AVX2でFMAも有効になる
+#if defined(__FMA__) || (defined(_MSC_VER) && MT4_SIMD_AVX2)
+#define MT4_SIMD_FMA 1
+#else
+#define MT4_SIMD_FMA 0
+#endif
+
+// 一括演算カーネル用のレーン型
+// カーネルを置く翻訳単位ごとに命令セットが異なるため、すべて内部リンケージにしておく
+// 標準ライブラリのインライン関数(std::bit_cast、std::fabsなど)も翻訳単位をまたいで1つの実体にまとめられ、
+// AVX2でコンパイルしたものが選ばれることがあるので、カーネルでは使わずに下の関数とCの数学関数を使う
+namespace {
+
+template<class To, class From>
+constexpr To BitCast(const From& from) {
+	return __builtin_bit_cast(To, from);
+}
+
+// 最下位の1のビットの位置(maskは0以外)
+inline int CountTrailingZeros(uint32_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return int(index);
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+// 1のビットの数(POPCNT命令は使わない)
+inline int PopCount(uint32_t mask) {
+	mask = mask - ((mask >> 1) & 0x55555555u);
+	mask = (mask & 0x33333333u) + ((mask >> 2) & 0x33333333u);
+	return int((((mask + (mask >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24);
+}
+
+// 半精度浮動小数点数(IEEE 754 binary16)との変換
+// 最近接偶数に丸め、範囲を超えたら無限大にする SIMD版も同じ手順で計算して結果をそろえる
+inline uint16_t FloatToHalf(float value) {
+	const uint32_t bits = BitCast<uint32_t>(value);
+	const uint32_t sign = bits & 0x80000000u;
+	const uint32_t magnitude = bits ^ sign;
+	uint32_t half;
+	if (magnitude >= (127u + 16u) << 23) {
+		// 無限大・NaN
+		half = magnitude > 0x7F800000u ? 0x7E00u : 0x7C00u;
+	}
+	else if (magnitude < (127u - 14u) << 23) {
+		// 非正規化数 仮数部の位置がそろう数を足して丸めさせる
+		const float magic = BitCast<float>(((127u - 15u) + (23u - 10u) + 1u) << 23);
+		half = BitCast<uint32_t>(BitCast<float>(magnitude) + magic) - BitCast<uint32_t>(magic);
+	}
+	else {
+		// 指数部を付け替え、仮数部の下位13ビットを最近接偶数で丸める
+		half = (magnitude + (0xFFFu - ((127u - 15u) << 23)) + ((magnitude >> 13) & 1u)) >> 13;
+	}
+	return static_cast<uint16_t>(half | (sign >> 16));
+}
+inline float HalfToFloat(uint16_t half) {
+	const uint32_t magnitude = half & 0x7FFFu;
+	const uint32_t sign = static_cast<uint32_t>(half ^ magnitude) << 16;
+	// 13ビットずらして2^112を掛けると非正規化数も含めて値になる
+	uint32_t bits = BitCast<uint32_t>(
+	    BitCast<float>(magnitude << 13) * BitCast<float>((254u - 15u) << 23));
+	if (magnitude > 0x7BFFu) {
+		bits |= 255u << 23;
+	}
+	return BitCast<float>(bits | sign);
+}
+
+// スカラー(1レーン)
+struct SimdFloat1 {
+	static constexpr size_t kWidth = 1;
+	float v;
+
+	static SimdFloat1 Load(const float* p) { return { *p }; }
+	static SimdFloat1 Broadcast(float s) { return { s }; }
+	void Store(float* p) const { *p = v; }
+
+	// 整数・半精度浮動小数点数の配列との変換
+	// 整数へは最近接偶数に丸める(範囲外の値は不定)
+	static SimdFloat1 LoadUInt16(const uint16_t* p) { return { static_cast<float>(*p) }; }
+	static SimdFloat1 LoadInt32(const int32_t* p) { return { static_cast<float>(*p) }; }
+	static SimdFloat1 LoadHalf(const uint16_t* p) { return { HalfToFloat(*p) }; }
+	void StoreUInt16(uint16_t* p) const { *p = static_cast<uint16_t>(lrintf(v)); }
+	void StoreInt32(int32_t* p) const { *p = static_cast<int32_t>(lrintf(v)); }
+	void StoreHalf(uint16_t* p) const { *p = FloatToHalf(v); }
+};
+
+inline SimdFloat1 operator+(SimdFloat1 a, SimdFloat1 b) { return { a.v + b.v }; }
+inline SimdFloat1 operator-(SimdFloat1 a, SimdFloat1 b) { return { a.v - b.v }; }
+inline SimdFloat1 operator*(SimdFloat1 a, SimdFloat1 b) { return { a.v * b.v }; }
+inline SimdFloat1 operator/(SimdFloat1 a, SimdFloat1 b) { return { a.v / b.v }; }
+// a * b + c
+inline SimdFloat1 MulAdd(SimdFloat1 a, SimdFloat1 b, SimdFloat1 c) { return { a.v * b.v + c.v }; }
+inline SimdFloat1 Abs(SimdFloat1 a) { return { fabsf(a.v) }; }
+inline SimdFloat1 Sqrt(SimdFloat1 a) { return { sqrtf(a.v) }; }
+// 1 / sqrt(a)と1 / a aは正規化数の正の値
+// Estimateは近似命令そのまま(相対誤差1.5 * 2^-12以下)、付かないものはニュートン法で1回補正する
+// スカラー版は近似命令がないのでどちらも除算で求める
+inline SimdFloat1 ReciprocalSqrtEstimate(SimdFloat1 a) { return { 1.0f / sqrtf(a.v) }; }
+inline SimdFloat1 ReciprocalSqrt(SimdFloat1 a) { return { 1.0f / sqrtf(a.v) }; }
+inline SimdFloat1 ReciprocalEstimate(SimdFloat1 a) { return { 1.0f / a.v }; }
+inline SimdFloat1 Reciprocal(SimdFloat1 a) { return { 1.0f / a.v }; }
+inline SimdFloat1 Min(SimdFloat1 a, SimdFloat1 b) { return { a.v < b.v ? a.v : b.v }; }
+inline SimdFloat1 Max(SimdFloat1 a, SimdFloat1 b) { return { a.v > b.v ? a.v : b.v }; }
+
+// 比較結果はレーンごとの全ビットマスク
+inline SimdFloat1 MakeMask(bool b) { return { BitCast<float>(b ? 0xFFFFFFFFu : 0u) }; }
+inline SimdFloat1 CompareLess(SimdFloat1 a, SimdFloat1 b) { return MakeMask(a.v < b.v); }
+inline SimdFloat1 CompareLessEqual(SimdFloat1 a, SimdFloat1 b) { return MakeMask(a.v <= b.v); }
+inline SimdFloat1 And(SimdFloat1 a, SimdFloat1 b) {
+	return { BitCast<float>(BitCast<uint32_t>(a.v) & BitCast<uint32_t>(b.v)) };
+}
+inline SimdFloat1 Or(SimdFloat1 a, SimdFloat1 b) {
+	return { BitCast<float>(BitCast<uint32_t>(a.v) | BitCast<uint32_t>(b.v)) };
+}
+// mask ? a : b
+inline SimdFloat1 Select(SimdFloat1 mask, SimdFloat1 a, SimdFloat1 b) {
+	return BitCast<uint32_t>(mask.v) != 0 ? a : b;
+}
+// 各レーンの最上位ビットを並べた整数
+inline int MoveMask(SimdFloat1 mask) { return int(BitCast<uint32_t>(mask.v) >> 31); }
+// 4つのレーン型を要素ごとに(x, y, z, w)の順で並べて書き込む(16バイトの構造体の配列に書き込む用)
+inline void StoreInterleaved(SimdFloat1 x, SimdFloat1 y, SimdFloat1 z, SimdFloat1 w, void* p) {
+	const float values[4] = { x.v, y.v, z.v, w.v };
+	std::memcpy(p, values, sizeof(values));
+}
+// (x, y, z)の順に並んだ12バイトの構造体の配列から読み、要素ごとのレーン型にする
+inline void LoadInterleaved(const void* p, SimdFloat1& x, SimdFloat1& y, SimdFloat1& z) {
+	float values[3];
+	std::memcpy(values, p, sizeof(values));
+	x.v = values[0];
+	y.v = values[1];
+	z.v = values[2];
+}
+// 3つのレーン型を要素ごとに(x, y, z)の順で並べて書き込む(12バイトの構造体の配列に書き込む用)
+inline void StoreInterleaved(SimdFloat1 x, SimdFloat1 y, SimdFloat1 z, void* p) {
+	const float values[3] = { x.v, y.v, z.v };
+	std::memcpy(p, values, sizeof(values));
+}
+
+#if MT4_SIMD_SSE2
+// 32ビットの各レーンの下位16ビットを半精度浮動小数点数とみなす(FloatToHalf(float)と同じ手順)
+inline __m128i FloatToHalf(__m128 value) {
+	const __m128i bits = _mm_castps_si128(value);
+	const __m128i sign = _mm_and_si128(bits, _mm_set1_epi32(int(0x80000000u)));
+	const __m128i magnitude = _mm_xor_si128(bits, sign);
+	const __m128i isFinite = _mm_cmpgt_epi32(_mm_set1_epi32((127 + 16) << 23), magnitude);
+	const __m128i isDenormal = _mm_cmpgt_epi32(_mm_set1_epi32((127 - 14) << 23), magnitude);
+	const __m128i infinityOrNaN = _mm_or_si128(_mm_set1_epi32(0x7C00),
+	    _mm_and_si128(_mm_cmpgt_epi32(magnitude, _mm_set1_epi32(0x7F800000)), _mm_set1_epi32(0x200)));
+	const __m128 magic = _mm_castsi128_ps(_mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23));
+	const __m128i denormal = _mm_sub_epi32(
+	    _mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(magnitude), magic)), _mm_castps_si128(magic));
+	const __m128i odd = _mm_and_si128(_mm_srli_epi32(magnitude, 13), _mm_set1_epi32(1));
+	const __m128i normal = _mm_srli_epi32(
+	    _mm_add_epi32(_mm_add_epi32(magnitude, _mm_set1_epi32(0xFFF - ((127 - 15) << 23))), odd), 13);
+	const __m128i finite = _mm_or_si128(_mm_and_si128(isDenormal, denormal), _mm_andnot_si128(isDenormal, normal));
+	const __m128i half = _mm_or_si128(_mm_and_si128(isFinite, finite), _mm_andnot_si128(isFinite, infinityOrNaN));
+	return _mm_or_si128(half, _mm_srli_epi32(sign, 16));
+}
+inline __m128 HalfToFloat(__m128i half) {
+	const __m128i magnitude = _mm_and_si128(half, _mm_set1_epi32(0x7FFF));
+	const __m128i sign = _mm_slli_epi32(_mm_xor_si128(half, magnitude), 16);
+	const __m128 value = _mm_mul_ps(
+	    _mm_castsi128_ps(_mm_slli_epi32(magnitude, 13)), _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23)));
+	const __m128i infinityOrNaN =
+	    _mm_and_si128(_mm_cmpgt_epi32(magnitude, _mm_set1_epi32(0x7BFF)), _mm_set1_epi32(255 << 23));
+	return _mm_or_ps(value, _mm_castsi128_ps(_mm_or_si128(infinityOrNaN, sign)));
+}
+// 16ビット整数4つを32ビットに広げる / 32ビットの下位16ビットを詰めて書き込む
+inline __m128i LoadUInt16x4(const uint16_t* p) {
+	return _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)), _mm_setzero_si128());
+}
+inline void StoreUInt16x4(__m128i values, uint16_t* p) {
+	// 符号付きの飽和で詰めるので、下位16ビットを符号拡張しておく
+	const __m128i extended = _mm_srai_epi32(_mm_slli_epi32(values, 16), 16);
+	_mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packs_epi32(extended, extended));
+}
+
+// SSE2(4レーン)
+struct SimdFloat4 {
+	static constexpr size_t kWidth = 4;
+	__m128 v;
+
+	static SimdFloat4 Load(const float* p) { return { _mm_loadu_ps(p) }; }
+	static SimdFloat4 Broadcast(float s) { return { _mm_set1_ps(s) }; }
+	void Store(float* p) const { _mm_storeu_ps(p, v); }
+
+	static SimdFloat4 LoadUInt16(const uint16_t* p) { return { _mm_cvtepi32_ps(LoadUInt16x4(p)) }; }
+	static SimdFloat4 LoadInt32(const int32_t* p) {
+		return { _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) };
+	}
+	static SimdFloat4 LoadHalf(const uint16_t* p) { return { HalfToFloat(LoadUInt16x4(p)) }; }
+	void StoreUInt16(uint16_t* p) const { StoreUInt16x4(_mm_cvtps_epi32(v), p); }
+	void StoreInt32(int32_t* p) const { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_cvtps_epi32(v)); }
+	void StoreHalf(uint16_t* p) const { StoreUInt16x4(FloatToHalf(v), p); }
+};
+
+inline SimdFloat4 operator+(SimdFloat4 a, SimdFloat4 b) { return { _mm_add_ps(a.v, b.v) }; }
+inline SimdFloat4 operator-(SimdFloat4 a, SimdFloat4 b) { return { _mm_sub_ps(a.v, b.v) }; }
+inline SimdFloat4 operator*(SimdFloat4 a, SimdFloat4 b) { return { _mm_mul_ps(a.v, b.v) }; }
+inline SimdFloat4 operator/(SimdFloat4 a, SimdFloat4 b) { return { _mm_div_ps(a.v, b.v) }; }
+inline SimdFloat4 MulAdd(SimdFloat4 a, SimdFloat4 b, SimdFloat4 c) {
+#if MT4_SIMD_FMA
+	return { _mm_fmadd_ps(a.v, b.v, c.v) };
+#else
+	return { _mm_add_ps(_mm_mul_ps(a.v, b.v), c.v) };
+#endif
+}
+inline SimdFloat4 Abs(SimdFloat4 a) { return { _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v) }; }
+inline SimdFloat4 Sqrt(SimdFloat4 a) { return { _mm_sqrt_ps(a.v) }; }
+inline SimdFloat4 ReciprocalSqrtEstimate(SimdFloat4 a) { return { _mm_rsqrt_ps(a.v) }; }
+// y * (1.5 - 0.5 * a * y^2) a * yを先に掛けてy^2のアンダーフローを避ける
+inline SimdFloat4 ReciprocalSqrt(SimdFloat4 a) {
+	const __m128 y = _mm_rsqrt_ps(a.v);
+	const __m128 halfAyy = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(a.v, y), y), _mm_set1_ps(0.5f));
+	return { _mm_mul_ps(y, _mm_sub_ps(_mm_set1_ps(1.5f), halfAyy)) };
+}
+inline SimdFloat4 ReciprocalEstimate(SimdFloat4 a) { return { _mm_rcp_ps(a.v) }; }
+// y * (2 - a * y)
+inline SimdFloat4 Reciprocal(SimdFloat4 a) {
+	const __m128 y = _mm_rcp_ps(a.v);
+	return { _mm_mul_ps(y, _mm_sub_ps(_mm_set1_ps(2.0f), _mm_mul_ps(a.v, y))) };
+}
+inline SimdFloat4 Min(SimdFloat4 a, SimdFloat4 b) { return { _mm_min_ps(a.v, b.v) }; }
+inline SimdFloat4 Max(SimdFloat4 a, SimdFloat4 b) { return { _mm_max_ps(a.v, b.v) }; }
+
+inline SimdFloat4 CompareLess(SimdFloat4 a, SimdFloat4 b) { return { _mm_cmplt_ps(a.v, b.v) }; }
+inline SimdFloat4 CompareLessEqual(SimdFloat4 a, SimdFloat4 b) { return { _mm_cmple_ps(a.v, b.v) }; }
+inline SimdFloat4 And(SimdFloat4 a, SimdFloat4 b) { return { _mm_and_ps(a.v, b.v) }; }
+inline SimdFloat4 Or(SimdFloat4 a, SimdFloat4 b) { return { _mm_or_ps(a.v, b.v) }; }
+inline SimdFloat4 Select(SimdFloat4 mask, SimdFloat4 a, SimdFloat4 b) {
+	return { _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)) };
+}
+inline int MoveMask(SimdFloat4 mask) { return _mm_movemask_ps(mask.v); }
+inline void StoreInterleaved(SimdFloat4 x, SimdFloat4 y, SimdFloat4 z, SimdFloat4 w, void* p) {
+	__m128 r0 = x.v, r1 = y.v, r2 = z.v, r3 = w.v;
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+	float* out = static_cast<float*>(p);
+	_mm_storeu_ps(out, r0);
+	_mm_storeu_ps(out + 4, r1);
+	_mm_storeu_ps(out + 8, r2);
+	_mm_storeu_ps(out + 12, r3);
+}
+// (x0 y0 z0 x1), (y1 z1 x2 y2), (z2 x3 y3 z3)の3回に分けて読み、シャッフルで並べ替える
+inline void LoadInterleaved(const void* p, SimdFloat4& x, SimdFloat4& y, SimdFloat4& z) {
+	const float* in = static_cast<const float*>(p);
+	const __m128 a = _mm_loadu_ps(in), b = _mm_loadu_ps(in + 4), c = _mm_loadu_ps(in + 8);
+	const __m128 x2y2y3x3 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 2, 3, 2));
+	const __m128 y0z0y1z1 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 2, 1));
+	x.v = _mm_shuffle_ps(a, x2y2y3x3, _MM_SHUFFLE(3, 0, 3, 0));
+	y.v = _mm_shuffle_ps(y0z0y1z1, x2y2y3x3, _MM_SHUFFLE(2, 1, 2, 0));
+	z.v = _mm_shuffle_ps(y0z0y1z1, c, _MM_SHUFFLE(3, 0, 3, 1));
+}
+inline void StoreInterleaved(SimdFloat4 x, SimdFloat4 y, SimdFloat4 z, void* p) {
+	const __m128 xy01 = _mm_unpacklo_ps(x.v, y.v); // (x0 y0 x1 y1)
+	const __m128 xy23 = _mm_unpackhi_ps(x.v, y.v); // (x2 y2 x3 y3)
+	const __m128 z0x1 = _mm_shuffle_ps(z.v, xy01, _MM_SHUFFLE(2, 2, 0, 0));
+	const __m128 y1z1 = _mm_shuffle_ps(y.v, z.v, _MM_SHUFFLE(1, 1, 1, 1));
+	const __m128 z2x3 = _mm_shuffle_ps(z.v, xy23, _MM_SHUFFLE(2, 2, 2, 2));
+	const __m128 y3z3 = _mm_shuffle_ps(xy23, z.v, _MM_SHUFFLE(3, 3, 3, 3));
+	float* out = static_cast<float*>(p);
+	_mm_storeu_ps(out, _mm_shuffle_ps(xy01, z0x1, _MM_SHUFFLE(2, 0, 1, 0)));
+	_mm_storeu_ps(out + 4, _mm_shuffle_ps(y1z1, xy23, _MM_SHUFFLE(1, 0, 2, 0)));
+	_mm_storeu_ps(out + 8, _mm_shuffle_ps(z2x3, y3z3, _MM_SHUFFLE(2, 0, 2, 0)));
+}
+#endif
+
+#if MT4_SIMD_AVX2
+inline __m256i FloatToHalf(__m256 value) {
+	const __m256i bits = _mm256_castps_si256(value);
+	const __m256i sign = _mm256_and_si256(bits, _mm256_set1_epi32(int(0x80000000u)));
+	const __m256i magnitude = _mm256_xor_si256(bits, sign);
+	const __m256i isFinite = _mm256_cmpgt_epi32(_mm256_set1_epi32((127 + 16) << 23), magnitude);
+	const __m256i isDenormal = _mm256_cmpgt_epi32(_mm256_set1_epi32((127 - 14) << 23), magnitude);
+	const __m256i infinityOrNaN = _mm256_or_si256(_mm256_set1_epi32(0x7C00),
+	    _mm256_and_si256(_mm256_cmpgt_epi32(magnitude, _mm256_set1_epi32(0x7F800000)), _mm256_set1_epi32(0x200)));
+	const __m256 magic = _mm256_castsi256_ps(_mm256_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23));
+	const __m256i denormal = _mm256_sub_epi32(
+	    _mm256_castps_si256(_mm256_add_ps(_mm256_castsi256_ps(magnitude), magic)), _mm256_castps_si256(magic));
+	const __m256i odd = _mm256_and_si256(_mm256_srli_epi32(magnitude, 13), _mm256_set1_epi32(1));
+	const __m256i normal = _mm256_srli_epi32(
+	    _mm256_add_epi32(_mm256_add_epi32(magnitude, _mm256_set1_epi32(0xFFF - ((127 - 15) << 23))), odd), 13);
+	const __m256i finite = _mm256_blendv_epi8(normal, denormal, isDenormal);
+	const __m256i half = _mm256_blendv_epi8(infinityOrNaN, finite, isFinite);
+	return _mm256_or_si256(half, _mm256_srli_epi32(sign, 16));
+}
+inline __m256 HalfToFloat(__m256i half) {
+	const __m256i magnitude = _mm256_and_si256(half, _mm256_set1_epi32(0x7FFF));
+	const __m256i sign = _mm256_slli_epi32(_mm256_xor_si256(half, magnitude), 16);
+	const __m256 value = _mm256_mul_ps(_mm256_castsi256_ps(_mm256_slli_epi32(magnitude, 13)),
+	    _mm256_castsi256_ps(_mm256_set1_epi32((254 - 15) << 23)));
+	const __m256i infinityOrNaN =
+	    _mm256_and_si256(_mm256_cmpgt_epi32(magnitude, _mm256_set1_epi32(0x7BFF)), _mm256_set1_epi32(255 << 23));
+	return _mm256_or_ps(value, _mm256_castsi256_ps(_mm256_or_si256(infinityOrNaN, sign)));
+}
+inline __m256i LoadUInt16x8(const uint16_t* p) {
+	return _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+}
+inline void StoreUInt16x8(__m256i values, uint16_t* p) {
+	// 128ビットごとに詰めてから、前半と後半の下位64ビットを並べる
+	const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(values, values), _MM_SHUFFLE(3, 1, 2, 0));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm256_castsi256_si128(packed));
+}
+
+// AVX2(8レーン)
+struct SimdFloat8 {
+	static constexpr size_t kWidth = 8;
+	__m256 v;
+
+	static SimdFloat8 Load(const float* p) { return { _mm256_loadu_ps(p) }; }
+	static SimdFloat8 Broadcast(float s) { return { _mm256_set1_ps(s) }; }
+	void Store(float* p) const { _mm256_storeu_ps(p, v); }
+
+	static SimdFloat8 LoadUInt16(const uint16_t* p) { return { _mm256_cvtepi32_ps(LoadUInt16x8(p)) }; }
+	static SimdFloat8 LoadInt32(const int32_t* p) {
+		return { _mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))) };
+	}
+	static SimdFloat8 LoadHalf(const uint16_t* p) { return { HalfToFloat(LoadUInt16x8(p)) }; }
+	void StoreUInt16(uint16_t* p) const { StoreUInt16x8(_mm256_cvtps_epi32(v), p); }
+	void StoreInt32(int32_t* p) const {
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(p), _mm256_cvtps_epi32(v));
+	}
+	void StoreHalf(uint16_t* p) const { StoreUInt16x8(FloatToHalf(v), p); }
+};
+
+inline SimdFloat8 operator+(SimdFloat8 a, SimdFloat8 b) { return { _mm256_add_ps(a.v, b.v) }; }
+inline SimdFloat8 operator-(SimdFloat8 a, SimdFloat8 b) { return { _mm256_sub_ps(a.v, b.v) }; }
+inline SimdFloat8 operator*(SimdFloat8 a, SimdFloat8 b) { return { _mm256_mul_ps(a.v, b.v) }; }
+inline SimdFloat8 operator/(SimdFloat8 a, SimdFloat8 b) { return { _mm256_div_ps(a.v, b.v) }; }
+inline SimdFloat8 MulAdd(SimdFloat8 a, SimdFloat8 b, SimdFloat8 c) { return { _mm256_fmadd_ps(a.v, b.v, c.v) }; }
+inline SimdFloat8 Abs(SimdFloat8 a) { return { _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v) }; }
+inline SimdFloat8 Sqrt(SimdFloat8 a) { return { _mm256_sqrt_ps(a.v) }; }
+inline SimdFloat8 ReciprocalSqrtEstimate(SimdFloat8 a) { return { _mm256_rsqrt_ps(a.v) }; }
+// y + 0.5 * y * (1 - a * y^2) 残差をFMAで求めて丸めを減らす
+inline SimdFloat8 ReciprocalSqrt(SimdFloat8 a) {
+	const __m256 y = _mm256_rsqrt_ps(a.v);
+	const __m256 residual = _mm256_fnmadd_ps(_mm256_mul_ps(a.v, y), y, _mm256_set1_ps(1.0f));
+	return { _mm256_fmadd_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), y), residual, y) };
+}
+inline SimdFloat8 ReciprocalEstimate(SimdFloat8 a) { return { _mm256_rcp_ps(a.v) }; }
+// y + y * (1 - a * y)
+inline SimdFloat8 Reciprocal(SimdFloat8 a) {
+	const __m256 y = _mm256_rcp_ps(a.v);
+	return { _mm256_fmadd_ps(y, _mm256_fnmadd_ps(a.v, y, _mm256_set1_ps(1.0f)), y) };
+}
+inline SimdFloat8 Min(SimdFloat8 a, SimdFloat8 b) { return { _mm256_min_ps(a.v, b.v) }; }
+inline SimdFloat8 Max(SimdFloat8 a, SimdFloat8 b) { return { _mm256_max_ps(a.v, b.v) }; }
+
+inline SimdFloat8 CompareLess(SimdFloat8 a, SimdFloat8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ) }; }
+inline SimdFloat8 CompareLessEqual(SimdFloat8 a, SimdFloat8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ) }; }
+inline SimdFloat8 And(SimdFloat8 a, SimdFloat8 b) { return { _mm256_and_ps(a.v, b.v) }; }
+inline SimdFloat8 Or(SimdFloat8 a, SimdFloat8 b) { return { _mm256_or_ps(a.v, b.v) }; }
+inline SimdFloat8 Select(SimdFloat8 mask, SimdFloat8 a, SimdFloat8 b) { return { _mm256_blendv_ps(b.v, a.v, mask.v) }; }
+inline int MoveMask(SimdFloat8 mask) { return _mm256_movemask_ps(mask.v); }
+// 128ビットごとに4x4の転置をしてから、前半と後半の要素を並べ替える
+inline void StoreInterleaved(SimdFloat8 x, SimdFloat8 y, SimdFloat8 z, SimdFloat8 w, void* p) {
+	const __m256 xy0 = _mm256_unpacklo_ps(x.v, y.v), xy1 = _mm256_unpackhi_ps(x.v, y.v);
+	const __m256 zw0 = _mm256_unpacklo_ps(z.v, w.v), zw1 = _mm256_unpackhi_ps(z.v, w.v);
+	const __m256 v04 = _mm256_shuffle_ps(xy0, zw0, _MM_SHUFFLE(1, 0, 1, 0));
+	const __m256 v15 = _mm256_shuffle_ps(xy0, zw0, _MM_SHUFFLE(3, 2, 3, 2));
+	const __m256 v26 = _mm256_shuffle_ps(xy1, zw1, _MM_SHUFFLE(1, 0, 1, 0));
+	const __m256 v37 = _mm256_shuffle_ps(xy1, zw1, _MM_SHUFFLE(3, 2, 3, 2));
+	float* out = static_cast<float*>(p);
+	_mm256_storeu_ps(out, _mm256_permute2f128_ps(v04, v15, 0x20));
+	_mm256_storeu_ps(out + 8, _mm256_permute2f128_ps(v26, v37, 0x20));
+	_mm256_storeu_ps(out + 16, _mm256_permute2f128_ps(v04, v15, 0x31));
+	_mm256_storeu_ps(out + 24, _mm256_permute2f128_ps(v26, v37, 0x31));
+}
+// 3回読んで前半128ビットに0～3番目、後半に4～7番目の構造体を集め、128ビットごとにSimdFloat4と同じシャッフルをする
+inline void LoadInterleaved(const void* p, SimdFloat8& x, SimdFloat8& y, SimdFloat8& z) {
+	const float* in = static_cast<const float*>(p);
+	const __m256 m03 = _mm256_loadu_ps(in), m14 = _mm256_loadu_ps(in + 8), m25 = _mm256_loadu_ps(in + 16);
+	const __m256 a = _mm256_blend_ps(m03, m14, 0xF0);          // (in[0..3] in[12..15])
+	const __m256 b = _mm256_permute2f128_ps(m03, m25, 0x21); // (in[4..7] in[16..19])
+	const __m256 c = _mm256_blend_ps(m14, m25, 0xF0);          // (in[8..11] in[20..23])
+	const __m256 x2y2y3x3 = _mm256_shuffle_ps(b, c, _MM_SHUFFLE(1, 2, 3, 2));
+	const __m256 y0z0y1z1 = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 2, 1));
+	x.v = _mm256_shuffle_ps(a, x2y2y3x3, _MM_SHUFFLE(3, 0, 3, 0));
+	y.v = _mm256_shuffle_ps(y0z0y1z1, x2y2y3x3, _MM_SHUFFLE(2, 1, 2, 0));
+	z.v = _mm256_shuffle_ps(y0z0y1z1, c, _MM_SHUFFLE(3, 0, 3, 1));
+}
+inline void StoreInterleaved(SimdFloat8 x, SimdFloat8 y, SimdFloat8 z, void* p) {
+	const __m256 xy01 = _mm256_unpacklo_ps(x.v, y.v);
+	const __m256 xy23 = _mm256_unpackhi_ps(x.v, y.v);
+	const __m256 z0x1 = _mm256_shuffle_ps(z.v, xy01, _MM_SHUFFLE(2, 2, 0, 0));
+	const __m256 y1z1 = _mm256_shuffle_ps(y.v, z.v, _MM_SHUFFLE(1, 1, 1, 1));
+	const __m256 z2x3 = _mm256_shuffle_ps(z.v, xy23, _MM_SHUFFLE(2, 2, 2, 2));
+	const __m256 y3z3 = _mm256_shuffle_ps(xy23, z.v, _MM_SHUFFLE(3, 3, 3, 3));
+	const __m256 a = _mm256_shuffle_ps(xy01, z0x1, _MM_SHUFFLE(2, 0, 1, 0));
+	const __m256 b = _mm256_shuffle_ps(y1z1, xy23, _MM_SHUFFLE(1, 0, 2, 0));
+	const __m256 c = _mm256_shuffle_ps(z2x3, y3z3, _MM_SHUFFLE(2, 0, 2, 0));
+	float* out = static_cast<float*>(p);
+	_mm256_storeu_ps(out, _mm256_permute2f128_ps(a, b, 0x20));
+	_mm256_storeu_ps(out + 8, _mm256_blend_ps(c, a, 0xF0));
+	_mm256_storeu_ps(out + 16, _mm256_permute2f128_ps(b, c, 0x31));
+}
+#endif
+
+} // namespace
@@ -0,0 +1,157 @@
+#pragma once
+
+// 行列の積の遅延評価
+// Lazy(world) * Lazy(view) * Lazy(projection) のように積の式を作り、
+// Evaluateで行列に、Transform/TransformNormalでベクトルに直接適用する
+// 途中の行列は作らず、行ベクトルに左の行列から順に掛けていく
+//
+// 1つのベクトルにだけ使う積はTransformで直接適用するのが速い
+// 多数のベクトルに同じ積を使うときはEvaluateで一度だけ行列にする
+// 一般の行列同士だけの積を行列にするならMultiply(命令セット別のカーネル)の方が速い
+// 式は行列を参照で持つので、作った文の中で評価すること
+
+#include <cassert>
+#include <concepts>
+#include "Matrix4x4.h"
+#include "Vector3.h"
+#include "Vector4.h"
+
+// 遅延評価できる行列の式
+// MultiplyRow: 行ベクトルに右から掛ける  GetRow: i行目
+// kAffine: 4列目が(0,0,0,1)であることが型から分かる
+template<class T>
+concept LazyMatrixExpression = requires(const T& expression, const Vector4& row, int i) {
+	{ expression.MultiplyRow(row) } -> std::same_as<Vector4>;
+	{ expression.GetRow(i) } -> std::same_as<Vector4>;
+	{ T::kAffine } -> std::convertible_to<bool>;
+};
+
+// 一般の行列
+struct LazyMatrix final {
+	static constexpr bool kAffine = false;
+	const Matrix4x4* matrix;
+
+	constexpr Vector4 MultiplyRow(const Vector4& v) const {
+		const Matrix4x4& m = *matrix;
+		return Vector4{
+		    v.x * m.m[0][0] + v.y * m.m[1][0] + v.z * m.m[2][0] + v.w * m.m[3][0],
+		    v.x * m.m[0][1] + v.y * m.m[1][1] + v.z * m.m[2][1] + v.w * m.m[3][1],
+		    v.x * m.m[0][2] + v.y * m.m[1][2] + v.z * m.m[2][2] + v.w * m.m[3][2],
+		    v.x * m.m[0][3] + v.y * m.m[1][3] + v.z * m.m[2][3] + v.w * m.m[3][3] };
+	}
+	constexpr Vector4 GetRow(int i) const {
+		const Matrix4x4& m = *matrix;
+		return Vector4{ m.m[i][0], m.m[i][1], m.m[i][2], m.m[i][3] };
+	}
+};
+
+// 拡大縮小行列(対角成分だけ掛ける)
+struct LazyScaleMatrix final {
+	static constexpr bool kAffine = true;
+	Vector3 scale;
+
+	constexpr Vector4 MultiplyRow(const Vector4& v) const {
+		return Vector4{ v.x * scale.x, v.y * scale.y, v.z * scale.z, v.w };
+	}
+	constexpr Vector4 GetRow(int i) const {
+		switch (i) {
+		case 0:
+			return Vector4{ scale.x, 0.0f, 0.0f, 0.0f };
+		case 1:
+			return Vector4{ 0.0f, scale.y, 0.0f, 0.0f };
+		case 2:
+			return Vector4{ 0.0f, 0.0f, scale.z, 0.0f };
+		default:
+			return Vector4{ 0.0f, 0.0f, 0.0f, 1.0f };
+		}
+	}
+};
+
+// 平行移動行列(wに比例した移動量を足すだけ)
+struct LazyTranslateMatrix final {
+	static constexpr bool kAffine = true;
+	Vector3 translate;
+
+	constexpr Vector4 MultiplyRow(const Vector4& v) const {
+		return Vector4{ v.x + v.w * translate.x, v.y + v.w * translate.y, v.z + v.w * translate.z, v.w };
+	}
+	constexpr Vector4 GetRow(int i) const {
+		switch (i) {
+		case 0:
+			return Vector4{ 1.0f, 0.0f, 0.0f, 0.0f };
+		case 1:
+			return Vector4{ 0.0f, 1.0f, 0.0f, 0.0f };
+		case 2:
+			return Vector4{ 0.0f, 0.0f, 1.0f, 0.0f };
+		default:
+			return Vector4{ translate.x, translate.y, translate.z, 1.0f };
+		}
+	}
+};
+
+// 積 left * right
+template<LazyMatrixExpression Left, LazyMatrixExpression Right>
+struct LazyProduct final {
+	static constexpr bool kAffine = Left::kAffine && Right::kAffine;
+	Left left;
+	Right right;
+
+	constexpr Vector4 MultiplyRow(const Vector4& v) const { return right.MultiplyRow(left.MultiplyRow(v)); }
+	constexpr Vector4 GetRow(int i) const { return right.MultiplyRow(left.GetRow(i)); }
+};
+
+// 式の作成
+constexpr LazyMatrix Lazy(const Matrix4x4& m) { return LazyMatrix{ &m }; }
+// 一時オブジェクトの行列は式より先に破棄されるので受け付けない
+LazyMatrix Lazy(const Matrix4x4&&) = delete;
+constexpr LazyScaleMatrix LazyScale(const Vector3& scale) { return LazyScaleMatrix{ scale }; }
+constexpr LazyTranslateMatrix LazyTranslate(const Vector3& translate) { return LazyTranslateMatrix{ translate }; }
+
+template<LazyMatrixExpression Left, LazyMatrixExpression Right>
+constexpr LazyProduct<Left, Right> operator*(const Left& left, const Right& right) {
+	return LazyProduct<Left, Right>{ left, right };
+}
+// 拡大縮小同士・平行移動同士はその場でまとめる
+constexpr LazyScaleMatrix operator*(const LazyScaleMatrix& left, const LazyScaleMatrix& right) {
+	return LazyScaleMatrix{ Vector3{
+	    left.scale.x * right.scale.x, left.scale.y * right.scale.y, left.scale.z * right.scale.z } };
+}
+constexpr LazyTranslateMatrix operator*(const LazyTranslateMatrix& left, const LazyTranslateMatrix& right) {
+	return LazyTranslateMatrix{ Vector3{
+	    left.translate.x + right.translate.x, left.translate.y + right.translate.y,
+	    left.translate.z + right.translate.z } };
+}
+
+// 式を行列にする
+template<LazyMatrixExpression Expression>
+constexpr Matrix4x4 Evaluate(const Expression& expression) {
+	Matrix4x4 result{};
+	for (int i = 0; i < 4; i++) {
+		const Vector4 row = expression.GetRow(i);
+		result.m[i][0] = row.x;
+		result.m[i][1] = row.y;
+		result.m[i][2] = row.z;
+		result.m[i][3] = row.w;
+	}
+	return result;
+}
+
+// 座標変換(アフィンと分かっている式はw除算を省略する)
+template<LazyMatrixExpression Expression>
+constexpr Vector3 Transform(const Vector3& vector, const Expression& expression) {
+	const Vector4 result = expression.MultiplyRow(Vector4{ vector.x, vector.y, vector.z, 1.0f });
+	if constexpr (Expression::kAffine) {
+		return Vector3{ result.x, result.y, result.z };
+	}
+	else {
+		assert(result.w != 0.0f);
+		return Vector3{ result.x / result.w, result.y / result.w, result.z / result.w };
+	}
+}
+
+// ベクトル変換(平行移動を含めない)
+template<LazyMatrixExpression Expression>
+constexpr Vector3 TransformNormal(const Vector3& v, const Expression& expression) {
+	const Vector4 result = expression.MultiplyRow(Vector4{ v.x, v.y, v.z, 0.0f });
+	return Vector3{ result.x, result.y, result.z };
+}
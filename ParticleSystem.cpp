@@ -0,0 +1,97 @@
+#include "ParticleSystem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include "JobSystem.h"
+#include "MathKernel.h"
+#include "SimdDispatch.h"
+
+namespace {
+
+// JobSystemで粒子を分けるときの1区間の最小の粒子数
+const size_t kParallelMinParticles = 2048;
+
+Vector3SoA Offset(const Vector3SoA& soa, size_t i) { return { soa.x + i, soa.y + i, soa.z + i }; }
+
+} // namespace
+
+ParticleSystem::ParticleSystem(size_t capacity)
+    : positionX_(capacity), positionY_(capacity), positionZ_(capacity), velocityX_(capacity), velocityY_(capacity),
+      velocityZ_(capacity), lifetimes_(capacity) {}
+
+size_t ParticleSystem::Emit(const Vector3& position, const Vector3& velocity, float lifetime) {
+	if (count_ == GetCapacity()) {
+		return 0;
+	}
+	positionX_[count_] = position.x;
+	positionY_[count_] = position.y;
+	positionZ_[count_] = position.z;
+	velocityX_[count_] = velocity.x;
+	velocityY_[count_] = velocity.y;
+	velocityZ_[count_] = velocity.z;
+	lifetimes_[count_] = lifetime;
+	count_++;
+	return 1;
+}
+
+size_t ParticleSystem::Emit(
+    const ConstVector3SoA& positions, const ConstVector3SoA& velocities, const float* lifetimes, size_t count) {
+	const size_t emitted = std::min(count, GetCapacity() - count_);
+	std::copy_n(positions.x, emitted, positionX_.begin() + count_);
+	std::copy_n(positions.y, emitted, positionY_.begin() + count_);
+	std::copy_n(positions.z, emitted, positionZ_.begin() + count_);
+	std::copy_n(velocities.x, emitted, velocityX_.begin() + count_);
+	std::copy_n(velocities.y, emitted, velocityY_.begin() + count_);
+	std::copy_n(velocities.z, emitted, velocityZ_.begin() + count_);
+	std::copy_n(lifetimes, emitted, lifetimes_.begin() + count_);
+	count_ += emitted;
+	return emitted;
+}
+
+void ParticleSystem::Kill(size_t index) {
+	assert(index < count_);
+	count_--;
+	Move(count_, index);
+}
+
+void ParticleSystem::Move(size_t from, size_t to) {
+	positionX_[to] = positionX_[from];
+	positionY_[to] = positionY_[from];
+	positionZ_[to] = positionZ_[from];
+	velocityX_[to] = velocityX_[from];
+	velocityY_[to] = velocityY_[from];
+	velocityZ_[to] = velocityZ_[from];
+	lifetimes_[to] = lifetimes_[from];
+}
+
+// 積分は区間に分けて並列に、詰める処理は呼び出したスレッドで行う
+// 寿命が尽きた粒子がなければ詰める処理を省く
+void ParticleSystem::Update(float deltaTime) {
+	static const auto kernel = MT4_SELECT_SIMD_KERNEL(IntegrateParticles);
+	const Vector3SoA positions{ positionX_.data(), positionY_.data(), positionZ_.data() };
+	const Vector3SoA velocities{ velocityX_.data(), velocityY_.data(), velocityZ_.data() };
+	const float damping = std::exp(-drag_ * deltaTime);
+	std::atomic<size_t> expired = 0;
+	JobSystem::GetInstance().ParallelFor(count_, kParallelMinParticles, [&](size_t begin, size_t end) {
+		const size_t n = kernel(Offset(positions, begin), Offset(velocities, begin), lifetimes_.data() + begin,
+		    end - begin, gravity_, damping, deltaTime);
+		if (n != 0) {
+			expired.fetch_add(n, std::memory_order_relaxed);
+		}
+	});
+	if (expired.load(std::memory_order_relaxed) != 0) {
+		RemoveExpired();
+	}
+}
+
+// 見つけた粒子の位置に末尾の粒子を写し、写した粒子も尽きていればもう一度調べる
+void ParticleSystem::RemoveExpired() {
+	static const auto find = MT4_SELECT_SIMD_KERNEL(FindExpiredParticle);
+	size_t i = 0;
+	while ((i = find(lifetimes_.data(), i, count_)) < count_) {
+		count_--;
+		Move(count_, i);
+	}
+}
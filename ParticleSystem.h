@@ -0,0 +1,61 @@
+#pragma once
+
+// パーティクル(SoA)
+// 座標・速度・残りの寿命を成分ごとの配列で持ち、容量分を作成時に確保する(フレームごとの確保はしない)
+// Updateで重力・空気抵抗・速度を一括で積分し、寿命が尽きた粒子は末尾の粒子と入れ替えて詰める
+// 生きている粒子は常に[0, GetCount())に詰まっているので、GetPositions()をそのままTransformや
+// VertexPipeline::Transformに渡せる(入れ替えで並び順は変わる)
+
+#include <cstddef>
+#include <vector>
+#include "Vector3.h"
+#include "Vector3SoA.h"
+
+class ParticleSystem {
+public:
+	explicit ParticleSystem(size_t capacity);
+
+	// 粒子を追加する 容量を超える分は捨て、追加した数を返す
+	size_t Emit(const Vector3& position, const Vector3& velocity, float lifetime);
+	size_t Emit(const ConstVector3SoA& positions, const ConstVector3SoA& velocities, const float* lifetimes, size_t count);
+	// index番目の粒子を取り除く(末尾の粒子がindex番目に移る)
+	void Kill(size_t index);
+	// すべて取り除く
+	void Clear() { count_ = 0; }
+
+	// 重力加速度(既定は0)
+	void SetGravity(const Vector3& gravity) { gravity_ = gravity; }
+	// 空気抵抗の係数(1秒あたりの減衰率 dv/dt = -drag * v 既定は0)
+	void SetDrag(float drag) { drag_ = drag; }
+
+	// deltaTime秒進める(半陰的オイラー法) 寿命が尽きた粒子を取り除く
+	// v = (v + dt * gravity) * exp(-drag * dt), p = p + dt * v
+	void Update(float deltaTime);
+
+	size_t GetCount() const { return count_; }
+	size_t GetCapacity() const { return positionX_.size(); }
+	const Vector3& GetGravity() const { return gravity_; }
+	float GetDrag() const { return drag_; }
+	// 生きている粒子([0, GetCount()))
+	ConstVector3SoA GetPositions() const { return { positionX_.data(), positionY_.data(), positionZ_.data() }; }
+	ConstVector3SoA GetVelocities() const { return { velocityX_.data(), velocityY_.data(), velocityZ_.data() }; }
+	const float* GetLifetimes() const { return lifetimes_.data(); }
+	Vector3 GetPosition(size_t index) const { return { positionX_[index], positionY_[index], positionZ_[index] }; }
+	Vector3 GetVelocity(size_t index) const { return { velocityX_[index], velocityY_[index], velocityZ_[index] }; }
+	// 書き換え用(衝突の応答など) 範囲は[0, GetCount())
+	Vector3SoA GetPositions() { return { positionX_.data(), positionY_.data(), positionZ_.data() }; }
+	Vector3SoA GetVelocities() { return { velocityX_.data(), velocityY_.data(), velocityZ_.data() }; }
+
+private:
+	// from番目の粒子をto番目に写す
+	void Move(size_t from, size_t to);
+	// 寿命が尽きた粒子を末尾の粒子と入れ替えて詰める
+	void RemoveExpired();
+
+	std::vector<float> positionX_, positionY_, positionZ_;
+	std::vector<float> velocityX_, velocityY_, velocityZ_;
+	std::vector<float> lifetimes_; // 残りの寿命(秒)
+	size_t count_ = 0;
+	Vector3 gravity_{};
+	float drag_ = 0.0f;
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+// 図形
+
+#include "Vector3.h"
+
+// 球
+struct Sphere final {
+	Vector3 center;
+	float radius;
+};
+
+// 軸平行境界箱
+struct AABB final {
+	Vector3 min;
+	Vector3 max;
+};
+
+// 平面 Dot(normal, p) == distanceとなる点pの集合(normalは正規化済み)
+struct Plane final {
+	Vector3 normal;
+	float distance;
+};
+
+// 線分 origin + t * diff (0 <= t <= 1)
+struct Segment final {
+	Vector3 origin;
+	Vector3 diff;
+};
+
+// 半直線 origin + t * diff (t >= 0)
+struct Ray final {
+	Vector3 origin;
+	Vector3 diff;
+};
+
+// 三角形
+struct Triangle final {
+	Vector3 vertices[3];
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+// 球の列(SoA形式)
+struct SphereSoA final {
+	float* x;
+	float* y;
+	float* z;
+	float* radius;
+};
+
+// 球の列(SoA形式・読み取り専用)
+struct ConstSphereSoA final {
+	const float* x;
+	const float* y;
+	const float* z;
+	const float* radius;
+
+	ConstSphereSoA() = default;
+	ConstSphereSoA(const float* xs, const float* ys, const float* zs, const float* radii)
+	    : x(xs), y(ys), z(zs), radius(radii) {}
+	ConstSphereSoA(const SphereSoA& soa) : x(soa.x), y(soa.y), z(soa.z), radius(soa.radius) {}
+};
+
+// 軸平行境界箱の列(SoA形式)
+struct AABBSoA final {
+	float* minX;
+	float* minY;
+	float* minZ;
+	float* maxX;
+	float* maxY;
+	float* maxZ;
+};
+
+// 軸平行境界箱の列(SoA形式・読み取り専用)
+struct ConstAABBSoA final {
+	const float* minX;
+	const float* minY;
+	const float* minZ;
+	const float* maxX;
+	const float* maxY;
+	const float* maxZ;
+
+	ConstAABBSoA() = default;
+	ConstAABBSoA(const float* minXs, const float* minYs, const float* minZs,
+	    const float* maxXs, const float* maxYs, const float* maxZs)
+	    : minX(minXs), minY(minYs), minZ(minZs), maxX(maxXs), maxY(maxYs), maxZ(maxZs) {}
+	ConstAABBSoA(const AABBSoA& soa)
+	    : minX(soa.minX), minY(soa.minY), minZ(soa.minZ), maxX(soa.maxX), maxY(soa.maxY), maxZ(soa.maxZ) {}
+};
+
+// 半直線の列(SoA形式)
+struct RaySoA final {
+	float* originX;
+	float* originY;
+	float* originZ;
+	float* diffX;
+	float* diffY;
+	float* diffZ;
+};
+
+// 半直線の列(SoA形式・読み取り専用)
+struct ConstRaySoA final {
+	const float* originX;
+	const float* originY;
+	const float* originZ;
+	const float* diffX;
+	const float* diffY;
+	const float* diffZ;
+
+	ConstRaySoA() = default;
+	ConstRaySoA(const float* originXs, const float* originYs, const float* originZs,
+	    const float* diffXs, const float* diffYs, const float* diffZs)
+	    : originX(originXs), originY(originYs), originZ(originZs), diffX(diffXs), diffY(diffYs), diffZ(diffZs) {}
+	ConstRaySoA(const RaySoA& soa)
+	    : originX(soa.originX), originY(soa.originY), originZ(soa.originZ),
+	      diffX(soa.diffX), diffY(soa.diffY), diffZ(soa.diffZ) {}
+};
@@ -0,0 +1,290 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// タイムスタンプカウンタが読めるか
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define MT4_PROFILE_HAS_CYCLE_COUNTER 1
+#else
+#define MT4_PROFILE_HAS_CYCLE_COUNTER 0
+#endif
+
+namespace {
+
+constexpr size_t kFunctionCount = size_t(ProfileFunction::kCount);
+
+const char* const kFunctionNames[kFunctionCount] = {
+	"Multiply",
+	"Multiply (batch)",
+	"Inverse",
+	"Inverse (batch)",
+	"InverseAffine",
+	"InverseRigid",
+	"Transform",
+	"Transform (batch)",
+	"MakeAffineMatrix",
+	"MakeAffineMatrix (batch)",
+};
+
+// 関数1つ分の合計
+struct Totals {
+	uint64_t calls;
+	uint64_t elements;
+	uint64_t ticks;
+	uint64_t histogram[kProfileHistogramBucketCount];
+};
+
+// スレッドごとのカウンタ
+// 書き込むのは持ち主のスレッドだけなので、不可分な加算は使わずに読んで足して書く
+// まとめる側は前回読んだ値との差を取る(カウンタは減らさない)
+struct ThreadCounters {
+	struct Counter {
+		std::atomic<uint64_t> calls{ 0 };
+		std::atomic<uint64_t> elements{ 0 };
+		std::atomic<uint64_t> ticks{ 0 };
+		std::atomic<uint64_t> histogram[kProfileHistogramBucketCount] = {};
+	};
+	Counter counters[kFunctionCount];
+	Totals reported[kFunctionCount] = {}; // 前回まとめたときの値(Registryのmutexで守る)
+
+	ThreadCounters();
+	~ThreadCounters();
+};
+
+// 全スレッドのカウンタの一覧
+struct Registry {
+	std::mutex mutex;
+	std::vector<ThreadCounters*> threads;
+	Totals retired[kFunctionCount] = {}; // 終了したスレッドのまだまとめていない分
+	uint64_t frame = 0;
+	// ticksをナノ秒に換算するための基準
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	uint64_t startTicks = ReadProfileTicks();
+	std::chrono::steady_clock::time_point frameStartTime = startTime;
+};
+
+Registry& GetRegistry() {
+	static Registry registry;
+	return registry;
+}
+
+void Add(std::atomic<uint64_t>& counter, uint64_t value) {
+	counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+// 前回からの増分をtotalsに足し、今回の値を覚える
+void Collect(ThreadCounters& thread, Totals* totals) {
+	for (size_t f = 0; f < kFunctionCount; f++) {
+		const ThreadCounters::Counter& counter = thread.counters[f];
+		Totals& reported = thread.reported[f];
+		const auto collect = [](const std::atomic<uint64_t>& value, uint64_t& last, uint64_t& total) {
+			const uint64_t current = value.load(std::memory_order_relaxed);
+			total += current - last;
+			last = current;
+		};
+		collect(counter.calls, reported.calls, totals[f].calls);
+		collect(counter.elements, reported.elements, totals[f].elements);
+		collect(counter.ticks, reported.ticks, totals[f].ticks);
+		for (size_t b = 0; b < kProfileHistogramBucketCount; b++) {
+			collect(counter.histogram[b], reported.histogram[b], totals[f].histogram[b]);
+		}
+	}
+}
+
+ThreadCounters::ThreadCounters() {
+	Registry& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	registry.threads.push_back(this);
+}
+
+ThreadCounters::~ThreadCounters() {
+	Registry& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	Collect(*this, registry.retired);
+	registry.threads.erase(std::find(registry.threads.begin(), registry.threads.end(), this));
+}
+
+// 区間の範囲[min, max] 最後の区間のmaxは0(上限なし)
+size_t GetBucketMin(size_t bucket) { return bucket == 0 ? 0 : size_t(1) << (bucket - 1); }
+size_t GetBucketMax(size_t bucket) {
+	return bucket == 0 ? 0 : bucket + 1 == kProfileHistogramBucketCount ? 0 : (size_t(1) << bucket) - 1;
+}
+
+void Append(std::string& text, const char* format, ...) {
+	char buffer[256];
+	va_list args;
+	va_start(args, format);
+	const int length = std::vsnprintf(buffer, sizeof(buffer), format, args);
+	va_end(args);
+	if (length > 0) {
+		text.append(buffer, std::min<size_t>(size_t(length), sizeof(buffer) - 1));
+	}
+}
+
+} // namespace
+
+const char* GetProfileFunctionName(ProfileFunction function) { return kFunctionNames[size_t(function)]; }
+
+size_t GetProfileHistogramBucket(size_t count) {
+	return std::min<size_t>(std::bit_width(count), kProfileHistogramBucketCount - 1);
+}
+
+uint64_t ReadProfileTicks() {
+#if MT4_PROFILE_HAS_CYCLE_COUNTER
+	return __rdtsc();
+#else
+	return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+	    std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+void RecordProfile(ProfileFunction function, size_t count, uint64_t ticks) {
+	thread_local ThreadCounters thread;
+	ThreadCounters::Counter& counter = thread.counters[size_t(function)];
+	Add(counter.calls, 1);
+	Add(counter.elements, count);
+	Add(counter.ticks, ticks);
+	Add(counter.histogram[GetProfileHistogramBucket(count)], 1);
+}
+
+ProfileReport EndProfileFrame() {
+	Registry& registry = GetRegistry();
+	Totals totals[kFunctionCount] = {};
+	ProfileReport report{};
+	{
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		std::copy(registry.retired, registry.retired + kFunctionCount, totals);
+		std::fill(registry.retired, registry.retired + kFunctionCount, Totals{});
+		for (ThreadCounters* thread : registry.threads) {
+			Collect(*thread, totals);
+		}
+		const auto now = std::chrono::steady_clock::now();
+		report.frame = registry.frame++;
+		report.frameNanoseconds = std::chrono::duration<double, std::nano>(now - registry.frameStartTime).count();
+		registry.frameStartTime = now;
+	}
+
+	// 計測を始めてからの経過時間でticksとナノ秒の比を求める
+	double nanosecondsPerTick = 1.0;
+#if MT4_PROFILE_HAS_CYCLE_COUNTER
+	const double elapsed =
+	    std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - registry.startTime).count();
+	const uint64_t elapsedTicks = ReadProfileTicks() - registry.startTicks;
+	if (elapsedTicks > 0) {
+		nanosecondsPerTick = elapsed / double(elapsedTicks);
+	}
+#endif
+	for (size_t f = 0; f < kFunctionCount; f++) {
+		ProfileEntry& entry = report.entries[f];
+		entry.name = kFunctionNames[f];
+		entry.calls = totals[f].calls;
+		entry.elements = totals[f].elements;
+		entry.nanoseconds = double(totals[f].ticks) * nanosecondsPerTick;
+		std::copy(totals[f].histogram, totals[f].histogram + kProfileHistogramBucketCount, entry.histogram);
+	}
+	return report;
+}
+
+std::string FormatProfileText(const ProfileReport& report) {
+	std::string text;
+	Append(text, "frame %llu  %.3f ms%s\n", static_cast<unsigned long long>(report.frame),
+	    report.frameNanoseconds * 1e-6, IsProfilingEnabled() ? "" : "  (profiling disabled)");
+	Append(text, "%-26s %10s %12s %12s %10s %10s %7s\n", "function", "calls", "elements", "total us", "ns/call",
+	    "ns/elem", "frame%");
+
+	// 時間の長い順(回数だけ数える関数は回数の多い順で後ろ)
+	std::vector<const ProfileEntry*> entries;
+	for (const ProfileEntry& entry : report.entries) {
+		if (entry.calls > 0) {
+			entries.push_back(&entry);
+		}
+	}
+	std::stable_sort(entries.begin(), entries.end(), [](const ProfileEntry* a, const ProfileEntry* b) {
+		if (a->nanoseconds != b->nanoseconds) {
+			return a->nanoseconds > b->nanoseconds;
+		}
+		return a->calls > b->calls;
+	});
+	for (const ProfileEntry* entry : entries) {
+		if (entry->nanoseconds > 0.0) {
+			Append(text, "%-26s %10llu %12llu %12.1f %10.1f %10.2f %6.1f%%\n", entry->name,
+			    static_cast<unsigned long long>(entry->calls), static_cast<unsigned long long>(entry->elements),
+			    entry->nanoseconds * 1e-3, entry->nanoseconds / double(entry->calls),
+			    entry->nanoseconds / double(std::max<uint64_t>(entry->elements, 1)),
+			    report.frameNanoseconds > 0.0 ? entry->nanoseconds / report.frameNanoseconds * 100.0 : 0.0);
+		}
+		else {
+			Append(text, "%-26s %10llu %12llu %12s %10s %10s %7s\n", entry->name,
+			    static_cast<unsigned long long>(entry->calls), static_cast<unsigned long long>(entry->elements), "-",
+			    "-", "-", "-");
+		}
+	}
+
+	// 要素数の分布
+	for (const ProfileEntry* entry : entries) {
+		if (entry->elements == entry->calls && entry->histogram[1] == entry->calls) {
+			continue; // 1個ずつの関数
+		}
+		Append(text, "  %s elements per call:", entry->name);
+		for (size_t b = 0; b < kProfileHistogramBucketCount; b++) {
+			if (entry->histogram[b] == 0) {
+				continue;
+			}
+			const size_t min = GetBucketMin(b);
+			const size_t max = GetBucketMax(b);
+			if (b + 1 == kProfileHistogramBucketCount) {
+				Append(text, " %zu+:%llu", min, static_cast<unsigned long long>(entry->histogram[b]));
+			}
+			else if (min == max) {
+				Append(text, " %zu:%llu", min, static_cast<unsigned long long>(entry->histogram[b]));
+			}
+			else {
+				Append(text, " %zu-%zu:%llu", min, max, static_cast<unsigned long long>(entry->histogram[b]));
+			}
+		}
+		text += '\n';
+	}
+	return text;
+}
+
+std::string FormatProfileJson(const ProfileReport& report) {
+	std::string json;
+	Append(json, "{\"frame\": %llu, \"frame_nanoseconds\": %.1f, \"functions\": [",
+	    static_cast<unsigned long long>(report.frame), report.frameNanoseconds);
+	for (size_t f = 0; f < kFunctionCount; f++) {
+		const ProfileEntry& entry = report.entries[f];
+		Append(json, "%s{\"name\": \"%s\", \"calls\": %llu, \"elements\": %llu, \"nanoseconds\": %.1f, \"histogram\": [",
+		    f > 0 ? ", " : "", entry.name, static_cast<unsigned long long>(entry.calls),
+		    static_cast<unsigned long long>(entry.elements), entry.nanoseconds);
+		bool first = true;
+		for (size_t b = 0; b < kProfileHistogramBucketCount; b++) {
+			if (entry.histogram[b] == 0) {
+				continue;
+			}
+			Append(json, "%s{\"min\": %zu, \"max\": ", first ? "" : ", ", GetBucketMin(b));
+			if (b + 1 == kProfileHistogramBucketCount) {
+				json += "null";
+			}
+			else {
+				Append(json, "%zu", GetBucketMax(b));
+			}
+			Append(json, ", \"calls\": %llu}", static_cast<unsigned long long>(entry.histogram[b]));
+			first = false;
+		}
+		json += "]}";
+	}
+	json += "]}\n";
+	return json;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+// 数学関数の呼び出し回数と時間の計測
+// MT4_ENABLE_PROFILINGを1にしてビルドしたときだけ計測する(0なら計測のコードは展開されない)
+// CMakeは -DMT4_ENABLE_PROFILING=ON、Visual Studioはプリプロセッサの定義にMT4_ENABLE_PROFILING=1を加える
+//
+// 呼び出しごとの記録はスレッドローカルのカウンタに足すだけで、EndProfileFrameで全スレッド分をまとめる
+// 時間はタイムスタンプカウンタ(rdtsc)で測り、まとめるときにナノ秒に換算する
+// インライン関数(Transform(Vector3, Matrix4x4)など)は時間を測ると計測の方が重くなるので回数だけ数える
+// 一括版の処理はワーカースレッドの分も含めて呼び出し元の時間に入る
+// 計測の負荷は1回あたりrdtsc 2回と加算数回(rdtscが遅い仮想環境では1回あたり数十ns増える)
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifndef MT4_ENABLE_PROFILING
+#define MT4_ENABLE_PROFILING 0
+#endif
+
+// 計測する関数(一括版は要素数を個数の分布に記録する)
+enum class ProfileFunction {
+	kMultiply,
+	kMultiplyBatch,
+	kInverse,
+	kInverseBatch,
+	kInverseAffine,
+	kInverseRigid,
+	kTransform,
+	kTransformBatch,
+	kMakeAffineMatrix,
+	kMakeAffineMatrixBatch,
+	kCount,
+};
+
+// 要素数の分布の区間数(区間iは[2^(i-1), 2^i) 区間0は0個 最後の区間はそれ以上すべて)
+constexpr size_t kProfileHistogramBucketCount = 24;
+
+// 関数ごとの1フレーム分の集計
+struct ProfileEntry final {
+	const char* name;
+	uint64_t calls;
+	uint64_t elements;
+	double nanoseconds; // 回数だけ数える関数は0
+	uint64_t histogram[kProfileHistogramBucketCount];
+};
+
+// 1フレーム分の集計
+struct ProfileReport final {
+	uint64_t frame;            // 0から数えたフレーム番号
+	double frameNanoseconds;   // 前回のEndProfileFrameからの経過時間
+	ProfileEntry entries[size_t(ProfileFunction::kCount)];
+};
+
+// 計測が有効なビルドか
+constexpr bool IsProfilingEnabled() { return MT4_ENABLE_PROFILING != 0; }
+
+// 関数名
+const char* GetProfileFunctionName(ProfileFunction function);
+// 要素数の分布の区間
+size_t GetProfileHistogramBucket(size_t count);
+
+// タイムスタンプカウンタの値(読めなければsteady_clockのナノ秒)
+uint64_t ReadProfileTicks();
+// 1回分を記録する(ticksが0なら回数と要素数だけ)
+void RecordProfile(ProfileFunction function, size_t count, uint64_t ticks);
+
+// 前回の呼び出しからの全スレッド分をまとめて返し、次のフレームの計測を始める
+// 計測が無効なビルドでは呼び出し回数が0の集計を返す
+ProfileReport EndProfileFrame();
+
+// 時間の長い順の表と、一括版の要素数の分布
+std::string FormatProfileText(const ProfileReport& report);
+// JSON({"frame", "frame_nanoseconds", "functions": [{"name", "calls", "elements", "nanoseconds", "histogram"}]})
+// histogramは空でない区間だけを{"min", "max", "calls"}で並べる(maxがnullなら上限なし)
+std::string FormatProfileJson(const ProfileReport& report);
+
+// スコープの間の時間を記録する
+class ProfileScope {
+public:
+	ProfileScope(ProfileFunction function, size_t count)
+	    : function_(function), count_(count), start_(ReadProfileTicks()) {}
+	~ProfileScope() { RecordProfile(function_, count_, ReadProfileTicks() - start_); }
+
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+	ProfileFunction function_;
+	size_t count_;
+	uint64_t start_;
+};
+
+// 関数の先頭に置く(countは処理する要素数)
+#if MT4_ENABLE_PROFILING
+#define MT4_PROFILE_SCOPE(function, count) const ProfileScope mt4ProfileScope(ProfileFunction::function, count)
+#define MT4_PROFILE_COUNT(function, count) RecordProfile(ProfileFunction::function, count, 0)
+#else
+#define MT4_PROFILE_SCOPE(function, count) ((void)0)
+#define MT4_PROFILE_COUNT(function, count) ((void)0)
+#endif
@@ -0,0 +1,9 @@
+#pragma once
+
+// クォータニオン (x, y, z)がベクトル部、wがスカラー部
+struct Quaternion final {
+	float x;
+	float y;
+	float z;
+	float w;
+};
@@ -0,0 +1,22 @@
+#pragma once
+
+// クォータニオン列(SoA形式)
+struct QuaternionSoA final {
+	float* x;
+	float* y;
+	float* z;
+	float* w;
+};
+
+// クォータニオン列(SoA形式・読み取り専用)
+struct ConstQuaternionSoA final {
+	const float* x;
+	const float* y;
+	const float* z;
+	const float* w;
+
+	ConstQuaternionSoA() = default;
+	ConstQuaternionSoA(const float* xs, const float* ys, const float* zs, const float* ws)
+	    : x(xs), y(ys), z(zs), w(ws) {}
+	ConstQuaternionSoA(const QuaternionSoA& soa) : x(soa.x), y(soa.y), z(soa.z), w(soa.w) {}
+};
@@ -0,0 +1,17 @@
+#pragma once
+
+// 逆数・逆平方根の精度(ベクトルの長さ・正規化・正射影の一括版で使う)
+// 精度はテンプレート引数で選ぶ 誤差の上限はulp(benchmark/VectorBatchBenchmark.cppで確かめる)
+// Length/Normalizeは倍精度で求めた値との差、Projectは内積の桁落ちが精度によらないのでkExactとの差
+//   kExact   : 平方根と除算 Length 1ulp, Normalize 2ulp
+//   kPrecise : 近似命令(rsqrt/rcp) + ニュートン法1回 Length/Normalize 4ulp, Project 6ulp
+//   kFast    : 近似命令そのまま(相対誤差1.5 * 2^-12以下) 6200ulp
+// 近似命令のないスカラー版(MT4_SIMD=scalarと端数)はどれもkExactと同じ計算になる
+// 長さの2乗が非正規化数・近似命令の範囲外になる要素を含むレーンの組はkExactで計算し直す
+// 平方根と除算がパイプライン化されたCPUでは、Lengthは近似版の方が遅いこともある
+
+enum class ReciprocalPrecision {
+	kExact,
+	kPrecise,
+	kFast,
+};
@@ -0,0 +1,138 @@
+#include "SimdDispatch.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+#if MT4_SIMD_SSE2
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace {
+
+#if MT4_SIMD_SSE2
+// CPUID (eax, ebx, ecx, edx)
+void CpuId(unsigned int leaf, unsigned int subLeaf, unsigned int registers[4]) {
+#if defined(_MSC_VER)
+	int values[4];
+	__cpuidex(values, int(leaf), int(subLeaf));
+	for (int i = 0; i < 4; i++) {
+		registers[i] = static_cast<unsigned int>(values[i]);
+	}
+#else
+	__cpuid_count(leaf, subLeaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+}
+
+// OSが保存するレジスタ状態(XCR0)
+unsigned long long GetXcr0() {
+#if defined(_MSC_VER)
+	return _xgetbv(0);
+#else
+	unsigned int eax = 0;
+	unsigned int edx = 0;
+	__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+}
+#endif
+
+SimdLevel DetectSimdLevel() {
+#if MT4_SIMD_SSE2
+	unsigned int registers[4] = {};
+	CpuId(0, 0, registers);
+	const unsigned int maxLeaf = registers[0];
+
+	CpuId(1, 0, registers);
+	const bool osxsave = (registers[2] & (1u << 27)) != 0;
+	const bool avx = (registers[2] & (1u << 28)) != 0;
+	const bool fma = (registers[2] & (1u << 12)) != 0;
+	if (!osxsave || !avx || !fma || maxLeaf < 7) {
+		return SimdLevel::kSSE2;
+	}
+	// XMM/YMMの状態をOSが保存しているか
+	const unsigned long long xcr0 = GetXcr0();
+	if ((xcr0 & 0x6) != 0x6) {
+		return SimdLevel::kSSE2;
+	}
+
+	CpuId(7, 0, registers);
+	const bool avx2 = (registers[1] & (1u << 5)) != 0;
+	const bool avx512f = (registers[1] & (1u << 16)) != 0;
+	if (!avx2) {
+		return SimdLevel::kSSE2;
+	}
+	// opmask/ZMMの状態をOSが保存しているか
+	if (avx512f && (xcr0 & 0xE0) == 0xE0) {
+		return SimdLevel::kAVX512;
+	}
+	return SimdLevel::kAVX2;
+#else
+	return SimdLevel::kScalar;
+#endif
+}
+
+// 大文字小文字を区別せずに比較
+bool EqualsIgnoreCase(const char* a, const char* b) {
+	for (; *a != '\0' && *b != '\0'; a++, b++) {
+		if (std::tolower(static_cast<unsigned char>(*a)) != std::tolower(static_cast<unsigned char>(*b))) {
+			return false;
+		}
+	}
+	return *a == *b;
+}
+
+// 環境変数MT4_SIMDの指定を反映する
+SimdLevel SelectSimdLevel() {
+	const SimdLevel supported = GetSupportedSimdLevel();
+	char value[32] = {};
+#if defined(_MSC_VER)
+	size_t length = 0;
+	if (getenv_s(&length, value, sizeof(value), "MT4_SIMD") != 0 || length == 0) {
+		return supported;
+	}
+#else
+	const char* env = std::getenv("MT4_SIMD");
+	if (env == nullptr) {
+		return supported;
+	}
+	std::strncpy(value, env, sizeof(value) - 1);
+#endif
+	const SimdLevel levels[] = { SimdLevel::kScalar, SimdLevel::kSSE2, SimdLevel::kAVX2, SimdLevel::kAVX512 };
+	for (SimdLevel level : levels) {
+		if (EqualsIgnoreCase(value, GetSimdLevelName(level))) {
+			// 未対応の命令セットは指定されても使わない
+			return level < supported ? level : supported;
+		}
+	}
+	return supported;
+}
+
+} // namespace
+
+SimdLevel GetSupportedSimdLevel() {
+	static const SimdLevel level = DetectSimdLevel();
+	return level;
+}
+
+SimdLevel GetSimdLevel() {
+	static const SimdLevel level = SelectSimdLevel();
+	return level;
+}
+
+const char* GetSimdLevelName(SimdLevel level) {
+	switch (level) {
+	case SimdLevel::kSSE2:
+		return "sse2";
+	case SimdLevel::kAVX2:
+		return "avx2";
+	case SimdLevel::kAVX512:
+		return "avx512";
+	default:
+		return "scalar";
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+// 実行時のSIMD命令セット選択
+// 起動後最初の問い合わせ時にCPUIDで判定し、以降は固定
+// 環境変数MT4_SIMD(scalar / sse2 / avx2 / avx512)で対応範囲内の任意の経路に固定できる
+
+#include "MathSimd.h"
+
+enum class SimdLevel {
+	kScalar,
+	kSSE2,
+	kAVX2, // AVX2 + FMA
+	kAVX512, // AVX-512F
+};
+
+// CPUとOSが対応している最上位の命令セット
+SimdLevel GetSupportedSimdLevel();
+// 実際に使用する命令セット(環境変数の指定を反映したもの)
+SimdLevel GetSimdLevel();
+// 命令セット名
+const char* GetSimdLevelName(SimdLevel level);
+
+// 使用する命令セットに合わせてカーネルを選ぶ(nullptrの経路は下位にフォールバック)
+template<class Func>
+Func SelectSimdKernel(Func scalar, Func sse2, Func avx2, Func avx512 = nullptr) {
+	const SimdLevel level = GetSimdLevel();
+	if (level >= SimdLevel::kAVX512 && avx512) {
+		return avx512;
+	}
+	if (level >= SimdLevel::kAVX2 && avx2) {
+		return avx2;
+	}
+	if (level >= SimdLevel::kSSE2 && sse2) {
+		return sse2;
+	}
+	return scalar;
+}
+
+// 命令セット別カーネル(名前 + Scalar/SSE2/AVX2[/AVX512])を選ぶ
+#if MT4_SIMD_SSE2
+#define MT4_SELECT_SIMD_KERNEL(name) SelectSimdKernel(name##Scalar, name##SSE2, name##AVX2)
+#define MT4_SELECT_SIMD_KERNEL_AVX512(name) SelectSimdKernel(name##Scalar, name##SSE2, name##AVX2, name##AVX512)
+#else
+#define MT4_SELECT_SIMD_KERNEL(name) (name##Scalar)
+#define MT4_SELECT_SIMD_KERNEL_AVX512(name) (name##Scalar)
+#endif
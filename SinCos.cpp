@@ -0,0 +1,30 @@
+#include "SinCos.h"
+
+#include "JobSystem.h"
+#include "MathKernel.h"
+#include "SimdDispatch.h"
+
+// sinとcos(一括)
+// 近似は実行環境に合わせて選んだカーネルで計算する
+template<SinCosPrecision kPrecision>
+void SinCos(const float* radians, float* sin, float* cos, size_t count) {
+	if constexpr (kPrecision == SinCosPrecision::kExact) {
+		for (size_t i = 0; i < count; i++) {
+			const float radian = radians[i];
+			sin[i] = std::sin(radian);
+			cos[i] = std::cos(radian);
+		}
+	}
+	else {
+		// 一括演算をJobSystemで分けるときの1区間の最小の要素数
+		const size_t kParallelMinGrain = 4096;
+		static const auto kernel = MT4_SELECT_SIMD_KERNEL(SinCos);
+		JobSystem::GetInstance().ParallelFor(count, kParallelMinGrain, [&](size_t begin, size_t end) {
+			kernel(radians + begin, sin + begin, cos + begin, end - begin, kPrecision);
+		});
+	}
+}
+
+template void SinCos<SinCosPrecision::kExact>(const float* radians, float* sin, float* cos, size_t count);
+template void SinCos<SinCosPrecision::kPrecise>(const float* radians, float* sin, float* cos, size_t count);
+template void SinCos<SinCosPrecision::kFast>(const float* radians, float* sin, float* cos, size_t count);
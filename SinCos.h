@@ -0,0 +1,99 @@
+#pragma once
+
+// sinとcosの同時計算
+// 精度はテンプレート引数で選ぶ
+//   kExact   : 標準ライブラリ(std::sin / std::cos)
+//   kPrecise : 多項式近似 最大誤差1e-7程度(|x| <= 8192)
+//   kFast    : 多項式近似 最大誤差4e-4程度(|x| <= 8192)
+// 近似はπ/2の整数倍nを引いて[-π/4, π/4]に寄せ、nを4で割った余りでsin/cosの入れ替えと符号を決める
+
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+
+enum class SinCosPrecision {
+	kExact,
+	kPrecise,
+	kFast,
+};
+
+// 多項式近似の定数(一括版のカーネルと共用)
+// r = x - n * (kHalfPi[0] + kHalfPi[1] + ...)
+// sin(r) = r + r^3 * (kSin[0] + r^2 * (kSin[1] + ...))
+// cos(r) = 1 + r^2 * (kCos[0] + r^2 * (kCos[1] + ...))
+template<SinCosPrecision kPrecision>
+struct SinCosPolynomial;
+
+template<>
+struct SinCosPolynomial<SinCosPrecision::kPrecise> {
+	static constexpr float kHalfPi[] = { 1.5703125f, 4.837512969970703125e-4f, 7.54978995489188216e-8f };
+	static constexpr float kSin[] = { -1.6666654611e-1f, 8.3321608736e-3f, -1.9515295891e-4f };
+	static constexpr float kCos[] = { -0.5f, 4.166664568298827e-2f, -1.388731625493765e-3f, 2.443315711809948e-5f };
+};
+
+template<>
+struct SinCosPolynomial<SinCosPrecision::kFast> {
+	static constexpr float kHalfPi[] = { 1.5703125f, 4.8382679e-4f };
+	static constexpr float kSin[] = { -0.16226f };
+	static constexpr float kCos[] = { -0.49977f, 0.04048f };
+};
+
+// 2/π
+constexpr float kSinCosTwoOverPi = 0.636619772367581343f;
+// 加えて引くと整数に丸められる値(1.5 * 2^23 |x| < 2^22で有効)
+constexpr float kSinCosRoundingBias = 12582912.0f;
+
+// sinとcos
+template<SinCosPrecision kPrecision = SinCosPrecision::kExact>
+inline void SinCos(float radian, float& sin, float& cos) {
+	if constexpr (kPrecision == SinCosPrecision::kExact) {
+		sin = std::sin(radian);
+		cos = std::cos(radian);
+	}
+	else {
+		using Polynomial = SinCosPolynomial<kPrecision>;
+		const float n = (radian * kSinCosTwoOverPi + kSinCosRoundingBias) - kSinCosRoundingBias;
+		float r = radian;
+		for (float halfPi : Polynomial::kHalfPi) {
+			r -= n * halfPi;
+		}
+		const float r2 = r * r;
+
+		const size_t sinCount = std::size(Polynomial::kSin);
+		float s = Polynomial::kSin[sinCount - 1];
+		for (size_t i = sinCount - 1; i-- > 0;) {
+			s = s * r2 + Polynomial::kSin[i];
+		}
+		s = r + r * r2 * s;
+		const size_t cosCount = std::size(Polynomial::kCos);
+		float c = Polynomial::kCos[cosCount - 1];
+		for (size_t i = cosCount - 1; i-- > 0;) {
+			c = c * r2 + Polynomial::kCos[i];
+		}
+		c = 1.0f + r2 * c;
+
+		switch (static_cast<int>(n) & 3) {
+		case 0:
+			sin = s;
+			cos = c;
+			break;
+		case 1:
+			sin = c;
+			cos = -s;
+			break;
+		case 2:
+			sin = -s;
+			cos = -c;
+			break;
+		default:
+			sin = -c;
+			cos = s;
+			break;
+		}
+	}
+}
+
+// sinとcos(一括)
+// sin, cosはradiansと同じ配列でもよい
+template<SinCosPrecision kPrecision = SinCosPrecision::kExact>
+void SinCos(const float* radians, float* sin, float* cos, size_t count);
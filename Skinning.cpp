@@ -0,0 +1,46 @@
+#include "Skinning.h"
+
+#include "JobSystem.h"
+#include "MathKernel.h"
+#include "SimdDispatch.h"
+
+namespace {
+
+// JobSystemで頂点を分けるときの1区間の最小の頂点数
+const size_t kParallelMinVertices = 2048;
+
+ConstVector3SoA Offset(const ConstVector3SoA& soa, size_t i) {
+	return soa.x ? ConstVector3SoA(soa.x + i, soa.y + i, soa.z + i) : soa;
+}
+Vector3SoA Offset(const Vector3SoA& soa, size_t i) {
+	return soa.x ? Vector3SoA{ soa.x + i, soa.y + i, soa.z + i } : soa;
+}
+
+} // namespace
+
+void SkinVertices(const Matrix4x4* palette, const SkinInfluence* influences, const ConstVector3SoA& positions,
+    const Vector3SoA& skinnedPositions, size_t count) {
+	SkinVertices(palette, influences, positions, ConstVector3SoA(nullptr, nullptr, nullptr), skinnedPositions,
+	    Vector3SoA{ nullptr, nullptr, nullptr }, count);
+}
+
+void SkinVertices(const Matrix4x4* palette, const SkinInfluence* influences, const ConstVector3SoA& positions,
+    const ConstVector3SoA& normals, const Vector3SoA& skinnedPositions, const Vector3SoA& skinnedNormals, size_t count) {
+	static const auto kernel = MT4_SELECT_SIMD_KERNEL(SkinVertices);
+	JobSystem::GetInstance().ParallelFor(count, kParallelMinVertices, [&](size_t begin, size_t end) {
+		kernel(palette, influences + begin, Offset(positions, begin), Offset(normals, begin),
+		    Offset(skinnedPositions, begin), Offset(skinnedNormals, begin), end - begin);
+	});
+}
+
+// メッシュの中は呼び出したスレッドでそのまま処理する
+void SkinMeshes(const SkinnedMesh* meshes, size_t meshCount) {
+	static const auto kernel = MT4_SELECT_SIMD_KERNEL(SkinVertices);
+	JobSystem::GetInstance().ParallelFor(meshCount, 1, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			const SkinnedMesh& mesh = meshes[i];
+			kernel(mesh.palette, mesh.influences, mesh.positions, mesh.normals, mesh.skinnedPositions,
+			    mesh.skinnedNormals, mesh.vertexCount);
+		}
+	});
+}
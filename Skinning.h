@@ -0,0 +1,44 @@
+#pragma once
+
+// スキニング(線形ブレンド)
+// 頂点ごとに最大4本のボーン行列を重みで足し合わせてから1回だけ変換する
+//   position' = position * Σ weight_k * palette[bone_k]
+//   normal'   = normalize(normal * Σ weight_k * palette[bone_k]の左上3x3)
+// パレットの行列はアフィン(4列目は使わない) 法線は拡大が一様でないボーンでは近似になる
+// 頂点はSIMDのレーン幅ずつまとめて処理し、結果は呼び出し側が用意した配列に書き込む(メモリは確保しない)
+
+#include <cstddef>
+#include <cstdint>
+#include "Matrix4x4.h"
+#include "Vector3SoA.h"
+
+// 1頂点に影響するボーンの数
+constexpr size_t kSkinInfluenceCount = 4;
+
+// 頂点に影響するボーンと重み
+// 重みの和は1にしておく 使わない枠は重みを0にする(ボーン番号はパレットの範囲内ならどれでもよい)
+struct SkinInfluence final {
+	uint16_t bones[kSkinInfluenceCount];
+	float weights[kSkinInfluenceCount];
+};
+
+// メッシュ1つ分の入力と出力
+struct SkinnedMesh final {
+	const Matrix4x4* palette; // ボーンごとのバインドポーズの逆行列 * ボーンのワールド行列
+	const SkinInfluence* influences;
+	ConstVector3SoA positions;
+	ConstVector3SoA normals;  // 法線を変換しなければx, y, zをnullptrにする
+	Vector3SoA skinnedPositions;
+	Vector3SoA skinnedNormals;
+	size_t vertexCount;
+};
+
+// 頂点を変換する(一括・SoA) 入力と出力は同じ配列でもよい
+void SkinVertices(const Matrix4x4* palette, const SkinInfluence* influences, const ConstVector3SoA& positions,
+    const Vector3SoA& skinnedPositions, size_t count);
+void SkinVertices(const Matrix4x4* palette, const SkinInfluence* influences, const ConstVector3SoA& positions,
+    const ConstVector3SoA& normals, const Vector3SoA& skinnedPositions, const Vector3SoA& skinnedNormals, size_t count);
+
+// 複数のメッシュをメッシュ単位で並列に変換する
+// 大きなメッシュが1つだけならSkinVertices(頂点を分けて並列に処理する)の方が速い
+void SkinMeshes(const SkinnedMesh* meshes, size_t meshCount);
@@ -0,0 +1,172 @@
+#include "TransformHierarchy.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include "JobSystem.h"
+#include "MathFunction.h"
+
+namespace {
+
+// 1つのジョブで処理するノード数
+const size_t kUpdateGrain = 256;
+
+} // namespace
+
+uint32_t TransformHierarchy::AddNode(
+    uint32_t parent, const Vector3& scale, const Quaternion& rotate, const Vector3& translate) {
+	assert(parent == kNoParent || parent < parents_.size());
+	const uint32_t node = static_cast<uint32_t>(parents_.size());
+	const uint32_t depth = parent == kNoParent ? 0 : depths_[parent] + 1;
+
+	parents_.push_back(parent);
+	depths_.push_back(depth);
+	scales_.push_back(scale);
+	rotates_.push_back(rotate);
+	translates_.push_back(translate);
+	localMatrices_.push_back(MakeIdentity4x4());
+	worldMatrices_.push_back(MakeIdentity4x4());
+	normalMatrices_.push_back(MakeIdentity3x3());
+	uniformScales_.push_back(1);
+	localDirty_.push_back(0);
+	worldChanged_.push_back(0);
+	if (levels_.size() <= depth) {
+		levels_.resize(depth + 1);
+		levelDirty_.resize(depth + 1, 0);
+	}
+	levels_[depth].push_back(node);
+	MarkDirty(node);
+	return node;
+}
+
+void TransformHierarchy::Reserve(size_t nodeCount) {
+	parents_.reserve(nodeCount);
+	depths_.reserve(nodeCount);
+	scales_.reserve(nodeCount);
+	rotates_.reserve(nodeCount);
+	translates_.reserve(nodeCount);
+	localMatrices_.reserve(nodeCount);
+	worldMatrices_.reserve(nodeCount);
+	normalMatrices_.reserve(nodeCount);
+	uniformScales_.reserve(nodeCount);
+	localDirty_.reserve(nodeCount);
+	worldChanged_.reserve(nodeCount);
+}
+
+void TransformHierarchy::SetLocalTransform(
+    uint32_t node, const Vector3& scale, const Quaternion& rotate, const Vector3& translate) {
+	scales_[node] = scale;
+	rotates_[node] = rotate;
+	translates_[node] = translate;
+	MarkDirty(node);
+}
+
+void TransformHierarchy::SetScale(uint32_t node, const Vector3& scale) {
+	scales_[node] = scale;
+	MarkDirty(node);
+}
+
+void TransformHierarchy::SetRotate(uint32_t node, const Quaternion& rotate) {
+	rotates_[node] = rotate;
+	MarkDirty(node);
+}
+
+void TransformHierarchy::SetTranslate(uint32_t node, const Vector3& translate) {
+	translates_[node] = translate;
+	MarkDirty(node);
+}
+
+void TransformHierarchy::MarkDirty(uint32_t node) {
+	localDirty_[node] = 1;
+	levelDirty_[depths_[node]] = 1;
+}
+
+// ワーカーがいないときはノード番号順に1回で処理する(親は子より前にあるので順に計算すればよい)
+// 並列に処理するときは浅い順に深さごとにまとめ、
+// ローカルの変更がなく、1つ上の深さでワールド行列が変わったノードもなければその深さは飛ばす
+void TransformHierarchy::Update() {
+	JobSystem& jobSystem = JobSystem::GetInstance();
+	if (jobSystem.GetThreadCount() == 1 || parents_.size() <= kUpdateGrain) {
+		if (std::find(levelDirty_.begin(), levelDirty_.end(), uint8_t(1)) == levelDirty_.end()) {
+			return;
+		}
+		for (uint32_t node = 0; node < parents_.size(); node++) {
+			UpdateNode(node, true);
+		}
+		std::fill(levelDirty_.begin(), levelDirty_.end(), uint8_t(0));
+		return;
+	}
+
+	bool parentLevelChanged = false;
+	for (size_t depth = 0; depth < levels_.size(); depth++) {
+		if (!levelDirty_[depth] && !parentLevelChanged) {
+			continue;
+		}
+		const std::vector<uint32_t>& level = levels_[depth];
+		const bool checkParents = parentLevelChanged;
+		std::atomic<bool> changed = false;
+		jobSystem.ParallelFor(level.size(), kUpdateGrain, [&](size_t begin, size_t end) {
+			bool anyChanged = false;
+			for (size_t k = begin; k < end; k++) {
+				anyChanged |= UpdateNode(level[k], checkParents);
+			}
+			if (anyChanged) {
+				changed.store(true, std::memory_order_relaxed);
+			}
+		});
+		levelDirty_[depth] = 0;
+		parentLevelChanged = changed.load(std::memory_order_relaxed);
+	}
+}
+
+// 親は子より前にあるので番号順に求めればよい
+void TransformHierarchy::SetNormalMatricesEnabled(bool enabled) {
+	normalMatricesEnabled_ = enabled;
+	if (enabled) {
+		for (uint32_t node = 0; node < parents_.size(); node++) {
+			UpdateNormalMatrix(node);
+		}
+	}
+}
+
+// checkParentsがfalseなら親の深さは今回計算していない(worldChanged_が古い)ので参照しない
+bool TransformHierarchy::UpdateNode(uint32_t node, bool checkParents) {
+	const uint32_t parent = parents_[node];
+	const bool localDirty = localDirty_[node] != 0;
+	const bool parentChanged = checkParents && parent != kNoParent && worldChanged_[parent] != 0;
+	if (localDirty) {
+		// 書き込んだばかりのlocalMatrices_を読み直さず、一時変数から積を求める
+		const Matrix4x4 local = MakeAffineMatrix(scales_[node], rotates_[node], translates_[node]);
+		localMatrices_[node] = local;
+		localDirty_[node] = 0;
+		worldMatrices_[node] = parent == kNoParent ? local : Multiply(local, worldMatrices_[parent]);
+		if (normalMatricesEnabled_) {
+			UpdateNormalMatrix(node);
+		}
+		worldChanged_[node] = 1;
+		return true;
+	}
+	if (parentChanged) {
+		worldMatrices_[node] = Multiply(localMatrices_[node], worldMatrices_[parent]);
+		if (normalMatricesEnabled_) {
+			UpdateNormalMatrix(node);
+		}
+		worldChanged_[node] = 1;
+		return true;
+	}
+	worldChanged_[node] = 0;
+	return false;
+}
+
+// 拡大が一様なら回転(と鏡映)に拡大を掛けただけなので、左上3x3を拡大の2乗で割れば逆行列の転置になる
+// 親は先に計算しているのでuniformScales_[parent]は最新
+void TransformHierarchy::UpdateNormalMatrix(uint32_t node) {
+	const uint32_t parent = parents_[node];
+	const Vector3& scale = scales_[node];
+	const bool uniform = scale.x != 0.0f && std::fabs(scale.x) == std::fabs(scale.y) &&
+	                     std::fabs(scale.x) == std::fabs(scale.z) && (parent == kNoParent || uniformScales_[parent] != 0);
+	uniformScales_[node] = uniform ? 1 : 0;
+	normalMatrices_[node] =
+	    uniform ? MakeNormalMatrixUniformScale(worldMatrices_[node]) : MakeNormalMatrix(worldMatrices_[node]);
+}
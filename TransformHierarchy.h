@@ -0,0 +1,75 @@
+#pragma once
+
+// 親子関係のあるトランスフォーム
+// ノードは親より後に追加する(配列の並びがそのまま親→子の順になる)
+// ローカルの拡大縮小・回転・平行移動を変更したノードと、その子孫のワールド行列だけをUpdateで計算し直す
+// ワーカースレッドがあるときは深さごとにまとめ、同じ深さのノードを並列に処理する
+// SetNormalMatricesEnabled(true)にすると、ワールド行列と一緒に法線行列も求めておく
+// (祖先まで含めて拡大が一様なノードは余因子を使わずに求める)
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Matrix4x4.h"
+#include "Quaternion.h"
+#include "Vector3.h"
+#include "VectorMatrix.h"
+
+class TransformHierarchy {
+public:
+	static constexpr uint32_t kNoParent = UINT32_MAX;
+
+	// ノードを追加してその番号を返す(parentは追加済みのノードかkNoParent)
+	uint32_t AddNode(uint32_t parent, const Vector3& scale, const Quaternion& rotate, const Vector3& translate);
+	// 容量の予約
+	void Reserve(size_t nodeCount);
+
+	// ローカルトランスフォームの変更(次のUpdateで反映する)
+	void SetLocalTransform(uint32_t node, const Vector3& scale, const Quaternion& rotate, const Vector3& translate);
+	void SetScale(uint32_t node, const Vector3& scale);
+	void SetRotate(uint32_t node, const Quaternion& rotate);
+	void SetTranslate(uint32_t node, const Vector3& translate);
+
+	// 変更のあったノードとその子孫の行列を計算し直す
+	void Update();
+	// 法線行列も求めるか(既定は求めない) 有効にした時点のワールド行列からすべて求め直す
+	void SetNormalMatricesEnabled(bool enabled);
+
+	size_t GetNodeCount() const { return parents_.size(); }
+	uint32_t GetParent(uint32_t node) const { return parents_[node]; }
+	const Vector3& GetScale(uint32_t node) const { return scales_[node]; }
+	const Quaternion& GetRotate(uint32_t node) const { return rotates_[node]; }
+	const Vector3& GetTranslate(uint32_t node) const { return translates_[node]; }
+	// Update後の行列
+	const Matrix4x4& GetLocalMatrix(uint32_t node) const { return localMatrices_[node]; }
+	const Matrix4x4& GetWorldMatrix(uint32_t node) const { return worldMatrices_[node]; }
+	const Matrix4x4* GetWorldMatrices() const { return worldMatrices_.data(); }
+	// Update後の法線行列(MakeNormalMatrix(GetWorldMatrix(node))と同じ値) SetNormalMatricesEnabled(true)のときだけ有効
+	const Matrix3x3& GetNormalMatrix(uint32_t node) const { return normalMatrices_[node]; }
+	const Matrix3x3* GetNormalMatrices() const { return normalMatrices_.data(); }
+
+private:
+	void MarkDirty(uint32_t node);
+	// 1ノード分を計算し、ワールド行列が変わったらtrueを返す
+	bool UpdateNode(uint32_t node, bool checkParents);
+	// ワールド行列から法線行列を求める
+	void UpdateNormalMatrix(uint32_t node);
+
+	// ノードごとの値
+	std::vector<uint32_t> parents_;
+	std::vector<uint32_t> depths_;
+	std::vector<Vector3> scales_;
+	std::vector<Quaternion> rotates_;
+	std::vector<Vector3> translates_;
+	std::vector<Matrix4x4> localMatrices_;
+	std::vector<Matrix4x4> worldMatrices_;
+	std::vector<Matrix3x3> normalMatrices_;
+	std::vector<uint8_t> uniformScales_; // 自分と祖先の拡大がすべて一様
+	std::vector<uint8_t> localDirty_; // ローカルトランスフォームが変わった
+	std::vector<uint8_t> worldChanged_; // 直前のUpdateでワールド行列が変わった(子が参照する)
+
+	// 深さごとのノード番号と、ローカルの変更があったか
+	std::vector<std::vector<uint32_t>> levels_;
+	std::vector<uint8_t> levelDirty_;
+	bool normalMatricesEnabled_ = false;
+};
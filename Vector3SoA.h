@@ -0,0 +1,19 @@
+#pragma once
+
+// 3次元ベクトル列(SoA形式)
+struct Vector3SoA final {
+	float* x;
+	float* y;
+	float* z;
+};
+
+// 3次元ベクトル列(SoA形式・読み取り専用)
+struct ConstVector3SoA final {
+	const float* x;
+	const float* y;
+	const float* z;
+
+	ConstVector3SoA() = default;
+	ConstVector3SoA(const float* xs, const float* ys, const float* zs) : x(xs), y(ys), z(zs) {}
+	ConstVector3SoA(const Vector3SoA& soa) : x(soa.x), y(soa.y), z(soa.z) {}
+};
@@ -0,0 +1,332 @@
+#pragma once
+
+// 要素の型と次元を引数にしたベクトル Vec<T, N> と行列 Mat<T, R, C>
+// 演算は次元に依らず1度だけ書き、要素ごとの処理はUnrollForでコンパイル時に展開する
+// float 4要素のベクトルと4x4行列の演算はSSE2のレジスタで計算する(定数式の中では展開した式を使う)
+// 行列は行優先で、ベクトルは行ベクトルとして左から掛ける(Matrix4x4と同じ)
+// Vec<float, 2/3/4>・Mat<float, 4, 4>はVector2/3/4・Matrix4x4と同じ並びで、ToVec/ToVector3/ToMatなどで相互に変換できる
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include "Matrix4x4.h"
+#include "Vector2.h"
+#include "Vector3.h"
+#include "Vector4.h"
+// 一括演算カーネル用のMathSimd.hは公開ヘッダーから読み込まず、必要なSSE2の命令だけを使う
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+#define MT4_VECTOR_MATRIX_SSE2 1
+#include <emmintrin.h>
+#else
+#define MT4_VECTOR_MATRIX_SSE2 0
+#endif
+
+template<class T, size_t N>
+struct Vec final {
+	static_assert(std::is_floating_point_v<T> && N > 0);
+	T v[N];
+
+	constexpr T& operator[](size_t i) { return v[i]; }
+	constexpr const T& operator[](size_t i) const { return v[i]; }
+};
+
+template<class T, size_t R, size_t C>
+struct Mat final {
+	static_assert(std::is_floating_point_v<T> && R > 0 && C > 0);
+	T m[R][C];
+};
+
+using Vec2f = Vec<float, 2>;
+using Vec3f = Vec<float, 3>;
+using Vec4f = Vec<float, 4>;
+using Vec2d = Vec<double, 2>;
+using Vec3d = Vec<double, 3>;
+using Vec4d = Vec<double, 4>;
+using Mat3f = Mat<float, 3, 3>;
+using Mat4f = Mat<float, 4, 4>;
+using Mat3d = Mat<double, 3, 3>;
+using Mat4d = Mat<double, 4, 4>;
+// 3x3行列(法線の変換や回転に使う)
+using Matrix3x3 = Mat<float, 3, 3>;
+
+static_assert(sizeof(Vec2f) == sizeof(Vector2) && sizeof(Vec3f) == sizeof(Vector3) && sizeof(Vec4f) == sizeof(Vector4));
+static_assert(sizeof(Mat4f) == sizeof(Matrix4x4));
+
+// func(std::integral_constant<size_t, i>)をi = 0, 1, ..., N - 1の順に呼ぶ
+template<size_t N, class Func>
+constexpr void UnrollFor(Func&& func) {
+	[&]<size_t... I>(std::index_sequence<I...>) {
+		(func(std::integral_constant<size_t, I>{}), ...);
+	}(std::make_index_sequence<N>{});
+}
+
+// 要素iをfunc(i)にしたベクトル
+template<class T, size_t N, class Func>
+constexpr Vec<T, N> MakeVec(Func&& func) {
+	return [&]<size_t... I>(std::index_sequence<I...>) {
+		return Vec<T, N>{ static_cast<T>(func(std::integral_constant<size_t, I>{}))... };
+	}(std::make_index_sequence<N>{});
+}
+
+// float 4要素の演算(SSE2の命令はVectorMatrixDetailの関数の中だけで使う)
+namespace VectorMatrixDetail {
+
+// float 4要素をSSE2で計算するか
+template<class T, size_t N>
+constexpr bool kUseSimd = MT4_VECTOR_MATRIX_SSE2 && std::is_same_v<T, float> && N == 4;
+
+inline void Add4(const float* v1, const float* v2, float* result) {
+#if MT4_VECTOR_MATRIX_SSE2
+	_mm_storeu_ps(result, _mm_add_ps(_mm_loadu_ps(v1), _mm_loadu_ps(v2)));
+#else
+	UnrollFor<4>([&](auto i) { result[i] = v1[i] + v2[i]; });
+#endif
+}
+inline void Subtract4(const float* v1, const float* v2, float* result) {
+#if MT4_VECTOR_MATRIX_SSE2
+	_mm_storeu_ps(result, _mm_sub_ps(_mm_loadu_ps(v1), _mm_loadu_ps(v2)));
+#else
+	UnrollFor<4>([&](auto i) { result[i] = v1[i] - v2[i]; });
+#endif
+}
+inline void Multiply4(float k, const float* v1, float* result) {
+#if MT4_VECTOR_MATRIX_SSE2
+	_mm_storeu_ps(result, _mm_mul_ps(_mm_set1_ps(k), _mm_loadu_ps(v1)));
+#else
+	UnrollFor<4>([&](auto i) { result[i] = k * v1[i]; });
+#endif
+}
+// R要素の行ベクトルとR行4列の行列の積
+template<size_t R>
+inline void MultiplyRow4(const float* v, const float (*m)[4], float* result) {
+#if MT4_VECTOR_MATRIX_SSE2
+	__m128 sum = _mm_mul_ps(_mm_set1_ps(v[0]), _mm_loadu_ps(m[0]));
+	UnrollFor<R - 1>([&](auto k) { sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(v[k + 1]), _mm_loadu_ps(m[k + 1]))); });
+	_mm_storeu_ps(result, sum);
+#else
+	UnrollFor<4>([&](auto j) {
+		float sum = v[0] * m[0][j];
+		UnrollFor<R - 1>([&](auto k) { sum += v[k + 1] * m[k + 1][j]; });
+		result[j] = sum;
+	});
+#endif
+}
+
+} // namespace VectorMatrixDetail
+
+#undef MT4_VECTOR_MATRIX_SSE2
+
+// ベクトルの加法
+template<class T, size_t N>
+constexpr Vec<T, N> Add(const Vec<T, N>& v1, const Vec<T, N>& v2) {
+	if constexpr (VectorMatrixDetail::kUseSimd<T, N>) {
+		if (!std::is_constant_evaluated()) {
+			Vec<T, N> result;
+			VectorMatrixDetail::Add4(v1.v, v2.v, result.v);
+			return result;
+		}
+	}
+	return MakeVec<T, N>([&](auto i) { return v1[i] + v2[i]; });
+}
+// ベクトルの減法
+template<class T, size_t N>
+constexpr Vec<T, N> Subtract(const Vec<T, N>& v1, const Vec<T, N>& v2) {
+	if constexpr (VectorMatrixDetail::kUseSimd<T, N>) {
+		if (!std::is_constant_evaluated()) {
+			Vec<T, N> result;
+			VectorMatrixDetail::Subtract4(v1.v, v2.v, result.v);
+			return result;
+		}
+	}
+	return MakeVec<T, N>([&](auto i) { return v1[i] - v2[i]; });
+}
+// スカラー倍
+template<class T, size_t N>
+constexpr Vec<T, N> Multiply(std::type_identity_t<T> k, const Vec<T, N>& v1) {
+	if constexpr (VectorMatrixDetail::kUseSimd<T, N>) {
+		if (!std::is_constant_evaluated()) {
+			Vec<T, N> result;
+			VectorMatrixDetail::Multiply4(k, v1.v, result.v);
+			return result;
+		}
+	}
+	return MakeVec<T, N>([&](auto i) { return k * v1[i]; });
+}
+// 内積
+template<class T, size_t N>
+constexpr T Dot(const Vec<T, N>& v1, const Vec<T, N>& v2) {
+	// 0から足し始めると0 + xを省けないので、最初の積から始める
+	T result = v1[0] * v2[0];
+	UnrollFor<N - 1>([&](auto i) { result += v1[i + 1] * v2[i + 1]; });
+	return result;
+}
+// 長さ(ノルム)
+template<class T, size_t N>
+inline T Length(const Vec<T, N>& v1) {
+	return std::sqrt(Dot(v1, v1));
+}
+// 正規化(長さが0なら0ベクトル)
+template<class T, size_t N>
+inline Vec<T, N> Normalize(const Vec<T, N>& v1) {
+	const T length = Length(v1);
+	if (length == T(0)) {
+		return Vec<T, N>{};
+	}
+	return MakeVec<T, N>([&](auto i) { return v1[i] / length; });
+}
+// 線形補間
+template<class T, size_t N>
+constexpr Vec<T, N> Lerp(const Vec<T, N>& v1, const Vec<T, N>& v2, std::type_identity_t<T> t) {
+	return MakeVec<T, N>([&](auto i) { return v1[i] + t * (v2[i] - v1[i]); });
+}
+// クロス積
+template<class T>
+constexpr Vec<T, 3> Cross(const Vec<T, 3>& v1, const Vec<T, 3>& v2) {
+	return Vec<T, 3>{ v1[1] * v2[2] - v1[2] * v2[1], v1[2] * v2[0] - v1[0] * v2[2], v1[0] * v2[1] - v1[1] * v2[0] };
+}
+
+// 行
+template<class T, size_t R, size_t C>
+constexpr Vec<T, C> GetRow(const Mat<T, R, C>& m, size_t i) {
+	return MakeVec<T, C>([&](auto j) { return m.m[i][j]; });
+}
+// 要素iをfunc(i, j)にした行列
+template<class T, size_t R, size_t C, class Func>
+constexpr Mat<T, R, C> MakeMat(Func&& func) {
+	Mat<T, R, C> result{};
+	UnrollFor<R>([&](auto i) {
+		UnrollFor<C>([&](auto j) { result.m[i][j] = static_cast<T>(func(i, j)); });
+	});
+	return result;
+}
+// 単位行列
+template<class T, size_t N>
+constexpr Mat<T, N, N> MakeIdentity() {
+	return MakeMat<T, N, N>([](auto i, auto j) { return i == j ? T(1) : T(0); });
+}
+
+// 行列の加法
+template<class T, size_t R, size_t C>
+constexpr Mat<T, R, C> Add(const Mat<T, R, C>& m1, const Mat<T, R, C>& m2) {
+	return MakeMat<T, R, C>([&](auto i, auto j) { return m1.m[i][j] + m2.m[i][j]; });
+}
+// 行列の減法
+template<class T, size_t R, size_t C>
+constexpr Mat<T, R, C> Subtract(const Mat<T, R, C>& m1, const Mat<T, R, C>& m2) {
+	return MakeMat<T, R, C>([&](auto i, auto j) { return m1.m[i][j] - m2.m[i][j]; });
+}
+// スカラー倍
+template<class T, size_t R, size_t C>
+constexpr Mat<T, R, C> Multiply(std::type_identity_t<T> k, const Mat<T, R, C>& m1) {
+	return MakeMat<T, R, C>([&](auto i, auto j) { return k * m1.m[i][j]; });
+}
+// 行ベクトルと行列の積 v * m
+template<class T, size_t R, size_t C>
+constexpr Vec<T, C> Multiply(const Vec<T, R>& v, const Mat<T, R, C>& m) {
+	if constexpr (VectorMatrixDetail::kUseSimd<T, C>) {
+		if (!std::is_constant_evaluated()) {
+			Vec<T, C> result;
+			VectorMatrixDetail::MultiplyRow4<R>(v.v, m.m, result.v);
+			return result;
+		}
+	}
+	return MakeVec<T, C>([&](auto j) {
+		T sum = v[0] * m.m[0][j];
+		UnrollFor<R - 1>([&](auto k) { sum += v[k + 1] * m.m[k + 1][j]; });
+		return sum;
+	});
+}
+// 行列の積 m1 * m2
+template<class T, size_t R, size_t K, size_t C>
+constexpr Mat<T, R, C> Multiply(const Mat<T, R, K>& m1, const Mat<T, K, C>& m2) {
+	Mat<T, R, C> result{};
+	// 結果のi行目 = m1のi行目 * m2
+	UnrollFor<R>([&](auto i) {
+		const Vec<T, C> row = Multiply(GetRow(m1, i), m2);
+		UnrollFor<C>([&](auto j) { result.m[i][j] = row[j]; });
+	});
+	return result;
+}
+// 転置行列
+template<class T, size_t R, size_t C>
+constexpr Mat<T, C, R> Transpose(const Mat<T, R, C>& m) {
+	return MakeMat<T, C, R>([&](auto i, auto j) { return m.m[j][i]; });
+}
+
+// row行とcol列を除いた小行列
+template<class T, size_t N>
+constexpr Mat<T, N - 1, N - 1> GetMinor(const Mat<T, N, N>& m, size_t row, size_t col) {
+	return MakeMat<T, N - 1, N - 1>([&](auto i, auto j) {
+		const size_t sourceRow = i < row ? size_t(i) : size_t(i) + 1;
+		const size_t sourceCol = j < col ? size_t(j) : size_t(j) + 1;
+		return m.m[sourceRow][sourceCol];
+	});
+}
+// 行列式(1行目で余因子展開する 4x4までを想定)
+template<class T, size_t N>
+constexpr T Determinant(const Mat<T, N, N>& m) {
+	if constexpr (N == 1) {
+		return m.m[0][0];
+	}
+	else if constexpr (N == 2) {
+		return m.m[0][0] * m.m[1][1] - m.m[0][1] * m.m[1][0];
+	}
+	else {
+		T result = T(0);
+		UnrollFor<N>([&](auto j) {
+			const T cofactor = Determinant(GetMinor(m, 0, j));
+			result += (j % 2 == 0 ? m.m[0][j] : -m.m[0][j]) * cofactor;
+		});
+		return result;
+	}
+}
+// 逆行列(正則でなければfalseを返し、resultは変更しない)
+// 余因子行列を行列式で割る
+template<class T, size_t N>
+constexpr bool TryInverse(const Mat<T, N, N>& m, Mat<T, N, N>& result) {
+	const T determinant = Determinant(m);
+	if (determinant == T(0)) {
+		return false;
+	}
+	if constexpr (N == 1) {
+		result.m[0][0] = T(1) / determinant;
+	}
+	else {
+		const T inverseDeterminant = T(1) / determinant;
+		// (i, j)成分は(j, i)成分の余因子
+		result = MakeMat<T, N, N>([&](auto i, auto j) {
+			const T cofactor = Determinant(GetMinor(m, j, i));
+			return ((i + j) % 2 == 0 ? cofactor : -cofactor) * inverseDeterminant;
+		});
+	}
+	return true;
+}
+// 逆行列(正則であること)
+template<class T, size_t N>
+constexpr Mat<T, N, N> Inverse(const Mat<T, N, N>& m) {
+	Mat<T, N, N> result{};
+	[[maybe_unused]] const bool succeeded = TryInverse(m, result);
+	assert(succeeded);
+	return result;
+}
+
+// 既存の型との変換
+// 同じ並びだがstd::bit_castはメモリを経由するコードになりやすいので、要素ごとに写す
+constexpr Vec2f ToVec(const Vector2& v) { return Vec2f{ v.x, v.y }; }
+constexpr Vec3f ToVec(const Vector3& v) { return Vec3f{ v.x, v.y, v.z }; }
+constexpr Vec4f ToVec(const Vector4& v) { return Vec4f{ v.x, v.y, v.z, v.w }; }
+constexpr Mat4f ToMat(const Matrix4x4& m) {
+	return MakeMat<float, 4, 4>([&](auto i, auto j) { return m.m[i][j]; });
+}
+constexpr Vector2 ToVector2(const Vec2f& v) { return Vector2{ v[0], v[1] }; }
+constexpr Vector3 ToVector3(const Vec3f& v) { return Vector3{ v[0], v[1], v[2] }; }
+constexpr Vector4 ToVector4(const Vec4f& v) { return Vector4{ v[0], v[1], v[2], v[3] }; }
+constexpr Matrix4x4 ToMatrix4x4(const Mat4f& m) {
+	Matrix4x4 result{};
+	UnrollFor<4>([&](auto i) {
+		UnrollFor<4>([&](auto j) { result.m[i][j] = m.m[i][j]; });
+	});
+	return result;
+}
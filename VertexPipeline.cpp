@@ -0,0 +1,89 @@
+#include "VertexPipeline.h"
+
+#include <cassert>
+#include "JobSystem.h"
+#include "MathFunction.h"
+#include "MathKernel.h"
+#include "SimdDispatch.h"
+
+namespace {
+
+// 1回に変換する頂点数(作業領域がL1に収まる量)
+const size_t kChunkSize = 256;
+// JobSystemで分けるときの1区間の最小の頂点数
+const size_t kParallelMinGrain = 2048;
+
+// (x, y, z, 1) * matrix
+Vector4 TransformHomogeneous(const Vector3& v, const Matrix4x4& matrix) {
+	return Vector4{
+	    v.x * matrix.m[0][0] + v.y * matrix.m[1][0] + v.z * matrix.m[2][0] + matrix.m[3][0],
+	    v.x * matrix.m[0][1] + v.y * matrix.m[1][1] + v.z * matrix.m[2][1] + matrix.m[3][1],
+	    v.x * matrix.m[0][2] + v.y * matrix.m[1][2] + v.z * matrix.m[2][2] + matrix.m[3][2],
+	    v.x * matrix.m[0][3] + v.y * matrix.m[1][3] + v.z * matrix.m[2][3] + matrix.m[3][3] };
+}
+
+// クリップ座標をビューポート変換してw除算する(ビューポート行列はアフィンなのでwは変わらない)
+Vector3 ClipToScreen(const Vector4& clip, const Matrix4x4& viewport) {
+	const float inverseW = 1.0f / clip.w;
+	const Vector3 ndc{ clip.x * inverseW, clip.y * inverseW, clip.z * inverseW };
+	return Vector3{
+	    ndc.x * viewport.m[0][0] + ndc.y * viewport.m[1][0] + ndc.z * viewport.m[2][0] + viewport.m[3][0],
+	    ndc.x * viewport.m[0][1] + ndc.y * viewport.m[1][1] + ndc.z * viewport.m[2][1] + viewport.m[3][1],
+	    ndc.x * viewport.m[0][2] + ndc.y * viewport.m[1][2] + ndc.z * viewport.m[2][2] + viewport.m[3][2] };
+}
+
+} // namespace
+
+VertexPipeline::VertexPipeline(
+    const Matrix4x4& world, const Matrix4x4& view, const Matrix4x4& projection, const Matrix4x4& viewport)
+    : clipMatrix_(Multiply(Multiply(world, view), projection)), viewport_(viewport) {
+	assert(IsAffineMatrix(viewport));
+	screenMatrix_ = Multiply(clipMatrix_, viewport);
+}
+
+// kChunkSize個ずつSoAに集めてから変換する
+void VertexPipeline::Transform(const Vector3* positions, size_t stride, size_t count, ScreenVertex* output) const {
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(positions);
+	JobSystem::GetInstance().ParallelFor(count, kParallelMinGrain, [&](size_t rangeBegin, size_t rangeEnd) {
+		float x[kChunkSize], y[kChunkSize], z[kChunkSize];
+		for (size_t begin = rangeBegin; begin < rangeEnd; begin += kChunkSize) {
+			const size_t chunkCount = rangeEnd - begin < kChunkSize ? rangeEnd - begin : kChunkSize;
+			for (size_t i = 0; i < chunkCount; i++) {
+				const Vector3& position = *reinterpret_cast<const Vector3*>(bytes + (begin + i) * stride);
+				x[i] = position.x;
+				y[i] = position.y;
+				z[i] = position.z;
+			}
+			Transform(ConstVector3SoA(x, y, z), chunkCount, output + begin);
+		}
+	});
+}
+
+void VertexPipeline::Transform(const ConstVector3SoA& positions, size_t count, ScreenVertex* output) const {
+	static const auto kernel = MT4_SELECT_SIMD_KERNEL(ProjectPoints);
+	JobSystem::GetInstance().ParallelFor(count, kParallelMinGrain, [&](size_t begin, size_t end) {
+		const ConstVector3SoA range(positions.x + begin, positions.y + begin, positions.z + begin);
+		kernel(range, output + begin, end - begin, clipMatrix_, screenMatrix_);
+	});
+}
+
+// 同次座標で z = 0 (近クリップ面)との交点を求めて手前側を置き換える
+bool VertexPipeline::TransformSegment(
+    const Vector3& start, const Vector3& end, Vector3& screenStart, Vector3& screenEnd) const {
+	Vector4 clipStart = TransformHomogeneous(start, clipMatrix_);
+	Vector4 clipEnd = TransformHomogeneous(end, clipMatrix_);
+	if (clipStart.z < 0.0f && clipEnd.z < 0.0f) {
+		return false;
+	}
+	if (clipStart.z < 0.0f) {
+		clipStart = Lerp(clipStart, clipEnd, clipStart.z / (clipStart.z - clipEnd.z));
+		clipStart.z = 0.0f;
+	}
+	else if (clipEnd.z < 0.0f) {
+		clipEnd = Lerp(clipEnd, clipStart, clipEnd.z / (clipEnd.z - clipStart.z));
+		clipEnd.z = 0.0f;
+	}
+	screenStart = ClipToScreen(clipStart, viewport_);
+	screenEnd = ClipToScreen(clipEnd, viewport_);
+	return true;
+}
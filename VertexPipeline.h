@@ -0,0 +1,53 @@
+#pragma once
+
+// 頂点変換(ワールド → ビュー → 射影 → ビューポート)
+// 4つの行列を作成時に合成しておき、頂点ごとの計算は行列1回分とw除算1回で済ませる
+// クリップ判定は射影後の同次座標で行い(深度は0～1)、近クリップ面の手前の頂点は除算しない
+
+#include <cstddef>
+#include <cstdint>
+#include "Matrix4x4.h"
+#include "Vector3.h"
+#include "Vector3SoA.h"
+
+// 頂点が外側にあるクリップ面のビット(Frustumの平面と同じ順番)
+constexpr uint32_t kClipLeft = 1 << 0;
+constexpr uint32_t kClipRight = 1 << 1;
+constexpr uint32_t kClipBottom = 1 << 2;
+constexpr uint32_t kClipTop = 1 << 3;
+constexpr uint32_t kClipNear = 1 << 4;
+constexpr uint32_t kClipFar = 1 << 5;
+
+// 変換後の頂点(一括変換では16バイト単位でまとめて書き込む)
+struct ScreenVertex final {
+	Vector3 position; // x, yはスクリーン座標、zは深度(ビューポートのminDepth～maxDepth)
+	uint32_t clipFlags; // 0なら視錐台の内側。kClipNearが立っていればpositionは(0, 0, 0)
+};
+static_assert(sizeof(ScreenVertex) == 16);
+
+class VertexPipeline {
+public:
+	// viewportはMakeViewportMatrixで作ったもの(アフィン行列であること)
+	VertexPipeline(const Matrix4x4& world, const Matrix4x4& view, const Matrix4x4& projection, const Matrix4x4& viewport);
+
+	// 頂点の一括変換
+	// positionsはstrideバイト間隔で並んだ頂点の先頭の座標(頂点構造体の配列をそのまま渡せる)
+	// SoAに詰め替えながらL1に収まる数ずつ変換する
+	void Transform(const Vector3* positions, size_t stride, size_t count, ScreenVertex* output) const;
+	void Transform(const Vector3* positions, size_t count, ScreenVertex* output) const {
+		Transform(positions, sizeof(Vector3), count, output);
+	}
+	void Transform(const ConstVector3SoA& positions, size_t count, ScreenVertex* output) const;
+
+	// 線分を近クリップ面で切り取ってスクリーン座標にする(全体が手前ならfalseを返す)
+	bool TransformSegment(const Vector3& start, const Vector3& end, Vector3& screenStart, Vector3& screenEnd) const;
+
+	// 合成した行列
+	const Matrix4x4& GetClipMatrix() const { return clipMatrix_; }
+	const Matrix4x4& GetScreenMatrix() const { return screenMatrix_; }
+
+private:
+	Matrix4x4 clipMatrix_; // world * view * projection
+	Matrix4x4 screenMatrix_; // clipMatrix_ * viewport
+	Matrix4x4 viewport_;
+};
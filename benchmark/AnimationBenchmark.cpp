@@ -0,0 +1,320 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "Animation.h"
+#include "Benchmark.h"
+#include "MathFunction.h"
+#include "SimdDispatch.h"
+
+// 1万チャンネルのアニメーションを1/60秒ずつ進めながら評価する
+// チャンネルごとにキーを先頭から線形探索してLerp/Slerp/LerpShortAngleを呼ぶ場合と、トラックで一括評価する場合を比べる
+// 最後に1万ボーンの平行移動・回転・スケールから行列を作るまでを比べる
+// 計測の前に、トラックの評価結果がチャンネルごとの評価と一致することを確かめる(違えば1を返す)
+
+namespace {
+
+const size_t kChannelCount = 10000;
+const size_t kKeyCount = 30;
+const float kDuration = 10.0f;
+const float kFrameTime = 1.0f / 60.0f;
+// トラックとチャンネルごとの評価の差の上限
+const float kTolerance = 1e-5f;
+// 確かめるときのチャンネル数(JobSystemで分かれ、kChunkSizeの端数も出る数)
+const size_t kCheckChannelCount = 3001;
+
+// チャンネルごとのキー(時刻は少しずつずらす)
+struct Channels {
+	std::vector<std::vector<float>> times;
+	std::vector<std::vector<Vector3>> vectors;
+	std::vector<std::vector<Vector3>> angles;
+	std::vector<std::vector<Quaternion>> rotates;
+};
+
+Channels MakeChannels() {
+	std::mt19937 random(0);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	Channels channels;
+	for (size_t c = 0; c < kChannelCount; c++) {
+		std::vector<float> times(kKeyCount);
+		std::vector<Vector3> vectors(kKeyCount), angles(kKeyCount);
+		std::vector<Quaternion> rotates(kKeyCount);
+		for (size_t k = 0; k < kKeyCount; k++) {
+			times[k] = kDuration * (float(k) + (k == 0 ? 0.0f : unit(random) * 0.5f)) / float(kKeyCount - 1);
+			vectors[k] = { unit(random) * 2.0f - 1.0f, unit(random) * 2.0f - 1.0f, unit(random) * 2.0f - 1.0f };
+			angles[k] = { unit(random) * 12.0f - 6.0f, unit(random) * 12.0f - 6.0f, unit(random) * 12.0f - 6.0f };
+			const Vector3 axis = Normalize(Vector3{ unit(random) - 0.5f, unit(random) - 0.5f, unit(random) - 0.5f });
+			rotates[k] = MakeRotateAxisAngleQuaternion(axis, unit(random) * 2.0f);
+		}
+		times.back() = kDuration;
+		channels.times.push_back(times);
+		channels.vectors.push_back(vectors);
+		channels.angles.push_back(angles);
+		channels.rotates.push_back(rotates);
+	}
+	return channels;
+}
+
+// 確かめる用のチャンネル 種類を順に繰り返す
+// 通常のキー、キーが1つ、同じ時刻のキーが続く(先頭・途中・末尾)、時刻が途中から始まる、キーが多い
+Channels MakeCheckChannels() {
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	Channels channels;
+	for (size_t c = 0; c < kCheckChannelCount; c++) {
+		const size_t kind = c % 5;
+		const size_t keyCount = kind == 1 ? 1 : kind == 4 ? 40 : 8;
+		const float start = kind == 3 ? 3.0f : unit(random) * 0.5f;
+		const float end = kind == 3 ? 7.0f : kDuration - unit(random) * 0.5f;
+		std::vector<float> times(keyCount);
+		for (float& time : times) {
+			time = start + (end - start) * unit(random);
+		}
+		std::sort(times.begin(), times.end());
+		if (kind == 2) {
+			times[1] = times[0];
+			times[keyCount / 2] = times[keyCount / 2 - 1];
+			times[keyCount - 1] = times[keyCount - 2];
+		}
+		std::vector<Vector3> vectors(keyCount), angles(keyCount);
+		std::vector<Quaternion> rotates(keyCount);
+		for (size_t k = 0; k < keyCount; k++) {
+			vectors[k] = { unit(random) * 2.0f - 1.0f, unit(random) * 2.0f - 1.0f, unit(random) * 2.0f - 1.0f };
+			angles[k] = { unit(random) * 12.0f - 6.0f, unit(random) * 12.0f - 6.0f, unit(random) * 12.0f - 6.0f };
+			const Vector3 axis = Normalize(Vector3{ unit(random) - 0.5f, unit(random) - 0.5f, unit(random) - 0.5f });
+			rotates[k] = MakeRotateAxisAngleQuaternion(axis, unit(random) * 3.0f);
+		}
+		channels.times.push_back(times);
+		channels.vectors.push_back(vectors);
+		channels.angles.push_back(angles);
+		channels.rotates.push_back(rotates);
+	}
+	return channels;
+}
+
+// キーを先頭から探して補間係数を求める(変更前の評価方法)
+size_t FindKey(const std::vector<float>& times, float time, float& t) {
+	if (time <= times.front()) {
+		t = 0.0f;
+		return 0;
+	}
+	for (size_t k = 0; k + 1 < times.size(); k++) {
+		if (time < times[k + 1]) {
+			t = (time - times[k]) / (times[k + 1] - times[k]);
+			return k;
+		}
+	}
+	t = 1.0f;
+	return times.size() - 2;
+}
+
+struct SoA3 {
+	std::vector<float> x, y, z;
+	explicit SoA3(size_t count = kChannelCount) : x(count), y(count), z(count) {}
+	Vector3SoA Get() { return { x.data(), y.data(), z.data() }; }
+	Vector3 At(size_t i) const { return { x[i], y[i], z[i] }; }
+};
+
+struct SoA4 {
+	std::vector<float> x, y, z, w;
+	explicit SoA4(size_t count = kChannelCount) : x(count), y(count), z(count), w(count) {}
+	QuaternionSoA Get() { return { x.data(), y.data(), z.data(), w.data() }; }
+	Quaternion At(size_t i) const { return { x[i], y[i], z[i], w[i] }; }
+};
+
+// 誤差の最大値を更新する(NaNは残す)
+void UpdateMaxError(float& maxError, float error) {
+	if (!(error <= maxError) && !std::isnan(maxError)) {
+		maxError = error;
+	}
+}
+
+// 角度の差(2πの違いは同じとみなす)
+float AngleDifference(float a, float b) {
+	return std::fabs(std::remainder(a - b, 6.28318531f));
+}
+
+// トラックの評価結果をFindKeyとLerp/LerpShortAngle/Slerp/Nlerpで求めた値と比べる
+// 順に再生する、巻き戻る、範囲外、遠くへ飛ぶ、キーの時刻ちょうどの時刻で評価し、カーソルは通して使う
+bool CheckTracks() {
+	const Channels channels = MakeCheckChannels();
+	Vector3Track translateTrack;
+	Vector3Track angleTrack(Vector3Interpolation::kShortAngle);
+	QuaternionTrack slerpTrack;
+	QuaternionTrack nlerpTrack(QuaternionInterpolation::kNlerp);
+	for (size_t c = 0; c < kCheckChannelCount; c++) {
+		const size_t keyCount = channels.times[c].size();
+		translateTrack.AddChannel(channels.times[c].data(), channels.vectors[c].data(), keyCount);
+		angleTrack.AddChannel(channels.times[c].data(), channels.angles[c].data(), keyCount);
+		slerpTrack.AddChannel(channels.times[c].data(), channels.rotates[c].data(), keyCount);
+		nlerpTrack.AddChannel(channels.times[c].data(), channels.rotates[c].data(), keyCount);
+	}
+
+	std::vector<float> sampleTimes;
+	for (float time = -1.0f; time < kDuration + 1.0f; time += kFrameTime) {
+		sampleTimes.push_back(time);
+	}
+	for (float time : { 9.9f, 0.05f, 5.0f, 4.95f, 4.9f, 9.0f, 1.0f, -5.0f, 20.0f, 0.0f, kDuration }) {
+		sampleTimes.push_back(time);
+	}
+	for (size_t c : { size_t(0), size_t(2), size_t(4) }) {
+		for (float time : channels.times[c]) {
+			sampleTimes.push_back(time);
+		}
+	}
+	std::mt19937 random(2);
+	std::uniform_real_distribution<float> anyTime(-1.0f, kDuration + 1.0f);
+	for (int i = 0; i < 64; i++) {
+		sampleTimes.push_back(anyTime(random));
+	}
+
+	std::vector<uint32_t> translateCursors(kCheckChannelCount), angleCursors(kCheckChannelCount),
+	    slerpCursors(kCheckChannelCount), nlerpCursors(kCheckChannelCount);
+	SoA3 translates(kCheckChannelCount), angles(kCheckChannelCount);
+	SoA4 slerps(kCheckChannelCount), nlerps(kCheckChannelCount);
+	float translateError = 0.0f, angleError = 0.0f, slerpError = 0.0f, nlerpError = 0.0f;
+	for (float time : sampleTimes) {
+		translateTrack.Sample(time, translateCursors.data(), translates.Get());
+		angleTrack.Sample(time, angleCursors.data(), angles.Get());
+		slerpTrack.Sample(time, slerpCursors.data(), slerps.Get());
+		nlerpTrack.Sample(time, nlerpCursors.data(), nlerps.Get());
+		for (size_t c = 0; c < kCheckChannelCount; c++) {
+			// キーが1つならその値
+			size_t k = 0;
+			float t = 0.0f;
+			if (channels.times[c].size() > 1) {
+				k = FindKey(channels.times[c], time, t);
+			}
+			const size_t next = std::min(k + 1, channels.times[c].size() - 1);
+			const Vector3 translate = Lerp(channels.vectors[c][k], channels.vectors[c][next], t);
+			const Vector3& from = channels.angles[c][k];
+			const Vector3& to = channels.angles[c][next];
+			const Vector3 angle{ LerpShortAngle(from.x, to.x, t), LerpShortAngle(from.y, to.y, t),
+				LerpShortAngle(from.z, to.z, t) };
+			const Quaternion slerp = Slerp(channels.rotates[c][k], channels.rotates[c][next], t);
+			const Quaternion nlerp = Nlerp(channels.rotates[c][k], channels.rotates[c][next], t);
+			UpdateMaxError(translateError, Length(Subtract(translate, translates.At(c))));
+			const Vector3 sampledAngle = angles.At(c);
+			UpdateMaxError(angleError, AngleDifference(angle.x, sampledAngle.x));
+			UpdateMaxError(angleError, AngleDifference(angle.y, sampledAngle.y));
+			UpdateMaxError(angleError, AngleDifference(angle.z, sampledAngle.z));
+			const Quaternion sampledSlerp = slerps.At(c), sampledNlerp = nlerps.At(c);
+			UpdateMaxError(slerpError, Norm(Quaternion{ slerp.x - sampledSlerp.x, slerp.y - sampledSlerp.y,
+			                               slerp.z - sampledSlerp.z, slerp.w - sampledSlerp.w }));
+			UpdateMaxError(nlerpError, Norm(Quaternion{ nlerp.x - sampledNlerp.x, nlerp.y - sampledNlerp.y,
+			                               nlerp.z - sampledNlerp.z, nlerp.w - sampledNlerp.w }));
+		}
+	}
+	const bool ok = translateError <= kTolerance && angleError <= kTolerance && slerpError <= kTolerance &&
+	                nlerpError <= kTolerance;
+	std::printf("track vs per channel (%zu times)  Lerp %.1e  LerpShortAngle %.1e  Slerp %.1e  Nlerp %.1e  %s\n",
+	    sampleTimes.size(), translateError, angleError, slerpError, nlerpError, ok ? "ok" : "NG");
+	return ok;
+}
+
+void Print(const char* name, double each, double track) {
+	std::printf("%-26s per channel %8.2f M/s  track %8.2f M/s  x%.2f\n", name, each * 1e-6, track * 1e-6, track / each);
+}
+
+} // namespace
+
+int main() {
+	std::printf("simd: %s  channels: %zu  keys: %zu\n", GetSimdLevelName(GetSimdLevel()), kChannelCount, kKeyCount);
+	const bool ok = CheckTracks();
+	const Channels channels = MakeChannels();
+
+	Vector3Track translateTrack;
+	Vector3Track angleTrack(Vector3Interpolation::kShortAngle);
+	QuaternionTrack rotateTrack;
+	for (size_t c = 0; c < kChannelCount; c++) {
+		translateTrack.AddChannel(channels.times[c].data(), channels.vectors[c].data(), kKeyCount);
+		angleTrack.AddChannel(channels.times[c].data(), channels.angles[c].data(), kKeyCount);
+		rotateTrack.AddChannel(channels.times[c].data(), channels.rotates[c].data(), kKeyCount);
+	}
+	std::vector<uint32_t> translateCursors(kChannelCount), angleCursors(kChannelCount), rotateCursors(kChannelCount);
+
+	std::vector<Vector3> vectors(kChannelCount);
+	std::vector<Quaternion> rotates(kChannelCount);
+	SoA3 translates, angles;
+	SoA4 rotateSoA;
+	std::vector<Matrix4x4> matrices(kChannelCount);
+
+	float time = 0.0f;
+	const auto advance = [&] {
+		time += kFrameTime;
+		if (time > kDuration) {
+			time -= kDuration;
+		}
+		return time;
+	};
+
+	const double translateEach = Benchmark::MeasureThroughput(kChannelCount, [&] {
+		const float now = advance();
+		for (size_t c = 0; c < kChannelCount; c++) {
+			float t;
+			const size_t k = FindKey(channels.times[c], now, t);
+			vectors[c] = Lerp(channels.vectors[c][k], channels.vectors[c][k + 1], t);
+		}
+		Benchmark::DoNotOptimize(vectors);
+	});
+	const double translateBatch = Benchmark::MeasureThroughput(kChannelCount, [&] {
+		translateTrack.Sample(advance(), translateCursors.data(), translates.Get());
+		Benchmark::DoNotOptimize(translates.x);
+	});
+	Print("Vector3 (Lerp)", translateEach, translateBatch);
+
+	const double angleEach = Benchmark::MeasureThroughput(kChannelCount, [&] {
+		const float now = advance();
+		for (size_t c = 0; c < kChannelCount; c++) {
+			float t;
+			const size_t k = FindKey(channels.times[c], now, t);
+			const Vector3& from = channels.angles[c][k];
+			const Vector3& to = channels.angles[c][k + 1];
+			vectors[c] = { LerpShortAngle(from.x, to.x, t), LerpShortAngle(from.y, to.y, t), LerpShortAngle(from.z, to.z, t) };
+		}
+		Benchmark::DoNotOptimize(vectors);
+	});
+	const double angleBatch = Benchmark::MeasureThroughput(kChannelCount, [&] {
+		angleTrack.Sample(advance(), angleCursors.data(), angles.Get());
+		Benchmark::DoNotOptimize(angles.x);
+	});
+	Print("Vector3 (LerpShortAngle)", angleEach, angleBatch);
+
+	const double rotateEach = Benchmark::MeasureThroughput(kChannelCount, [&] {
+		const float now = advance();
+		for (size_t c = 0; c < kChannelCount; c++) {
+			float t;
+			const size_t k = FindKey(channels.times[c], now, t);
+			rotates[c] = Slerp(channels.rotates[c][k], channels.rotates[c][k + 1], t);
+		}
+		Benchmark::DoNotOptimize(rotates);
+	});
+	const double rotateBatch = Benchmark::MeasureThroughput(kChannelCount, [&] {
+		rotateTrack.Sample(advance(), rotateCursors.data(), rotateSoA.Get());
+		Benchmark::DoNotOptimize(rotateSoA.x);
+	});
+	Print("Quaternion (Slerp)", rotateEach, rotateBatch);
+
+	// 平行移動・回転・スケール(スケールも平行移動と同じキーを使う)から行列を作る
+	const double poseEach = Benchmark::MeasureThroughput(kChannelCount, [&] {
+		const float now = advance();
+		for (size_t c = 0; c < kChannelCount; c++) {
+			float t;
+			const size_t k = FindKey(channels.times[c], now, t);
+			const Vector3 translate = Lerp(channels.vectors[c][k], channels.vectors[c][k + 1], t);
+			const Quaternion rotate = Slerp(channels.rotates[c][k], channels.rotates[c][k + 1], t);
+			matrices[c] = MakeAffineMatrix(translate, rotate, translate);
+		}
+		Benchmark::DoNotOptimize(matrices);
+	});
+	const double poseBatch = Benchmark::MeasureThroughput(kChannelCount, [&] {
+		const float now = advance();
+		translateTrack.Sample(now, translateCursors.data(), translates.Get());
+		rotateTrack.Sample(now, rotateCursors.data(), rotateSoA.Get());
+		MakeAffineMatrix(translates.Get(), rotateSoA.Get(), translates.Get(), matrices.data(), kChannelCount);
+		Benchmark::DoNotOptimize(matrices);
+	});
+	Print("pose -> MakeAffineMatrix", poseEach, poseBatch);
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,364 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+#include "BVH.h"
+#include "Benchmark.h"
+#include "MathFunction.h"
+#include "SimdDispatch.h"
+
+// 起伏のある地面(三角形)の上に球と線分を置いた場面で、
+// 全図形を総当たりで調べる場合とBVHを比べる(レイの最初の交点と、点からの最近接点)
+// BVHの結果は総当たりの結果と同じ図形・同じ距離になることを確かめる(違えば終了コード1)
+// 最後に構築と、球を動かしたあとのRefitの時間を測る
+// 別に、SAHが端の数個ずつしか切り離せない並び(指数的に離れた点)でも葉が大きくならないことを確かめる
+
+namespace {
+
+const size_t kGridSize = 256; // 地面は(kGridSize x kGridSize)の四角形を2つずつの三角形に分ける
+const size_t kSphereCount = 4096;
+const size_t kSegmentCount = 4096;
+const float kSegmentRadius = 0.05f;
+const size_t kImageSize = 256; // レイは(kImageSize x kImageSize)の画素に1本ずつ
+const size_t kPointCount = 1 << 16;
+// 総当たりは遅いので一部だけ測る
+const size_t kBruteForceCount = 512;
+// 最近接点の距離の許容誤差
+const float kDistanceTolerance = 1e-4f;
+// 偏った並びの図形の数
+const size_t kSkewedCount = 1 << 18;
+
+float GetHeight(float x, float z) { return 2.0f * std::sin(x * 0.11f) * std::cos(z * 0.07f); }
+
+struct Scene {
+	std::vector<Triangle> triangles;
+	std::vector<Sphere> spheres;
+	std::vector<Segment> segments;
+
+	BVHGeometry GetGeometry() const {
+		return { triangles.data(), triangles.size(), spheres.data(), spheres.size(), segments.data(), segments.size(),
+			kSegmentRadius };
+	}
+};
+
+Scene MakeScene(std::mt19937& random) {
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	Scene scene;
+	for (size_t z = 0; z < kGridSize; z++) {
+		for (size_t x = 0; x < kGridSize; x++) {
+			const auto vertex = [](size_t vx, size_t vz) {
+				return Vector3{ float(vx), GetHeight(float(vx), float(vz)), float(vz) };
+			};
+			scene.triangles.push_back({ { vertex(x, z), vertex(x + 1, z), vertex(x, z + 1) } });
+			scene.triangles.push_back({ { vertex(x + 1, z), vertex(x + 1, z + 1), vertex(x, z + 1) } });
+		}
+	}
+	for (size_t i = 0; i < kSphereCount; i++) {
+		const float x = unit(random) * kGridSize, z = unit(random) * kGridSize;
+		scene.spheres.push_back({ { x, GetHeight(x, z) + 1.0f + unit(random) * 4.0f, z }, 0.2f + unit(random) * 0.8f });
+	}
+	for (size_t i = 0; i < kSegmentCount; i++) {
+		const float x = unit(random) * kGridSize, z = unit(random) * kGridSize;
+		const Vector3 origin{ x, GetHeight(x, z), z };
+		scene.segments.push_back({ origin, { unit(random) - 0.5f, 2.0f + unit(random) * 3.0f, unit(random) - 0.5f } });
+	}
+	return scene;
+}
+
+// 変更前の判定(全図形を1つずつ調べる)
+bool IntersectTriangle(const Ray& ray, const Triangle& triangle, float& t) {
+	const Vector3 e1 = Subtract(triangle.vertices[1], triangle.vertices[0]);
+	const Vector3 e2 = Subtract(triangle.vertices[2], triangle.vertices[0]);
+	const Vector3 p = Cross(ray.diff, e2);
+	const float det = Dot(e1, p);
+	if (det == 0.0f) {
+		return false;
+	}
+	const Vector3 s = Subtract(ray.origin, triangle.vertices[0]);
+	const float u = Dot(s, p) / det;
+	const Vector3 q = Cross(s, e1);
+	const float v = Dot(ray.diff, q) / det;
+	t = Dot(e2, q) / det;
+	return u >= 0.0f && v >= 0.0f && u + v <= 1.0f && t >= 0.0f;
+}
+
+bool IntersectSphere(const Ray& ray, const Sphere& sphere, float& t) {
+	const Vector3 offset = Subtract(ray.origin, sphere.center);
+	const float a = Dot(ray.diff, ray.diff);
+	const float b = Dot(offset, ray.diff);
+	const Vector3 line = Subtract(offset, Multiply(b / a, ray.diff));
+	const float discriminant = a * (sphere.radius * sphere.radius - Dot(line, line));
+	if (discriminant < 0.0f || -b + std::sqrt(discriminant) < 0.0f) {
+		return false;
+	}
+	t = std::fmax((-b - std::sqrt(discriminant)) / a, 0.0f);
+	return true;
+}
+
+// レイと線分が最も近づく位置で、線分までの距離がkSegmentRadius以下なら当たり
+bool IntersectSegment(const Ray& ray, const Segment& segment, float& t) {
+	const Vector3 w = Subtract(ray.origin, segment.origin);
+	const float a = Dot(ray.diff, ray.diff), b = Dot(ray.diff, segment.diff), c = Dot(segment.diff, segment.diff);
+	const float d = Dot(ray.diff, w), e = Dot(segment.diff, w);
+	const float denominator = a * c - b * b;
+	float s = denominator > a * c * 1e-6f ? std::fmax((b * e - c * d) / denominator, 0.0f) : 0.0f;
+	const float u = (b * s + e) / c;
+	if (u < 0.0f) {
+		s = std::fmax(-d / a, 0.0f);
+	}
+	else if (u > 1.0f) {
+		s = std::fmax((b - d) / a, 0.0f);
+	}
+	const Vector3 onRay = Add(ray.origin, Multiply(s, ray.diff));
+	const Vector3 offset = Subtract(onRay, ClosestPoint(onRay, segment));
+	t = s;
+	return Dot(offset, offset) <= kSegmentRadius * kSegmentRadius;
+}
+
+RayHit RaycastBruteForce(const Scene& scene, const Ray& ray, float maxT) {
+	RayHit hit{ maxT, kBVHNoHit, BVHPrimitiveType::kTriangle };
+	float t;
+	for (size_t i = 0; i < scene.triangles.size(); i++) {
+		if (IntersectTriangle(ray, scene.triangles[i], t) && t < hit.t) {
+			hit = { t, uint32_t(i), BVHPrimitiveType::kTriangle };
+		}
+	}
+	for (size_t i = 0; i < scene.spheres.size(); i++) {
+		if (IntersectSphere(ray, scene.spheres[i], t) && t < hit.t) {
+			hit = { t, uint32_t(i), BVHPrimitiveType::kSphere };
+		}
+	}
+	for (size_t i = 0; i < scene.segments.size(); i++) {
+		if (IntersectSegment(ray, scene.segments[i], t) && t < hit.t) {
+			hit = { t, uint32_t(i), BVHPrimitiveType::kSegment };
+		}
+	}
+	return hit;
+}
+
+float FindClosestDistanceBruteForce(const Scene& scene, const Vector3& point) {
+	float best = std::numeric_limits<float>::infinity();
+	for (const Triangle& triangle : scene.triangles) {
+		best = std::fmin(best, Length(Subtract(ClosestPoint(point, triangle), point)));
+	}
+	for (const Sphere& sphere : scene.spheres) {
+		best = std::fmin(best, Length(Subtract(ClosestPoint(point, sphere), point)));
+	}
+	for (const Segment& segment : scene.segments) {
+		best = std::fmin(best, Length(Subtract(ClosestPoint(point, segment), point)));
+	}
+	return best;
+}
+
+// 地面を斜め上から見下ろすカメラのレイ(画素の順に並べる)
+struct Rays {
+	std::vector<float> originX, originY, originZ, diffX, diffY, diffZ, maxT;
+
+	Ray Get(size_t i) const { return { { originX[i], originY[i], originZ[i] }, { diffX[i], diffY[i], diffZ[i] } }; }
+	ConstRaySoA GetSoA() const {
+		return { originX.data(), originY.data(), originZ.data(), diffX.data(), diffY.data(), diffZ.data() };
+	}
+};
+
+Rays MakeRays() {
+	Rays rays;
+	const Vector3 eye{ kGridSize * 0.5f, 60.0f, -40.0f };
+	for (size_t y = 0; y < kImageSize; y++) {
+		for (size_t x = 0; x < kImageSize; x++) {
+			const float u = (float(x) + 0.5f) / kImageSize - 0.5f;
+			const float v = (float(y) + 0.5f) / kImageSize - 0.5f;
+			const Vector3 direction = Normalize(Vector3{ u * 1.6f, -0.6f - v, 1.0f });
+			rays.originX.push_back(eye.x);
+			rays.originY.push_back(eye.y);
+			rays.originZ.push_back(eye.z);
+			rays.diffX.push_back(direction.x);
+			rays.diffY.push_back(direction.y);
+			rays.diffZ.push_back(direction.z);
+			rays.maxT.push_back(1000.0f);
+		}
+	}
+	return rays;
+}
+
+// 同じ図形に当たったか、距離がほぼ同じ(境界上で別の図形を選んだ)ならよい
+bool IsSameHit(const RayHit& a, const RayHit& b) {
+	if (a.index == kBVHNoHit || b.index == kBVHNoHit) {
+		return a.index == b.index;
+	}
+	return (a.index == b.index && a.type == b.type) || std::fabs(a.t - b.t) <= 1e-4f * std::fmax(a.t, 1.0f);
+}
+
+// 葉の図形の数がすべてkBVHMaxLeafSize以下で、合わせると図形の数になるか
+bool CheckLeaves(const BVH& bvh, size_t primitiveCount, size_t& maxLeafSize) {
+	size_t total = 0;
+	maxLeafSize = 0;
+	for (const BVHNode& node : bvh.GetNodes()) {
+		total += node.count;
+		maxLeafSize = std::max(maxLeafSize, size_t(node.count));
+	}
+	return total == primitiveCount && maxLeafSize <= kBVHMaxLeafSize;
+}
+
+// x軸上で2^-120から2^120まで指数的に離れた点(半径0の球)
+// 中心の範囲を16に分けたビンでは最も小さいビンにほとんどが入るので、SAHは大きい側の数個ずつしか切り離せない
+bool CheckSkewedScene() {
+	std::vector<Sphere> spheres(kSkewedCount);
+	for (size_t i = 0; i < kSkewedCount; i++) {
+		const int exponent = -120 + int(240 * i / kSkewedCount);
+		spheres[i] = { { std::ldexp(1.0f + float(i % 97) / 97.0f, exponent), 0.0f, 0.0f }, 0.0f };
+	}
+	BVH bvh;
+	bvh.Build({ nullptr, 0, spheres.data(), spheres.size(), nullptr, 0, 0.0f });
+	size_t maxLeafSize = 0;
+	bool ok = CheckLeaves(bvh, kSkewedCount, maxLeafSize);
+	// 最近接点が総当たりと同じ距離になるか
+	float maxError = 0.0f;
+	for (size_t i = 0; i < kSkewedCount; i += kSkewedCount / 64) {
+		const Vector3 point{ spheres[i].center.x, 1.0f, 0.0f };
+		float expected = std::numeric_limits<float>::infinity();
+		for (const Sphere& sphere : spheres) {
+			expected = std::fmin(expected, Length(Subtract(sphere.center, point)));
+		}
+		BVHClosestPoint closest;
+		ok &= bvh.FindClosestPoint(point, closest);
+		maxError = std::fmax(maxError, std::fabs(closest.distance - expected));
+	}
+	ok &= maxError <= kDistanceTolerance;
+	std::printf("skewed: %zu spheres  nodes %zu  max primitives per leaf %zu  max distance error %.1e  %s\n",
+	    kSkewedCount, bvh.GetNodes().size(), maxLeafSize, double(maxError), ok ? "ok" : "NG");
+	return ok;
+}
+
+} // namespace
+
+int main() {
+	std::printf("simd: %s\n", GetSimdLevelName(GetSimdLevel()));
+	std::mt19937 random(0);
+	Scene scene = MakeScene(random);
+	const size_t primitiveCount = scene.triangles.size() + scene.spheres.size() + scene.segments.size();
+	std::printf("triangles: %zu  spheres: %zu  segments: %zu\n", scene.triangles.size(), scene.spheres.size(),
+	    scene.segments.size());
+
+	BVH bvh;
+	const Benchmark::Measurement build = Benchmark::Measure(1, [&] { bvh.Build(scene.GetGeometry()); });
+	size_t leafCount = 0, maxLeafSize = 0;
+	for (const BVHNode& node : bvh.GetNodes()) {
+		leafCount += node.count > 0;
+	}
+	bool ok = CheckLeaves(bvh, primitiveCount, maxLeafSize);
+	std::printf("build %8.2f ms  nodes %zu  leaves %zu  (%.2f primitives per leaf)\n", build.nanoseconds * 1e-6,
+	    bvh.GetNodes().size(), leafCount, double(primitiveCount) / double(leafCount));
+
+	// レイ 画素の順(隣り合うレイの向きが近い)と、順番を混ぜたもの
+	const Rays rays = MakeRays();
+	const size_t rayCount = rays.originX.size();
+	Rays shuffled = rays;
+	{
+		std::vector<size_t> order(rayCount);
+		std::iota(order.begin(), order.end(), size_t(0));
+		std::shuffle(order.begin(), order.end(), random);
+		for (size_t i = 0; i < rayCount; i++) {
+			shuffled.diffX[i] = rays.diffX[order[i]];
+			shuffled.diffY[i] = rays.diffY[order[i]];
+			shuffled.diffZ[i] = rays.diffZ[order[i]];
+		}
+	}
+	std::vector<RayHit> hits(rayCount), singleHits(rayCount);
+	bvh.Raycast(rays.GetSoA(), rays.maxT.data(), hits.data(), rayCount);
+	size_t hitCount = 0, mismatches = 0;
+	for (size_t i = 0; i < rayCount; i++) {
+		hitCount += hits[i].index != kBVHNoHit;
+		bvh.Raycast(rays.Get(i), singleHits[i], rays.maxT[i]);
+		mismatches += !IsSameHit(hits[i], singleHits[i]);
+	}
+	const size_t step = rayCount / kBruteForceCount;
+	for (size_t i = 0; i < rayCount; i += step) {
+		mismatches += !IsSameHit(hits[i], RaycastBruteForce(scene, rays.Get(i), rays.maxT[i]));
+	}
+	ok &= mismatches == 0;
+	std::printf("rays: %zu  hit %zu  mismatches against brute force / single ray: %zu\n", rayCount, hitCount, mismatches);
+
+	const double bruteForce = Benchmark::MeasureThroughput(kBruteForceCount, [&] {
+		for (size_t i = 0; i < rayCount; i += step) {
+			Benchmark::DoNotOptimize(RaycastBruteForce(scene, rays.Get(i), rays.maxT[i]));
+		}
+	});
+	const double single = Benchmark::MeasureThroughput(rayCount, [&] {
+		for (size_t i = 0; i < rayCount; i++) {
+			bvh.Raycast(rays.Get(i), singleHits[i], rays.maxT[i]);
+		}
+		Benchmark::DoNotOptimize(singleHits);
+	});
+	const double packet = Benchmark::MeasureThroughput(rayCount, [&] {
+		bvh.Raycast(rays.GetSoA(), rays.maxT.data(), hits.data(), rayCount);
+		Benchmark::DoNotOptimize(hits);
+	});
+	const double incoherent = Benchmark::MeasureThroughput(rayCount, [&] {
+		bvh.Raycast(shuffled.GetSoA(), shuffled.maxT.data(), hits.data(), rayCount);
+		Benchmark::DoNotOptimize(hits);
+	});
+	std::printf("%-32s %10.3f M rays/s\n", "Raycast brute force", bruteForce * 1e-6);
+	std::printf("%-32s %10.3f M rays/s  x%.0f\n", "Raycast BVH single", single * 1e-6, single / bruteForce);
+	std::printf("%-32s %10.3f M rays/s  x%.0f\n", "Raycast BVH packet", packet * 1e-6, packet / bruteForce);
+	std::printf("%-32s %10.3f M rays/s  x%.0f\n", "Raycast BVH packet (shuffled)", incoherent * 1e-6,
+	    incoherent / bruteForce);
+
+	// 最近接点 場面の範囲の少し上の点
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::vector<float> px(kPointCount), py(kPointCount), pz(kPointCount);
+	for (size_t i = 0; i < kPointCount; i++) {
+		px[i] = unit(random) * kGridSize;
+		py[i] = unit(random) * 10.0f - 2.0f;
+		pz[i] = unit(random) * kGridSize;
+	}
+	const ConstVector3SoA points(px.data(), py.data(), pz.data());
+	std::vector<BVHClosestPoint> closest(kPointCount);
+	bvh.FindClosestPoints(points, closest.data(), kPointCount);
+	double maxError = 0.0;
+	const size_t pointStep = kPointCount / kBruteForceCount;
+	for (size_t i = 0; i < kPointCount; i += pointStep) {
+		const float expected = FindClosestDistanceBruteForce(scene, Vector3{ px[i], py[i], pz[i] });
+		maxError = std::max(maxError, double(std::fabs(closest[i].distance - expected)));
+	}
+	ok &= maxError <= kDistanceTolerance;
+	std::printf("closest points: %zu  max distance error against brute force %.1e\n", kPointCount, maxError);
+	const double closestBruteForce = Benchmark::MeasureThroughput(kBruteForceCount, [&] {
+		for (size_t i = 0; i < kPointCount; i += pointStep) {
+			Benchmark::DoNotOptimize(FindClosestDistanceBruteForce(scene, Vector3{ px[i], py[i], pz[i] }));
+		}
+	});
+	const double closestBVH = Benchmark::MeasureThroughput(kPointCount, [&] {
+		bvh.FindClosestPoints(points, closest.data(), kPointCount);
+		Benchmark::DoNotOptimize(closest);
+	});
+	std::printf("%-32s %10.3f M points/s\n", "ClosestPoint brute force", closestBruteForce * 1e-6);
+	std::printf("%-32s %10.3f M points/s  x%.0f\n", "ClosestPoint BVH", closestBVH * 1e-6, closestBVH / closestBruteForce);
+
+	// 球を少し動かしてRefitする(構築し直した場合と比べる)
+	std::uniform_real_distribution<float> offset(-0.5f, 0.5f);
+	for (Sphere& sphere : scene.spheres) {
+		sphere.center = Add(sphere.center, Vector3{ offset(random), offset(random), offset(random) });
+	}
+	const Benchmark::Measurement refit = Benchmark::Measure(1, [&] { bvh.Refit(scene.GetGeometry()); });
+	bvh.Raycast(rays.GetSoA(), rays.maxT.data(), hits.data(), rayCount);
+	const double refitPacket = Benchmark::MeasureThroughput(rayCount, [&] {
+		bvh.Raycast(rays.GetSoA(), rays.maxT.data(), hits.data(), rayCount);
+		Benchmark::DoNotOptimize(hits);
+	});
+	mismatches = 0;
+	for (size_t i = 0; i < rayCount; i += step) {
+		mismatches += !IsSameHit(hits[i], RaycastBruteForce(scene, rays.Get(i), rays.maxT[i]));
+	}
+	BVH rebuilt;
+	const Benchmark::Measurement rebuild = Benchmark::Measure(1, [&] { rebuilt.Build(scene.GetGeometry()); });
+	std::printf("refit %8.2f ms (rebuild %.2f ms)  packet after refit %.3f M rays/s  mismatches %zu\n",
+	    refit.nanoseconds * 1e-6, rebuild.nanoseconds * 1e-6, refitPacket * 1e-6, mismatches);
+	ok &= mismatches == 0;
+
+	ok &= CheckSkewedScene();
+	std::printf("%s\n", ok ? "ok" : "NG");
+	return ok ? 0 : 1;
+}
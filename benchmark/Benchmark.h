@@ -0,0 +1,90 @@
+#pragma once
+
+// ベンチマーク共通処理
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// タイムスタンプカウンタが読めるか
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define MT4_BENCHMARK_HAS_CYCLE_COUNTER 1
+#else
+#define MT4_BENCHMARK_HAS_CYCLE_COUNTER 0
+#endif
+
+namespace Benchmark {
+
+// 経過時間計測
+class Stopwatch {
+public:
+	Stopwatch() : start_(std::chrono::steady_clock::now()) {}
+
+	// 計測開始からの経過秒数
+	double GetSeconds() const {
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+	}
+
+private:
+	std::chrono::steady_clock::time_point start_;
+};
+
+// 計測対象の計算結果が最適化で消されないようにする
+template<class T>
+inline void DoNotOptimize(const T& value) {
+#if defined(_MSC_VER) && !defined(__clang__)
+	static const void* volatile sink;
+	sink = &value;
+	_ReadWriteBarrier();
+#else
+	asm volatile("" : : "r"(&value) : "memory");
+#endif
+}
+
+// タイムスタンプカウンタの値(rdtsc 読めなければ0)
+// 一定周期で進むので、ターボなどでコアのクロックが変わると実際のサイクル数とはずれる
+inline uint64_t ReadCycleCounter() {
+#if MT4_BENCHMARK_HAS_CYCLE_COUNTER
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+// 計測結果(1要素あたり)
+struct Measurement {
+	double nanoseconds;
+	double elementsPerSecond;
+	double cycles; // タイムスタンプカウンタが読めなければ0
+};
+
+// 1回あたりの要素数を与えて、一定時間以上繰り返した処理を計測する
+template<class Func>
+inline Measurement Measure(size_t elementsPerCall, Func&& func, double minSeconds = 0.2) {
+	func(); // ウォームアップ
+	size_t calls = 0;
+	Stopwatch stopwatch;
+	const uint64_t startCycles = ReadCycleCounter();
+	double seconds = 0.0;
+	do {
+		func();
+		calls++;
+		seconds = stopwatch.GetSeconds();
+	} while (seconds < minSeconds);
+	const uint64_t cycles = ReadCycleCounter() - startCycles;
+	const double elements = double(elementsPerCall) * double(calls);
+	return Measurement{ seconds * 1e9 / elements, elements / seconds, double(cycles) / elements };
+}
+
+// 1回あたりの要素数を与えて、一定時間以上繰り返した処理の要素/秒を返す
+template<class Func>
+inline double MeasureThroughput(size_t elementsPerCall, Func&& func, double minSeconds = 0.2) {
+	return Measure(elementsPerCall, func, minSeconds).elementsPerSecond;
+}
+
+} // namespace Benchmark
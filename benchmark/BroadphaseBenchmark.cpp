@@ -0,0 +1,209 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "Broadphase.h"
+#include "JobSystem.h"
+#include "SimdDispatch.h"
+
+// 密度を一定にして球の数を1000から100万まで増やし、総当たり・SweepAndPrune・SpatialHashGridを比べる
+// 組は総当たり(数が多いときはSweepAndPruneとSpatialHashGrid同士)と同じになることを確かめる
+// SweepAndPruneは最初のフレーム(並べ替えから)と、少し動かしたあとのフレーム(挿入ソート)を分けて測る
+// 格子のセルより極端に大きい物体が混ざる場合も確かめ、どれかが一致しなければ失敗(終了コード1)にする
+
+namespace {
+
+// 物体1つあたりの空間の体積
+const float kVolumePerObject = 8.0f;
+const float kMinRadius = 0.5f;
+const float kMaxRadius = 1.0f;
+// 1フレームで動かす距離の最大
+const float kStep = 0.05f;
+// 総当たりで確かめる最大の数
+const size_t kBruteForceMaxCount = 10000;
+
+struct Spheres {
+	std::vector<float> x, y, z, radius;
+
+	explicit Spheres(size_t count) : x(count), y(count), z(count), radius(count) {}
+	ConstSphereSoA GetSoA() const { return { x.data(), y.data(), z.data(), radius.data() }; }
+};
+
+// 総当たり(SphereShape::Overlapsと同じ式)
+void FindPairsBruteForce(const ConstSphereSoA& spheres, size_t count, std::vector<CollisionPair>& pairs) {
+	pairs.clear();
+	for (uint32_t a = 0; a < count; a++) {
+		for (uint32_t b = a + 1; b < count; b++) {
+			const float dx = spheres.x[b] - spheres.x[a];
+			const float dy = spheres.y[b] - spheres.y[a];
+			const float dz = spheres.z[b] - spheres.z[a];
+			const float radius = spheres.radius[a] + spheres.radius[b];
+			if (dx * dx + dy * dy + dz * dz <= radius * radius) {
+				pairs.push_back({ a, b });
+			}
+		}
+	}
+}
+
+void FindPairsBruteForce(const ConstAABBSoA& aabbs, size_t count, std::vector<CollisionPair>& pairs) {
+	pairs.clear();
+	for (uint32_t a = 0; a < count; a++) {
+		for (uint32_t b = a + 1; b < count; b++) {
+			if (aabbs.minX[a] <= aabbs.maxX[b] && aabbs.minX[b] <= aabbs.maxX[a] &&
+			    aabbs.minY[a] <= aabbs.maxY[b] && aabbs.minY[b] <= aabbs.maxY[a] &&
+			    aabbs.minZ[a] <= aabbs.maxZ[b] && aabbs.minZ[b] <= aabbs.maxZ[a]) {
+				pairs.push_back({ a, b });
+			}
+		}
+	}
+}
+
+// 並べて比べる
+bool SamePairs(std::vector<CollisionPair> a, std::vector<CollisionPair> b) {
+	const auto less = [](const CollisionPair& l, const CollisionPair& r) {
+		return l.first != r.first ? l.first < r.first : l.second < r.second;
+	};
+	std::sort(a.begin(), a.end(), less);
+	std::sort(b.begin(), b.end(), less);
+	return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](const CollisionPair& l, const CollisionPair& r) {
+		return l.first == r.first && l.second == r.second;
+	});
+}
+
+// 球を囲むAABB
+void ToAABBs(const Spheres& spheres, std::vector<float> (&bounds)[6]) {
+	const size_t count = spheres.x.size();
+	for (std::vector<float>& component : bounds) {
+		component.resize(count);
+	}
+	for (size_t i = 0; i < count; i++) {
+		bounds[0][i] = spheres.x[i] - spheres.radius[i];
+		bounds[1][i] = spheres.y[i] - spheres.radius[i];
+		bounds[2][i] = spheres.z[i] - spheres.radius[i];
+		bounds[3][i] = spheres.x[i] + spheres.radius[i];
+		bounds[4][i] = spheres.y[i] + spheres.radius[i];
+		bounds[5][i] = spheres.z[i] + spheres.radius[i];
+	}
+}
+
+} // namespace
+
+int main() {
+	std::printf("simd: %s  threads: %zu\n", GetSimdLevelName(GetSimdLevel()), JobSystem::GetInstance().GetThreadCount());
+	std::printf("%8s %9s %6s %12s %12s %12s %12s\n", "count", "pairs", "match", "brute ms", "SAP first ms",
+	    "SAP next ms", "grid ms");
+	std::mt19937 random(0);
+	std::vector<CollisionPair> expected, pairs, gridPairs;
+	bool allMatch = true;
+	for (size_t count : { size_t(1000), size_t(10000), size_t(100000), size_t(1000000) }) {
+		const float size = std::cbrt(kVolumePerObject * count);
+		std::uniform_real_distribution<float> position(0.0f, size);
+		std::uniform_real_distribution<float> radius(kMinRadius, kMaxRadius);
+		std::uniform_real_distribution<float> step(-kStep, kStep);
+		Spheres spheres(count), moved(count);
+		for (size_t i = 0; i < count; i++) {
+			spheres.x[i] = position(random);
+			spheres.y[i] = position(random);
+			spheres.z[i] = position(random);
+			spheres.radius[i] = radius(random);
+			moved.x[i] = spheres.x[i] + step(random);
+			moved.y[i] = spheres.y[i] + step(random);
+			moved.z[i] = spheres.z[i] + step(random);
+			moved.radius[i] = spheres.radius[i];
+		}
+
+		SweepAndPrune sweepAndPrune;
+		SpatialHashGrid grid(kMaxRadius * 2.0f);
+		sweepAndPrune.FindPairs(spheres.GetSoA(), count, pairs);
+		grid.FindPairs(spheres.GetSoA(), count, gridPairs);
+		bool match = SamePairs(pairs, gridPairs);
+		double bruteForce = 0.0;
+		if (count <= kBruteForceMaxCount) {
+			FindPairsBruteForce(spheres.GetSoA(), count, expected);
+			match = match && SamePairs(pairs, expected);
+			bruteForce = Benchmark::Measure(1, [&] {
+				FindPairsBruteForce(spheres.GetSoA(), count, expected);
+			}).nanoseconds;
+
+			// AABBも確かめる
+			std::vector<float> bounds[6];
+			ToAABBs(spheres, bounds);
+			const ConstAABBSoA aabbs(bounds[0].data(), bounds[1].data(), bounds[2].data(), bounds[3].data(),
+			    bounds[4].data(), bounds[5].data());
+			FindPairsBruteForce(aabbs, count, expected);
+			sweepAndPrune.FindPairs(aabbs, count, pairs);
+			grid.FindPairs(aabbs, count, gridPairs);
+			match = match && SamePairs(pairs, expected) && SamePairs(gridPairs, expected);
+		}
+		// 動かしたあとも同じになること
+		sweepAndPrune.FindPairs(spheres.GetSoA(), count, pairs);
+		sweepAndPrune.FindPairs(moved.GetSoA(), count, pairs);
+		grid.FindPairs(moved.GetSoA(), count, gridPairs);
+		match = match && SamePairs(pairs, gridPairs);
+		const size_t pairCount = pairs.size();
+
+		const double first = Benchmark::Measure(1, [&] {
+			SweepAndPrune fresh;
+			fresh.FindPairs(spheres.GetSoA(), count, pairs);
+			Benchmark::DoNotOptimize(pairs);
+		}).nanoseconds;
+		// 2つの位置を交互に渡して、毎回少し動いた状態にする
+		bool flip = false;
+		const double next = Benchmark::Measure(1, [&] {
+			sweepAndPrune.FindPairs(flip ? moved.GetSoA() : spheres.GetSoA(), count, pairs);
+			flip = !flip;
+			Benchmark::DoNotOptimize(pairs);
+		}).nanoseconds;
+		const double gridTime = Benchmark::Measure(1, [&] {
+			grid.FindPairs(spheres.GetSoA(), count, gridPairs);
+			Benchmark::DoNotOptimize(gridPairs);
+		}).nanoseconds;
+
+		allMatch = allMatch && match;
+		std::printf("%8zu %9zu %6s", count, pairCount, match ? "ok" : "NG");
+		if (bruteForce > 0.0) {
+			std::printf(" %12.3f", bruteForce * 1e-6);
+		}
+		else {
+			std::printf(" %12s", "-");
+		}
+		std::printf(" %12.3f %12.3f %12.3f\n", first * 1e-6, next * 1e-6, gridTime * 1e-6);
+	}
+
+	// 多くのセルにまたがる物体(セルの数がuint32_tに収まらないものも含む)
+	{
+		const size_t count = 2000;
+		const float size = std::cbrt(kVolumePerObject * count);
+		std::uniform_real_distribution<float> position(0.0f, size);
+		std::uniform_real_distribution<float> radius(kMinRadius, kMaxRadius);
+		Spheres spheres(count);
+		for (size_t i = 0; i < count; i++) {
+			spheres.x[i] = position(random);
+			spheres.y[i] = position(random);
+			spheres.z[i] = position(random);
+			spheres.radius[i] = radius(random);
+		}
+		spheres.radius[0] = 1e7f;
+		spheres.radius[count / 2] = 10.0f;
+		spheres.radius[count - 1] = 1e9f;
+		SweepAndPrune sweepAndPrune;
+		SpatialHashGrid grid(kMaxRadius * 2.0f);
+		FindPairsBruteForce(spheres.GetSoA(), count, expected);
+		sweepAndPrune.FindPairs(spheres.GetSoA(), count, pairs);
+		grid.FindPairs(spheres.GetSoA(), count, gridPairs);
+		bool match = SamePairs(pairs, expected) && SamePairs(gridPairs, expected);
+		std::vector<float> bounds[6];
+		ToAABBs(spheres, bounds);
+		const ConstAABBSoA aabbs(bounds[0].data(), bounds[1].data(), bounds[2].data(), bounds[3].data(),
+		    bounds[4].data(), bounds[5].data());
+		FindPairsBruteForce(aabbs, count, expected);
+		sweepAndPrune.FindPairs(aabbs, count, pairs);
+		grid.FindPairs(aabbs, count, gridPairs);
+		match = match && SamePairs(pairs, expected) && SamePairs(gridPairs, expected);
+		allMatch = allMatch && match;
+		std::printf("large objects %6s\n", match ? "ok" : "NG");
+	}
+	return allMatch ? 0 : 1;
+}
@@ -0,0 +1,142 @@
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "LegacyMathFunction.h"
+#include "MathFunction.h"
+
+// 小さな関数を別の翻訳単位に置いていたとき(変更前)と、ヘッダーでinline定義したとき(変更後)の
+// 呼び出しあたりのスループットを比較する
+
+namespace {
+
+// 変更後の関数はコンパイル時にも評価できる
+constexpr Matrix4x4 kTranslate = MakeTranslateMatrix(Vector3{ 1.0f, 2.0f, 3.0f });
+static_assert(Transform(Vector3{ 1.0f, 1.0f, 1.0f }, kTranslate).z == 4.0f);
+static_assert(GetXAxis(MakeScaleMatrix(Vector3{ 2.0f, 3.0f, 4.0f })).x == 2.0f);
+static_assert(Dot(Cross(Vector3{ 1.0f, 0.0f, 0.0f }, Vector3{ 0.0f, 1.0f, 0.0f }), Vector3{ 0.0f, 0.0f, 1.0f }) == 1.0f);
+
+const size_t kVectorCount = 1 << 14; // L1/L2に収まる量
+
+// 同じ計測コードで呼び分けるための窓口
+struct LegacyApi {
+	static Vector3 Add(const Vector3& v1, const Vector3& v2) { return Legacy::Add(v1, v2); }
+	static float Dot(const Vector3& v1, const Vector3& v2) { return Legacy::Dot(v1, v2); }
+	static Vector3 Cross(const Vector3& v1, const Vector3& v2) { return Legacy::Cross(v1, v2); }
+	static Vector3 GetXAxis(const Matrix4x4& m) { return Legacy::GetXAxis(m); }
+	static Matrix4x4 MakeIdentity4x4() { return Legacy::MakeIdentity4x4(); }
+	static Matrix4x4 MakeTranslateMatrix(const Vector3& v) { return Legacy::MakeTranslateMatrix(v); }
+	static Vector3 Transform(const Vector3& v, const Matrix4x4& m) { return Legacy::Transform(v, m); }
+	static Vector3 Lerp(const Vector3& v1, const Vector3& v2, float t) { return Legacy::Lerp(v1, v2, t); }
+};
+
+struct InlineApi {
+	static Vector3 Add(const Vector3& v1, const Vector3& v2) { return ::Add(v1, v2); }
+	static float Dot(const Vector3& v1, const Vector3& v2) { return ::Dot(v1, v2); }
+	static Vector3 Cross(const Vector3& v1, const Vector3& v2) { return ::Cross(v1, v2); }
+	static Vector3 GetXAxis(const Matrix4x4& m) { return ::GetXAxis(m); }
+	static Matrix4x4 MakeIdentity4x4() { return ::MakeIdentity4x4(); }
+	static Matrix4x4 MakeTranslateMatrix(const Vector3& v) { return ::MakeTranslateMatrix(v); }
+	static Vector3 Transform(const Vector3& v, const Matrix4x4& m) { return ::Transform(v, m); }
+	static Vector3 Lerp(const Vector3& v1, const Vector3& v2, float t) { return ::Lerp(v1, v2, t); }
+};
+
+struct Data {
+	std::vector<Vector3> a;
+	std::vector<Vector3> b;
+	std::vector<Vector3> out;
+	Matrix4x4 matrix;
+};
+
+template<class Api>
+double MeasureDot(Data& data) {
+	return Benchmark::MeasureThroughput(kVectorCount, [&] {
+		float sum = 0.0f;
+		for (size_t i = 0; i < kVectorCount; i++) {
+			sum += Api::Dot(data.a[i], data.b[i]);
+		}
+		Benchmark::DoNotOptimize(sum);
+	});
+}
+
+template<class Api>
+double MeasureCrossAdd(Data& data) {
+	return Benchmark::MeasureThroughput(kVectorCount, [&] {
+		for (size_t i = 0; i < kVectorCount; i++) {
+			data.out[i] = Api::Add(data.a[i], Api::Cross(data.a[i], data.b[i]));
+		}
+		Benchmark::DoNotOptimize(data.out);
+	});
+}
+
+template<class Api>
+double MeasureLerp(Data& data) {
+	return Benchmark::MeasureThroughput(kVectorCount, [&] {
+		for (size_t i = 0; i < kVectorCount; i++) {
+			data.out[i] = Api::Lerp(data.a[i], data.b[i], 0.25f);
+		}
+		Benchmark::DoNotOptimize(data.out);
+	});
+}
+
+template<class Api>
+double MeasureTransform(Data& data) {
+	return Benchmark::MeasureThroughput(kVectorCount, [&] {
+		for (size_t i = 0; i < kVectorCount; i++) {
+			data.out[i] = Api::Transform(data.a[i], data.matrix);
+		}
+		Benchmark::DoNotOptimize(data.out);
+	});
+}
+
+// 行列を作ってすぐ使う(インライン化されれば0と1の成分が畳み込まれる)
+template<class Api>
+double MeasureTranslate(Data& data) {
+	return Benchmark::MeasureThroughput(kVectorCount, [&] {
+		for (size_t i = 0; i < kVectorCount; i++) {
+			data.out[i] = Api::Transform(data.a[i], Api::MakeTranslateMatrix(data.b[i]));
+		}
+		Benchmark::DoNotOptimize(data.out);
+	});
+}
+
+template<class Api>
+double MeasureAxis(Data& data) {
+	return Benchmark::MeasureThroughput(kVectorCount, [&] {
+		float sum = 0.0f;
+		for (size_t i = 0; i < kVectorCount; i++) {
+			sum += Api::Dot(Api::GetXAxis(Api::MakeIdentity4x4()), data.a[i]);
+		}
+		Benchmark::DoNotOptimize(sum);
+	});
+}
+
+void Report(const char* name, double before, double after) {
+	std::printf("%-28s before %9.2f Mops/s  after %9.2f Mops/s  x%.2f\n",
+	    name, before * 1e-6, after * 1e-6, after / before);
+}
+
+} // namespace
+
+int main() {
+	std::mt19937 random(0);
+	std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+	Data data;
+	data.a.resize(kVectorCount);
+	data.b.resize(kVectorCount);
+	data.out.resize(kVectorCount);
+	for (size_t i = 0; i < kVectorCount; i++) {
+		data.a[i] = { distribution(random), distribution(random), distribution(random) };
+		data.b[i] = { distribution(random), distribution(random), distribution(random) };
+	}
+	const Vector3 rotate{ 0.3f, 1.2f, -0.5f };
+	data.matrix = MakeAffineMatrix(Vector3{ 1.0f, 2.0f, 1.5f }, rotate, Vector3{ 3.0f, -1.0f, 2.0f });
+
+	Report("Dot", MeasureDot<LegacyApi>(data), MeasureDot<InlineApi>(data));
+	Report("Add(Cross)", MeasureCrossAdd<LegacyApi>(data), MeasureCrossAdd<InlineApi>(data));
+	Report("Lerp", MeasureLerp<LegacyApi>(data), MeasureLerp<InlineApi>(data));
+	Report("Transform", MeasureTransform<LegacyApi>(data), MeasureTransform<InlineApi>(data));
+	Report("Transform(MakeTranslate)", MeasureTranslate<LegacyApi>(data), MeasureTranslate<InlineApi>(data));
+	Report("Dot(GetXAxis(Identity))", MeasureAxis<LegacyApi>(data), MeasureAxis<InlineApi>(data));
+	return 0;
+}
@@ -0,0 +1,170 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "CompressedTransform.h"
+#include "MathFunction.h"
+#include "SimdDispatch.h"
+
+// ランダムな姿勢を圧縮・展開し、誤差がCompressedTransform.hに書いた範囲に収まることを確かめる(超えたら終了コード1)
+// 速度はMatrix4x4の配列をそのまま写す場合と比べる
+
+namespace {
+
+const size_t kCount = 1 << 16;
+const float kPositionRange = 1000.0f;
+const TransformQuantization kQuantization{ { -kPositionRange, -kPositionRange, -kPositionRange }, 1.0f / 1024.0f };
+
+struct Transforms {
+	std::vector<float> sx, sy, sz, qx, qy, qz, qw, tx, ty, tz;
+
+	ConstVector3SoA GetScale() const { return { sx.data(), sy.data(), sz.data() }; }
+	ConstQuaternionSoA GetRotate() const { return { qx.data(), qy.data(), qz.data(), qw.data() }; }
+	ConstVector3SoA GetTranslate() const { return { tx.data(), ty.data(), tz.data() }; }
+};
+
+struct Errors {
+	double angle = 0.0;    // 回転角(rad)
+	double rotation = 0.0; // 回転行列の成分
+	double scale = 0.0;    // 拡大の相対誤差
+	double position = 0.0; // 平行移動の各軸(step単位)
+};
+
+// CompressedTransform.hに書いた誤差の上限(拡大と平行移動は復元のfloatの丸めの分を足す)
+// 平行移動の丸めは|t| <= kPositionRangeのfloatの1ulp(stepの1/16)まで
+const Errors kErrorBounds{ 1e-4, 1e-4, 4.9e-4, 0.5 + 1.0 / 16.0 };
+
+Errors Measure(const Transforms& transforms, const std::vector<Matrix4x4>& decoded) {
+	Errors errors;
+	for (size_t i = 0; i < kCount; i++) {
+		const Quaternion q{ transforms.qx[i], transforms.qy[i], transforms.qz[i], transforms.qw[i] };
+		const Matrix4x4 expected = MakeRotateMatrix(q);
+		const float scales[3] = { transforms.sx[i], transforms.sy[i], transforms.sz[i] };
+		// 拡大の誤差を含めないように、行の長さで割って回転を取り出す
+		Matrix4x4 rotation = MakeIdentity4x4();
+		for (int row = 0; row < 3; row++) {
+			const double length = std::sqrt(double(decoded[i].m[row][0]) * decoded[i].m[row][0] +
+			    double(decoded[i].m[row][1]) * decoded[i].m[row][1] + double(decoded[i].m[row][2]) * decoded[i].m[row][2]);
+			errors.scale = std::max(errors.scale, std::fabs(length / std::fabs(scales[row]) - 1.0));
+			for (int col = 0; col < 3; col++) {
+				rotation.m[row][col] = float(decoded[i].m[row][col] / length);
+			}
+		}
+		for (int row = 0; row < 3; row++) {
+			for (int col = 0; col < 3; col++) {
+				errors.rotation = std::max(errors.rotation, double(std::fabs(rotation.m[row][col] - expected.m[row][col])));
+			}
+		}
+		// 差の回転 conj(q) * actualの角度(acosは1の近くで誤差が大きいのでatan2で求める)
+		const Quaternion difference = Multiply(Conjugate(q), MakeRotateQuaternion(rotation));
+		const double sine = std::sqrt(double(difference.x) * difference.x + double(difference.y) * difference.y +
+		    double(difference.z) * difference.z);
+		errors.angle = std::max(errors.angle, 2.0 * std::atan2(sine, std::fabs(double(difference.w))));
+		const float translates[3] = { transforms.tx[i], transforms.ty[i], transforms.tz[i] };
+		for (int axis = 0; axis < 3; axis++) {
+			errors.position = std::max(errors.position,
+			    std::fabs(double(decoded[i].m[3][axis]) - translates[axis]) / kQuantization.step);
+		}
+	}
+	return errors;
+}
+
+bool Print(const char* name, const Errors& errors) {
+	const bool ok = errors.angle <= kErrorBounds.angle && errors.rotation <= kErrorBounds.rotation &&
+	    errors.scale <= kErrorBounds.scale && errors.position <= kErrorBounds.position;
+	std::printf("%-22s angle %.1e rad  rotation %.1e  scale %.1e  position %.2f step  %s\n", name, errors.angle,
+	    errors.rotation, errors.scale, errors.position, ok ? "ok" : "NG");
+	return ok;
+}
+
+} // namespace
+
+int main() {
+	std::printf("simd: %s  count: %zu\n", GetSimdLevelName(GetSimdLevel()), kCount);
+	std::mt19937 random(0);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> logScale(std::log(0.01f), std::log(100.0f));
+	std::uniform_real_distribution<float> position(-kPositionRange, kPositionRange);
+	Transforms transforms;
+	std::vector<Matrix4x4> matrices(kCount);
+	for (size_t i = 0; i < kCount; i++) {
+		Quaternion q;
+		do {
+			q = Quaternion{ unit(random), unit(random), unit(random), unit(random) };
+		} while (Dot(q, q) > 1.0f || Dot(q, q) < 1e-4f);
+		q = Normalize(q);
+		const Vector3 scale{ std::exp(logScale(random)), std::exp(logScale(random)), std::exp(logScale(random)) };
+		const Vector3 translate{ position(random), position(random), position(random) };
+		transforms.sx.push_back(scale.x);
+		transforms.sy.push_back(scale.y);
+		transforms.sz.push_back(scale.z);
+		transforms.qx.push_back(q.x);
+		transforms.qy.push_back(q.y);
+		transforms.qz.push_back(q.z);
+		transforms.qw.push_back(q.w);
+		transforms.tx.push_back(translate.x);
+		transforms.ty.push_back(translate.y);
+		transforms.tz.push_back(translate.z);
+		matrices[i] = MakeAffineMatrix(scale, q, translate);
+	}
+
+	// ファイルやネットワークから受け取ったバッファとみなして、その場で展開する
+	const size_t size = GetCompressedTransformSize(kCount);
+	std::vector<uint32_t> blob((size + 3) / 4);
+	EncodeTransforms(transforms.GetScale(), transforms.GetRotate(), transforms.GetTranslate(), kCount, kQuantization,
+	    blob.data());
+	CompressedTransformView view;
+	if (!view.Open(blob.data(), size)) {
+		std::printf("Open failed\n");
+		return 1;
+	}
+	std::printf("bytes per transform %.2f (Matrix4x4 %zu)\n", double(size) / kCount, sizeof(Matrix4x4));
+	std::vector<Matrix4x4> decoded(kCount);
+	view.Decode(decoded.data(), 0, kCount);
+	bool ok = Print("Encode (SoA)", Measure(transforms, decoded));
+
+	// 行列から圧縮しても同じ範囲に収まる
+	std::vector<uint32_t> matrixBlob((size + 3) / 4);
+	EncodeTransforms(matrices.data(), kCount, kQuantization, matrixBlob.data());
+	CompressedTransformView matrixView;
+	ok &= matrixView.Open(matrixBlob.data(), size);
+	matrixView.Decode(decoded.data(), 0, kCount);
+	ok &= Print("Encode (Matrix4x4)", Measure(transforms, decoded));
+
+	// 一部だけ展開しても同じ結果になる
+	std::vector<Matrix4x4> part(1000);
+	view.Decode(part.data(), 123, part.size());
+	view.Decode(decoded.data(), 0, kCount);
+	const bool samePart = std::memcmp(part.data(), decoded.data() + 123, part.size() * sizeof(Matrix4x4)) == 0;
+	const Matrix4x4 single = view.Decode(kCount - 1);
+	const bool sameSingle = std::memcmp(&single, &decoded[kCount - 1], sizeof(Matrix4x4)) == 0;
+	std::printf("partial decode %s  single decode %s\n", samePart ? "ok" : "NG", sameSingle ? "ok" : "NG");
+	ok &= samePart && sameSingle;
+
+	std::vector<Matrix4x4> copied(kCount);
+	const double copy = Benchmark::MeasureThroughput(kCount, [&] {
+		std::memcpy(copied.data(), matrices.data(), kCount * sizeof(Matrix4x4));
+		Benchmark::DoNotOptimize(copied);
+	});
+	const double encode = Benchmark::MeasureThroughput(kCount, [&] {
+		EncodeTransforms(transforms.GetScale(), transforms.GetRotate(), transforms.GetTranslate(), kCount,
+		    kQuantization, blob.data());
+		Benchmark::DoNotOptimize(blob);
+	});
+	const double encodeMatrix = Benchmark::MeasureThroughput(kCount, [&] {
+		EncodeTransforms(matrices.data(), kCount, kQuantization, matrixBlob.data());
+		Benchmark::DoNotOptimize(matrixBlob);
+	});
+	const double decode = Benchmark::MeasureThroughput(kCount, [&] {
+		view.Decode(decoded.data(), 0, kCount);
+		Benchmark::DoNotOptimize(decoded);
+	});
+	std::printf("%-22s %8.1f M/s\n", "memcpy Matrix4x4", copy * 1e-6);
+	std::printf("%-22s %8.1f M/s\n", "Encode (SoA)", encode * 1e-6);
+	std::printf("%-22s %8.1f M/s\n", "Encode (Matrix4x4)", encodeMatrix * 1e-6);
+	std::printf("%-22s %8.1f M/s\n", "Decode", decode * 1e-6);
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "MathFunction.h"
+#include "SimdDispatch.h"
+
+// アフィン行列の分解(Decompose)と、分解→補間→組み立てを一括で行うBlendAffineMatrices
+// MakeAffineMatrixで作った行列が元の拡大・回転・平行移動に戻ること、剪断と拡大0を見分けることを確かめ、
+// 1つずつDecompose/Lerp/Nlerp/MakeAffineMatrixを呼ぶ方法と速さを比べる
+
+namespace {
+
+const size_t kMatrixCount = 1 << 14;
+// 一括の補間と1つずつの補間の差の上限(相対)
+const float kBlendTolerance = 1e-5f;
+
+struct Transforms {
+	std::vector<float> scale[3], rotate[4], translate[3];
+
+	explicit Transforms(size_t count) {
+		for (auto* components : { scale, translate }) {
+			for (int i = 0; i < 3; i++) {
+				components[i].resize(count);
+			}
+		}
+		for (auto& component : rotate) {
+			component.resize(count);
+		}
+	}
+	Vector3SoA Scale() { return { scale[0].data(), scale[1].data(), scale[2].data() }; }
+	QuaternionSoA Rotate() { return { rotate[0].data(), rotate[1].data(), rotate[2].data(), rotate[3].data() }; }
+	Vector3SoA Translate() { return { translate[0].data(), translate[1].data(), translate[2].data() }; }
+	Vector3 GetScale(size_t i) const { return { scale[0][i], scale[1][i], scale[2][i] }; }
+	Quaternion GetRotate(size_t i) const { return { rotate[0][i], rotate[1][i], rotate[2][i], rotate[3][i] }; }
+	Vector3 GetTranslate(size_t i) const { return { translate[0][i], translate[1][i], translate[2][i] }; }
+};
+
+// 2つの回転のなす角
+float AngleBetween(const Quaternion& a, const Quaternion& b) {
+	const Quaternion d = Multiply(Conjugate(a), b);
+	return 2.0f * std::atan2(std::sqrt(d.x * d.x + d.y * d.y + d.z * d.z), std::fabs(d.w));
+}
+
+float MaxDifference(const Matrix4x4& a, const Matrix4x4& b) {
+	float difference = 0.0f;
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			difference = std::max(difference, std::fabs(a.m[i][j] - b.m[i][j]));
+		}
+	}
+	return difference;
+}
+
+// 1つずつ分解して補間する(BlendAffineMatricesと同じ計算)
+// 分解できなければ要素ごとに線形補間する
+Matrix4x4 BlendReference(
+    const Matrix4x4& m0, const Matrix4x4& m1, float t, float shearTolerance = kDecomposeShearTolerance) {
+	Vector3 scale0, scale1, translate0, translate1;
+	Quaternion rotate0, rotate1;
+	const bool decomposed0 = Decompose(m0, scale0, rotate0, translate0, shearTolerance);
+	const bool decomposed1 = Decompose(m1, scale1, rotate1, translate1, shearTolerance);
+	if (!decomposed0 || !decomposed1) {
+		Matrix4x4 result;
+		for (int i = 0; i < 4; i++) {
+			for (int j = 0; j < 4; j++) {
+				result.m[i][j] = m0.m[i][j] + (m1.m[i][j] - m0.m[i][j]) * t;
+			}
+		}
+		return result;
+	}
+	return MakeAffineMatrix(Lerp(scale0, scale1, t), Nlerp(rotate0, rotate1, t), Lerp(translate0, translate1, t));
+}
+
+} // namespace
+
+int main() {
+	std::printf("simd: %s  matrices: %zu\n", GetSimdLevelName(GetSimdLevel()), kMatrixCount);
+	std::mt19937 random(0);
+	std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> logScale(std::log(0.1f), std::log(10.0f));
+
+	// 拡大(一部は鏡映)・回転・平行移動から行列を作る
+	std::vector<Vector3> scales(kMatrixCount), translates(kMatrixCount);
+	std::vector<Quaternion> rotates(kMatrixCount);
+	std::vector<Matrix4x4> matrices(kMatrixCount), targets(kMatrixCount);
+	std::vector<float> weights(kMatrixCount);
+	for (size_t i = 0; i < kMatrixCount; i++) {
+		const float sign = i % 5 == 0 ? -1.0f : 1.0f;
+		scales[i] = Vector3{ sign * std::exp(logScale(random)), std::exp(logScale(random)), std::exp(logScale(random)) };
+		rotates[i] = MakeRotateAxisAngleQuaternion(Normalize(Vector3{ value(random), value(random), value(random) }),
+		    value(random) * 3.0f);
+		translates[i] = Multiply(100.0f, Vector3{ value(random), value(random), value(random) });
+		matrices[i] = MakeAffineMatrix(scales[i], rotates[i], translates[i]);
+		targets[i] = MakeAffineMatrix(
+		    Vector3{ std::exp(logScale(random)), std::exp(logScale(random)), std::exp(logScale(random)) },
+		    MakeRotateAxisAngleQuaternion(Normalize(Vector3{ value(random), value(random), value(random) }),
+		        value(random) * 3.0f),
+		    Multiply(100.0f, Vector3{ value(random), value(random), value(random) }));
+		weights[i] = 0.5f * (value(random) + 1.0f);
+	}
+
+	// 元の値に戻るか(1つずつ・一括)
+	Transforms batch(kMatrixCount);
+	std::vector<char> succeeded(kMatrixCount);
+	const bool allSucceeded = Decompose(matrices.data(), batch.Scale(), batch.Rotate(), batch.Translate(), kMatrixCount,
+	    reinterpret_cast<bool*>(succeeded.data()));
+	float scaleError = 0.0f, angleError = 0.0f, translateError = 0.0f, batchAngleError = 0.0f, batchScaleError = 0.0f;
+	bool singleSucceeded = true;
+	for (size_t i = 0; i < kMatrixCount; i++) {
+		Vector3 scale, translate;
+		Quaternion rotate;
+		singleSucceeded = Decompose(matrices[i], scale, rotate, translate) && singleSucceeded;
+		const Vector3 scaleDifference = Subtract(scale, scales[i]);
+		for (float d : { scaleDifference.x / scales[i].x, scaleDifference.y / scales[i].y, scaleDifference.z / scales[i].z }) {
+			scaleError = std::max(scaleError, std::fabs(d));
+		}
+		angleError = std::max(angleError, AngleBetween(rotate, rotates[i]));
+		translateError = std::max(translateError, Length(Subtract(translate, translates[i])));
+		batchAngleError = std::max(batchAngleError, AngleBetween(batch.GetRotate(i), rotates[i]));
+		batchScaleError = std::max(batchScaleError, Length(Subtract(batch.GetScale(i), scale)) / Length(scale));
+	}
+	std::printf("round trip  succeeded %s/%s  max scale %.1e  angle %.1e rad  translate %.1e\n",
+	    singleSucceeded ? "ok" : "NG", allSucceeded ? "ok" : "NG", scaleError, angleError, translateError);
+	std::printf("batch vs single  max scale %.1e  angle %.1e rad\n", batchScaleError, batchAngleError);
+
+	// 剪断・拡大0は失敗になり、一括版の行列ごとの結果も同じになる
+	std::vector<Matrix4x4> special(16, MakeAffineMatrix(Vector3{ 2.0f, 3.0f, 4.0f }, rotates[0], translates[0]));
+	special[3].m[1][0] += 0.1f; // 剪断
+	special[7] = MakeAffineMatrix(Vector3{ 1.0f, 0.0f, 1.0f }, rotates[1], translates[1]);
+	special[10].m[2][1] += 0.5f;
+	special[15] = MakeScaleMatrix(Vector3{ 0.0f, 0.0f, 0.0f });
+	std::vector<char> specialSucceeded(special.size());
+	Transforms specialResult(special.size());
+	Decompose(special.data(), specialResult.Scale(), specialResult.Rotate(), specialResult.Translate(), special.size(),
+	    reinterpret_cast<bool*>(specialSucceeded.data()));
+	bool detection = true;
+	for (size_t i = 0; i < special.size(); i++) {
+		Vector3 scale, translate;
+		Quaternion rotate;
+		const bool expected = i != 3 && i != 7 && i != 10 && i != 15;
+		detection = detection && Decompose(special[i], scale, rotate, translate) == expected &&
+		            (specialSucceeded[i] != 0) == expected;
+	}
+	const Quaternion zeroRotate = specialResult.GetRotate(15);
+	detection = detection && zeroRotate.w == 1.0f && zeroRotate.x == 0.0f;
+	std::printf("shear/zero scale detection %s\n", detection ? "ok" : "NG");
+
+	// 一括の補間と1つずつの補間の差
+	std::vector<Matrix4x4> blended(kMatrixCount), expected(kMatrixCount);
+	BlendAffineMatrices(matrices.data(), targets.data(), weights.data(), blended.data(), kMatrixCount);
+	float blendError = 0.0f;
+	for (size_t i = 0; i < kMatrixCount; i++) {
+		expected[i] = BlendReference(matrices[i], targets[i], weights[i]);
+		blendError = std::max(blendError, MaxDifference(expected[i], blended[i]) / std::max(1.0f, MaxDifference(expected[i], Matrix4x4{})));
+	}
+	std::printf("BlendAffineMatrices max relative difference %.1e\n", blendError);
+
+	// 剪断・拡大0を含むものは要素ごとの線形補間になり、shearToleranceを緩めれば分解して補間する
+	bool specialBlend = true;
+	for (float tolerance : { kDecomposeShearTolerance, 1.0f }) {
+		std::vector<Matrix4x4> specialBlended(special.size());
+		BlendAffineMatrices(special.data(), targets.data(), weights.data(), specialBlended.data(), special.size(),
+		    tolerance);
+		for (size_t i = 0; i < special.size(); i++) {
+			const Matrix4x4 reference = BlendReference(special[i], targets[i], weights[i], tolerance);
+			specialBlend = specialBlend && MaxDifference(reference, specialBlended[i]) <=
+			                                   kBlendTolerance * std::max(1.0f, MaxDifference(reference, Matrix4x4{}));
+		}
+	}
+	std::printf("shear/zero scale blend %s\n", specialBlend ? "ok" : "NG");
+
+	const double single = Benchmark::MeasureThroughput(kMatrixCount, [&] {
+		for (size_t i = 0; i < kMatrixCount; i++) {
+			Decompose(matrices[i], scales[i], rotates[i], translates[i]);
+		}
+		Benchmark::DoNotOptimize(rotates);
+	});
+	const double batchDecompose = Benchmark::MeasureThroughput(kMatrixCount, [&] {
+		Decompose(matrices.data(), batch.Scale(), batch.Rotate(), batch.Translate(), kMatrixCount);
+		Benchmark::DoNotOptimize(batch);
+	});
+	const double blendSingle = Benchmark::MeasureThroughput(kMatrixCount, [&] {
+		for (size_t i = 0; i < kMatrixCount; i++) {
+			expected[i] = BlendReference(matrices[i], targets[i], weights[i]);
+		}
+		Benchmark::DoNotOptimize(expected);
+	});
+	const double blendBatch = Benchmark::MeasureThroughput(kMatrixCount, [&] {
+		BlendAffineMatrices(matrices.data(), targets.data(), weights.data(), blended.data(), kMatrixCount);
+		Benchmark::DoNotOptimize(blended);
+	});
+	std::printf("%-40s %8.1f M/s\n", "Decompose (single)", single * 1e-6);
+	std::printf("%-40s %8.1f M/s\n", "Decompose (batch)", batchDecompose * 1e-6);
+	std::printf("%-40s %8.1f M/s\n", "Decompose + Lerp/Nlerp + MakeAffineMatrix", blendSingle * 1e-6);
+	std::printf("%-40s %8.1f M/s\n", "BlendAffineMatrices", blendBatch * 1e-6);
+	return singleSucceeded && allSucceeded && detection && blendError <= kBlendTolerance && specialBlend ? 0 : 1;
+}
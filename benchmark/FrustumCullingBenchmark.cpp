@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "Frustum.h"
+#include "MathFunction.h"
+#include "SimdDispatch.h"
+
+// 10万個の球とAABBについて、1個ずつのIsVisibleと一括のCullSpheres/CullAABBs(lastPlanesあり/なし)を比べる
+// 物体は格子状の区画ごとに並べ(空間的に近いものが配列でも近い)、カメラは毎フレーム少しずつ回す
+// 一括の結果がIsVisibleと1つでも違えば終了コード1
+
+namespace {
+
+const size_t kObjectCount = 100000;
+const int kCellCount = 32; // 区画の数(1辺)
+const float kWorldSize = 1000.0f;
+const size_t kFrameCount = 64;
+
+struct Scene {
+	std::vector<Sphere> spheres;
+	std::vector<AABB> aabbs;
+	std::vector<float> sphereX, sphereY, sphereZ, radius;
+	std::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+};
+
+Scene MakeScene() {
+	std::mt19937 random(0);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	const float cellSize = kWorldSize / kCellCount;
+	const size_t perCell = kObjectCount / (kCellCount * kCellCount) + 1;
+	Scene scene;
+	for (int cellZ = 0; cellZ < kCellCount; cellZ++) {
+		for (int cellX = 0; cellX < kCellCount; cellX++) {
+			for (size_t k = 0; k < perCell && scene.spheres.size() < kObjectCount; k++) {
+				const Vector3 center{ (float(cellX) + unit(random)) * cellSize - kWorldSize * 0.5f, unit(random) * 50.0f,
+				    (float(cellZ) + unit(random)) * cellSize - kWorldSize * 0.5f };
+				const Vector3 half{ 0.5f + unit(random) * 2.0f, 0.5f + unit(random) * 2.0f, 0.5f + unit(random) * 2.0f };
+				scene.spheres.push_back({ center, Length(half) });
+				scene.aabbs.push_back({ Subtract(center, half), Add(center, half) });
+				scene.sphereX.push_back(center.x);
+				scene.sphereY.push_back(center.y);
+				scene.sphereZ.push_back(center.z);
+				scene.radius.push_back(Length(half));
+				scene.minX.push_back(center.x - half.x);
+				scene.minY.push_back(center.y - half.y);
+				scene.minZ.push_back(center.z - half.z);
+				scene.maxX.push_back(center.x + half.x);
+				scene.maxY.push_back(center.y + half.y);
+				scene.maxZ.push_back(center.z + half.z);
+			}
+		}
+	}
+	return scene;
+}
+
+// 原点付近から水平方向に見回すカメラ
+std::vector<Frustum> MakeFrustums() {
+	const Matrix4x4 projection = MakePerspectiveFovMatrix(0.8f, 16.0f / 9.0f, 0.1f, 300.0f);
+	std::vector<Frustum> frustums;
+	for (size_t frame = 0; frame < kFrameCount; frame++) {
+		const Matrix4x4 view = MakeViewMatrix(Vector3{ 0.1f, 0.02f * float(frame), 0.0f }, Vector3{ 0.0f, 20.0f, 0.0f });
+		frustums.push_back(MakeFrustum(Multiply(view, projection)));
+	}
+	return frustums;
+}
+
+template<class Shape>
+size_t CullEach(const Frustum& frustum, const std::vector<Shape>& shapes, uint32_t* visibleIndices) {
+	size_t visibleCount = 0;
+	for (size_t i = 0; i < shapes.size(); i++) {
+		if (IsVisible(frustum, shapes[i])) {
+			visibleIndices[visibleCount++] = static_cast<uint32_t>(i);
+		}
+	}
+	return visibleCount;
+}
+
+struct Methods {
+	double each;
+	double batch;
+	double coherent;
+	size_t mismatches; // IsVisibleと結果が違った物体の数
+	double visibleRatio;
+};
+
+template<class Shape, class SoA, class CullFunc>
+Methods Compare(const std::vector<Frustum>& frustums, const std::vector<Shape>& shapes, const SoA& soa, CullFunc cull) {
+	const size_t count = shapes.size();
+	std::vector<uint32_t> expected(count), actual(count);
+	std::vector<uint8_t> lastPlanes(count, kFrustumVisible);
+	Methods methods{};
+
+	// 結果の確認(lastPlanesを使う場合は前フレームの値が入った状態で比べる)
+	size_t visibleTotal = 0;
+	for (const Frustum& frustum : frustums) {
+		const size_t expectedCount = CullEach(frustum, shapes, expected.data());
+		for (uint8_t* planes : { static_cast<uint8_t*>(nullptr), lastPlanes.data() }) {
+			const size_t actualCount = cull(frustum, soa, count, actual.data(), planes);
+			std::vector<uint32_t> difference;
+			std::set_symmetric_difference(expected.begin(), expected.begin() + expectedCount, actual.begin(),
+			    actual.begin() + actualCount, std::back_inserter(difference));
+			methods.mismatches += difference.size();
+		}
+		visibleTotal += expectedCount;
+	}
+	methods.visibleRatio = double(visibleTotal) / double(count * frustums.size());
+
+	size_t frame = 0;
+	methods.each = Benchmark::MeasureThroughput(count, [&] {
+		Benchmark::DoNotOptimize(CullEach(frustums[frame++ % frustums.size()], shapes, expected.data()));
+	});
+	methods.batch = Benchmark::MeasureThroughput(count, [&] {
+		Benchmark::DoNotOptimize(cull(frustums[frame++ % frustums.size()], soa, count, actual.data(), nullptr));
+	});
+	methods.coherent = Benchmark::MeasureThroughput(count, [&] {
+		Benchmark::DoNotOptimize(
+		    cull(frustums[frame++ % frustums.size()], soa, count, actual.data(), lastPlanes.data()));
+	});
+	return methods;
+}
+
+bool Print(const char* name, const Methods& methods) {
+	std::printf("%-7s visible %4.1f%%  mismatches %zu  %s\n", name, methods.visibleRatio * 100.0, methods.mismatches,
+	    methods.mismatches == 0 ? "ok" : "NG");
+	std::printf("  IsVisible per object       %8.1f M/s\n", methods.each * 1e-6);
+	std::printf("  batch                      %8.1f M/s  x%.2f\n", methods.batch * 1e-6, methods.batch / methods.each);
+	std::printf("  batch + lastPlanes         %8.1f M/s  x%.2f\n", methods.coherent * 1e-6,
+	    methods.coherent / methods.each);
+	return methods.mismatches == 0;
+}
+
+} // namespace
+
+int main() {
+	std::printf("simd: %s  objects: %zu\n", GetSimdLevelName(GetSimdLevel()), kObjectCount);
+	const Scene scene = MakeScene();
+	const std::vector<Frustum> frustums = MakeFrustums();
+
+	const ConstSphereSoA spheres(scene.sphereX.data(), scene.sphereY.data(), scene.sphereZ.data(), scene.radius.data());
+	bool ok = Print("sphere", Compare(frustums, scene.spheres, spheres,
+	    [](const Frustum& frustum, const ConstSphereSoA& soa, size_t count, uint32_t* indices, uint8_t* planes) {
+		    return CullSpheres(frustum, soa, count, indices, planes);
+	    }));
+
+	const ConstAABBSoA aabbs(scene.minX.data(), scene.minY.data(), scene.minZ.data(), scene.maxX.data(),
+	    scene.maxY.data(), scene.maxZ.data());
+	ok &= Print("AABB", Compare(frustums, scene.aabbs, aabbs,
+	    [](const Frustum& frustum, const ConstAABBSoA& soa, size_t count, uint32_t* indices, uint8_t* planes) {
+		    return CullAABBs(frustum, soa, count, indices, planes);
+	    }));
+	return ok ? 0 : 1;
+}
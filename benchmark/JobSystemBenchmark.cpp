@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+#include "Benchmark.h"
+#include "JobSystem.h"
+#include "MathFunction.h"
+#include "SimdDispatch.h"
+
+// JobSystemのスレッド数を1から論理コア数(MT4_THREADSの指定が多ければその数)まで変えて、
+// 一括演算のスループットがどれだけ伸びるかを調べる
+// 要素数が少なくその場で処理する場合と、ワーカーを起こす場合の1回あたりの負荷も測る
+// 計測の前に、スレッド数と区間の大きさを変えてもすべての要素をちょうど1回ずつ処理することを確かめる(違えば1を返す)
+
+namespace {
+
+const size_t kMatrixCount = 1 << 18;
+const size_t kPointCount = 1 << 20;
+// 負荷の計測で1回の計測に含めるParallelForの回数
+const size_t kOverheadCalls = 1000;
+// 確かめるときに同じ条件で繰り返す回数(スレッドの処理順が変わるように)
+const size_t kCheckRepeats = 20;
+
+// [0, count)をParallelForで処理し、どの要素もちょうど1回ずつ渡されたかを調べる
+// 先頭の区間ほど重くして、ほかのスレッドが盗むようにする
+bool CheckCoverage(JobSystem& jobSystem, size_t count, size_t minGrain) {
+	std::vector<std::atomic<uint32_t>> visits(count);
+	std::atomic<bool> validRanges = true;
+	jobSystem.ParallelFor(count, minGrain, [&](size_t begin, size_t end) {
+		if (begin >= end || end > count) {
+			validRanges = false;
+			return;
+		}
+		for (size_t i = begin; i < end; i++) {
+			visits[i].fetch_add(1, std::memory_order_relaxed);
+		}
+		if (begin < count / 8) {
+			std::this_thread::yield();
+		}
+	});
+	return validRanges && std::all_of(visits.begin(), visits.end(), [](const auto& v) { return v.load() == 1; });
+}
+
+// ParallelForの中からParallelForを呼ぶ(内側は呼び出したスレッドで処理する)
+bool CheckNested(JobSystem& jobSystem, size_t outerCount, size_t innerCount) {
+	std::vector<std::atomic<uint32_t>> visits(outerCount * innerCount);
+	jobSystem.ParallelFor(outerCount, 1, [&](size_t outerBegin, size_t outerEnd) {
+		for (size_t i = outerBegin; i < outerEnd; i++) {
+			jobSystem.ParallelFor(innerCount, 1, [&](size_t begin, size_t end) {
+				for (size_t j = begin; j < end; j++) {
+					visits[i * innerCount + j].fetch_add(1, std::memory_order_relaxed);
+				}
+			});
+		}
+	});
+	return std::all_of(visits.begin(), visits.end(), [](const auto& v) { return v.load() == 1; });
+}
+
+// スレッド数・要素数・区間の大きさを変えて確かめる
+// 別のスレッドから同時に呼んだとき(片方は呼び出し元で処理する)も確かめる
+bool CheckParallelFor(JobSystem& jobSystem) {
+	const size_t threadCounts[] = { 1, 2, 3, 4, 8 };
+	const size_t counts[] = { 0, 1, 7, 1000, 4097, 100003 };
+	const size_t grains[] = { 1, 3, 64, JobSystem::kDefaultMinGrain };
+	bool ok = true;
+	for (size_t threadCount : threadCounts) {
+		jobSystem.SetThreadCount(threadCount);
+		bool coverage = true;
+		for (size_t repeat = 0; repeat < kCheckRepeats; repeat++) {
+			for (size_t count : counts) {
+				for (size_t grain : grains) {
+					coverage = CheckCoverage(jobSystem, count, grain) && coverage;
+				}
+			}
+		}
+		bool nested = true;
+		for (size_t repeat = 0; repeat < kCheckRepeats; repeat++) {
+			nested = CheckNested(jobSystem, 37, 100) && nested;
+		}
+		std::atomic<bool> concurrent = true;
+		std::thread other([&] {
+			for (size_t repeat = 0; repeat < kCheckRepeats; repeat++) {
+				if (!CheckCoverage(jobSystem, 4097, 3)) {
+					concurrent = false;
+				}
+			}
+		});
+		for (size_t repeat = 0; repeat < kCheckRepeats; repeat++) {
+			if (!CheckCoverage(jobSystem, 4097, 3)) {
+				concurrent = false;
+			}
+		}
+		other.join();
+		std::printf("ParallelFor %zu threads  each index once %s  nested %s  concurrent %s\n", threadCount,
+		    coverage ? "ok" : "NG", nested ? "ok" : "NG", concurrent ? "ok" : "NG");
+		ok = ok && coverage && nested && concurrent;
+	}
+	return ok;
+}
+
+// 1, 2, 4, ... とmaxThreads
+std::vector<size_t> MakeThreadCounts(size_t maxThreads) {
+	std::vector<size_t> threadCounts;
+	for (size_t threadCount = 1; threadCount < maxThreads; threadCount *= 2) {
+		threadCounts.push_back(threadCount);
+	}
+	threadCounts.push_back(maxThreads);
+	return threadCounts;
+}
+
+struct Batches {
+	std::vector<Matrix4x4> m1, m2, result;
+	std::vector<float> scaleX, scaleY, scaleZ, rotateX, rotateY, rotateZ, translateX, translateY, translateZ;
+	std::vector<float> x, y, z;
+};
+
+Batches MakeBatches() {
+	std::mt19937 random(0);
+	std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+	Batches batches;
+	batches.m1.resize(kMatrixCount);
+	batches.m2.resize(kMatrixCount);
+	batches.result.resize(kMatrixCount);
+	for (size_t i = 0; i < kMatrixCount; i++) {
+		for (int row = 0; row < 4; row++) {
+			for (int column = 0; column < 4; column++) {
+				batches.m1[i].m[row][column] = distribution(random);
+				batches.m2[i].m[row][column] = distribution(random);
+			}
+		}
+	}
+	for (std::vector<float>* values : { &batches.scaleX, &batches.scaleY, &batches.scaleZ, &batches.rotateX,
+	         &batches.rotateY, &batches.rotateZ, &batches.translateX, &batches.translateY, &batches.translateZ }) {
+		values->resize(kMatrixCount);
+		for (float& value : *values) {
+			value = distribution(random);
+		}
+	}
+	for (std::vector<float>* values : { &batches.x, &batches.y, &batches.z }) {
+		values->resize(kPointCount);
+		for (float& value : *values) {
+			value = distribution(random);
+		}
+	}
+	return batches;
+}
+
+} // namespace
+
+int main() {
+	JobSystem& jobSystem = JobSystem::GetInstance();
+	const size_t hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+	const size_t maxThreads = std::max(hardwareThreads, jobSystem.GetThreadCount());
+	std::printf("simd: %s  hardware threads: %zu\n", GetSimdLevelName(GetSimdLevel()), hardwareThreads);
+
+	const bool ok = CheckParallelFor(jobSystem);
+
+	Batches batches = MakeBatches();
+	const ConstVector3SoA scale(batches.scaleX.data(), batches.scaleY.data(), batches.scaleZ.data());
+	const ConstVector3SoA rotate(batches.rotateX.data(), batches.rotateY.data(), batches.rotateZ.data());
+	const ConstVector3SoA translate(batches.translateX.data(), batches.translateY.data(), batches.translateZ.data());
+	const Vector3SoA points{ batches.x.data(), batches.y.data(), batches.z.data() };
+	const Matrix4x4 matrix = MakeAffineMatrix(Vector3{ 1.0f, 1.0f, 1.0f }, Vector3{ 0.1f, 0.2f, 0.3f }, Vector3{});
+
+	std::printf("%-8s %22s %22s %22s\n", "threads", "Multiply (M/s)", "MakeAffineMatrix (M/s)", "Transform SoA (M/s)");
+	double baseline[3] = {};
+	for (size_t threadCount : MakeThreadCounts(maxThreads)) {
+		jobSystem.SetThreadCount(threadCount);
+		const double rates[3] = {
+			Benchmark::MeasureThroughput(kMatrixCount, [&] {
+				Multiply(batches.m1.data(), batches.m2.data(), batches.result.data(), kMatrixCount);
+				Benchmark::DoNotOptimize(batches.result);
+			}),
+			Benchmark::MeasureThroughput(kMatrixCount, [&] {
+				MakeAffineMatrix<SinCosPrecision::kFast>(scale, rotate, translate, batches.result.data(), kMatrixCount);
+				Benchmark::DoNotOptimize(batches.result);
+			}),
+			// 同じ配列に書き戻すので値は毎回変わるが、アフィン変換なのでスループットは変わらない
+			Benchmark::MeasureThroughput(kPointCount, [&] {
+				Transform(points, points, kPointCount, matrix);
+				Benchmark::DoNotOptimize(batches.x);
+			}),
+		};
+		std::printf("%-8zu", threadCount);
+		for (int i = 0; i < 3; i++) {
+			if (baseline[i] == 0.0) {
+				baseline[i] = rates[i];
+			}
+			std::printf(" %11.1f (x%5.2f %3.0f%%)", rates[i] * 1e-6, rates[i] / baseline[i],
+			    100.0 * rates[i] / (baseline[i] * double(threadCount)));
+		}
+		std::printf("\n");
+	}
+
+	// 1回のParallelForの負荷(処理は空)
+	jobSystem.SetThreadCount(maxThreads);
+	const auto empty = [](size_t begin, size_t end) { Benchmark::DoNotOptimize(end - begin); };
+	const Benchmark::Measurement inlined = Benchmark::Measure(kOverheadCalls, [&] {
+		for (size_t i = 0; i < kOverheadCalls; i++) {
+			jobSystem.ParallelFor(16, empty);
+		}
+	});
+	const Benchmark::Measurement dispatched = Benchmark::Measure(kOverheadCalls, [&] {
+		for (size_t i = 0; i < kOverheadCalls; i++) {
+			jobSystem.ParallelFor(1 << 16, 1, empty);
+		}
+	});
+	std::printf("ParallelFor overhead  inline (16 elements) %8.1f ns  dispatch to %zu threads %8.1f ns\n",
+	    inlined.nanoseconds, maxThreads, dispatched.nanoseconds);
+	return ok ? 0 : 1;
+}
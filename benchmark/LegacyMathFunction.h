@@ -0,0 +1,22 @@
+#pragma once
+
+// インライン化前のMathFunction(別の翻訳単位に置いた関数)
+// 呼び出しのオーバーヘッドを比較するためだけに使う
+
+#include "Matrix4x4.h"
+#include "Vector3.h"
+
+namespace Legacy {
+
+Vector3 Add(const Vector3& v1, const Vector3& v2);
+Vector3 Subtract(const Vector3& v1, const Vector3 v2);
+Vector3 Multiply(const float& k, Vector3 v1);
+float Dot(const Vector3& v1, const Vector3& v2);
+Vector3 Cross(const Vector3& v1, const Vector3& v2);
+Vector3 GetXAxis(const Matrix4x4& m);
+Matrix4x4 MakeIdentity4x4();
+Matrix4x4 MakeTranslateMatrix(const Vector3& translate);
+Vector3 Transform(const Vector3& vector, const Matrix4x4& matrix);
+Vector3 Lerp(const Vector3& v1, const Vector3& v2, float t);
+
+} // namespace Legacy
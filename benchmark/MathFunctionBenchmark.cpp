@@ -0,0 +1,602 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Benchmark.h"
+#include "MathFunction.h"
+#include "SimdDispatch.h"
+
+// MathFunction.h(とSinCos.h)のすべての関数を要素数ごとに計測し、JSONで出力する
+// 1要素あたりのns、1秒あたりの要素数、タイムスタンプカウンタのサイクル数を出す
+// 結果は1件1行で、名前と要素数の順序は固定なのでコミット間でdiffを取れる
+//
+// 引数
+//   --filter=<文字列>   名前にその文字列を含むものだけ計測する
+//   --batch=<n,n,...>   要素数(既定 64,4096,65536)
+//   --min-time=<秒>     1件あたりの最短計測時間(既定 0.1)
+//   --output=<path>     出力先(既定 標準出力)
+
+namespace {
+
+struct Result {
+	std::string name;
+	size_t batch;
+	Benchmark::Measurement measurement;
+};
+
+// 入力(最大の要素数分を乱数で作っておく)
+struct Inputs {
+	std::vector<Vector3> v1, v2;
+	std::vector<Vector3> unit1, unit2; // 正規化済み
+	std::vector<Vector2> vector2s1, vector2s2;
+	std::vector<Vector4> vector4s1, vector4s2;
+	std::vector<float> scalars, t, angles;
+	std::vector<Matrix4x4> m1, m2; // 一般の行列
+	std::vector<Matrix4x4> affine, rigid;
+	std::vector<Matrix3x3> m3x3a, m3x3b; // 一般の行列(3x3)
+	std::vector<Quaternion> q1, q2; // 単位クォータニオン
+	std::vector<Vector3> scales, rotations, translates;
+
+	// SoA形式
+	std::vector<float> soaX, soaY, soaZ;
+	std::vector<float> soa2X, soa2Y, soa2Z;
+	std::vector<float> scaleX, scaleY, scaleZ, rotateX, rotateY, rotateZ, translateX, translateY, translateZ;
+	std::vector<float> q1X, q1Y, q1Z, q1W, q2X, q2Y, q2Z, q2W;
+};
+
+// 出力
+struct Outputs {
+	std::vector<Vector3> vectors, translates;
+	std::vector<Vector2> vector2s;
+	std::vector<Vector4> vector4s;
+	std::vector<float> scalars, scalars2;
+	std::vector<uint8_t> flags;
+	std::vector<Matrix4x4> matrices;
+	std::vector<Matrix3x3> matrices3x3;
+	std::vector<Quaternion> quaternions;
+	std::vector<float> soaX, soaY, soaZ, soaW;
+	std::vector<float> scaleX, scaleY, scaleZ, translateX, translateY, translateZ;
+};
+
+Inputs MakeInputs(size_t count) {
+	std::mt19937 random(0);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> zeroToOne(0.0f, 1.0f);
+	std::uniform_real_distribution<float> angle(-6.28318531f, 6.28318531f);
+	std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+	std::uniform_real_distribution<float> translate(-100.0f, 100.0f);
+	const auto randomVector = [&] {
+		Vector3 v{ unit(random), unit(random), unit(random) };
+		return Dot(v, v) < 1e-4f ? Vector3{ 1.0f, 0.0f, 0.0f } : v;
+	};
+
+	Inputs in;
+	for (size_t i = 0; i < count; i++) {
+		in.v1.push_back(randomVector());
+		in.v2.push_back(randomVector());
+		in.unit1.push_back(Normalize(in.v1.back()));
+		in.unit2.push_back(Normalize(in.v2.back()));
+		in.scalars.push_back(unit(random) * 10.0f);
+		const Vector3& v1 = in.v1.back();
+		const Vector3& v2 = in.v2.back();
+		in.vector2s1.push_back(Vector2{ v1.x, v1.y });
+		in.vector2s2.push_back(Vector2{ v2.x, v2.y });
+		in.vector4s1.push_back(Vector4{ v1.x, v1.y, v1.z, in.scalars.back() });
+		in.vector4s2.push_back(Vector4{ v2.x, v2.y, v2.z, 1.0f });
+		in.t.push_back(zeroToOne(random));
+		in.angles.push_back(angle(random));
+
+		Matrix4x4 m1, m2;
+		for (int line = 0; line < 4; line++) {
+			for (int column = 0; column < 4; column++) {
+				m1.m[line][column] = unit(random);
+				m2.m[line][column] = unit(random);
+			}
+		}
+		in.m1.push_back(m1);
+		in.m2.push_back(m2);
+		in.m3x3a.push_back(MakeMatrix3x3(m1));
+		in.m3x3b.push_back(MakeMatrix3x3(m2));
+
+		const Vector3 s{ scale(random), scale(random), scale(random) };
+		const Vector3 r{ angle(random), angle(random), angle(random) };
+		const Vector3 t{ translate(random), translate(random), translate(random) };
+		in.scales.push_back(s);
+		in.rotations.push_back(r);
+		in.translates.push_back(t);
+		in.affine.push_back(MakeAffineMatrix(s, r, t));
+		in.rigid.push_back(MakeAffineMatrix(Vector3{ 1.0f, 1.0f, 1.0f }, r, t));
+
+		Quaternion q1 = MakeRotateAxisAngleQuaternion(in.unit1.back(), angle(random));
+		Quaternion q2 = MakeRotateAxisAngleQuaternion(in.unit2.back(), angle(random));
+		in.q1.push_back(q1);
+		in.q2.push_back(q2);
+
+		in.soaX.push_back(in.v1.back().x);
+		in.soaY.push_back(in.v1.back().y);
+		in.soaZ.push_back(in.v1.back().z);
+		in.soa2X.push_back(in.v2.back().x);
+		in.soa2Y.push_back(in.v2.back().y);
+		in.soa2Z.push_back(in.v2.back().z);
+		in.scaleX.push_back(s.x);
+		in.scaleY.push_back(s.y);
+		in.scaleZ.push_back(s.z);
+		in.rotateX.push_back(r.x);
+		in.rotateY.push_back(r.y);
+		in.rotateZ.push_back(r.z);
+		in.translateX.push_back(t.x);
+		in.translateY.push_back(t.y);
+		in.translateZ.push_back(t.z);
+		in.q1X.push_back(q1.x);
+		in.q1Y.push_back(q1.y);
+		in.q1Z.push_back(q1.z);
+		in.q1W.push_back(q1.w);
+		in.q2X.push_back(q2.x);
+		in.q2Y.push_back(q2.y);
+		in.q2Z.push_back(q2.z);
+		in.q2W.push_back(q2.w);
+	}
+	return in;
+}
+
+Outputs MakeOutputs(size_t count) {
+	Outputs out;
+	out.vectors.resize(count);
+	out.translates.resize(count);
+	out.vector2s.resize(count);
+	out.vector4s.resize(count);
+	out.scalars.resize(count);
+	out.scalars2.resize(count);
+	out.flags.resize(count);
+	out.matrices.resize(count);
+	out.matrices3x3.resize(count);
+	out.quaternions.resize(count);
+	out.soaX.resize(count);
+	out.soaY.resize(count);
+	out.soaZ.resize(count);
+	out.soaW.resize(count);
+	out.scaleX.resize(count);
+	out.scaleY.resize(count);
+	out.scaleZ.resize(count);
+	out.translateX.resize(count);
+	out.translateY.resize(count);
+	out.translateZ.resize(count);
+	return out;
+}
+
+class Suite {
+public:
+	Suite(std::vector<size_t> batches, std::string filter, double minSeconds)
+	    : batches_(std::move(batches)), filter_(std::move(filter)), minSeconds_(minSeconds) {}
+
+	// func(count)で先頭からcount要素を処理する
+	template<class Func>
+	void Run(const std::string& name, Func&& func) {
+		if (!filter_.empty() && name.find(filter_) == std::string::npos) {
+			return;
+		}
+		for (size_t batch : batches_) {
+			results_.push_back({ name, batch, Benchmark::Measure(batch, [&] { func(batch); }, minSeconds_) });
+		}
+	}
+
+	// 1要素ずつ呼び出す関数 output[i] = func(i)
+	template<class T, class Func>
+	void RunEach(const std::string& name, std::vector<T>& output, Func func) {
+		Run(name, [&](size_t count) {
+			for (size_t i = 0; i < count; i++) {
+				output[i] = func(i);
+			}
+			Benchmark::DoNotOptimize(output);
+		});
+	}
+
+	const std::vector<Result>& GetResults() const { return results_; }
+
+private:
+	std::vector<size_t> batches_;
+	std::string filter_;
+	double minSeconds_;
+	std::vector<Result> results_;
+};
+
+const char* GetPrecisionName(SinCosPrecision precision) {
+	switch (precision) {
+	case SinCosPrecision::kExact:
+		return "kExact";
+	case SinCosPrecision::kPrecise:
+		return "kPrecise";
+	default:
+		return "kFast";
+	}
+}
+
+const char* GetPrecisionName(ReciprocalPrecision precision) {
+	switch (precision) {
+	case ReciprocalPrecision::kExact:
+		return "kExact";
+	case ReciprocalPrecision::kPrecise:
+		return "kPrecise";
+	default:
+		return "kFast";
+	}
+}
+
+void AddVectorCases(Suite& suite, const Inputs& in, Outputs& out) {
+	suite.RunEach("Add(Vector3, Vector3)", out.vectors, [&](size_t i) { return Add(in.v1[i], in.v2[i]); });
+	suite.RunEach("Subtract(Vector3, Vector3)", out.vectors, [&](size_t i) { return Subtract(in.v1[i], in.v2[i]); });
+	suite.RunEach("Multiply(float, Vector3)", out.vectors, [&](size_t i) { return Multiply(in.scalars[i], in.v1[i]); });
+	suite.RunEach("Dot(Vector3, Vector3)", out.scalars, [&](size_t i) { return Dot(in.v1[i], in.v2[i]); });
+	suite.RunEach("Length(Vector3)", out.scalars, [&](size_t i) { return Length(in.v1[i]); });
+	suite.RunEach("LengthSquared(Vector3)", out.scalars, [&](size_t i) { return LengthSquared(in.v1[i]); });
+	suite.RunEach("Normalize(Vector3)", out.vectors, [&](size_t i) { return Normalize(in.v1[i]); });
+	suite.RunEach("TransformNormal(Vector3, Matrix4x4)", out.vectors,
+	    [&](size_t i) { return TransformNormal(in.v1[i], in.affine[i]); });
+	suite.RunEach("Cross(Vector3, Vector3)", out.vectors, [&](size_t i) { return Cross(in.v1[i], in.v2[i]); });
+	suite.RunEach("GetXAxis(Matrix4x4)", out.vectors, [&](size_t i) { return GetXAxis(in.affine[i]); });
+	suite.RunEach("GetYAxis(Matrix4x4)", out.vectors, [&](size_t i) { return GetYAxis(in.affine[i]); });
+	suite.RunEach("GetZAxis(Matrix4x4)", out.vectors, [&](size_t i) { return GetZAxis(in.affine[i]); });
+	suite.RunEach("Project(Vector3, Vector3)", out.vectors, [&](size_t i) { return Project(in.v1[i], in.v2[i]); });
+	suite.RunEach("ClosestPoint(Vector3, Segment)", out.vectors,
+	    [&](size_t i) { return ClosestPoint(in.v1[i], Segment{ in.v2[i], in.unit1[i] }); });
+	suite.RunEach("ClosestPoint(Vector3, Sphere)", out.vectors,
+	    [&](size_t i) { return ClosestPoint(in.v1[i], Sphere{ in.v2[i], in.t[i] }); });
+	suite.RunEach("ClosestPoint(Vector3, Triangle)", out.vectors,
+	    [&](size_t i) { return ClosestPoint(in.v1[i], Triangle{ { in.v2[i], in.unit1[i], in.unit2[i] } }); });
+	suite.RunEach("ConvertToRadians(float)", out.scalars, [&](size_t i) { return ConvertToRadians(in.scalars[i]); });
+	suite.RunEach("LerpShortAngle(float, float, float)", out.scalars,
+	    [&](size_t i) { return LerpShortAngle(in.angles[i], in.scalars[i], in.t[i]); });
+	suite.Run("LerpShortAngle(float*, float*, float*, count)", [&](size_t count) {
+		LerpShortAngle(in.angles.data(), in.scalars.data(), in.t.data(), out.scalars.data(), count);
+		Benchmark::DoNotOptimize(out.scalars);
+	});
+	suite.RunEach("Lerp(Vector3, Vector3, float)", out.vectors,
+	    [&](size_t i) { return Lerp(in.v1[i], in.v2[i], in.t[i]); });
+	const ConstVector3SoA v1(in.soaX.data(), in.soaY.data(), in.soaZ.data());
+	const ConstVector3SoA v2(in.soa2X.data(), in.soa2Y.data(), in.soa2Z.data());
+	const Vector3SoA result{ out.soaX.data(), out.soaY.data(), out.soaZ.data() };
+	suite.Run("Lerp(Vector3SoA, Vector3SoA, float*, count)", [&](size_t count) {
+		Lerp(v1, v2, in.t.data(), result, count);
+		Benchmark::DoNotOptimize(out.soaX);
+	});
+	suite.Run("Slerp(Vector3SoA, Vector3SoA, float*, count)", [&](size_t count) {
+		Slerp(v1, v2, in.t.data(), result, count);
+		Benchmark::DoNotOptimize(out.soaX);
+	});
+	suite.Run("LengthSquared(Vector3SoA, float*, count)", [&](size_t count) {
+		LengthSquared(v1, out.scalars.data(), count);
+		Benchmark::DoNotOptimize(out.scalars);
+	});
+
+	suite.RunEach("Add(Vector2, Vector2)", out.vector2s,
+	    [&](size_t i) { return Add(in.vector2s1[i], in.vector2s2[i]); });
+	suite.RunEach("Subtract(Vector2, Vector2)", out.vector2s,
+	    [&](size_t i) { return Subtract(in.vector2s1[i], in.vector2s2[i]); });
+	suite.RunEach("Multiply(float, Vector2)", out.vector2s,
+	    [&](size_t i) { return Multiply(in.scalars[i], in.vector2s1[i]); });
+	suite.RunEach("Dot(Vector2, Vector2)", out.scalars, [&](size_t i) { return Dot(in.vector2s1[i], in.vector2s2[i]); });
+	suite.RunEach("Length(Vector2)", out.scalars, [&](size_t i) { return Length(in.vector2s1[i]); });
+	suite.RunEach("Normalize(Vector2)", out.vector2s, [&](size_t i) { return Normalize(in.vector2s1[i]); });
+	suite.RunEach("Lerp(Vector2, Vector2, float)", out.vector2s,
+	    [&](size_t i) { return Lerp(in.vector2s1[i], in.vector2s2[i], in.t[i]); });
+
+	suite.RunEach("Add(Vector4, Vector4)", out.vector4s,
+	    [&](size_t i) { return Add(in.vector4s1[i], in.vector4s2[i]); });
+	suite.RunEach("Subtract(Vector4, Vector4)", out.vector4s,
+	    [&](size_t i) { return Subtract(in.vector4s1[i], in.vector4s2[i]); });
+	suite.RunEach("Multiply(float, Vector4)", out.vector4s,
+	    [&](size_t i) { return Multiply(in.scalars[i], in.vector4s1[i]); });
+	suite.RunEach("Dot(Vector4, Vector4)", out.scalars, [&](size_t i) { return Dot(in.vector4s1[i], in.vector4s2[i]); });
+	suite.RunEach("Length(Vector4)", out.scalars, [&](size_t i) { return Length(in.vector4s1[i]); });
+	suite.RunEach("Normalize(Vector4)", out.vector4s, [&](size_t i) { return Normalize(in.vector4s1[i]); });
+	suite.RunEach("Lerp(Vector4, Vector4, float)", out.vector4s,
+	    [&](size_t i) { return Lerp(in.vector4s1[i], in.vector4s2[i], in.t[i]); });
+	suite.RunEach("Transform(Vector4, Matrix4x4)", out.vector4s,
+	    [&](size_t i) { return Transform(in.vector4s2[i], in.m1[i]); });
+}
+
+void AddMatrixCases(Suite& suite, const Inputs& in, Outputs& out) {
+	suite.RunEach("Add(Matrix4x4, Matrix4x4)", out.matrices, [&](size_t i) { return Add(in.m1[i], in.m2[i]); });
+	suite.RunEach("Subtract(Matrix4x4, Matrix4x4)", out.matrices,
+	    [&](size_t i) { return Subtract(in.m1[i], in.m2[i]); });
+	suite.RunEach("Multiply(Matrix4x4, Matrix4x4)", out.matrices,
+	    [&](size_t i) { return Multiply(in.m1[i], in.m2[i]); });
+	suite.Run("Multiply(Matrix4x4*, Matrix4x4*, count)", [&](size_t count) {
+		Multiply(in.m1.data(), in.m2.data(), out.matrices.data(), count);
+		Benchmark::DoNotOptimize(out.matrices);
+	});
+	suite.RunEach("Inverse(Matrix4x4)", out.matrices, [&](size_t i) { return Inverse(in.m1[i]); });
+	suite.RunEach("TryInverse(Matrix4x4)", out.flags, [&](size_t i) { return TryInverse(in.m1[i], out.matrices[i]); });
+	suite.Run("Inverse(Matrix4x4*, count)", [&](size_t count) {
+		Benchmark::DoNotOptimize(Inverse(in.m1.data(), out.matrices.data(), count));
+		Benchmark::DoNotOptimize(out.matrices);
+	});
+	suite.RunEach("InverseAffine(Matrix4x4)", out.matrices, [&](size_t i) { return InverseAffine(in.affine[i]); });
+	suite.RunEach("InverseRigid(Matrix4x4)", out.matrices, [&](size_t i) { return InverseRigid(in.rigid[i]); });
+	suite.RunEach("Transpose(Matrix4x4)", out.matrices, [&](size_t i) { return Transpose(in.m1[i]); });
+	suite.RunEach("MakeIdentity4x4()", out.matrices, [&](size_t) { return MakeIdentity4x4(); });
+	suite.RunEach("MakeTranslateMatrix(Vector3)", out.matrices,
+	    [&](size_t i) { return MakeTranslateMatrix(in.translates[i]); });
+	suite.RunEach("MakeScaleMatrix(Vector3)", out.matrices, [&](size_t i) { return MakeScaleMatrix(in.scales[i]); });
+	suite.RunEach("Transform(Vector3, Matrix4x4)", out.vectors,
+	    [&](size_t i) { return Transform(in.v1[i], in.affine[i]); });
+	suite.Run("Transform(Vector3SoA, count, Matrix4x4)", [&](size_t count) {
+		Transform(ConstVector3SoA(in.soaX.data(), in.soaY.data(), in.soaZ.data()),
+		    Vector3SoA{ out.soaX.data(), out.soaY.data(), out.soaZ.data() }, count, in.affine[0]);
+		Benchmark::DoNotOptimize(out.soaX);
+	});
+	suite.Run("Transform(Vector3*, count, Matrix4x4)", [&](size_t count) {
+		Transform(in.v1.data(), out.vectors.data(), count, in.affine[0]);
+		Benchmark::DoNotOptimize(out.vectors);
+	});
+	suite.RunEach("MakeNormalMatrix(Matrix4x4)", out.matrices3x3,
+	    [&](size_t i) { return MakeNormalMatrix(in.affine[i]); });
+	suite.RunEach("MakeNormalMatrixUniformScale(Matrix4x4)", out.matrices3x3,
+	    [&](size_t i) { return MakeNormalMatrixUniformScale(in.rigid[i]); });
+	const Matrix3x3 normalMatrix = MakeNormalMatrix(in.affine[0]);
+	suite.Run("TransformNormals(Vector3SoA, count, Matrix3x3)", [&](size_t count) {
+		TransformNormals(ConstVector3SoA(in.soaX.data(), in.soaY.data(), in.soaZ.data()),
+		    Vector3SoA{ out.soaX.data(), out.soaY.data(), out.soaZ.data() }, count, normalMatrix);
+		Benchmark::DoNotOptimize(out.soaX);
+	});
+	suite.Run("TransformNormals(Vector3*, count, Matrix3x3)", [&](size_t count) {
+		TransformNormals(in.v1.data(), out.vectors.data(), count, normalMatrix);
+		Benchmark::DoNotOptimize(out.vectors);
+	});
+	suite.RunEach("IsAffineMatrix(Matrix4x4)", out.flags, [&](size_t i) { return IsAffineMatrix(in.m1[i]); });
+	suite.RunEach("MakeAffineMatrix(Vector3, Matrix4x4, Vector3)", out.matrices,
+	    [&](size_t i) { return MakeAffineMatrix(in.scales[i], in.rigid[i], in.translates[i]); });
+	suite.RunEach("MakeAffineMatrix(Vector3, Quaternion, Vector3)", out.matrices,
+	    [&](size_t i) { return MakeAffineMatrix(in.scales[i], in.q1[i], in.translates[i]); });
+	suite.Run("MakeAffineMatrix(Vector3SoA, QuaternionSoA, Vector3SoA, count)", [&](size_t count) {
+		MakeAffineMatrix(ConstVector3SoA(in.scaleX.data(), in.scaleY.data(), in.scaleZ.data()),
+		    ConstQuaternionSoA(in.q1X.data(), in.q1Y.data(), in.q1Z.data(), in.q1W.data()),
+		    ConstVector3SoA(in.translateX.data(), in.translateY.data(), in.translateZ.data()), out.matrices.data(),
+		    count);
+		Benchmark::DoNotOptimize(out.matrices);
+	});
+	suite.RunEach("Decompose(Matrix4x4, Vector3, Matrix3x3, Vector3)", out.flags,
+	    [&](size_t i) { return Decompose(in.affine[i], out.vectors[i], out.matrices3x3[i], out.translates[i]); });
+	suite.RunEach("Decompose(Matrix4x4, Vector3, Quaternion, Vector3)", out.flags,
+	    [&](size_t i) { return Decompose(in.affine[i], out.vectors[i], out.quaternions[i], out.translates[i]); });
+	suite.Run("Decompose(Matrix4x4*, Vector3SoA, QuaternionSoA, Vector3SoA, count)", [&](size_t count) {
+		Benchmark::DoNotOptimize(Decompose(in.affine.data(),
+		    Vector3SoA{ out.scaleX.data(), out.scaleY.data(), out.scaleZ.data() },
+		    QuaternionSoA{ out.soaX.data(), out.soaY.data(), out.soaZ.data(), out.soaW.data() },
+		    Vector3SoA{ out.translateX.data(), out.translateY.data(), out.translateZ.data() }, count));
+		Benchmark::DoNotOptimize(out.soaX);
+	});
+	suite.Run("BlendAffineMatrices(Matrix4x4*, Matrix4x4*, float*, count)", [&](size_t count) {
+		BlendAffineMatrices(in.affine.data(), in.rigid.data(), in.t.data(), out.matrices.data(), count);
+		Benchmark::DoNotOptimize(out.matrices);
+	});
+	suite.RunEach("MakeOrthographicMatrix(float, float, float, float, float, float)", out.matrices, [&](size_t i) {
+		return MakeOrthographicMatrix(-in.scales[i].x, in.scales[i].y, in.scales[i].x, -in.scales[i].y, 0.1f, 100.0f);
+	});
+	suite.RunEach("MakeViewportMatrix(float, float, float, float, float, float)", out.matrices,
+	    [&](size_t i) { return MakeViewportMatrix(0.0f, 0.0f, 1280.0f * in.t[i], 720.0f, 0.0f, 1.0f); });
+	suite.RunEach("MakeViewMatrix(Vector3, Vector3)", out.matrices,
+	    [&](size_t i) { return MakeViewMatrix(in.rotations[i], in.translates[i]); });
+	suite.RunEach("DirectionToDirection(Vector3, Vector3)", out.matrices,
+	    [&](size_t i) { return DirectionToDirection(in.unit1[i], in.unit2[i]); });
+
+	suite.RunEach("MakeIdentity3x3()", out.matrices3x3, [&](size_t) { return MakeIdentity3x3(); });
+	suite.RunEach("MakeMatrix3x3(Matrix4x4)", out.matrices3x3, [&](size_t i) { return MakeMatrix3x3(in.m1[i]); });
+	suite.RunEach("MakeMatrix4x4(Matrix3x3)", out.matrices, [&](size_t i) { return MakeMatrix4x4(in.m3x3a[i]); });
+	suite.RunEach("MakeRotateMatrix3x3(Quaternion)", out.matrices3x3,
+	    [&](size_t i) { return MakeRotateMatrix3x3(in.q1[i]); });
+	suite.RunEach("Multiply(Matrix3x3, Matrix3x3)", out.matrices3x3,
+	    [&](size_t i) { return Multiply(in.m3x3a[i], in.m3x3b[i]); });
+	suite.RunEach("Inverse(Matrix3x3)", out.matrices3x3, [&](size_t i) { return Inverse(in.m3x3a[i]); });
+	suite.RunEach("Transform(Vector3, Matrix3x3)", out.vectors,
+	    [&](size_t i) { return Transform(in.v1[i], in.m3x3a[i]); });
+}
+
+void AddQuaternionCases(Suite& suite, const Inputs& in, Outputs& out) {
+	suite.RunEach("Multiply(Quaternion, Quaternion)", out.quaternions,
+	    [&](size_t i) { return Multiply(in.q1[i], in.q2[i]); });
+	suite.RunEach("IdentityQuaternion()", out.quaternions, [&](size_t) { return IdentityQuaternion(); });
+	suite.RunEach("Conjugate(Quaternion)", out.quaternions, [&](size_t i) { return Conjugate(in.q1[i]); });
+	suite.RunEach("Dot(Quaternion, Quaternion)", out.scalars, [&](size_t i) { return Dot(in.q1[i], in.q2[i]); });
+	suite.RunEach("Norm(Quaternion)", out.scalars, [&](size_t i) { return Norm(in.q1[i]); });
+	suite.RunEach("Normalize(Quaternion)", out.quaternions, [&](size_t i) { return Normalize(in.q1[i]); });
+	suite.RunEach("Inverse(Quaternion)", out.quaternions, [&](size_t i) { return Inverse(in.q1[i]); });
+	suite.RunEach("DirectionToDirectionQuaternion(Vector3, Vector3)", out.quaternions,
+	    [&](size_t i) { return DirectionToDirectionQuaternion(in.unit1[i], in.unit2[i]); });
+	suite.RunEach("RotateVector(Vector3, Quaternion)", out.vectors,
+	    [&](size_t i) { return RotateVector(in.v1[i], in.q1[i]); });
+	suite.RunEach("MakeRotateMatrix(Quaternion)", out.matrices, [&](size_t i) { return MakeRotateMatrix(in.q1[i]); });
+	suite.RunEach("MakeRotateQuaternion(Matrix4x4)", out.quaternions,
+	    [&](size_t i) { return MakeRotateQuaternion(in.rigid[i]); });
+	suite.RunEach("Nlerp(Quaternion, Quaternion, float)", out.quaternions,
+	    [&](size_t i) { return Nlerp(in.q1[i], in.q2[i], in.t[i]); });
+	const ConstQuaternionSoA q1(in.q1X.data(), in.q1Y.data(), in.q1Z.data(), in.q1W.data());
+	const ConstQuaternionSoA q2(in.q2X.data(), in.q2Y.data(), in.q2Z.data(), in.q2W.data());
+	const QuaternionSoA result{ out.soaX.data(), out.soaY.data(), out.soaZ.data(), out.soaW.data() };
+	suite.Run("Nlerp(QuaternionSoA, QuaternionSoA, float*, count)", [&](size_t count) {
+		Nlerp(q1, q2, in.t.data(), result, count);
+		Benchmark::DoNotOptimize(out.soaX);
+	});
+	suite.Run("Slerp(QuaternionSoA, QuaternionSoA, float*, count)", [&](size_t count) {
+		Slerp(q1, q2, in.t.data(), result, count);
+		Benchmark::DoNotOptimize(out.soaX);
+	});
+}
+
+// sin/cosの精度を選べる関数
+template<SinCosPrecision kPrecision>
+void AddPrecisionCases(Suite& suite, const Inputs& in, Outputs& out) {
+	const std::string suffix = std::string("<") + GetPrecisionName(kPrecision) + ">";
+	suite.Run("SinCos" + suffix + "(float)", [&](size_t count) {
+		for (size_t i = 0; i < count; i++) {
+			SinCos<kPrecision>(in.angles[i], out.scalars[i], out.scalars2[i]);
+		}
+		Benchmark::DoNotOptimize(out.scalars);
+		Benchmark::DoNotOptimize(out.scalars2);
+	});
+	suite.Run("SinCos" + suffix + "(float*, count)", [&](size_t count) {
+		SinCos<kPrecision>(in.angles.data(), out.scalars.data(), out.scalars2.data(), count);
+		Benchmark::DoNotOptimize(out.scalars);
+		Benchmark::DoNotOptimize(out.scalars2);
+	});
+	suite.RunEach("MakeRotateXMatrix" + suffix + "(float)", out.matrices,
+	    [&](size_t i) { return MakeRotateXMatrix<kPrecision>(in.angles[i]); });
+	suite.RunEach("MakeRotateYMatrix" + suffix + "(float)", out.matrices,
+	    [&](size_t i) { return MakeRotateYMatrix<kPrecision>(in.angles[i]); });
+	suite.RunEach("MakeRotateZMatrix" + suffix + "(float)", out.matrices,
+	    [&](size_t i) { return MakeRotateZMatrix<kPrecision>(in.angles[i]); });
+	suite.RunEach("MakeRotateXYZMatrix" + suffix + "(Vector3)", out.matrices,
+	    [&](size_t i) { return MakeRotateXYZMatrix<kPrecision>(in.rotations[i]); });
+	suite.RunEach("MakeAffineMatrix" + suffix + "(Vector3, Vector3, Vector3)", out.matrices,
+	    [&](size_t i) { return MakeAffineMatrix<kPrecision>(in.scales[i], in.rotations[i], in.translates[i]); });
+	suite.Run("MakeAffineMatrix" + suffix + "(Vector3SoA, Vector3SoA, Vector3SoA, count)", [&](size_t count) {
+		MakeAffineMatrix<kPrecision>(ConstVector3SoA(in.scaleX.data(), in.scaleY.data(), in.scaleZ.data()),
+		    ConstVector3SoA(in.rotateX.data(), in.rotateY.data(), in.rotateZ.data()),
+		    ConstVector3SoA(in.translateX.data(), in.translateY.data(), in.translateZ.data()), out.matrices.data(),
+		    count);
+		Benchmark::DoNotOptimize(out.matrices);
+	});
+	suite.RunEach("MakePerspectiveFovMatrix" + suffix + "(float, float, float, float)", out.matrices, [&](size_t i) {
+		return MakePerspectiveFovMatrix<kPrecision>(0.3f + in.t[i], 16.0f / 9.0f, 0.1f, 1000.0f);
+	});
+	suite.RunEach("MakeRotateAxisAngle" + suffix + "(Vector3, float)", out.matrices,
+	    [&](size_t i) { return MakeRotateAxisAngle<kPrecision>(in.unit1[i], in.angles[i]); });
+	suite.RunEach("Slerp" + suffix + "(Vector3, Vector3, float)", out.vectors,
+	    [&](size_t i) { return Slerp<kPrecision>(in.unit1[i], in.unit2[i], in.t[i]); });
+	suite.RunEach("MakeRotateAxisAngleQuaternion" + suffix + "(Vector3, float)", out.quaternions,
+	    [&](size_t i) { return MakeRotateAxisAngleQuaternion<kPrecision>(in.unit1[i], in.angles[i]); });
+	suite.RunEach("Slerp" + suffix + "(Quaternion, Quaternion, float)", out.quaternions,
+	    [&](size_t i) { return Slerp<kPrecision>(in.q1[i], in.q2[i], in.t[i]); });
+}
+
+// 逆数・逆平方根の精度を選べる関数
+template<ReciprocalPrecision kPrecision>
+void AddReciprocalCases(Suite& suite, const Inputs& in, Outputs& out) {
+	const std::string suffix = std::string("<") + GetPrecisionName(kPrecision) + ">";
+	const ConstVector3SoA v1(in.soaX.data(), in.soaY.data(), in.soaZ.data());
+	const ConstVector3SoA v2(in.soa2X.data(), in.soa2Y.data(), in.soa2Z.data());
+	const Vector3SoA result{ out.soaX.data(), out.soaY.data(), out.soaZ.data() };
+	suite.Run("Length" + suffix + "(Vector3SoA, float*, count)", [&](size_t count) {
+		Length<kPrecision>(v1, out.scalars.data(), count);
+		Benchmark::DoNotOptimize(out.scalars);
+	});
+	suite.Run("Normalize" + suffix + "(Vector3SoA, count)", [&](size_t count) {
+		Normalize<kPrecision>(v1, result, count);
+		Benchmark::DoNotOptimize(out.soaX);
+	});
+	suite.Run("Project" + suffix + "(Vector3SoA, Vector3SoA, count)", [&](size_t count) {
+		Project<kPrecision>(v1, v2, result, count);
+		Benchmark::DoNotOptimize(out.soaX);
+	});
+}
+
+void WriteJson(std::FILE* file, const std::vector<Result>& results, double minSeconds) {
+	std::fprintf(file, "{\n");
+	std::fprintf(file, "  \"simd\": \"%s\",\n", GetSimdLevelName(GetSimdLevel()));
+	std::fprintf(file, "  \"cycle_counter\": %s,\n", MT4_BENCHMARK_HAS_CYCLE_COUNTER ? "\"tsc\"" : "null");
+	std::fprintf(file, "  \"min_time_seconds\": %g,\n", minSeconds);
+	std::fprintf(file, "  \"results\": [\n");
+	for (size_t i = 0; i < results.size(); i++) {
+		const Result& result = results[i];
+		const Benchmark::Measurement& measurement = result.measurement;
+		std::fprintf(file,
+		    "    {\"name\": \"%s\", \"batch\": %zu, \"ns_per_op\": %.4f, \"ops_per_sec\": %.6e, \"cycles_per_op\": ",
+		    result.name.c_str(), result.batch, measurement.nanoseconds, measurement.elementsPerSecond);
+		if (MT4_BENCHMARK_HAS_CYCLE_COUNTER) {
+			std::fprintf(file, "%.4f}", measurement.cycles);
+		}
+		else {
+			std::fprintf(file, "null}");
+		}
+		std::fprintf(file, "%s\n", i + 1 < results.size() ? "," : "");
+	}
+	std::fprintf(file, "  ]\n}\n");
+}
+
+// "--name=value"形式の引数ならvalueを返す
+const char* FindOption(const char* argument, const char* name) {
+	const size_t length = std::strlen(name);
+	if (std::strncmp(argument, name, length) == 0 && argument[length] == '=') {
+		return argument + length + 1;
+	}
+	return nullptr;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	std::vector<size_t> batches = { 64, 4096, 65536 };
+	std::string filter;
+	double minSeconds = 0.1;
+	const char* outputPath = nullptr;
+	for (int i = 1; i < argc; i++) {
+		if (const char* value = FindOption(argv[i], "--filter")) {
+			filter = value;
+		}
+		else if (const char* value = FindOption(argv[i], "--batch")) {
+			batches.clear();
+			for (const char* p = value; *p != '\0';) {
+				char* end = nullptr;
+				const size_t batch = std::strtoull(p, &end, 10);
+				if (end == p || batch == 0) {
+					std::fprintf(stderr, "invalid --batch: %s\n", value);
+					return 1;
+				}
+				batches.push_back(batch);
+				p = *end == ',' ? end + 1 : end;
+			}
+		}
+		else if (const char* value = FindOption(argv[i], "--min-time")) {
+			minSeconds = std::atof(value);
+		}
+		else if (const char* value = FindOption(argv[i], "--output")) {
+			outputPath = value;
+		}
+		else {
+			std::fprintf(stderr,
+			    "usage: %s [--filter=<text>] [--batch=<n,n,...>] [--min-time=<seconds>] [--output=<path>]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (batches.empty()) {
+		std::fprintf(stderr, "--batch needs at least one size\n");
+		return 1;
+	}
+
+	size_t maxBatch = 0;
+	for (size_t batch : batches) {
+		maxBatch = std::max(maxBatch, batch);
+	}
+	const Inputs in = MakeInputs(maxBatch);
+	Outputs out = MakeOutputs(maxBatch);
+
+	Suite suite(batches, filter, minSeconds);
+	AddVectorCases(suite, in, out);
+	AddMatrixCases(suite, in, out);
+	AddQuaternionCases(suite, in, out);
+	AddPrecisionCases<SinCosPrecision::kExact>(suite, in, out);
+	AddPrecisionCases<SinCosPrecision::kPrecise>(suite, in, out);
+	AddPrecisionCases<SinCosPrecision::kFast>(suite, in, out);
+	AddReciprocalCases<ReciprocalPrecision::kExact>(suite, in, out);
+	AddReciprocalCases<ReciprocalPrecision::kPrecise>(suite, in, out);
+	AddReciprocalCases<ReciprocalPrecision::kFast>(suite, in, out);
+
+	std::FILE* file = stdout;
+	if (outputPath) {
+		file = std::fopen(outputPath, "w");
+		if (!file) {
+			std::fprintf(stderr, "cannot open %s\n", outputPath);
+			return 1;
+		}
+	}
+	WriteJson(file, suite.GetResults(), minSeconds);
+	if (file != stdout) {
+		std::fclose(file);
+	}
+	return 0;
+}
@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "MathFunction.h"
+#include "MatrixExpression.h"
+
+// 行列の積をMultiplyで作ってから使う場合と、MatrixExpressionで遅延評価する場合を比較する
+// 両者の結果の差(最大相対誤差)も合わせて表示し、許容誤差を超えたら失敗(終了コード1)にする
+
+namespace {
+
+// 拡大縮小と平行移動だけの式はコンパイル時に畳み込める
+constexpr Vector3 kScaled = Transform(
+    Vector3{ 1.0f, 2.0f, 3.0f }, LazyScale(Vector3{ 2.0f, 2.0f, 2.0f }) * LazyTranslate(Vector3{ 1.0f, 0.0f, -1.0f }));
+static_assert(kScaled.x == 3.0f && kScaled.y == 4.0f && kScaled.z == 5.0f);
+static_assert(Evaluate(LazyScale(Vector3{ 1.0f, 2.0f, 3.0f }) * LazyTranslate(Vector3{ 4.0f, 5.0f, 6.0f })).m[3][2] == 6.0f);
+
+// 一時オブジェクトの行列からは式を作れない(参照がぶら下がる)
+template<class T>
+concept CanMakeLazy = requires(T&& m) { Lazy(static_cast<T&&>(m)); };
+static_assert(CanMakeLazy<const Matrix4x4&> && !CanMakeLazy<Matrix4x4>);
+
+const size_t kObjectCount = 1 << 14;
+// 計算の順序が違うだけなので、差は丸め誤差の範囲に収まる
+const float kTolerance = 1e-5f;
+
+Matrix4x4 MakeRandomAffine(std::mt19937& random) {
+	std::uniform_real_distribution<float> distribution(-2.0f, 2.0f);
+	const Vector3 scale{ 1.0f + 0.25f * distribution(random), 1.0f + 0.25f * distribution(random), 1.0f };
+	const Vector3 rotate{ distribution(random), distribution(random), distribution(random) };
+	const Vector3 translate{ distribution(random), distribution(random), distribution(random) };
+	return MakeAffineMatrix(scale, rotate, translate);
+}
+
+float RelativeError(const Vector3& a, const Vector3& b) {
+	const float scale = std::max({ 1.0f, std::fabs(b.x), std::fabs(b.y), std::fabs(b.z) });
+	return std::max({ std::fabs(a.x - b.x), std::fabs(a.y - b.y), std::fabs(a.z - b.z) }) / scale;
+}
+
+float RelativeError(const Matrix4x4& a, const Matrix4x4& b) {
+	float error = 0.0f;
+	for (int line = 0; line < 4; line++) {
+		for (int column = 0; column < 4; column++) {
+			const float scale = std::max(1.0f, std::fabs(b.m[line][column]));
+			error = std::max(error, std::fabs(a.m[line][column] - b.m[line][column]) / scale);
+		}
+	}
+	return error;
+}
+
+bool Report(const char* name, double eager, double lazy, float error) {
+	const bool ok = error <= kTolerance;
+	std::printf("%-36s eager %8.2f Mops/s  lazy %8.2f Mops/s  x%.2f  max error %.2e %s\n",
+	    name, eager * 1e-6, lazy * 1e-6, lazy / eager, error, ok ? "ok" : "NG");
+	return ok;
+}
+
+} // namespace
+
+int main() {
+	std::mt19937 random(0);
+	std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+	std::vector<Matrix4x4> worlds(kObjectCount);
+	std::vector<Vector3> scales(kObjectCount), translates(kObjectCount), points(kObjectCount);
+	std::vector<Vector3> eagerPoints(kObjectCount), lazyPoints(kObjectCount);
+	std::vector<Matrix4x4> eagerMatrices(kObjectCount), lazyMatrices(kObjectCount);
+	for (size_t i = 0; i < kObjectCount; i++) {
+		worlds[i] = MakeRandomAffine(random);
+		scales[i] = { 1.0f + 0.5f * distribution(random), 1.0f + 0.5f * distribution(random), 1.0f };
+		translates[i] = { 10.0f * distribution(random), 10.0f * distribution(random), 10.0f * distribution(random) };
+		points[i] = { distribution(random), distribution(random), distribution(random) };
+	}
+	const Matrix4x4 rotate = MakeRotateXYZMatrix(Vector3{ 0.3f, -0.7f, 1.1f });
+	const Matrix4x4 view = MakeViewMatrix(Vector3{ 0.2f, 0.1f, 0.0f }, Vector3{ 0.0f, 2.0f, -20.0f });
+	const Matrix4x4 projection = MakePerspectiveFovMatrix(0.45f, 16.0f / 9.0f, 0.1f, 100.0f);
+	const Matrix4x4 viewport = MakeViewportMatrix(0.0f, 0.0f, 1280.0f, 720.0f, 0.0f, 1.0f);
+
+	// 物体ごとのworld * view * projection * viewportで1点を変換する
+	const double eagerScreen = Benchmark::MeasureThroughput(kObjectCount, [&] {
+		for (size_t i = 0; i < kObjectCount; i++) {
+			const Matrix4x4 matrix = Multiply(Multiply(Multiply(worlds[i], view), projection), viewport);
+			eagerPoints[i] = Transform(points[i], matrix);
+		}
+		Benchmark::DoNotOptimize(eagerPoints);
+	});
+	const double lazyScreen = Benchmark::MeasureThroughput(kObjectCount, [&] {
+		for (size_t i = 0; i < kObjectCount; i++) {
+			lazyPoints[i] = Transform(points[i], Lazy(worlds[i]) * Lazy(view) * Lazy(projection) * Lazy(viewport));
+		}
+		Benchmark::DoNotOptimize(lazyPoints);
+	});
+	float error = 0.0f;
+	for (size_t i = 0; i < kObjectCount; i++) {
+		error = std::max(error, RelativeError(lazyPoints[i], eagerPoints[i]));
+	}
+	bool ok = Report("Transform(p, W*V*P*Viewport)", eagerScreen, lazyScreen, error);
+
+	// 拡大縮小 * 回転 * 平行移動で1点を変換する
+	const double eagerSRT = Benchmark::MeasureThroughput(kObjectCount, [&] {
+		for (size_t i = 0; i < kObjectCount; i++) {
+			const Matrix4x4 matrix =
+			    Multiply(Multiply(MakeScaleMatrix(scales[i]), rotate), MakeTranslateMatrix(translates[i]));
+			eagerPoints[i] = Transform(points[i], matrix);
+		}
+		Benchmark::DoNotOptimize(eagerPoints);
+	});
+	const double lazySRT = Benchmark::MeasureThroughput(kObjectCount, [&] {
+		for (size_t i = 0; i < kObjectCount; i++) {
+			lazyPoints[i] = Transform(points[i], LazyScale(scales[i]) * Lazy(rotate) * LazyTranslate(translates[i]));
+		}
+		Benchmark::DoNotOptimize(lazyPoints);
+	});
+	error = 0.0f;
+	for (size_t i = 0; i < kObjectCount; i++) {
+		error = std::max(error, RelativeError(lazyPoints[i], eagerPoints[i]));
+	}
+	ok &= Report("Transform(p, S*R*T)", eagerSRT, lazySRT, error);
+
+	// world * view * projectionを行列にする
+	const double eagerMatrix = Benchmark::MeasureThroughput(kObjectCount, [&] {
+		for (size_t i = 0; i < kObjectCount; i++) {
+			eagerMatrices[i] = Multiply(Multiply(worlds[i], view), projection);
+		}
+		Benchmark::DoNotOptimize(eagerMatrices);
+	});
+	const double lazyMatrix = Benchmark::MeasureThroughput(kObjectCount, [&] {
+		for (size_t i = 0; i < kObjectCount; i++) {
+			lazyMatrices[i] = Evaluate(Lazy(worlds[i]) * Lazy(view) * Lazy(projection));
+		}
+		Benchmark::DoNotOptimize(lazyMatrices);
+	});
+	error = 0.0f;
+	for (size_t i = 0; i < kObjectCount; i++) {
+		error = std::max(error, RelativeError(lazyMatrices[i], eagerMatrices[i]));
+	}
+	ok &= Report("Evaluate(W*V*P)", eagerMatrix, lazyMatrix, error);
+
+	// S*R*Tを行列にする
+	const double eagerAffine = Benchmark::MeasureThroughput(kObjectCount, [&] {
+		for (size_t i = 0; i < kObjectCount; i++) {
+			eagerMatrices[i] = Multiply(Multiply(MakeScaleMatrix(scales[i]), rotate), MakeTranslateMatrix(translates[i]));
+		}
+		Benchmark::DoNotOptimize(eagerMatrices);
+	});
+	const double lazyAffine = Benchmark::MeasureThroughput(kObjectCount, [&] {
+		for (size_t i = 0; i < kObjectCount; i++) {
+			lazyMatrices[i] = Evaluate(LazyScale(scales[i]) * Lazy(rotate) * LazyTranslate(translates[i]));
+		}
+		Benchmark::DoNotOptimize(lazyMatrices);
+	});
+	error = 0.0f;
+	for (size_t i = 0; i < kObjectCount; i++) {
+		error = std::max(error, RelativeError(lazyMatrices[i], eagerMatrices[i]));
+	}
+	ok &= Report("Evaluate(S*R*T)", eagerAffine, lazyAffine, error);
+	return ok ? 0 : 1;
+}
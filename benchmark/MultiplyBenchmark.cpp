@@ -0,0 +1,66 @@
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "MathKernel.h"
+#include "SimdDispatch.h"
+
+// 行列の積を命令セット別に計測する(対応していない命令セットは飛ばす)
+
+namespace {
+
+const size_t kMatrixCount = 1 << 9; // L2に収まる量
+
+using MultiplyMatrixFunc = void (*)(const Matrix4x4&, const Matrix4x4&, Matrix4x4&);
+using MultiplyMatricesFunc = void (*)(const Matrix4x4*, const Matrix4x4*, Matrix4x4*, size_t);
+
+struct Kernel {
+	SimdLevel level;
+	MultiplyMatrixFunc single;
+	MultiplyMatricesFunc batch;
+};
+
+} // namespace
+
+int main() {
+	std::mt19937 random(0);
+	std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+	std::vector<Matrix4x4> m1(kMatrixCount), m2(kMatrixCount), result(kMatrixCount);
+	for (size_t i = 0; i < kMatrixCount; i++) {
+		for (int line = 0; line < 4; line++) {
+			for (int column = 0; column < 4; column++) {
+				m1[i].m[line][column] = distribution(random);
+				m2[i].m[line][column] = distribution(random);
+			}
+		}
+	}
+
+	const Kernel kernels[] = {
+		{ SimdLevel::kScalar, MultiplyMatrixScalar, MultiplyMatricesScalar },
+#if MT4_SIMD_SSE2
+		{ SimdLevel::kSSE2, MultiplyMatrixSSE2, MultiplyMatricesSSE2 },
+		{ SimdLevel::kAVX2, MultiplyMatrixAVX2, MultiplyMatricesAVX2 },
+		{ SimdLevel::kAVX512, MultiplyMatrixAVX512, MultiplyMatricesAVX512 },
+#endif
+	};
+
+	std::printf("supported: %s\n", GetSimdLevelName(GetSupportedSimdLevel()));
+	for (const Kernel& kernel : kernels) {
+		if (kernel.level > GetSupportedSimdLevel()) {
+			continue;
+		}
+		const double single = Benchmark::MeasureThroughput(kMatrixCount, [&] {
+			for (size_t i = 0; i < kMatrixCount; i++) {
+				kernel.single(m1[i], m2[i], result[i]);
+			}
+			Benchmark::DoNotOptimize(result);
+		});
+		const double batch = Benchmark::MeasureThroughput(kMatrixCount, [&] {
+			kernel.batch(m1.data(), m2.data(), result.data(), kMatrixCount);
+			Benchmark::DoNotOptimize(result);
+		});
+		std::printf("%-8s single %8.2f Mmul/s  batch %8.2f Mmul/s\n",
+		    GetSimdLevelName(kernel.level), single * 1e-6, batch * 1e-6);
+	}
+	return 0;
+}
@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "MathFunction.h"
+#include "SimdDispatch.h"
+#include "TransformHierarchy.h"
+
+// 法線行列(MakeNormalMatrix)と一括の法線変換(TransformNormals)
+// 拡大が一様でない行列で、変換後の法線が変換後の接線と垂直なままになることを確かめ(許容誤差を超えたら終了コード1)、
+// 4x4の逆行列を転置する方法・1つずつNormalizeする方法と速さを比べる
+
+namespace {
+
+const size_t kMatrixCount = 1 << 12;
+const size_t kNormalCount = 1 << 16;
+// 垂直からのずれ(余弦)・逆行列の転置との差・1つずつの変換との差の許容値
+const float kTolerance = 1e-5f;
+// TransformHierarchyの法線行列の相対誤差の許容値(親から掛けた行列の丸めが積み重なる分)
+const float kHierarchyTolerance = 1e-4f;
+
+// 変換後の法線と接線のなす角の余弦(0なら垂直)
+float MaxCosine(const Matrix4x4& m, const Matrix3x3& normalMatrix, const Vector3& normal, const Vector3& tangent) {
+	const Vector3 transformedNormal = Normalize(Transform(normal, normalMatrix));
+	const Vector3 transformedTangent = Normalize(TransformNormal(tangent, m));
+	return std::fabs(Dot(transformedNormal, transformedTangent));
+}
+
+} // namespace
+
+int main() {
+	std::printf("simd: %s\n", GetSimdLevelName(GetSimdLevel()));
+	std::mt19937 random(0);
+	std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> logScale(std::log(0.1f), std::log(10.0f));
+
+	// 拡大が一様でない行列
+	std::vector<Matrix4x4> matrices(kMatrixCount);
+	for (Matrix4x4& m : matrices) {
+		m = MakeAffineMatrix(Vector3{ std::exp(logScale(random)), std::exp(logScale(random)), std::exp(logScale(random)) },
+		    MakeRotateAxisAngleQuaternion(Normalize(Vector3{ value(random), value(random), value(random) }),
+		        value(random) * 3.0f),
+		    Vector3{ value(random), value(random), value(random) });
+	}
+
+	// 垂直の保たれ方と、4x4の逆行列の転置との差
+	float cosineNormalMatrix = 0.0f, cosineUpper3x3 = 0.0f, difference = 0.0f;
+	for (const Matrix4x4& m : matrices) {
+		const Vector3 normal = Normalize(Vector3{ value(random), value(random), value(random) });
+		const Vector3 tangent = Normalize(Cross(normal, Vector3{ value(random), value(random), value(random) }));
+		const Matrix3x3 normalMatrix = MakeNormalMatrix(m);
+		cosineNormalMatrix = std::max(cosineNormalMatrix, MaxCosine(m, normalMatrix, normal, tangent));
+		cosineUpper3x3 = std::max(cosineUpper3x3, MaxCosine(m, MakeMatrix3x3(m), normal, tangent));
+		const Matrix3x3 expected = MakeMatrix3x3(ToMatrix4x4(Transpose(ToMat(Inverse(m)))));
+		for (int i = 0; i < 3; i++) {
+			for (int j = 0; j < 3; j++) {
+				difference = std::max(difference,
+				    std::fabs(normalMatrix.m[i][j] - expected.m[i][j]) / std::max(std::fabs(expected.m[i][j]), 1.0f));
+			}
+		}
+	}
+	bool ok = cosineNormalMatrix <= kTolerance && difference <= kTolerance;
+	std::printf("max |cos| normal/tangent  MakeNormalMatrix %.1e  upper 3x3 %.1e\n", cosineNormalMatrix, cosineUpper3x3);
+	std::printf("max difference from Transpose(Inverse(m)) %.1e  %s\n", difference, ok ? "ok" : "NG");
+
+	// TransformHierarchyの法線行列(一様な拡大の近道も含む)
+	TransformHierarchy hierarchy;
+	hierarchy.SetNormalMatricesEnabled(true);
+	for (uint32_t i = 0; i < 256; i++) {
+		const float s = std::exp(logScale(random));
+		const Vector3 scale = i % 3 == 2 ? Vector3{ s, 2.0f * s, s } : Vector3{ s, s, s };
+		hierarchy.AddNode(i == 0 ? TransformHierarchy::kNoParent : uint32_t(random() % i), scale,
+		    MakeRotateAxisAngleQuaternion(Normalize(Vector3{ value(random), value(random), 1.0f }), value(random)),
+		    Vector3{ value(random), value(random), value(random) });
+	}
+	hierarchy.Update();
+	float hierarchyDifference = 0.0f;
+	for (uint32_t node = 0; node < hierarchy.GetNodeCount(); node++) {
+		const Matrix3x3 expected = MakeNormalMatrix(hierarchy.GetWorldMatrix(node));
+		const Matrix3x3& cached = hierarchy.GetNormalMatrix(node);
+		for (int i = 0; i < 3; i++) {
+			for (int j = 0; j < 3; j++) {
+				hierarchyDifference = std::max(hierarchyDifference,
+				    std::fabs(cached.m[i][j] - expected.m[i][j]) / std::max(std::fabs(expected.m[i][j]), 1e-3f));
+			}
+		}
+	}
+	ok &= hierarchyDifference <= kHierarchyTolerance;
+	std::printf("TransformHierarchy normal matrices max relative difference %.1e  %s\n", hierarchyDifference,
+	    hierarchyDifference <= kHierarchyTolerance ? "ok" : "NG");
+
+	// 一括の法線変換と1つずつの変換の差
+	std::vector<Vector3> normals(kNormalCount), expected(kNormalCount), transformed(kNormalCount);
+	for (Vector3& normal : normals) {
+		normal = Normalize(Vector3{ value(random), value(random), value(random) });
+	}
+	const Matrix3x3 normalMatrix = MakeNormalMatrix(matrices[0]);
+	for (size_t i = 0; i < kNormalCount; i++) {
+		expected[i] = Normalize(Transform(normals[i], normalMatrix));
+	}
+	TransformNormals(normals.data(), transformed.data(), kNormalCount, normalMatrix);
+	float normalError = 0.0f;
+	for (size_t i = 0; i < kNormalCount; i++) {
+		normalError = std::max(normalError, Length(Subtract(expected[i], transformed[i])));
+	}
+	ok &= normalError <= kTolerance;
+	std::printf("TransformNormals max error %.1e  %s\n", normalError, normalError <= kTolerance ? "ok" : "NG");
+
+	std::vector<Matrix3x3> normalMatrices(kMatrixCount);
+	const double inverse = Benchmark::MeasureThroughput(kMatrixCount, [&] {
+		for (size_t i = 0; i < kMatrixCount; i++) {
+			normalMatrices[i] = MakeMatrix3x3(ToMatrix4x4(Transpose(ToMat(Inverse(matrices[i])))));
+		}
+		Benchmark::DoNotOptimize(normalMatrices);
+	});
+	const double cofactor = Benchmark::MeasureThroughput(kMatrixCount, [&] {
+		for (size_t i = 0; i < kMatrixCount; i++) {
+			normalMatrices[i] = MakeNormalMatrix(matrices[i]);
+		}
+		Benchmark::DoNotOptimize(normalMatrices);
+	});
+	const double uniform = Benchmark::MeasureThroughput(kMatrixCount, [&] {
+		for (size_t i = 0; i < kMatrixCount; i++) {
+			normalMatrices[i] = MakeNormalMatrixUniformScale(matrices[i]);
+		}
+		Benchmark::DoNotOptimize(normalMatrices);
+	});
+	const double single = Benchmark::MeasureThroughput(kNormalCount, [&] {
+		for (size_t i = 0; i < kNormalCount; i++) {
+			transformed[i] = Normalize(Transform(normals[i], normalMatrix));
+		}
+		Benchmark::DoNotOptimize(transformed);
+	});
+	const double batch = Benchmark::MeasureThroughput(kNormalCount, [&] {
+		TransformNormals(normals.data(), transformed.data(), kNormalCount, normalMatrix);
+		Benchmark::DoNotOptimize(transformed);
+	});
+	std::printf("%-40s %8.1f M/s\n", "Transpose(Inverse(Matrix4x4))", inverse * 1e-6);
+	std::printf("%-40s %8.1f M/s\n", "MakeNormalMatrix", cofactor * 1e-6);
+	std::printf("%-40s %8.1f M/s\n", "MakeNormalMatrixUniformScale", uniform * 1e-6);
+	std::printf("%-40s %8.1f M/s\n", "Normalize(Transform(n, Matrix3x3))", single * 1e-6);
+	std::printf("%-40s %8.1f M/s\n", "TransformNormals (AoS)", batch * 1e-6);
+	return ok ? 0 : 1;
+}
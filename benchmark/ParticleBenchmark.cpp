@@ -0,0 +1,145 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "JobSystem.h"
+#include "MathFunction.h"
+#include "ParticleSystem.h"
+#include "SimdDispatch.h"
+
+// ParticleSystem(SoA・一括積分・入れ替えで詰める)と、AoSのVector3にAdd/Multiplyで積分して
+// 寿命の尽きた粒子をvectorから消す従来の方法を比べる
+// 積分結果と生き残る粒子が同じになることを確かめ、100万粒子の1フレームあたりの時間を計る
+
+namespace {
+
+const size_t kParticleCount = 1 << 20;
+const float kDeltaTime = 1.0f / 60.0f;
+const Vector3 kGravity{ 0.0f, -9.8f, 0.0f };
+const float kDrag = 0.5f;
+
+// 従来の方法
+struct Particle {
+	Vector3 position;
+	Vector3 velocity;
+	float lifetime;
+};
+
+void UpdateReference(std::vector<Particle>& particles, float deltaTime) {
+	const float damping = std::exp(-kDrag * deltaTime);
+	for (Particle& particle : particles) {
+		particle.velocity = Multiply(damping, Add(particle.velocity, Multiply(deltaTime, kGravity)));
+		particle.position = Add(particle.position, Multiply(deltaTime, particle.velocity));
+		particle.lifetime -= deltaTime;
+	}
+	particles.erase(std::remove_if(particles.begin(), particles.end(),
+	                    [](const Particle& particle) { return particle.lifetime <= 0.0f; }),
+	    particles.end());
+}
+
+// 発生させる粒子(SoA)
+struct Spawns {
+	std::vector<float> x, y, z, vx, vy, vz, lifetimes;
+
+	Spawns(size_t count, std::mt19937& random) : x(count), y(count), z(count), vx(count), vy(count), vz(count),
+	    lifetimes(count) {
+		std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+		std::uniform_real_distribution<float> lifetime(0.5f, 3.0f);
+		for (size_t i = 0; i < count; i++) {
+			x[i] = value(random);
+			y[i] = value(random);
+			z[i] = value(random);
+			vx[i] = value(random);
+			vy[i] = 5.0f + value(random);
+			vz[i] = value(random);
+			lifetimes[i] = lifetime(random);
+		}
+	}
+	ConstVector3SoA Positions(size_t offset) const { return { x.data() + offset, y.data() + offset, z.data() + offset }; }
+	ConstVector3SoA Velocities(size_t offset) const {
+		return { vx.data() + offset, vy.data() + offset, vz.data() + offset };
+	}
+	Particle Get(size_t i) const { return { { x[i], y[i], z[i] }, { vx[i], vy[i], vz[i] }, lifetimes[i] }; }
+};
+
+} // namespace
+
+int main() {
+	std::printf("simd: %s  threads: %zu  particles: %zu\n", GetSimdLevelName(GetSimdLevel()),
+	    JobSystem::GetInstance().GetThreadCount(), kParticleCount);
+	std::mt19937 random(0);
+	const Spawns spawns(kParticleCount * 2, random);
+
+	// 同じ粒子を両方で60フレーム進め、生き残った粒子の数と座標(並び順は違うので整列して)を比べる
+	ParticleSystem system(kParticleCount);
+	system.SetGravity(kGravity);
+	system.SetDrag(kDrag);
+	system.Emit(spawns.Positions(0), spawns.Velocities(0), spawns.lifetimes.data(), kParticleCount);
+	std::vector<Particle> reference(kParticleCount);
+	for (size_t i = 0; i < kParticleCount; i++) {
+		reference[i] = spawns.Get(i);
+	}
+	for (int frame = 0; frame < 60; frame++) {
+		system.Update(kDeltaTime);
+		UpdateReference(reference, kDeltaTime);
+	}
+	bool compacted = true;
+	for (size_t i = 0; i < system.GetCount(); i++) {
+		compacted = compacted && system.GetLifetimes()[i] > 0.0f;
+	}
+	std::vector<float> systemY(system.GetPositions().y, system.GetPositions().y + system.GetCount());
+	std::vector<float> referenceY(reference.size());
+	for (size_t i = 0; i < reference.size(); i++) {
+		referenceY[i] = reference[i].position.y;
+	}
+	std::sort(systemY.begin(), systemY.end());
+	std::sort(referenceY.begin(), referenceY.end());
+	float positionError = 0.0f;
+	for (size_t i = 0; i < std::min(systemY.size(), referenceY.size()); i++) {
+		positionError = std::max(positionError, std::fabs(systemY[i] - referenceY[i]));
+	}
+	const bool sameCount = system.GetCount() == reference.size();
+	std::printf("alive %zu (reference %zu)  compacted %s  max position difference %.1e\n", system.GetCount(),
+	    reference.size(), compacted ? "ok" : "NG", positionError);
+
+	// 1フレーム = 積分 + 尽きた分の補充(粒子数を100万前後に保つ)
+	size_t spawnOffset = kParticleCount;
+	const auto Refill = [&](size_t count) {
+		if (spawnOffset + count > spawns.x.size()) {
+			spawnOffset = 0;
+		}
+		const size_t offset = spawnOffset;
+		spawnOffset += count;
+		return offset;
+	};
+	const Benchmark::Measurement referenceFrame = Benchmark::Measure(1, [&] {
+		UpdateReference(reference, kDeltaTime);
+		const size_t offset = Refill(kParticleCount - reference.size());
+		for (size_t i = offset; i < spawnOffset; i++) {
+			reference.push_back(spawns.Get(i));
+		}
+		Benchmark::DoNotOptimize(reference);
+	});
+	const Benchmark::Measurement systemFrame = Benchmark::Measure(1, [&] {
+		system.Update(kDeltaTime);
+		const size_t count = kParticleCount - system.GetCount();
+		const size_t offset = Refill(count);
+		system.Emit(spawns.Positions(offset), spawns.Velocities(offset), spawns.lifetimes.data() + offset, count);
+		Benchmark::DoNotOptimize(system);
+	});
+	// 詰めた座標をそのままビュー射影変換する
+	const Matrix4x4 viewProjection = Multiply(Inverse(MakeTranslateMatrix(Vector3{ 0.0f, 2.0f, -10.0f })),
+	    MakePerspectiveFovMatrix(0.8f, 16.0f / 9.0f, 0.1f, 100.0f));
+	std::vector<float> clipX(kParticleCount), clipY(kParticleCount), clipZ(kParticleCount);
+	const Benchmark::Measurement transform = Benchmark::Measure(1, [&] {
+		Transform(system.GetPositions(), Vector3SoA{ clipX.data(), clipY.data(), clipZ.data() }, system.GetCount(),
+		    viewProjection);
+		Benchmark::DoNotOptimize(clipX);
+	});
+	std::printf("%-44s %8.2f ms/frame\n", "AoS Add/Multiply + erase (reference)", referenceFrame.nanoseconds * 1e-6);
+	std::printf("%-44s %8.2f ms/frame\n", "ParticleSystem Update + Emit", systemFrame.nanoseconds * 1e-6);
+	std::printf("%-44s %8.2f ms/frame\n", "Transform(GetPositions()) view projection", transform.nanoseconds * 1e-6);
+	return sameCount && compacted ? 0 : 1;
+}
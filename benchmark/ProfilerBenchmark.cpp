@@ -0,0 +1,79 @@
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "MathFunction.h"
+#include "Profiler.h"
+#include "SimdDispatch.h"
+#include "TransformHierarchy.h"
+
+// ゲームの1フレームを模した呼び出しを計測し、表とJSONを出す
+// 計測そのものの負荷は、Multiply 1回あたりの時間をMT4_ENABLE_PROFILINGのON/OFFで比べて確かめる
+
+namespace {
+
+const size_t kNodeCount = 2000;
+const size_t kVertexCount = 4096;
+const size_t kMultiplyCount = 1 << 20;
+
+} // namespace
+
+int main() {
+	std::printf("simd: %s  profiling: %s\n", GetSimdLevelName(GetSimdLevel()), IsProfilingEnabled() ? "on" : "off");
+	std::mt19937 random(0);
+	std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+
+	TransformHierarchy hierarchy;
+	hierarchy.Reserve(kNodeCount);
+	for (size_t i = 0; i < kNodeCount; i++) {
+		const uint32_t parent = i == 0 ? TransformHierarchy::kNoParent : uint32_t(random() % i);
+		hierarchy.AddNode(parent, Vector3{ 1.0f, 1.0f, 1.0f },
+		    MakeRotateAxisAngleQuaternion(Normalize(Vector3{ value(random), value(random), 1.0f }), value(random)),
+		    Vector3{ value(random), value(random), value(random) });
+	}
+	std::vector<Vector3> vertices(kVertexCount), transformed(kVertexCount);
+	for (Vector3& vertex : vertices) {
+		vertex = Vector3{ value(random), value(random), value(random) };
+	}
+	const Matrix4x4 view = Inverse(MakeAffineMatrix(Vector3{ 1.0f, 1.0f, 1.0f }, Vector3{ 0.3f, 0.5f, 0.0f },
+	    Vector3{ 0.0f, 2.0f, -10.0f }));
+	EndProfileFrame(); // 準備の分は捨てる
+
+	ProfileReport report{};
+	for (int frame = 0; frame < 3; frame++) {
+		// 毎フレーム一部の節点だけ動かす
+		for (uint32_t node = 0; node < kNodeCount; node += 7) {
+			hierarchy.SetTranslate(node, Vector3{ value(random), value(random), value(random) });
+		}
+		hierarchy.Update();
+		// 節点ごとのビュー行列と少数の頂点(1個ずつ)
+		const Matrix4x4* worlds = hierarchy.GetWorldMatrices();
+		for (size_t node = 0; node < kNodeCount; node += 16) {
+			const Matrix4x4 worldView = Multiply(worlds[node], view);
+			for (size_t i = 0; i < 8; i++) {
+				transformed[i] = Transform(vertices[i], worldView);
+			}
+			Benchmark::DoNotOptimize(InverseAffine(worldView));
+		}
+		// 大きさの違う一括変換
+		for (size_t count = 16; count <= kVertexCount; count *= 4) {
+			Transform(vertices.data(), transformed.data(), count, view);
+		}
+		Benchmark::DoNotOptimize(transformed);
+		report = EndProfileFrame();
+	}
+	std::printf("%s\n%s", FormatProfileText(report).c_str(), FormatProfileJson(report).c_str());
+
+	// 計測の負荷(1回あたりの時間)
+	const Matrix4x4 m1 = hierarchy.GetWorldMatrix(1), m2 = view;
+	Matrix4x4 product = m1;
+	const Benchmark::Measurement multiply = Benchmark::Measure(kMultiplyCount, [&] {
+		for (size_t i = 0; i < kMultiplyCount; i++) {
+			product = Multiply(product, m2);
+			Benchmark::DoNotOptimize(product);
+		}
+	});
+	EndProfileFrame();
+	std::printf("Multiply (single)  %.2f ns/call\n", multiply.nanoseconds);
+	return 0;
+}
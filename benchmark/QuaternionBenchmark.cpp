@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "MathFunction.h"
+#include "SimdDispatch.h"
+
+// 回転の補間を1つずつ行う場合と一括(SoA)で行う場合のスループットを比較する
+// 先に、DirectionToDirectionQuaternionで回したfromがtoに一致することを逆向きの近くまで確かめる(外れたら終了コード1)
+
+namespace {
+
+const size_t kRotationCount = 4096;
+// DirectionToDirectionQuaternionで回したfromとtoの差の許容値
+const float kDirectionTolerance = 2e-6f;
+
+void Report(const char* name, double rotationsPerSecond) {
+	std::printf("%-36s %10.2f Mrot/s\n", name, rotationsPerSecond * 1e-6);
+}
+
+// fromとtoのなす角がpi - deltaのときの、回したfromとtoの差の最大値
+float MaxDirectionError(std::mt19937& random, double delta) {
+	std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+	float error = 0.0f;
+	for (size_t i = 0; i < kRotationCount; i++) {
+		// 軸に沿った向き(逆向きのとき回転軸の選び方が変わる)も混ぜる
+		const Vector3 from = i == 0 ? Vector3{ 1.0f, 0.0f, 0.0f }
+		    : Normalize(Vector3{ distribution(random), distribution(random), distribution(random) });
+		const Vector3 perpendicular =
+		    Normalize(Cross(from, Vector3{ distribution(random), distribution(random), distribution(random) }));
+		const double angle = 3.14159265358979323846 - delta;
+		const Vector3 to = Normalize(Vector3{ float(from.x * std::cos(angle) + perpendicular.x * std::sin(angle)),
+		    float(from.y * std::cos(angle) + perpendicular.y * std::sin(angle)),
+		    float(from.z * std::cos(angle) + perpendicular.z * std::sin(angle)) });
+		const Quaternion q = DirectionToDirectionQuaternion(from, to);
+		error = std::max(error, Length(Subtract(RotateVector(from, q), to)));
+	}
+	return error;
+}
+
+} // namespace
+
+int main() {
+	std::printf("simd: %s\n", GetSimdLevelName(GetSimdLevel()));
+	std::mt19937 random(0);
+	std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+	bool ok = true;
+	for (const double delta : { 3.0, 1.0, 1e-1, 1e-2, 1.2e-3, 1e-4, 1e-5, 1e-6, 1e-7, 0.0 }) {
+		const float error = MaxDirectionError(random, delta);
+		ok &= error <= kDirectionTolerance;
+		std::printf("DirectionToDirectionQuaternion  angle pi - %.1e  max error %.1e  %s\n", delta, error,
+		    error <= kDirectionTolerance ? "ok" : "NG");
+	}
+
+	std::vector<Quaternion> from(kRotationCount), to(kRotationCount), blended(kRotationCount);
+	std::vector<float> t(kRotationCount);
+	std::vector<float> fromX(kRotationCount), fromY(kRotationCount), fromZ(kRotationCount), fromW(kRotationCount);
+	std::vector<float> toX(kRotationCount), toY(kRotationCount), toZ(kRotationCount), toW(kRotationCount);
+	std::vector<float> x(kRotationCount), y(kRotationCount), z(kRotationCount), w(kRotationCount);
+	for (size_t i = 0; i < kRotationCount; i++) {
+		from[i] = Normalize(Quaternion{ distribution(random), distribution(random), distribution(random), distribution(random) });
+		to[i] = Normalize(Quaternion{ distribution(random), distribution(random), distribution(random), distribution(random) });
+		t[i] = 0.5f + 0.5f * distribution(random);
+		fromX[i] = from[i].x;
+		fromY[i] = from[i].y;
+		fromZ[i] = from[i].z;
+		fromW[i] = from[i].w;
+		toX[i] = to[i].x;
+		toY[i] = to[i].y;
+		toZ[i] = to[i].z;
+		toW[i] = to[i].w;
+	}
+	const ConstQuaternionSoA fromSoA{ fromX.data(), fromY.data(), fromZ.data(), fromW.data() };
+	const ConstQuaternionSoA toSoA{ toX.data(), toY.data(), toZ.data(), toW.data() };
+	const QuaternionSoA blendedSoA{ x.data(), y.data(), z.data(), w.data() };
+
+	Report("Slerp (per rotation)", Benchmark::MeasureThroughput(kRotationCount, [&] {
+		for (size_t i = 0; i < kRotationCount; i++) {
+			blended[i] = Slerp(from[i], to[i], t[i]);
+		}
+		Benchmark::DoNotOptimize(blended);
+	}));
+	Report("Slerp<kPrecise> (per rotation)", Benchmark::MeasureThroughput(kRotationCount, [&] {
+		for (size_t i = 0; i < kRotationCount; i++) {
+			blended[i] = Slerp<SinCosPrecision::kPrecise>(from[i], to[i], t[i]);
+		}
+		Benchmark::DoNotOptimize(blended);
+	}));
+	Report("Nlerp (per rotation)", Benchmark::MeasureThroughput(kRotationCount, [&] {
+		for (size_t i = 0; i < kRotationCount; i++) {
+			blended[i] = Nlerp(from[i], to[i], t[i]);
+		}
+		Benchmark::DoNotOptimize(blended);
+	}));
+	Report("Slerp (batch SoA)", Benchmark::MeasureThroughput(kRotationCount, [&] {
+		Slerp(fromSoA, toSoA, t.data(), blendedSoA, kRotationCount);
+		Benchmark::DoNotOptimize(x);
+	}));
+	Report("Nlerp (batch SoA)", Benchmark::MeasureThroughput(kRotationCount, [&] {
+		Nlerp(fromSoA, toSoA, t.data(), blendedSoA, kRotationCount);
+		Benchmark::DoNotOptimize(x);
+	}));
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "MathFunction.h"
+#include "SinCos.h"
+#include "SimdDispatch.h"
+
+// sin/cosの精度段階ごとの最大誤差とスループット、回転行列の作成速度を計測する
+
+namespace {
+
+const size_t kValueCount = 1 << 12;
+
+struct Range {
+	const char* name;
+	float limit;
+};
+
+// 倍精度の値との最大絶対誤差
+template<SinCosPrecision kPrecision>
+double MeasureScalarError(const std::vector<float>& values) {
+	double error = 0.0;
+	for (float x : values) {
+		float s, c;
+		SinCos<kPrecision>(x, s, c);
+		error = std::max(error, std::fabs(double(s) - std::sin(double(x))));
+		error = std::max(error, std::fabs(double(c) - std::cos(double(x))));
+	}
+	return error;
+}
+
+template<SinCosPrecision kPrecision>
+double MeasureBatchError(const std::vector<float>& values) {
+	std::vector<float> s(values.size()), c(values.size());
+	SinCos<kPrecision>(values.data(), s.data(), c.data(), values.size());
+	double error = 0.0;
+	for (size_t i = 0; i < values.size(); i++) {
+		error = std::max(error, std::fabs(double(s[i]) - std::sin(double(values[i]))));
+		error = std::max(error, std::fabs(double(c[i]) - std::cos(double(values[i]))));
+	}
+	return error;
+}
+
+template<SinCosPrecision kPrecision>
+double MeasureScalar(const std::vector<float>& values) {
+	return Benchmark::MeasureThroughput(values.size(), [&] {
+		float sum = 0.0f;
+		for (float x : values) {
+			float s, c;
+			SinCos<kPrecision>(x, s, c);
+			sum += s + c;
+		}
+		Benchmark::DoNotOptimize(sum);
+	});
+}
+
+template<SinCosPrecision kPrecision>
+double MeasureBatch(const std::vector<float>& values, std::vector<float>& s, std::vector<float>& c) {
+	return Benchmark::MeasureThroughput(values.size(), [&] {
+		SinCos<kPrecision>(values.data(), s.data(), c.data(), values.size());
+		Benchmark::DoNotOptimize(s);
+		Benchmark::DoNotOptimize(c);
+	});
+}
+
+template<SinCosPrecision kPrecision>
+double MeasureRotateAxisAngle(const std::vector<float>& values, std::vector<Matrix4x4>& matrices) {
+	const Vector3 axis = Normalize(Vector3{ 1.0f, 2.0f, 3.0f });
+	return Benchmark::MeasureThroughput(values.size(), [&] {
+		for (size_t i = 0; i < values.size(); i++) {
+			matrices[i] = MakeRotateAxisAngle<kPrecision>(axis, values[i]);
+		}
+		Benchmark::DoNotOptimize(matrices);
+	});
+}
+
+template<SinCosPrecision kPrecision>
+double MeasureRotateXYZ(const std::vector<float>& values, std::vector<Matrix4x4>& matrices) {
+	return Benchmark::MeasureThroughput(values.size(), [&] {
+		for (size_t i = 0; i < values.size(); i++) {
+			const Vector3 rotation{ values[i], values[(i + 1) % values.size()], values[(i + 2) % values.size()] };
+			matrices[i] = MakeRotateXYZMatrix<kPrecision>(rotation);
+		}
+		Benchmark::DoNotOptimize(matrices);
+	});
+}
+
+} // namespace
+
+int main() {
+	std::printf("simd: %s\n", GetSimdLevelName(GetSimdLevel()));
+
+	const Range ranges[] = { { "|x| <= pi", 3.14159265f }, { "|x| <= 8192", 8192.0f } };
+	std::mt19937 random(0);
+	for (const Range& range : ranges) {
+		std::uniform_real_distribution<float> distribution(-range.limit, range.limit);
+		std::vector<float> values(1 << 20);
+		for (float& x : values) {
+			x = distribution(random);
+		}
+		std::printf("[max error %s]\n", range.name);
+		std::printf("%-10s scalar %.2e  batch %.2e\n", "exact",
+		    MeasureScalarError<SinCosPrecision::kExact>(values), MeasureBatchError<SinCosPrecision::kExact>(values));
+		std::printf("%-10s scalar %.2e  batch %.2e\n", "precise",
+		    MeasureScalarError<SinCosPrecision::kPrecise>(values), MeasureBatchError<SinCosPrecision::kPrecise>(values));
+		std::printf("%-10s scalar %.2e  batch %.2e\n", "fast",
+		    MeasureScalarError<SinCosPrecision::kFast>(values), MeasureBatchError<SinCosPrecision::kFast>(values));
+	}
+
+	std::uniform_real_distribution<float> distribution(-10.0f, 10.0f);
+	std::vector<float> values(kValueCount), s(kValueCount), c(kValueCount);
+	for (float& x : values) {
+		x = distribution(random);
+	}
+	std::vector<Matrix4x4> matrices(kValueCount);
+
+	const double exactScalar = MeasureScalar<SinCosPrecision::kExact>(values);
+	const double exactBatch = MeasureBatch<SinCosPrecision::kExact>(values, s, c);
+	const double exactAxis = MeasureRotateAxisAngle<SinCosPrecision::kExact>(values, matrices);
+	const double exactXYZ = MeasureRotateXYZ<SinCosPrecision::kExact>(values, matrices);
+	std::printf("[throughput, speedup vs exact]\n");
+	std::printf("%-10s SinCos %8.2f M/s  batch %8.2f M/s  MakeRotateAxisAngle %7.2f M/s  MakeRotateXYZMatrix %7.2f M/s\n",
+	    "exact", exactScalar * 1e-6, exactBatch * 1e-6, exactAxis * 1e-6, exactXYZ * 1e-6);
+
+	const double preciseScalar = MeasureScalar<SinCosPrecision::kPrecise>(values);
+	const double preciseBatch = MeasureBatch<SinCosPrecision::kPrecise>(values, s, c);
+	const double preciseAxis = MeasureRotateAxisAngle<SinCosPrecision::kPrecise>(values, matrices);
+	const double preciseXYZ = MeasureRotateXYZ<SinCosPrecision::kPrecise>(values, matrices);
+	std::printf("%-10s SinCos x%-6.2f       batch x%-6.2f       MakeRotateAxisAngle x%-6.2f     MakeRotateXYZMatrix x%-6.2f\n",
+	    "precise", preciseScalar / exactScalar, preciseBatch / exactBatch, preciseAxis / exactAxis, preciseXYZ / exactXYZ);
+
+	const double fastScalar = MeasureScalar<SinCosPrecision::kFast>(values);
+	const double fastBatch = MeasureBatch<SinCosPrecision::kFast>(values, s, c);
+	const double fastAxis = MeasureRotateAxisAngle<SinCosPrecision::kFast>(values, matrices);
+	const double fastXYZ = MeasureRotateXYZ<SinCosPrecision::kFast>(values, matrices);
+	std::printf("%-10s SinCos x%-6.2f       batch x%-6.2f       MakeRotateAxisAngle x%-6.2f     MakeRotateXYZMatrix x%-6.2f\n",
+	    "fast", fastScalar / exactScalar, fastBatch / exactBatch, fastAxis / exactAxis, fastXYZ / exactXYZ);
+	return 0;
+}
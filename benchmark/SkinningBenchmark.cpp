@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "MathFunction.h"
+#include "SimdDispatch.h"
+#include "Skinning.h"
+
+// 頂点ごと・ボーンごとにTransform/TransformNormalして重みで足す従来の方法と、
+// 行列を先に足し合わせて1回だけ変換するSkinVerticesを比べる
+// 結果が従来の方法と許容誤差以内で一致しなければ終了コード1
+
+namespace {
+
+const size_t kBoneCount = 64;
+const size_t kVertexCount = 1 << 16;
+const size_t kMeshCount = 64;
+// 従来の方法との差の許容値(ボーンの足し方が違う分の丸め)
+const float kTolerance = 1e-5f;
+
+struct Vertices {
+	std::vector<float> x, y, z;
+
+	explicit Vertices(size_t count) : x(count), y(count), z(count) {}
+	Vector3SoA Get() { return { x.data(), y.data(), z.data() }; }
+	ConstVector3SoA Get() const { return { x.data(), y.data(), z.data() }; }
+	Vector3 operator[](size_t i) const { return { x[i], y[i], z[i] }; }
+};
+
+// 従来の方法(ボーンごとに変換して重みで足す)
+void SkinReference(const Matrix4x4* palette, const SkinInfluence* influences, const Vertices& positions,
+    const Vertices& normals, Vertices& skinnedPositions, Vertices& skinnedNormals, size_t count) {
+	for (size_t i = 0; i < count; i++) {
+		Vector3 position{}, normal{};
+		for (size_t k = 0; k < kSkinInfluenceCount; k++) {
+			const Matrix4x4& m = palette[influences[i].bones[k]];
+			const float weight = influences[i].weights[k];
+			position = Add(position, Multiply(weight, Transform(positions[i], m)));
+			normal = Add(normal, Multiply(weight, TransformNormal(normals[i], m)));
+		}
+		normal = Normalize(normal);
+		skinnedPositions.x[i] = position.x;
+		skinnedPositions.y[i] = position.y;
+		skinnedPositions.z[i] = position.z;
+		skinnedNormals.x[i] = normal.x;
+		skinnedNormals.y[i] = normal.y;
+		skinnedNormals.z[i] = normal.z;
+	}
+}
+
+float MaxError(const Vertices& a, const Vertices& b, size_t count) {
+	float error = 0.0f;
+	for (size_t i = 0; i < count; i++) {
+		error = std::max(error, Length(Subtract(a[i], b[i])));
+	}
+	return error;
+}
+
+} // namespace
+
+int main() {
+	std::printf("simd: %s  bones: %zu  vertices: %zu\n", GetSimdLevelName(GetSimdLevel()), kBoneCount, kVertexCount);
+	std::mt19937 random(0);
+	std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	// 回転・一様な拡大・平行移動のボーン
+	std::vector<Matrix4x4> palette(kBoneCount);
+	for (Matrix4x4& bone : palette) {
+		const float scale = 0.5f + unit(random);
+		bone = MakeAffineMatrix(Vector3{ scale, scale, scale },
+		    MakeRotateAxisAngleQuaternion(Normalize(Vector3{ value(random), value(random), value(random) }),
+		        value(random) * 3.0f),
+		    Vector3{ value(random), value(random), value(random) });
+	}
+	Vertices positions(kVertexCount), normals(kVertexCount);
+	std::vector<SkinInfluence> influences(kVertexCount);
+	for (size_t i = 0; i < kVertexCount; i++) {
+		positions.x[i] = value(random);
+		positions.y[i] = value(random);
+		positions.z[i] = value(random);
+		const Vector3 normal = Normalize(Vector3{ value(random), value(random), value(random) });
+		normals.x[i] = normal.x;
+		normals.y[i] = normal.y;
+		normals.z[i] = normal.z;
+		// 影響するボーンは1～4本
+		const size_t used = 1 + random() % kSkinInfluenceCount;
+		float sum = 0.0f;
+		for (size_t k = 0; k < kSkinInfluenceCount; k++) {
+			influences[i].bones[k] = static_cast<uint16_t>(random() % kBoneCount);
+			influences[i].weights[k] = k < used ? 0.1f + unit(random) : 0.0f;
+			sum += influences[i].weights[k];
+		}
+		for (float& weight : influences[i].weights) {
+			weight /= sum;
+		}
+	}
+
+	Vertices expectedPositions(kVertexCount), expectedNormals(kVertexCount);
+	Vertices skinnedPositions(kVertexCount), skinnedNormals(kVertexCount);
+	SkinReference(palette.data(), influences.data(), positions, normals, expectedPositions, expectedNormals,
+	    kVertexCount);
+	SkinVertices(palette.data(), influences.data(), positions.Get(), normals.Get(), skinnedPositions.Get(),
+	    skinnedNormals.Get(), kVertexCount);
+	const float positionError = MaxError(expectedPositions, skinnedPositions, kVertexCount);
+	const float normalError = MaxError(expectedNormals, skinnedNormals, kVertexCount);
+	bool ok = positionError <= kTolerance && normalError <= kTolerance;
+	std::printf("max error  position %.1e  normal %.1e  %s\n", positionError, normalError, ok ? "ok" : "NG");
+
+	// 同じ頂点をメッシュに分けても同じ結果になる
+	std::vector<SkinnedMesh> meshes(kMeshCount);
+	const size_t meshVertexCount = kVertexCount / kMeshCount;
+	for (size_t i = 0; i < kMeshCount; i++) {
+		const size_t offset = i * meshVertexCount;
+		meshes[i] = SkinnedMesh{ palette.data(), influences.data() + offset,
+			ConstVector3SoA(positions.x.data() + offset, positions.y.data() + offset, positions.z.data() + offset),
+			ConstVector3SoA(normals.x.data() + offset, normals.y.data() + offset, normals.z.data() + offset),
+			Vector3SoA{ skinnedPositions.x.data() + offset, skinnedPositions.y.data() + offset,
+			    skinnedPositions.z.data() + offset },
+			Vector3SoA{ skinnedNormals.x.data() + offset, skinnedNormals.y.data() + offset,
+			    skinnedNormals.z.data() + offset },
+			meshVertexCount };
+	}
+	Vertices singlePositions = skinnedPositions, singleNormals = skinnedNormals;
+	std::fill(skinnedPositions.x.begin(), skinnedPositions.x.end(), 0.0f);
+	SkinMeshes(meshes.data(), meshes.size());
+	const bool sameMeshes = MaxError(singlePositions, skinnedPositions, kVertexCount) == 0.0f &&
+	    MaxError(singleNormals, skinnedNormals, kVertexCount) == 0.0f;
+	ok &= sameMeshes;
+	std::printf("SkinMeshes %s\n", sameMeshes ? "ok" : "NG");
+
+	const double reference = Benchmark::MeasureThroughput(kVertexCount, [&] {
+		SkinReference(palette.data(), influences.data(), positions, normals, expectedPositions, expectedNormals,
+		    kVertexCount);
+		Benchmark::DoNotOptimize(expectedPositions);
+	});
+	const double positionsOnly = Benchmark::MeasureThroughput(kVertexCount, [&] {
+		SkinVertices(palette.data(), influences.data(), positions.Get(), skinnedPositions.Get(), kVertexCount);
+		Benchmark::DoNotOptimize(skinnedPositions);
+	});
+	const double withNormals = Benchmark::MeasureThroughput(kVertexCount, [&] {
+		SkinVertices(palette.data(), influences.data(), positions.Get(), normals.Get(), skinnedPositions.Get(),
+		    skinnedNormals.Get(), kVertexCount);
+		Benchmark::DoNotOptimize(skinnedPositions);
+	});
+	const double perMesh = Benchmark::MeasureThroughput(kVertexCount, [&] {
+		SkinMeshes(meshes.data(), meshes.size());
+		Benchmark::DoNotOptimize(skinnedPositions);
+	});
+	std::printf("%-36s %8.1f M/s\n", "Transform per bone (reference)", reference * 1e-6);
+	std::printf("%-36s %8.1f M/s\n", "SkinVertices (positions)", positionsOnly * 1e-6);
+	std::printf("%-36s %8.1f M/s\n", "SkinVertices (positions + normals)", withNormals * 1e-6);
+	std::printf("%-36s %8.1f M/s\n", "SkinMeshes (64 meshes)", perMesh * 1e-6);
+	return ok ? 0 : 1;
+}
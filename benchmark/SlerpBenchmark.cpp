@@ -0,0 +1,212 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "MathFunction.h"
+#include "SimdDispatch.h"
+
+// ベクトルのSlerpについて、変更前の実装・スカラー版・一括版の精度と速度を比べる
+// 精度はdoubleで計算した値との差(長さで割った相対誤差)で、角度の大きさごとに調べる
+// Slerpとその一括版が許容誤差を超えるかNaNを返したら失敗(終了コード1)にする
+
+namespace {
+
+const size_t kCount = 100000;
+
+// 変更前のSlerp(角度が小さいとsinAngle ≒ 0で割る)
+Vector3 LegacySlerp(const Vector3& v1, const Vector3& v2, float t) {
+	float s = ((1 - t) * Length(v1)) + (t * Length(v2));
+	Vector3 e1 = Normalize(v1);
+	Vector3 e2 = Normalize(v2);
+	float an = std::acos(Dot(v1, v2) * (1.0f / (Length(v1) * Length(v2))));
+	if (an > 0.0f || an < 180.0f) {
+		float sinAngle, sin1, sin2, cos;
+		SinCos(an, sinAngle, cos);
+		SinCos((1 - t) * an, sin1, cos);
+		SinCos(t * an, sin2, cos);
+		Vector3 v1e = Multiply(sin1 / sinAngle, e1);
+		Vector3 v2e = Multiply(sin2 / sinAngle, e2);
+		Vector3 result = Multiply(s, Add(v1e, v2e));
+		return result;
+	}
+	return v1;
+}
+
+// doubleで計算した基準値
+// 逆向きに近くてもe2のe1に垂直な成分が残る限り、v1とv2が張る平面の中で補間する
+void ReferenceSlerp(const Vector3& v1, const Vector3& v2, double t, double result[3]) {
+	const double a[3] = { v1.x, v1.y, v1.z }, b[3] = { v2.x, v2.y, v2.z };
+	const double length1 = std::sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+	const double length2 = std::sqrt(b[0] * b[0] + b[1] * b[1] + b[2] * b[2]);
+	double e1[3], e2[3];
+	for (int k = 0; k < 3; k++) {
+		e1[k] = a[k] / length1;
+		e2[k] = b[k] / length2;
+	}
+	const double dot = std::clamp(e1[0] * e2[0] + e1[1] * e2[1] + e1[2] * e2[2], -1.0, 1.0);
+	double tangent[3];
+	for (int k = 0; k < 3; k++) {
+		tangent[k] = e2[k] - dot * e1[k];
+	}
+	const double tangentLength = std::sqrt(tangent[0] * tangent[0] + tangent[1] * tangent[1] + tangent[2] * tangent[2]);
+	const double angle = std::atan2(tangentLength, dot);
+	const double length = (1.0 - t) * length1 + t * length2;
+	double direction[3];
+	if (tangentLength == 0.0) {
+		for (int k = 0; k < 3; k++) {
+			direction[k] = e1[k];
+		}
+	}
+	else {
+		for (int k = 0; k < 3; k++) {
+			direction[k] = std::cos(t * angle) * e1[k] + std::sin(t * angle) * tangent[k] / tangentLength;
+		}
+	}
+	for (int k = 0; k < 3; k++) {
+		result[k] = length * direction[k];
+	}
+}
+
+struct Inputs {
+	std::vector<Vector3> v1, v2;
+	std::vector<float> t;
+	std::vector<float> x1, y1, z1, x2, y2, z2;
+};
+
+// v1とのなす角が[minAngle, maxAngle]のv2を作る(角度は対数で一様)
+Inputs MakeInputs(std::mt19937& random, float minAngle, float maxAngle) {
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::uniform_real_distribution<float> logAngle(std::log(minAngle), std::log(maxAngle));
+	Inputs inputs;
+	for (size_t i = 0; i < kCount; i++) {
+		const Vector3 axis = Normalize(Vector3{ unit(random) - 0.5f, unit(random) - 0.5f, unit(random) - 0.5f });
+		Vector3 perpendicular = Cross(axis, Vector3{ 0.0f, 1.0f, 0.0f });
+		if (Dot(perpendicular, perpendicular) < 1e-4f) {
+			perpendicular = Cross(axis, Vector3{ 1.0f, 0.0f, 0.0f });
+		}
+		perpendicular = Normalize(perpendicular);
+		const float angle = std::exp(logAngle(random));
+		const Vector3 direction = Add(Multiply(std::cos(angle), axis), Multiply(std::sin(angle), perpendicular));
+		const Vector3 v1 = Multiply(0.5f + unit(random) * 2.0f, axis);
+		const Vector3 v2 = Multiply(0.5f + unit(random) * 2.0f, direction);
+		inputs.v1.push_back(v1);
+		inputs.v2.push_back(v2);
+		inputs.t.push_back(unit(random));
+		inputs.x1.push_back(v1.x);
+		inputs.y1.push_back(v1.y);
+		inputs.z1.push_back(v1.z);
+		inputs.x2.push_back(v2.x);
+		inputs.y2.push_back(v2.y);
+		inputs.z2.push_back(v2.z);
+	}
+	return inputs;
+}
+
+struct Accuracy {
+	double maxError;
+	size_t nanCount;
+};
+
+Accuracy Measure(const Inputs& inputs, const std::function<Vector3(size_t)>& slerp) {
+	Accuracy accuracy{ 0.0, 0 };
+	for (size_t i = 0; i < kCount; i++) {
+		const Vector3 actual = slerp(i);
+		if (!std::isfinite(actual.x) || !std::isfinite(actual.y) || !std::isfinite(actual.z)) {
+			accuracy.nanCount++;
+			continue;
+		}
+		double expected[3];
+		ReferenceSlerp(inputs.v1[i], inputs.v2[i], inputs.t[i], expected);
+		const double dx = actual.x - expected[0], dy = actual.y - expected[1], dz = actual.z - expected[2];
+		const double length = std::sqrt(expected[0] * expected[0] + expected[1] * expected[1] + expected[2] * expected[2]);
+		accuracy.maxError = std::max(accuracy.maxError, std::sqrt(dx * dx + dy * dy + dz * dz) / length);
+	}
+	return accuracy;
+}
+
+} // namespace
+
+int main() {
+	std::printf("simd: %s  count: %zu\n", GetSimdLevelName(GetSimdLevel()), kCount);
+	std::mt19937 random(0);
+
+	// 逆向きに近いときの垂直な成分はfloatの正規化した向き同士の引き算で求めるので、
+	// その丸め誤差(1e-7程度)をπとの差で割った分だけ回転する平面がずれる(許容誤差は5e-7 / (π - 角度))
+	struct Range {
+		const char* name;
+		float minAngle, maxAngle;
+		double tolerance;
+	};
+	const float pi = 3.14159265f;
+	const Range ranges[] = {
+		{ "angle 1e-7 .. 1e-3", 1e-7f, 1e-3f, 1e-5 },
+		{ "angle 1e-3 .. 0.1", 1e-3f, 0.1f, 1e-5 },
+		{ "angle 0.1 .. 3", 0.1f, 3.0f, 1e-5 },
+		{ "angle pi - 1e-2 .. pi - 1e-3", pi - 1e-2f, pi - 1e-3f, 5e-4 },
+		{ "angle pi - 1e-3 .. pi - 1e-4", pi - 1e-3f, pi - 1e-4f, 5e-3 },
+		{ "angle pi - 1e-4 .. pi - 1e-5", pi - 1e-4f, pi - 1e-5f, 5e-2 },
+		{ "angle pi - 1e-5 .. pi - 2e-6", pi - 1e-5f, pi - 2e-6f, 2.5e-1 },
+	};
+	bool ok = true;
+	std::vector<float> x(kCount), y(kCount), z(kCount);
+	const Vector3SoA output{ x.data(), y.data(), z.data() };
+
+	std::printf("%-30s %18s %18s %18s\n", "", "legacy", "Slerp", "Slerp (SoA)");
+	for (const Range& range : ranges) {
+		const Inputs inputs = MakeInputs(random, range.minAngle, range.maxAngle);
+		const ConstVector3SoA v1(inputs.x1.data(), inputs.y1.data(), inputs.z1.data());
+		const ConstVector3SoA v2(inputs.x2.data(), inputs.y2.data(), inputs.z2.data());
+		Slerp(v1, v2, inputs.t.data(), output, kCount);
+		const Accuracy results[] = {
+			Measure(inputs, [&](size_t i) { return LegacySlerp(inputs.v1[i], inputs.v2[i], inputs.t[i]); }),
+			Measure(inputs, [&](size_t i) { return Slerp(inputs.v1[i], inputs.v2[i], inputs.t[i]); }),
+			Measure(inputs, [&](size_t i) { return Vector3{ x[i], y[i], z[i] }; }),
+		};
+		std::printf("%-30s", range.name);
+		for (const Accuracy& result : results) {
+			std::printf("  %7.1e NaN %5zu", result.maxError, result.nanCount);
+		}
+		bool rangeOk = true;
+		for (const Accuracy& result : { results[1], results[2] }) {
+			rangeOk = rangeOk && result.maxError <= range.tolerance && result.nanCount == 0;
+		}
+		std::printf("  %s\n", rangeOk ? "ok" : "NG");
+		ok = ok && rangeOk;
+	}
+
+	// 速度は一般的な角度で比べる
+	const Inputs inputs = MakeInputs(random, 0.1f, 3.0f);
+	const ConstVector3SoA v1(inputs.x1.data(), inputs.y1.data(), inputs.z1.data());
+	const ConstVector3SoA v2(inputs.x2.data(), inputs.y2.data(), inputs.z2.data());
+	std::vector<Vector3> results(kCount);
+	const double legacy = Benchmark::MeasureThroughput(kCount, [&] {
+		for (size_t i = 0; i < kCount; i++) {
+			results[i] = LegacySlerp(inputs.v1[i], inputs.v2[i], inputs.t[i]);
+		}
+		Benchmark::DoNotOptimize(results);
+	});
+	const double scalar = Benchmark::MeasureThroughput(kCount, [&] {
+		for (size_t i = 0; i < kCount; i++) {
+			results[i] = Slerp(inputs.v1[i], inputs.v2[i], inputs.t[i]);
+		}
+		Benchmark::DoNotOptimize(results);
+	});
+	const double precise = Benchmark::MeasureThroughput(kCount, [&] {
+		for (size_t i = 0; i < kCount; i++) {
+			results[i] = Slerp<SinCosPrecision::kPrecise>(inputs.v1[i], inputs.v2[i], inputs.t[i]);
+		}
+		Benchmark::DoNotOptimize(results);
+	});
+	const double batch = Benchmark::MeasureThroughput(kCount, [&] {
+		Slerp(v1, v2, inputs.t.data(), output, kCount);
+		Benchmark::DoNotOptimize(x);
+	});
+	std::printf("%-30s %8.1f M/s\n", "legacy", legacy * 1e-6);
+	std::printf("%-30s %8.1f M/s  x%.2f\n", "Slerp", scalar * 1e-6, scalar / legacy);
+	std::printf("%-30s %8.1f M/s  x%.2f\n", "Slerp<kPrecise>", precise * 1e-6, precise / legacy);
+	std::printf("%-30s %8.1f M/s  x%.2f\n", "Slerp (SoA)", batch * 1e-6, batch / legacy);
+	return ok ? 0 : 1;
+}
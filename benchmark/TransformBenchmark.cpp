@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "MathFunction.h"
+
+// Transformの1点ずつの呼び出しと一括版のスループット(点/秒)を比較する
+// 一括版(端数・入出力が同じ配列の場合も)の結果が1点ずつの結果と一致しなければ終了コード1
+
+namespace {
+
+const size_t kPointCount = 1 << 18;
+// 1点ずつの結果との相対誤差の許容値(積和の順とFMAの有無の違い)
+const float kTolerance = 1e-5f;
+// 端数を含む数
+const size_t kOddCount = 1003;
+
+float RelativeError(const Vector3& actual, const Vector3& expected) {
+	const float scale = std::max({ std::fabs(expected.x), std::fabs(expected.y), std::fabs(expected.z), 1.0f });
+	return Length(Subtract(actual, expected)) / scale;
+}
+
+void Report(const char* name, double pointsPerSecond) {
+	std::printf("%-32s %10.2f Mpoints/s\n", name, pointsPerSecond * 1e-6);
+}
+
+bool Run(const char* label, const Matrix4x4& matrix, const std::vector<Vector3>& points) {
+	std::vector<Vector3> outputAoS(kPointCount);
+	std::vector<float> x(kPointCount), y(kPointCount), z(kPointCount);
+	std::vector<float> ox(kPointCount), oy(kPointCount), oz(kPointCount);
+	for (size_t i = 0; i < kPointCount; i++) {
+		x[i] = points[i].x;
+		y[i] = points[i].y;
+		z[i] = points[i].z;
+	}
+	const ConstVector3SoA input{ x.data(), y.data(), z.data() };
+	const Vector3SoA output{ ox.data(), oy.data(), oz.data() };
+
+	// 1点ずつの結果と比べる(AoSは端数のある数を入出力が同じ配列で、SoAは全体を変換する)
+	std::vector<Vector3> expected(kPointCount);
+	for (size_t i = 0; i < kPointCount; i++) {
+		expected[i] = Transform(points[i], matrix);
+	}
+	std::vector<Vector3> inPlace(points.begin(), points.begin() + kOddCount);
+	Transform(inPlace.data(), inPlace.data(), kOddCount, matrix);
+	Transform(points.data(), outputAoS.data(), kPointCount, matrix);
+	Transform(input, output, kPointCount, matrix);
+	float error = 0.0f;
+	for (size_t i = 0; i < kPointCount; i++) {
+		error = std::max(error, RelativeError(outputAoS[i], expected[i]));
+		error = std::max(error, RelativeError(Vector3{ ox[i], oy[i], oz[i] }, expected[i]));
+		if (i < kOddCount) {
+			error = std::max(error, RelativeError(inPlace[i], expected[i]));
+		}
+	}
+	const bool ok = error <= kTolerance;
+
+	std::printf("[%s] max relative error against per point %.1e  %s\n", label, error, ok ? "ok" : "NG");
+	Report("Transform (per point)", Benchmark::MeasureThroughput(kPointCount, [&] {
+		for (size_t i = 0; i < kPointCount; i++) {
+			outputAoS[i] = Transform(points[i], matrix);
+		}
+		Benchmark::DoNotOptimize(outputAoS);
+	}));
+	Report("Transform (batch AoS)", Benchmark::MeasureThroughput(kPointCount, [&] {
+		Transform(points.data(), outputAoS.data(), kPointCount, matrix);
+		Benchmark::DoNotOptimize(outputAoS);
+	}));
+	Report("Transform (batch SoA)", Benchmark::MeasureThroughput(kPointCount, [&] {
+		Transform(input, output, kPointCount, matrix);
+		Benchmark::DoNotOptimize(ox);
+	}));
+	return ok;
+}
+
+} // namespace
+
+int main() {
+	std::mt19937 random(0);
+	std::uniform_real_distribution<float> distribution(-100.0f, 100.0f);
+	std::vector<Vector3> points(kPointCount);
+	for (Vector3& point : points) {
+		point = { distribution(random), distribution(random), distribution(random) };
+	}
+
+	const Vector3 rotate{ 0.3f, 1.2f, -0.4f };
+	const Matrix4x4 world = MakeAffineMatrix({ 1.0f, 2.0f, 1.5f }, rotate, { 10.0f, -5.0f, 3.0f });
+	const Matrix4x4 projection = Multiply(
+	    MakeViewMatrix({ 0.26f, 0.0f, 0.0f }, { 0.0f, 1.9f, -300.0f }),
+	    MakePerspectiveFovMatrix(0.45f, 1280.0f / 720.0f, 0.1f, 1000.0f));
+
+	bool ok = Run("affine", world, points);
+	ok &= Run("projective", projection, points);
+	return ok ? 0 : 1;
+}
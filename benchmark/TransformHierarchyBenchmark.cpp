@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "JobSystem.h"
+#include "MathFunction.h"
+#include "SimdDispatch.h"
+#include "TransformHierarchy.h"
+
+// 10万ノードの階層で、毎フレーム全ノードを計算し直す場合と
+// 変更のあったノードとその子孫だけをUpdateで計算し直す場合を比べる
+// Updateの結果が全計算と一致することも確かめ、違えば1を返す
+// (MT4_THREADSで2以上にすると深さごとに並列に処理する方を確かめる)
+
+namespace {
+
+const size_t kNodeCount = 100000;
+const uint32_t kMaxDepth = 8;
+// 全計算との差の上限(同じ計算をするので通常は0)
+const float kTolerance = 1e-5f;
+// 変更の伝わり方を確かめるフレーム数
+const size_t kCheckFrameCount = 48;
+
+struct Node {
+	uint32_t parent;
+	Vector3 scale;
+	Quaternion rotate;
+	Vector3 translate;
+};
+
+Quaternion RandomRotate(std::mt19937& random) {
+	std::uniform_real_distribution<float> angle(-3.14159265f, 3.14159265f);
+	std::uniform_real_distribution<float> component(-1.0f, 1.0f);
+	Vector3 axis{ component(random), component(random), component(random) };
+	if (Dot(axis, axis) < 1e-4f) {
+		axis = { 0.0f, 1.0f, 0.0f };
+	}
+	return MakeRotateAxisAngleQuaternion(Normalize(axis), angle(random));
+}
+
+// 親は深さkMaxDepth未満の追加済みノードから選ぶ
+std::vector<Node> MakeRandomTree(std::mt19937& random) {
+	std::uniform_real_distribution<float> scale(0.9f, 1.1f);
+	std::uniform_real_distribution<float> translate(-2.0f, 2.0f);
+	std::vector<Node> nodes;
+	std::vector<uint32_t> depths;
+	std::vector<uint32_t> parentCandidates;
+	nodes.reserve(kNodeCount);
+	for (size_t i = 0; i < kNodeCount; i++) {
+		uint32_t parent = TransformHierarchy::kNoParent;
+		if (i >= 16) {
+			parent = parentCandidates[std::uniform_int_distribution<size_t>(0, parentCandidates.size() - 1)(random)];
+		}
+		const uint32_t depth = parent == TransformHierarchy::kNoParent ? 0 : depths[parent] + 1;
+		depths.push_back(depth);
+		if (depth + 1 < kMaxDepth) {
+			parentCandidates.push_back(static_cast<uint32_t>(i));
+		}
+		nodes.push_back({ parent, { scale(random), scale(random), scale(random) }, RandomRotate(random),
+		    { translate(random), translate(random), translate(random) } });
+	}
+	return nodes;
+}
+
+// 毎回すべてのノードを計算し直す
+void UpdateAll(const std::vector<Node>& nodes, std::vector<Matrix4x4>& worldMatrices) {
+	for (size_t i = 0; i < nodes.size(); i++) {
+		const Node& node = nodes[i];
+		const Matrix4x4 local = MakeAffineMatrix(node.scale, node.rotate, node.translate);
+		worldMatrices[i] =
+		    node.parent == TransformHierarchy::kNoParent ? local : Multiply(local, worldMatrices[node.parent]);
+	}
+}
+
+float MaxDifference(const std::vector<Matrix4x4>& expected, const Matrix4x4* actual) {
+	float difference = 0.0f;
+	for (size_t i = 0; i < expected.size(); i++) {
+		for (int row = 0; row < 4; row++) {
+			for (int column = 0; column < 4; column++) {
+				difference = std::max(difference, std::fabs(expected[i].m[row][column] - actual[i].m[row][column]));
+			}
+		}
+	}
+	return difference;
+}
+
+// フレームごとに1つの深さ(と時々ほかの深さ)のノードを変更してUpdateし、全計算と比べる
+// 変更のない深さを飛ばすこと、飛ばした深さの古いworldChanged_を参照しないことを確かめる
+bool CheckPropagation(std::vector<Node>& nodes, TransformHierarchy& hierarchy, std::mt19937& random) {
+	std::vector<std::vector<uint32_t>> levels(kMaxDepth);
+	std::vector<uint32_t> depths(nodes.size());
+	for (size_t i = 0; i < nodes.size(); i++) {
+		const uint32_t parent = nodes[i].parent;
+		depths[i] = parent == TransformHierarchy::kNoParent ? 0 : depths[parent] + 1;
+		levels[depths[i]].push_back(static_cast<uint32_t>(i));
+	}
+	std::uniform_real_distribution<float> scale(0.9f, 1.1f);
+	std::uniform_real_distribution<float> translate(-2.0f, 2.0f);
+	std::uniform_int_distribution<int> kind(0, 3);
+	std::vector<Matrix4x4> worldMatrices(nodes.size());
+	float maxDifference = 0.0f;
+	for (size_t frame = 0; frame < kCheckFrameCount; frame++) {
+		// 3フレームに1回は変更なし、それ以外は深さを順に変えて数ノードを変更する
+		const std::vector<uint32_t>& level = levels[(frame * 5) % kMaxDepth];
+		const size_t changeCount = frame % 3 == 2 ? 0 : 1 + frame % 4;
+		for (size_t i = 0; i < changeCount; i++) {
+			const bool otherDepth = i == 3;
+			const uint32_t node = otherDepth
+			                          ? std::uniform_int_distribution<uint32_t>(0, uint32_t(nodes.size() - 1))(random)
+			                          : level[std::uniform_int_distribution<size_t>(0, level.size() - 1)(random)];
+			Node& n = nodes[node];
+			switch (kind(random)) {
+			case 0:
+				n.scale = { scale(random), scale(random), scale(random) };
+				hierarchy.SetScale(node, n.scale);
+				break;
+			case 1:
+				n.rotate = RandomRotate(random);
+				hierarchy.SetRotate(node, n.rotate);
+				break;
+			case 2:
+				n.translate = { translate(random), translate(random), translate(random) };
+				hierarchy.SetTranslate(node, n.translate);
+				break;
+			default:
+				n.translate = { translate(random), translate(random), translate(random) };
+				hierarchy.SetLocalTransform(node, n.scale, n.rotate, n.translate);
+				break;
+			}
+		}
+		hierarchy.Update();
+		UpdateAll(nodes, worldMatrices);
+		maxDifference = std::max(maxDifference, MaxDifference(worldMatrices, hierarchy.GetWorldMatrices()));
+	}
+	const bool ok = maxDifference <= kTolerance;
+	std::printf("propagation (%zu frames)  max diff %.1e  %s\n", kCheckFrameCount, maxDifference, ok ? "ok" : "NG");
+	return ok;
+}
+
+} // namespace
+
+int main() {
+	std::printf("simd: %s  threads: %zu  nodes: %zu\n", GetSimdLevelName(GetSimdLevel()),
+	    JobSystem::GetInstance().GetThreadCount(), kNodeCount);
+
+	std::mt19937 random(0);
+	std::vector<Node> nodes = MakeRandomTree(random);
+	std::vector<Matrix4x4> worldMatrices(nodes.size());
+
+	TransformHierarchy hierarchy;
+	hierarchy.Reserve(nodes.size());
+	for (const Node& node : nodes) {
+		hierarchy.AddNode(node.parent, node.scale, node.rotate, node.translate);
+	}
+	hierarchy.Update();
+	bool ok = CheckPropagation(nodes, hierarchy, random);
+
+	const double fullRate = Benchmark::MeasureThroughput(1, [&] {
+		UpdateAll(nodes, worldMatrices);
+		Benchmark::DoNotOptimize(worldMatrices);
+	});
+	std::printf("%-24s %9.3f ms/frame\n", "recompute all", 1e3 / fullRate);
+
+	const double changeRates[] = { 0.01, 0.1, 1.0 };
+	std::uniform_int_distribution<uint32_t> nodeDistribution(0, static_cast<uint32_t>(nodes.size() - 1));
+	for (double changeRate : changeRates) {
+		const size_t changeCount = static_cast<size_t>(double(nodes.size()) * changeRate);
+		// 変更するノードと回転はあらかじめ決めておき、計測には含めない
+		std::vector<uint32_t> changedNodes(changeCount);
+		std::vector<Quaternion> rotates(changeCount);
+		for (size_t i = 0; i < changeCount; i++) {
+			changedNodes[i] = changeRate >= 1.0 ? static_cast<uint32_t>(i) : nodeDistribution(random);
+			rotates[i] = RandomRotate(random);
+		}
+
+		size_t frame = 0;
+		const double rate = Benchmark::MeasureThroughput(1, [&] {
+			const Quaternion* rotate = frame++ % 2 == 0 ? rotates.data() : nullptr;
+			for (size_t i = 0; i < changeCount; i++) {
+				const uint32_t node = changedNodes[i];
+				hierarchy.SetRotate(node, rotate ? rotate[i] : nodes[node].rotate);
+			}
+			hierarchy.Update();
+			Benchmark::DoNotOptimize(hierarchy.GetWorldMatrices());
+		});
+
+		// 最後の状態を全計算の結果と比べる
+		if (frame % 2 == 1) {
+			for (size_t i = 0; i < changeCount; i++) {
+				nodes[changedNodes[i]].rotate = rotates[i];
+			}
+		}
+		UpdateAll(nodes, worldMatrices);
+		const float difference = MaxDifference(worldMatrices, hierarchy.GetWorldMatrices());
+		for (size_t i = 0; i < changeCount; i++) {
+			hierarchy.SetRotate(changedNodes[i], nodes[changedNodes[i]].rotate);
+		}
+		hierarchy.Update();
+
+		ok = ok && difference <= kTolerance;
+		std::printf("Update (%5.1f%% changed)  %9.3f ms/frame  x%-6.2f vs recompute all  max diff %.1e %s\n",
+		    changeRate * 100.0, 1e3 / rate, rate / fullRate, difference, difference <= kTolerance ? "ok" : "NG");
+	}
+	return ok ? 0 : 1;
+}
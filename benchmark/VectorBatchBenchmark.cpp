@@ -0,0 +1,222 @@
+#include <algorithm>
+#include <bit>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "MathFunction.h"
+#include "SimdDispatch.h"
+
+// 長さ・正規化・正射影の一括版(Reciprocal.hの精度ごと)
+// 倍精度で求めた値からのulp誤差がReciprocal.hに書いた上限に収まることを確かめ(超えたら1を返す)、
+// 1つずつLength/Normalize/Projectを呼ぶ方法と速さを比べる
+
+namespace {
+
+const size_t kVectorCount = 1 << 16;
+
+struct Vectors {
+	std::vector<float> x, y, z;
+
+	explicit Vectors(size_t count) : x(count), y(count), z(count) {}
+	Vector3SoA Get() { return { x.data(), y.data(), z.data() }; }
+	ConstVector3SoA Get() const { return { x.data(), y.data(), z.data() }; }
+	Vector3 operator[](size_t i) const { return { x[i], y[i], z[i] }; }
+	void Set(size_t i, const Vector3& v) {
+		x[i] = v.x;
+		y[i] = v.y;
+		z[i] = v.z;
+	}
+};
+
+// 2つのfloatの間にあるfloatの数(符号が違えば0をまたいだ分を数える)
+int64_t UlpDistance(float a, float b) {
+	const auto key = [](float f) {
+		const int32_t bits = std::bit_cast<int32_t>(f);
+		return bits < 0 ? -int64_t(bits & 0x7FFFFFFF) : int64_t(bits);
+	};
+	return std::abs(key(a) - key(b));
+}
+
+// 誤差の上限(ulp) Reciprocal.hのコメントと合わせる
+struct UlpBound {
+	int64_t length;
+	int64_t normalize;
+	int64_t project;
+};
+
+UlpBound GetUlpBound(ReciprocalPrecision precision) {
+	switch (precision) {
+	case ReciprocalPrecision::kExact:
+		return { 1, 2, 2 };
+	case ReciprocalPrecision::kPrecise:
+		return { 4, 4, 6 };
+	default:
+		return { 6200, 6200, 6200 };
+	}
+}
+
+const char* GetPrecisionName(ReciprocalPrecision precision) {
+	switch (precision) {
+	case ReciprocalPrecision::kExact:
+		return "kExact";
+	case ReciprocalPrecision::kPrecise:
+		return "kPrecise";
+	default:
+		return "kFast";
+	}
+}
+
+template<ReciprocalPrecision kPrecision>
+bool CheckPrecision(const Vectors& v1, const Vectors& v2) {
+	const size_t count = v1.x.size();
+	std::vector<float> lengths(count);
+	Vectors normalized(count), projected(count), exactProjected(count);
+	Length<kPrecision>(v1.Get(), lengths.data(), count);
+	Normalize<kPrecision>(v1.Get(), normalized.Get(), count);
+	Project<kPrecision>(v1.Get(), v2.Get(), projected.Get(), count);
+	Project<ReciprocalPrecision::kExact>(v1.Get(), v2.Get(), exactProjected.Get(), count);
+
+	int64_t lengthError = 0, normalizeError = 0, projectError = 0;
+	for (size_t i = 0; i < count; i++) {
+		const double x = v1.x[i], y = v1.y[i], z = v1.z[i];
+		const double length = std::sqrt(x * x + y * y + z * z);
+		lengthError = std::max(lengthError, UlpDistance(lengths[i], float(length)));
+		if (length != 0.0) {
+			normalizeError = std::max({ normalizeError, UlpDistance(normalized.x[i], float(x / length)),
+			    UlpDistance(normalized.y[i], float(y / length)), UlpDistance(normalized.z[i], float(z / length)) });
+		}
+		// 内積の桁落ちは精度によらないので、正射影はkExactとの差を見る
+		projectError = std::max({ projectError, UlpDistance(projected.x[i], exactProjected.x[i]),
+		    UlpDistance(projected.y[i], exactProjected.y[i]), UlpDistance(projected.z[i], exactProjected.z[i]) });
+	}
+	const UlpBound bound = GetUlpBound(kPrecision);
+	const bool ok = lengthError <= bound.length && normalizeError <= bound.normalize && projectError <= bound.project;
+	std::printf("%-9s max ulp  Length %5lld  Normalize %5lld  Project %5lld  %s\n", GetPrecisionName(kPrecision),
+	    static_cast<long long>(lengthError), static_cast<long long>(normalizeError),
+	    static_cast<long long>(projectError), ok ? "ok" : "NG");
+	return ok;
+}
+
+// 長さ0・非正規化数・オーバーフローするベクトルが1つずつのNormalizeと同じ結果になるか
+template<ReciprocalPrecision kPrecision>
+bool CheckSpecialValues() {
+	const Vector3 specials[] = {
+		{ 0.0f, 0.0f, 0.0f },
+		{ -0.0f, 0.0f, -0.0f },
+		{ 1e-30f, 0.0f, 0.0f },    // 長さの2乗が0に丸められる
+		{ 1e-20f, -2e-20f, 0.0f }, // 長さの2乗が非正規化数
+		{ 3e-19f, 1e-19f, 2e-19f }, // 長さの2乗がFLT_MINの少し上
+		{ 1e19f, 0.0f, -1e19f },   // 長さの2乗がFLT_MAXの少し下
+		{ 1e20f, 1e20f, 1e20f },   // 長さの2乗が無限大
+		{ 1.0f, 2.0f, 3.0f },
+	};
+	// SIMDのレーンが全部埋まるように並べる
+	const size_t count = std::size(specials) * 8;
+	Vectors v(count), normalized(count), projected(count);
+	std::vector<float> lengths(count);
+	for (size_t i = 0; i < count; i++) {
+		v.Set(i, specials[(i / 8 + i) % std::size(specials)]);
+	}
+	Length<kPrecision>(v.Get(), lengths.data(), count);
+	Normalize<kPrecision>(v.Get(), normalized.Get(), count);
+	Project<kPrecision>(v.Get(), v.Get(), projected.Get(), count);
+	const UlpBound bound = GetUlpBound(kPrecision);
+	bool ok = true;
+	for (size_t i = 0; i < count; i++) {
+		const Vector3 expected = Normalize(v[i]);
+		const Vector3 projection = LengthSquared(v[i]) == 0.0f ? Vector3{} : Project(v[i], v[i]);
+		ok &= UlpDistance(lengths[i], Length(v[i])) <= bound.length;
+		ok &= UlpDistance(normalized.x[i], expected.x) <= bound.normalize;
+		ok &= UlpDistance(normalized.y[i], expected.y) <= bound.normalize;
+		ok &= UlpDistance(normalized.z[i], expected.z) <= bound.normalize;
+		// 無限大になるものはNaNの位置が同じか見る
+		if (std::isfinite(LengthSquared(v[i]))) {
+			ok &= UlpDistance(projected.x[i], projection.x) <= bound.project;
+			ok &= UlpDistance(projected.y[i], projection.y) <= bound.project;
+			ok &= UlpDistance(projected.z[i], projection.z) <= bound.project;
+		}
+		else {
+			ok &= std::isnan(projected.x[i]) == std::isnan(projection.x);
+		}
+	}
+	std::printf("%-9s zero/subnormal/overflow %s\n", GetPrecisionName(kPrecision), ok ? "ok" : "NG");
+	return ok;
+}
+
+template<ReciprocalPrecision kPrecision>
+void MeasureBatch(const Vectors& v1, const Vectors& v2) {
+	const size_t count = v1.x.size();
+	std::vector<float> lengths(count);
+	Vectors result(count);
+	const double length = Benchmark::MeasureThroughput(count, [&] {
+		Length<kPrecision>(v1.Get(), lengths.data(), count);
+		Benchmark::DoNotOptimize(lengths);
+	});
+	const double normalize = Benchmark::MeasureThroughput(count, [&] {
+		Normalize<kPrecision>(v1.Get(), result.Get(), count);
+		Benchmark::DoNotOptimize(result);
+	});
+	const double project = Benchmark::MeasureThroughput(count, [&] {
+		Project<kPrecision>(v1.Get(), v2.Get(), result.Get(), count);
+		Benchmark::DoNotOptimize(result);
+	});
+	std::printf("%-24s %10.1f %10.1f %10.1f\n", GetPrecisionName(kPrecision), length * 1e-6, normalize * 1e-6,
+	    project * 1e-6);
+}
+
+} // namespace
+
+int main() {
+	std::printf("simd: %s  vectors: %zu\n", GetSimdLevelName(GetSimdLevel()), kVectorCount);
+	std::mt19937 random(0);
+	std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> logScale(std::log(1e-3f), std::log(1e3f));
+
+	// 向きと長さがばらばらのベクトル(一部は長さ0)
+	Vectors v1(kVectorCount), v2(kVectorCount);
+	for (size_t i = 0; i < kVectorCount; i++) {
+		const Vector3 direction{ value(random), value(random), value(random) };
+		v1.Set(i, i % 97 == 0 ? Vector3{} : Multiply(std::exp(logScale(random)), direction));
+		v2.Set(i, i % 89 == 0 ? Vector3{} : Multiply(std::exp(logScale(random)), Vector3{ value(random), value(random), value(random) }));
+	}
+
+	bool ok = true;
+	ok &= CheckPrecision<ReciprocalPrecision::kExact>(v1, v2);
+	ok &= CheckPrecision<ReciprocalPrecision::kPrecise>(v1, v2);
+	ok &= CheckPrecision<ReciprocalPrecision::kFast>(v1, v2);
+	ok &= CheckSpecialValues<ReciprocalPrecision::kExact>();
+	ok &= CheckSpecialValues<ReciprocalPrecision::kPrecise>();
+	ok &= CheckSpecialValues<ReciprocalPrecision::kFast>();
+
+	// 1つずつ呼ぶ方法
+	std::vector<float> lengths(kVectorCount);
+	Vectors result(kVectorCount);
+	const double length = Benchmark::MeasureThroughput(kVectorCount, [&] {
+		for (size_t i = 0; i < kVectorCount; i++) {
+			lengths[i] = Length(v1[i]);
+		}
+		Benchmark::DoNotOptimize(lengths);
+	});
+	const double normalize = Benchmark::MeasureThroughput(kVectorCount, [&] {
+		for (size_t i = 0; i < kVectorCount; i++) {
+			result.Set(i, Normalize(v1[i]));
+		}
+		Benchmark::DoNotOptimize(result);
+	});
+	const double project = Benchmark::MeasureThroughput(kVectorCount, [&] {
+		for (size_t i = 0; i < kVectorCount; i++) {
+			result.Set(i, Project(v1[i], v2[i]));
+		}
+		Benchmark::DoNotOptimize(result);
+	});
+	std::printf("%-24s %10s %10s %10s\n", "M/s", "Length", "Normalize", "Project");
+	std::printf("%-24s %10.1f %10.1f %10.1f\n", "single", length * 1e-6, normalize * 1e-6, project * 1e-6);
+	MeasureBatch<ReciprocalPrecision::kExact>(v1, v2);
+	MeasureBatch<ReciprocalPrecision::kPrecise>(v1, v2);
+	MeasureBatch<ReciprocalPrecision::kFast>(v1, v2);
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "MathFunction.h"
+#include "SimdDispatch.h"
+
+// テンプレートのベクトル・行列(VectorMatrix.h)と、型ごとに書いた既存の関数を比べる
+// 結果が同じになることを確かめてから、Vector3の演算と4x4行列の積のスループットを測る
+
+namespace {
+
+const size_t kCount = 1 << 14; // L1/L2に収まる量
+
+// 定数式でも評価できる
+static_assert(Dot(ToVec(Vector3{ 1.0f, 2.0f, 3.0f }), Vec3f{ 1.0f, 1.0f, 1.0f }) == 6.0f);
+static_assert(ToMatrix4x4(Multiply(ToMat(MakeIdentity4x4()), ToMat(MakeTranslateMatrix(Vector3{ 1.0f, 2.0f, 3.0f })))).m[3][2] == 3.0f);
+static_assert(Determinant(Mat3d{ { { 2.0, 1.0, 0.0 }, { 1.0, 3.0, 1.0 }, { 0.0, 1.0, 4.0 } } }) == 18.0);
+
+} // namespace
+
+int main() {
+	std::printf("simd: %s\n", GetSimdLevelName(GetSimdLevel()));
+	std::mt19937 random(0);
+	std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+	std::vector<Vector3> a(kCount), b(kCount), results(kCount);
+	std::vector<Matrix4x4> m1(kCount), m2(kCount), products(kCount);
+	for (size_t i = 0; i < kCount; i++) {
+		a[i] = { value(random), value(random), value(random) };
+		b[i] = { value(random), value(random), value(random) };
+		for (int row = 0; row < 4; row++) {
+			for (int col = 0; col < 4; col++) {
+				m1[i].m[row][col] = value(random);
+				m2[i].m[row][col] = value(random);
+			}
+		}
+	}
+
+	// 同じ結果になること(積は足す順が異なりうるので誤差で比べる)
+	float vectorError = 0.0f, matrixError = 0.0f;
+	for (size_t i = 0; i < kCount; i++) {
+		const Vector3 expected = Normalize(Add(Cross(a[i], b[i]), Multiply(Dot(a[i], b[i]), a[i])));
+		const Vec3f va = ToVec(a[i]), vb = ToVec(b[i]);
+		const Vector3 actual = ToVector3(Normalize(Add(Cross(va, vb), Multiply(Dot(va, vb), va))));
+		vectorError = std::fmax(vectorError, Length(Subtract(expected, actual)));
+		const Matrix4x4 product = Multiply(m1[i], m2[i]);
+		const Matrix4x4 templateProduct = ToMatrix4x4(Multiply(ToMat(m1[i]), ToMat(m2[i])));
+		for (int row = 0; row < 4; row++) {
+			for (int col = 0; col < 4; col++) {
+				matrixError = std::fmax(matrixError, std::fabs(product.m[row][col] - templateProduct.m[row][col]));
+			}
+		}
+	}
+	std::printf("max error  vector %.1e  matrix %.1e\n", vectorError, matrixError);
+
+	const double vector3 = Benchmark::MeasureThroughput(kCount, [&] {
+		for (size_t i = 0; i < kCount; i++) {
+			results[i] = Add(Cross(a[i], b[i]), Multiply(Dot(a[i], b[i]), a[i]));
+		}
+		Benchmark::DoNotOptimize(results);
+	});
+	const double vec3f = Benchmark::MeasureThroughput(kCount, [&] {
+		for (size_t i = 0; i < kCount; i++) {
+			const Vec3f va = ToVec(a[i]), vb = ToVec(b[i]);
+			results[i] = ToVector3(Add(Cross(va, vb), Multiply(Dot(va, vb), va)));
+		}
+		Benchmark::DoNotOptimize(results);
+	});
+	const double matrix4x4 = Benchmark::MeasureThroughput(kCount, [&] {
+		for (size_t i = 0; i < kCount; i++) {
+			products[i] = Multiply(m1[i], m2[i]);
+		}
+		Benchmark::DoNotOptimize(products);
+	});
+	const double mat4f = Benchmark::MeasureThroughput(kCount, [&] {
+		for (size_t i = 0; i < kCount; i++) {
+			products[i] = ToMatrix4x4(Multiply(ToMat(m1[i]), ToMat(m2[i])));
+		}
+		Benchmark::DoNotOptimize(products);
+	});
+	std::vector<Mat4d> d1(kCount), d2(kCount), dProducts(kCount);
+	for (size_t i = 0; i < kCount; i++) {
+		d1[i] = MakeMat<double, 4, 4>([&](auto row, auto col) { return m1[i].m[row][col]; });
+		d2[i] = MakeMat<double, 4, 4>([&](auto row, auto col) { return m2[i].m[row][col]; });
+	}
+	const double mat4d = Benchmark::MeasureThroughput(kCount, [&] {
+		for (size_t i = 0; i < kCount; i++) {
+			dProducts[i] = Multiply(d1[i], d2[i]);
+		}
+		Benchmark::DoNotOptimize(dProducts);
+	});
+
+	std::printf("%-36s %8.1f M/s\n", "Vector3 (hand written)", vector3 * 1e-6);
+	std::printf("%-36s %8.1f M/s\n", "Vec3f", vec3f * 1e-6);
+	std::printf("%-36s %8.1f M/s\n", "Multiply(Matrix4x4) (dispatched)", matrix4x4 * 1e-6);
+	std::printf("%-36s %8.1f M/s\n", "Multiply(Mat4f) (inline SSE2)", mat4f * 1e-6);
+	std::printf("%-36s %8.1f M/s\n", "Multiply(Mat4d)", mat4d * 1e-6);
+	return 0;
+}
@@ -0,0 +1,272 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "MathFunction.h"
+#include "SimdDispatch.h"
+#include "VertexPipeline.h"
+
+// 頂点ごとにTransformをワールド, ビュー, 射影, ビューポートの順に4回呼ぶ場合と
+// VertexPipelineで一括変換する場合を比べる(一部の頂点はカメラの後ろにある)
+// 3つの入力形式の結果とTransformSegmentを倍精度で求めた値と比べ、違えば1を返す
+
+namespace {
+
+const size_t kVertexCount = 100000;
+// 確かめる頂点数(レーン幅とkChunkSizeの端数が出る数)
+const size_t kCheckCount = kVertexCount - 5;
+// 倍精度で求めた座標との差の上限(相対)
+const double kTolerance = 1e-5;
+// クリップ面との距離がこれ(相対)より近い頂点はどちら側と判定してもよい
+const double kClipMargin = 1e-5;
+// 近クリップ面で切り取る線分の数
+const size_t kSegmentCount = 10000;
+// 線分の端点の誤差の上限(ピクセル)
+// 切り取った端点はw = nearで割るので、クリップ座標の丸め誤差が大きく拡大される(画面の端では座標の相対誤差で測れない)
+const double kSegmentPixelTolerance = 0.25;
+
+// 頂点構造体(座標以外の要素も持つ)
+struct Vertex {
+	Vector3 position;
+	Vector3 normal;
+	float u, v;
+};
+
+struct Vector4d {
+	double x, y, z, w;
+};
+
+// (x, y, z, w) * matrix を倍精度で求める
+Vector4d TransformDouble(const Vector4d& v, const Matrix4x4& matrix) {
+	Vector4d result;
+	double* components[] = { &result.x, &result.y, &result.z, &result.w };
+	for (int column = 0; column < 4; column++) {
+		*components[column] = v.x * matrix.m[0][column] + v.y * matrix.m[1][column] + v.z * matrix.m[2][column] +
+		                      v.w * matrix.m[3][column];
+	}
+	return result;
+}
+
+// 4つの行列を順に掛けずに倍精度で求めたクリップ座標とスクリーン座標
+struct Reference {
+	const Matrix4x4 *world, *view, *projection, *viewport;
+
+	Vector4d Clip(const Vector3& position) const {
+		const Vector4d p{ position.x, position.y, position.z, 1.0 };
+		return TransformDouble(TransformDouble(TransformDouble(p, *world), *view), *projection);
+	}
+	Vector4d Screen(const Vector4d& clip) const {
+		return TransformDouble(Vector4d{ clip.x / clip.w, clip.y / clip.w, clip.z / clip.w, 1.0 }, *viewport);
+	}
+	// クリップ面のビットと、境界に近くてどちらでもよいビット
+	uint32_t ClipFlags(const Vector4d& clip, uint32_t& ambiguous) const {
+		const double margin = kClipMargin * std::max({ std::fabs(clip.x), std::fabs(clip.y), std::fabs(clip.z),
+		                                        std::fabs(clip.w), 1.0 });
+		const double distances[] = { clip.x + clip.w, clip.w - clip.x, clip.y + clip.w, clip.w - clip.y, clip.z,
+			clip.w - clip.z };
+		uint32_t flags = 0;
+		ambiguous = 0;
+		for (int plane = 0; plane < 6; plane++) {
+			flags |= distances[plane] < 0.0 ? 1u << plane : 0u;
+			ambiguous |= std::fabs(distances[plane]) <= margin ? 1u << plane : 0u;
+		}
+		return flags;
+	}
+};
+
+double RelativeError(const Vector4d& expected, const Vector3& actual) {
+	const double dx = expected.x - actual.x, dy = expected.y - actual.y, dz = expected.z - actual.z;
+	const double length = std::sqrt(expected.x * expected.x + expected.y * expected.y + expected.z * expected.z);
+	return std::sqrt(dx * dx + dy * dy + dz * dz) / std::max(1.0, length);
+}
+
+// スクリーン上の距離(ピクセル)
+double PixelError(const Vector4d& expected, const Vector3& actual) {
+	return std::hypot(expected.x - actual.x, expected.y - actual.y);
+}
+
+// 一括変換の結果を確かめる クリップ面のビットはすべての頂点、近クリップ面の手前は(0, 0, 0)
+// 座標の相対誤差は視錐台の内側の頂点だけ調べる(外側でwが小さい頂点はfloatの桁落ちで誤差が大きくなる)
+bool CheckOutput(const char* name, const Reference& reference, const std::vector<Vector3>& positions,
+    const std::vector<ScreenVertex>& output) {
+	size_t flagMismatches = 0;
+	double maxError = 0.0;
+	bool zeroBehindNear = true;
+	for (size_t i = 0; i < kCheckCount; i++) {
+		const Vector4d clip = reference.Clip(positions[i]);
+		uint32_t ambiguous = 0;
+		const uint32_t flags = reference.ClipFlags(clip, ambiguous);
+		flagMismatches += ((flags ^ output[i].clipFlags) & ~ambiguous) != 0;
+		if (output[i].clipFlags & kClipNear) {
+			const Vector3& p = output[i].position;
+			zeroBehindNear = zeroBehindNear && p.x == 0.0f && p.y == 0.0f && p.z == 0.0f;
+			continue;
+		}
+		if (flags != 0) {
+			continue;
+		}
+		const double error = RelativeError(reference.Screen(clip), output[i].position);
+		maxError = error <= maxError ? maxError : error; // NaNは残す
+	}
+	const bool ok = flagMismatches == 0 && zeroBehindNear && maxError <= kTolerance;
+	std::printf("%-18s clip flag mismatches %zu  max relative error %.1e  %s\n", name, flagMismatches, maxError,
+	    ok ? "ok" : "NG");
+	return ok;
+}
+
+// 線分の近クリップ面での切り取りを倍精度で求めた値と比べる
+// 近クリップ面との交点が視錐台の内側に来る線分をビュー空間で作る(向きは両方)
+// 両端が手前の線分は見えない、両端が内側の線分は頂点の変換と同じになることも確かめる
+bool CheckSegments(const Reference& reference, const VertexPipeline& pipeline, const Matrix4x4& world,
+    const Matrix4x4& view, float nearClip, float fovY, float aspectRatio) {
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> length(0.05f, 5.0f);
+	const Matrix4x4 viewToWorld = Inverse(Multiply(world, view));
+	const float halfHeight = nearClip * std::tan(fovY * 0.5f);
+	const float halfWidth = halfHeight * aspectRatio;
+	size_t wrongResult = 0;
+	double maxError = 0.0;
+	for (size_t i = 0; i < kSegmentCount; i++) {
+		// 近クリップ面上の交点から、奥へ向かう向きに前後に伸ばす
+		const Vector3 cross{ unit(random) * halfWidth * 0.99f, unit(random) * halfHeight * 0.99f, nearClip };
+		const Vector3 direction = Normalize(Vector3{ unit(random), unit(random), 0.2f + std::fabs(unit(random)) });
+		const Vector3 front = Transform(Add(cross, Multiply(length(random), direction)), viewToWorld);
+		const Vector3 behind = Transform(Subtract(cross, Multiply(length(random), direction)), viewToWorld);
+		const bool frontFirst = i % 2 == 0;
+		const Vector3& start = frontFirst ? front : behind;
+		const Vector3& end = frontFirst ? behind : front;
+		Vector3 screenStart, screenEnd;
+		if (!pipeline.TransformSegment(start, end, screenStart, screenEnd)) {
+			wrongResult++;
+			continue;
+		}
+		Vector4d clipStart = reference.Clip(start), clipEnd = reference.Clip(end);
+		Vector4d& clipBehind = frontFirst ? clipEnd : clipStart;
+		const Vector4d& clipFront = frontFirst ? clipStart : clipEnd;
+		const double t = clipBehind.z / (clipBehind.z - clipFront.z);
+		clipBehind = { clipBehind.x + (clipFront.x - clipBehind.x) * t, clipBehind.y + (clipFront.y - clipBehind.y) * t,
+			0.0, clipBehind.w + (clipFront.w - clipBehind.w) * t };
+		const double error =
+		    std::max(PixelError(reference.Screen(clipStart), screenStart), PixelError(reference.Screen(clipEnd), screenEnd));
+		maxError = error <= maxError ? maxError : error;
+		// 切り取った端点は近クリップ面上(深度はminDepth)
+		wrongResult += (frontFirst ? screenEnd.z : screenStart.z) != 0.0f;
+
+		// 両端とも手前なら見えない、両端とも奥なら端点をそのまま変換する
+		const Vector3 farther = Transform(Add(cross, Multiply(2.0f * length(random), direction)), viewToWorld);
+		const Vector3 behindFarther = Transform(Subtract(cross, Multiply(0.1f + length(random), direction)), viewToWorld);
+		wrongResult += pipeline.TransformSegment(behind, behindFarther, screenStart, screenEnd);
+		if (!pipeline.TransformSegment(front, farther, screenStart, screenEnd)) {
+			wrongResult++;
+			continue;
+		}
+		const double frontError = std::max(PixelError(reference.Screen(reference.Clip(front)), screenStart),
+		    PixelError(reference.Screen(reference.Clip(farther)), screenEnd));
+		maxError = frontError <= maxError ? maxError : frontError;
+	}
+	const bool ok = wrongResult == 0 && maxError <= kSegmentPixelTolerance;
+	std::printf("%-18s segments %zu  wrong results %zu  max error %.3f px  %s\n", "TransformSegment",
+	    kSegmentCount, wrongResult, maxError, ok ? "ok" : "NG");
+	return ok;
+}
+
+} // namespace
+
+int main() {
+	std::printf("simd: %s  vertices: %zu\n", GetSimdLevelName(GetSimdLevel()), kVertexCount);
+
+	std::mt19937 random(0);
+	std::uniform_real_distribution<float> distribution(-10.0f, 10.0f);
+	std::uniform_real_distribution<float> farDistribution(-150.0f, 150.0f);
+	std::vector<Vertex> vertices(kVertexCount);
+	std::vector<Vector3> positions(kVertexCount);
+	std::vector<float> xs(kVertexCount), ys(kVertexCount), zs(kVertexCount);
+	for (size_t i = 0; i < kVertexCount; i++) {
+		// 一部は遠クリップ面の外側にも届くように広く置く
+		std::uniform_real_distribution<float>& range = i % 8 == 0 ? farDistribution : distribution;
+		const Vector3 position{ range(random), range(random), range(random) };
+		vertices[i] = Vertex{ position, Vector3{ 0.0f, 1.0f, 0.0f }, 0.0f, 0.0f };
+		positions[i] = position;
+		xs[i] = position.x;
+		ys[i] = position.y;
+		zs[i] = position.z;
+	}
+
+	const Matrix4x4 world = MakeAffineMatrix(Vector3{ 1.5f, 1.5f, 1.5f }, Vector3{ 0.2f, 0.4f, 0.0f }, Vector3{ 0.0f, 0.0f, 5.0f });
+	const Matrix4x4 view = MakeViewMatrix(Vector3{ 0.26f, 0.0f, 0.0f }, Vector3{ 0.0f, 1.9f, -6.49f });
+	const float fovY = 0.45f, aspectRatio = 1280.0f / 720.0f, nearClip = 0.1f;
+	const Matrix4x4 projection = MakePerspectiveFovMatrix(fovY, aspectRatio, nearClip, 100.0f);
+	const Matrix4x4 viewport = MakeViewportMatrix(0.0f, 0.0f, 1280.0f, 720.0f, 0.0f, 1.0f);
+	const VertexPipeline pipeline(world, view, projection, viewport);
+
+	std::vector<Vector3> chained(kVertexCount);
+	std::vector<ScreenVertex> output(kVertexCount);
+
+	// 3つの入力形式の結果を倍精度の値と比べる
+	const Reference reference{ &world, &view, &projection, &viewport };
+	pipeline.Transform(positions.data(), kCheckCount, output.data());
+	bool ok = CheckOutput("Vector3 array", reference, positions, output);
+	pipeline.Transform(ConstVector3SoA(xs.data(), ys.data(), zs.data()), kCheckCount, output.data());
+	ok = CheckOutput("SoA", reference, positions, output) && ok;
+	pipeline.Transform(&vertices[0].position, sizeof(Vertex), kCheckCount, output.data());
+	ok = CheckOutput("strided vertices", reference, positions, output) && ok;
+	ok = CheckSegments(reference, pipeline, world, view, nearClip, fovY, aspectRatio) && ok;
+
+	// 視錐台の内側の頂点について、4回のTransformとの差を調べる
+	pipeline.Transform(&vertices[0].position, sizeof(Vertex), kVertexCount, output.data());
+	size_t behindNear = 0, inside = 0;
+	double maxError = 0.0;
+	for (size_t i = 0; i < kVertexCount; i++) {
+		if (output[i].clipFlags & kClipNear) {
+			behindNear++;
+			continue;
+		}
+		if (output[i].clipFlags != 0) {
+			continue;
+		}
+		inside++;
+		const Vector3 expected = Transform(Transform(Transform(Transform(positions[i], world), view), projection), viewport);
+		const Vector3 difference = Subtract(expected, output[i].position);
+		const double scale = std::max(1.0f, Length(expected));
+		maxError = std::max(maxError, double(Length(difference)) / scale);
+	}
+	std::printf("behind near plane %.1f%%  inside view %.1f%%  max relative error %.1e\n",
+	    100.0 * double(behindNear) / kVertexCount, 100.0 * double(inside) / kVertexCount, maxError);
+
+	// 手前の頂点はw <= 0で除算することがあるが、計測には影響しない
+	const double chain = Benchmark::MeasureThroughput(kVertexCount, [&] {
+		for (size_t i = 0; i < kVertexCount; i++) {
+			chained[i] = Transform(Transform(Transform(Transform(positions[i], world), view), projection), viewport);
+		}
+		Benchmark::DoNotOptimize(chained);
+	});
+	const Matrix4x4 composed = Multiply(Multiply(Multiply(world, view), projection), viewport);
+	const double composedChain = Benchmark::MeasureThroughput(kVertexCount, [&] {
+		for (size_t i = 0; i < kVertexCount; i++) {
+			chained[i] = Transform(positions[i], composed);
+		}
+		Benchmark::DoNotOptimize(chained);
+	});
+	const double aos = Benchmark::MeasureThroughput(kVertexCount, [&] {
+		pipeline.Transform(positions.data(), kVertexCount, output.data());
+		Benchmark::DoNotOptimize(output);
+	});
+	const double strided = Benchmark::MeasureThroughput(kVertexCount, [&] {
+		pipeline.Transform(&vertices[0].position, sizeof(Vertex), kVertexCount, output.data());
+		Benchmark::DoNotOptimize(output);
+	});
+	const double soa = Benchmark::MeasureThroughput(kVertexCount, [&] {
+		pipeline.Transform(ConstVector3SoA(xs.data(), ys.data(), zs.data()), kVertexCount, output.data());
+		Benchmark::DoNotOptimize(output);
+	});
+
+	std::printf("%-34s %8.1f M/s\n", "Transform x4 per vertex", chain * 1e-6);
+	std::printf("%-34s %8.1f M/s  x%.2f\n", "Transform with composed matrix", composedChain * 1e-6, composedChain / chain);
+	std::printf("%-34s %8.1f M/s  x%.2f\n", "VertexPipeline (Vector3 array)", aos * 1e-6, aos / chain);
+	std::printf("%-34s %8.1f M/s  x%.2f\n", "VertexPipeline (strided vertices)", strided * 1e-6, strided / chain);
+	std::printf("%-34s %8.1f M/s  x%.2f\n", "VertexPipeline (SoA)", soa * 1e-6, soa / chain);
+	return ok ? 0 : 1;
+}